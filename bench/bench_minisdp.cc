@@ -0,0 +1,1101 @@
+/**
+ * @file bench/bench_minisdp.cc
+ * @brief micro benchmarks of sdp parsing and mini sdp packing
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ * usage: run_bench [--json <file>] [--filter <substr>] [--min-time <ms>]
+ *
+ */
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <linux/perf_event.h>
+#include <random>
+#include <sched.h>
+#include <string>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+#include "alloc_stats.h"
+#include "flat_sdp.h"
+#include "metrics.h"
+#include "mini_sdp.h"
+#include "mini_sdp_c.h"
+#include "packet_classifier.h"
+#include "sdp_parser.h"
+#include "sdp_rewriter.h"
+#include "sdp_snapshot.h"
+#include "session_ring.h"
+#include "stage_stats.h"
+#include "transcode_context.h"
+
+using namespace mini_sdp;
+
+struct BenchResult {
+    std::string name;
+    uint64_t    iterations      = 0;
+    double      ns_per_op       = 0;
+    double      ops_per_sec     = 0;
+    double      p50_ns          = 0;
+    double      p99_ns          = 0;
+    double      allocs_per_op   = 0;
+    double      bytes_per_op    = 0;
+};
+
+static double g_min_time_ms = 300;
+
+/**
+ * @brief run func repeatedly for at least g_min_time_ms
+ *  每个样本为一批调用的平均耗时，批大小使单个样本约 20us，以摊薄计时开销
+ */
+static BenchResult runBench(const std::string& name, const std::function<void()>& func) {
+    using Clock = std::chrono::steady_clock;
+    const double kSampleNs = 20000;
+
+    // warm up and pick a batch size
+    uint64_t batch = 1;
+    for (;;) {
+        auto start = Clock::now();
+        for (uint64_t i = 0; i < batch; i++) func();
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        if (ns >= kSampleNs || batch >= (1u << 20)) break;
+        batch *= 2;
+    }
+
+    std::vector<double> samples;
+    samples.reserve(1 << 16);   // keep vector growth out of the allocation count
+    uint64_t iterations = 0;
+    double total_ns = 0;
+    AllocScope scope;
+    while (total_ns < g_min_time_ms * 1e6 || samples.size() < 100) {
+        auto start = Clock::now();
+        for (uint64_t i = 0; i < batch; i++) func();
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        samples.push_back(ns / batch);
+        iterations += batch;
+        total_ns += ns;
+    }
+    uint64_t alloc_count = scope.Allocs();
+    uint64_t alloc_bytes = scope.Bytes();
+
+    std::sort(samples.begin(), samples.end());
+    BenchResult result;
+    result.name = name;
+    result.iterations = iterations;
+    result.ns_per_op = total_ns / iterations;
+    result.ops_per_sec = 1e9 / result.ns_per_op;
+    result.p50_ns = samples[samples.size() / 2];
+    result.p99_ns = samples[std::min(samples.size() - 1, samples.size() * 99 / 100)];
+    result.allocs_per_op = (double)alloc_count / iterations;
+    result.bytes_per_op = (double)alloc_bytes / iterations;
+    return result;
+}
+
+static void printResult(const BenchResult& result) {
+    printf("%-28s %10.0f ns/op %12.0f ops/s  p50 %8.0f  p99 %8.0f  %6.1f allocs/op %8.0f B/op\n",
+           result.name.c_str(), result.ns_per_op, result.ops_per_sec, result.p50_ns, result.p99_ns,
+           result.allocs_per_op, result.bytes_per_op);
+}
+
+static const char* kFingerprint =
+    "a=fingerprint:sha-256 8A:BD:A6:61:75:AF:31:4C:02:81:2A:FA:12:92:4C:48:7B:9F:23:DD:BF:3D:51:30:"
+    "E7:59:5C:9B:17:3D:92:34\r\n";
+
+static const char* kExtmaps =
+    "a=extmap:2 http://www.webrtc.org/experiments/rtp-hdrext/abs-send-time\r\n"
+    "a=extmap:3 http://www.ietf.org/id/draft-holmer-rmcat-transport-wide-cc-extensions-01\r\n"
+    "a=extmap:12 http://www.webrtc.org/experiments/rtp-hdrext/playout-delay\r\n";
+
+// chrome style offer, every H264 profile comes with a rtx codec
+static std::string makeOffer(int h264_num) {
+    std::string sdp = "v=0\r\no=- 4611731400430051336 2 IN IP4 127.0.0.1\r\ns=-\r\nt=0 0\r\na=group:BUNDLE 0 1\r\n"
+                      "m=audio 9 UDP/TLS/RTP/SAVPF 111\r\n"
+                      "c=IN IP4 0.0.0.0\r\na=ice-ufrag:Zh1u\r\na=ice-pwd:2P3Ww8ytUu1Sz6NUy1mWOUZr\r\n";
+    sdp += kFingerprint;
+    sdp += "a=setup:actpass\r\na=mid:0\r\n";
+    sdp += kExtmaps;
+    sdp += "a=sendonly\r\na=rtcp-mux\r\n"
+           "a=rtpmap:111 opus/48000/2\r\na=rtcp-fb:111 transport-cc\r\na=fmtp:111 minptime=10;useinbandfec=1\r\n"
+           "a=ssrc:3570614608 cname:4TOk42mSjXCkVIa6\r\n";
+
+    std::string pts, lines;
+    for (int i = 0, pt = 96; i < h264_num; i++, pt += 2) {
+        std::string fmt = std::to_string(pt), rtx = std::to_string(pt + 1);
+        pts += " " + fmt + " " + rtx;
+        lines += "a=rtpmap:" + fmt + " H264/90000\r\n"
+                 "a=rtcp-fb:" + fmt + " goog-remb\r\na=rtcp-fb:" + fmt + " transport-cc\r\n"
+                 "a=rtcp-fb:" + fmt + " nack\r\na=rtcp-fb:" + fmt + " nack pli\r\n"
+                 "a=fmtp:" + fmt + " level-asymmetry-allowed=1;packetization-mode=1;profile-level-id=42e01f\r\n"
+                 "a=rtpmap:" + rtx + " rtx/90000\r\na=fmtp:" + rtx + " apt=" + fmt + "\r\n";
+    }
+    sdp += "m=video 9 UDP/TLS/RTP/SAVPF" + pts + "\r\n";
+    sdp += "c=IN IP4 0.0.0.0\r\na=ice-ufrag:Zh1u\r\na=ice-pwd:2P3Ww8ytUu1Sz6NUy1mWOUZr\r\n";
+    sdp += kFingerprint;
+    sdp += "a=setup:actpass\r\na=mid:1\r\n";
+    sdp += kExtmaps;
+    sdp += "a=sendonly\r\na=rtcp-mux\r\n" + lines;
+    sdp += "a=ssrc-group:FID 2291961624 1366387413\r\n"
+           "a=ssrc:2291961624 cname:4TOk42mSjXCkVIa6\r\na=ssrc:1366387413 cname:4TOk42mSjXCkVIa6\r\n";
+    return sdp;
+}
+
+// server answer with a candidate
+static std::string makeAnswer() {
+    std::string sdp = "v=0\r\no=- 1 0 IN IP4 127.0.0.1\r\ns=webrtc_core\r\nt=0 0\r\na=group:BUNDLE 0 1\r\n";
+    for (int mid = 0; mid < 2; mid++) {
+        sdp += mid == 0 ? "m=audio 1 UDP/TLS/RTP/SAVPF 111\r\n" : "m=video 1 UDP/TLS/RTP/SAVPF 102 124\r\n";
+        sdp += "c=IN IP4 0.0.0.0\r\n"
+               "a=candidate:foundation 1 udp 100 127.0.0.1 8000 typ host generation 0\r\n"
+               "a=ice-ufrag:0_xxxx_d71956d9cc93e4a467b11e06fdaf039a_de71a64097d807c3\r\n"
+               "a=ice-pwd:be8577c0a03b0d3ffa4e5235\r\n";
+        sdp += kFingerprint;
+        sdp += "a=setup:passive\r\na=sendrecv\r\na=mid:" + std::to_string(mid) + "\r\n";
+        sdp += kExtmaps;
+        if (mid == 0) {
+            sdp += "a=rtcp-mux\r\na=rtpmap:111 opus/48000/2\r\na=rtcp-fb:111 nack\r\n"
+                   "a=fmtp:111 stereo=1;useinbandfec=1\r\na=ssrc:27172315 cname:webrtccore\r\n";
+        } else {
+            sdp += "a=rtcp-mux\r\na=rtpmap:102 H264/90000\r\na=rtcp-fb:102 nack\r\na=rtcp-fb:102 transport-cc\r\n"
+                   "a=fmtp:102 bframe-enabled=1;packetization-mode=1\r\na=rtpmap:124 flexfec-03/90000\r\n"
+                   "a=ssrc:50331648 cname:webrtccore\r\na=ssrc:50331649 cname:webrtccore\r\n";
+        }
+    }
+    return sdp;
+}
+
+static OriginSdpAttr makeAttr(const std::string& sdp, SdpType sdp_type) {
+    OriginSdpAttr attr;
+    attr.origin_sdp = sdp;
+    attr.sdp_type = sdp_type;
+    attr.stream_url = "webrtc://domain/live/xxxx_d71956d9cc93e4a467b11e06fdaf039a?txSecret=0123456789abcdef";
+    attr.svrsig = sdp_type == SdpType::kAnswer ? "1h8s" : "";
+    attr.status_code = sdp_type == SdpType::kAnswer ? 200 : 0;
+    attr.is_imm_send = sdp_type == SdpType::kOffer;
+    attr.is_compact_fingerprint = true;
+    return attr;
+}
+
+// avoid the result of a benchmark being optimized away
+static volatile size_t g_sink;
+
+static void benchSdp(const std::string& label, const OriginSdpAttr& origin, std::vector<BenchResult>& results,
+                     const std::string& filter) {
+    auto run = [&](const std::string& stage, const std::function<void()>& func) {
+        std::string name = stage + "/" + label;
+        if (!filter.empty() && name.find(filter) == std::string::npos) return;
+        results.push_back(runBench(name, func));
+        printResult(results.back());
+    };
+
+    const std::string& sdp = origin.origin_sdp;
+    run("parse", [&] {
+        SdpParser parser(sdp.data(), sdp.size());
+        parser.Parse();
+        g_sink = parser.GetSessionDescription()->Medias.size();
+    });
+
+    SdpParser parser(sdp.data(), sdp.size());
+    parser.Parse();
+    auto sdp_info = parser.GetSessionDescription();
+    run("to_string", [&] { g_sink = sdp_info->ToString().size(); });
+
+    for (uint8_t version = 0; version < 2; version++) {
+        OriginSdpAttr attr = origin;
+        attr.version = version;
+        std::string suffix = version == 0 ? "" : "_v1";
+        char buff[1400];
+        run("pack" + suffix, [&] { g_sink = ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff)); });
+
+        ssize_t size = ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff));
+        run("load" + suffix, [&] {
+            OriginSdpAttr loaded;
+            g_sink = LoadMiniSdpToOriginSdp(buff, size, loaded);
+        });
+
+        // a worker reusing its context and result
+        TranscodeContext ctx;
+        run("ctx_pack" + suffix, [&] { g_sink = ParseOriginSdpToMiniSdp(ctx, attr, buff, sizeof(buff)); });
+        OriginSdpAttr loaded;
+        run("ctx_load" + suffix, [&] { g_sink = LoadMiniSdpToOriginSdp(ctx, buff, size, loaded); });
+    }
+}
+
+static void benchStop(std::vector<BenchResult>& results, const std::string& filter) {
+    StopStreamAttr attr;
+    attr.svrsig = "127.0.0.1:0_xxxx_d71956d9cc93e4a467b11e06fdaf039a_de71a64097d807c3:1h8s";
+    attr.seq = 1;
+    char buff[1400];
+    ssize_t size = BuildStopStreamPacket(buff, sizeof(buff), attr);
+    std::vector<std::pair<std::string, std::function<void()>>> stages = {
+        {"stop_build", [&] { g_sink = BuildStopStreamPacket(buff, sizeof(buff), attr); }},
+        {"stop_load", [&] {
+            StopStreamAttr loaded;
+            g_sink = LoadStopStreamPacket(buff, size, loaded);
+        }},
+    };
+    for (auto& stage : stages) {
+        if (!filter.empty() && stage.first.find(filter) == std::string::npos) continue;
+        results.push_back(runBench(stage.first, stage.second));
+        printResult(results.back());
+    }
+}
+
+/*
+ * stats overhead
+ *  同一二进制内关闭/开启运行时开关交替测量，各取最小值，避免构建差异
+ */
+static void benchOverhead(const std::string& name, const std::function<void(bool)>& set_enabled,
+                          const std::string& label, const OriginSdpAttr& attr, std::vector<BenchResult>& results, const std::string& filter) {
+    if (!filter.empty() && name.find(filter) == std::string::npos) return;
+    char buff[1400];
+    ssize_t size = ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff));
+    std::vector<std::pair<std::string, std::function<void()>>> stages = {
+        {"pack", [&] { g_sink = ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff)); }},
+        {"load", [&] {
+            OriginSdpAttr loaded;
+            g_sink = LoadMiniSdpToOriginSdp(buff, size, loaded);
+        }},
+    };
+    for (auto& stage : stages) {
+        BenchResult best[2];
+        for (int round = 0; round < 3; round++) {
+            for (int enabled = 0; enabled < 2; enabled++) {
+                set_enabled(enabled);
+                BenchResult result = runBench(name + "/" + stage.first + (enabled ? "_on" : "_off") + "/" + label,
+                                              stage.second);
+                if (round == 0 || result.ns_per_op < best[enabled].ns_per_op) best[enabled] = result;
+            }
+        }
+        set_enabled(true);
+        results.push_back(best[0]);
+        results.push_back(best[1]);
+        printf("%-28s %10.0f ns/op off, %10.0f ns/op on, overhead %.2f%%\n",
+               (name + "/" + stage.first + "/" + label).c_str(), best[0].ns_per_op, best[1].ns_per_op,
+               100.0 * (best[1].ns_per_op - best[0].ns_per_op) / best[0].ns_per_op);
+    }
+}
+
+// absolute cost of recording, A/B above is within noise on a busy host
+static void benchMetrics(const OriginSdpAttr& attr, std::vector<BenchResult>& results, const std::string& filter) {
+    char buff[1400];
+    ssize_t size = ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff));
+    std::vector<char> text(64 * 1024);
+    std::vector<std::pair<std::string, std::function<void()>>> stages = {
+        {"metrics_record_pack", [&] { RecordPackMetrics(attr, size); }},
+        {"metrics_record_load", [&] { RecordLoadMetrics(buff, attr, size); }},
+        {"metrics_render", [&] { g_sink = RenderPrometheusMetrics(text.data(), text.size()); }},
+    };
+    for (auto& stage : stages) {
+        if (!filter.empty() && stage.first.find(filter) == std::string::npos) continue;
+        results.push_back(runBench(stage.first, stage.second));
+        printResult(results.back());
+    }
+}
+
+// if-chain of the per-protocol checks, the baseline of the table lookup
+static PacketClass classifyByChecks(const char* data, size_t len) {
+    if (IsMiniSdpReqPack(data, len)) return kPacketMiniSdpReq;
+    if (IsMiniSdpStopPack(data, len)) return kPacketMiniSdpStop;
+    if (len < 4) return kPacketUnknown;
+    uint8_t byte = data[0];
+    if (byte >= 128 && byte <= 191) {
+        uint8_t pt = data[1];
+        if (pt >= 192 && pt <= 223) return len >= 8 ? kPacketRtcp : kPacketUnknown;
+        return len >= 12 ? kPacketRtp : kPacketUnknown;
+    }
+    if (byte <= 3) return len >= 20 ? kPacketStun : kPacketUnknown;
+    if (byte >= 20 && byte <= 63) return len >= 13 ? kPacketDtls : kPacketUnknown;
+    if (byte >= 64 && byte <= 79) return kPacketTurnChannel;
+    if (byte >= 16 && byte <= 19) return len >= 12 ? kPacketZrtp : kPacketUnknown;
+    return kPacketUnknown;
+}
+
+/*
+ * garbage flood
+ *  offer 中的一行数字被破坏，每轮依次处理所有样本，ns/op 为单个样本的平均耗时；
+ *  逃出解析或打包的异常由服务的收包循环捕获，这里同样捕获，并输出抛出异常的样本数
+ */
+static void benchMalformed(std::vector<BenchResult>& results, const std::string& filter) {
+    const std::vector<std::pair<std::string, std::string>> corruptions = {
+        {"a=rtcp-fb:96 nack pli", "a=rtcp-fb:9x nack pli"},
+        {"a=rtcp-fb:111 transport-cc", "a=rtcp-fb:* transport-cc"},
+        {"packetization-mode=1;profile", "packetization-mode=1;bframe-enabled=on;profile"},
+        {"a=rtpmap:111 opus/48000/2", "a=rtpmap:111 opus/48k/2"},
+        {"a=rtpmap:98 H264/90000", "a=rtpmap:9999999999999999999999 H264/90000"},
+        {"a=ssrc:3570614608 cname", "a=ssrc:-3570614608 cname"},
+        {"a=ssrc-group:FID 2291961624", "a=ssrc-group:FID 22919616240"},
+        {"a=extmap:12 ", "a=extmap:1x2 "},
+        {"m=video 9 ", "m=video port "},
+    };
+    const std::string offer = makeOffer(8);
+    std::vector<OriginSdpAttr> attrs;
+    for (auto& corruption : corruptions) {
+        OriginSdpAttr attr = makeAttr(offer, SdpType::kOffer);
+        attr.origin_sdp.replace(attr.origin_sdp.find(corruption.first), corruption.first.size(), corruption.second);
+        attrs.push_back(attr);
+    }
+
+    // false if an exception escapes
+    char buff[1400];
+    std::vector<std::pair<std::string, std::function<bool(const OriginSdpAttr&)>>> stages = {
+        {"malformed_parse/offer", [&](const OriginSdpAttr& attr) {
+            try {
+                SdpParser parser(attr.origin_sdp.data(), attr.origin_sdp.size());
+                g_sink = parser.Parse();
+            } catch (const std::exception&) {
+                return false;
+            }
+            return true;
+        }},
+        {"malformed_pack/offer", [&](const OriginSdpAttr& attr) {
+            try {
+                g_sink = ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff));
+            } catch (const std::exception&) {
+                return false;
+            }
+            return true;
+        }},
+    };
+    for (auto& stage : stages) {
+        if (!filter.empty() && stage.first.find(filter) == std::string::npos) continue;
+        size_t thrown = 0;
+        for (auto& attr : attrs) thrown += stage.second(attr) ? 0 : 1;
+
+        BenchResult result = runBench(stage.first, [&] {
+            for (auto& attr : attrs) stage.second(attr);
+        });
+        double num = attrs.size();
+        result.ns_per_op /= num;
+        result.ops_per_sec *= num;
+        result.p50_ns /= num;
+        result.p99_ns /= num;
+        result.allocs_per_op /= num;
+        result.bytes_per_op /= num;
+        results.push_back(result);
+        printResult(results.back());
+        printf("%-28s %10zu of %zu inputs throw\n", "", thrown, attrs.size());
+    }
+}
+
+/*
+ * single port demux
+ *  一批 64 个包，RTP 为主，夹杂 RTCP、STUN、DTLS 和 mini sdp，顺序随机，ns/op 为整批耗时
+ */
+static void benchClassify(std::vector<BenchResult>& results, const std::string& filter) {
+    constexpr size_t kBatch = 64;
+    std::mt19937 rng(20261019);
+    std::vector<std::string> packets;
+    for (size_t i = 0; i < kBatch; i++) {
+        uint32_t dice = rng() % 100;
+        std::string packet;
+        if (dice < 70) {
+            packet.assign(1200, 0);
+            packet[0] = char(0x80);
+            packet[1] = char(96 + rng() % 16);
+        } else if (dice < 85) {
+            packet.assign(64, 0);
+            packet[0] = char(0x81);
+            packet[1] = char(200 + rng() % 7);
+        } else if (dice < 92) {
+            packet.assign(100, 0);
+            packet[0] = char(rng() % 2);
+        } else if (dice < 97) {
+            packet.assign(200, 0);
+            packet[0] = char(22 + rng() % 2);
+        } else {
+            packet = std::string("\xff" "SDP", 4) + std::string(300, 0);
+        }
+        packets.push_back(packet);
+    }
+    std::vector<struct iovec> iovs(kBatch);
+    for (size_t i = 0; i < kBatch; i++) {
+        iovs[i].iov_base = &packets[i][0];
+        iovs[i].iov_len = packets[i].size();
+    }
+
+    PacketQueues queues;
+    std::vector<std::pair<std::string, std::function<void()>>> stages = {
+        {"classify_checks/64", [&] {
+            size_t sum = 0;
+            for (auto& iov : iovs) sum += classifyByChecks((const char*)iov.iov_base, iov.iov_len);
+            g_sink = sum;
+        }},
+        {"classify_table/64", [&] {
+            size_t sum = 0;
+            for (auto& iov : iovs) sum += ClassifyPacket((const char*)iov.iov_base, iov.iov_len);
+            g_sink = sum;
+        }},
+        {"classify_batch/64", [&] {
+            ClassifyPacketBatch(iovs.data(), iovs.size(), queues);
+            g_sink = queues.Size(kPacketRtp);
+        }},
+    };
+    for (auto& stage : stages) {
+        if (!filter.empty() && stage.first.find(filter) == std::string::npos) continue;
+        results.push_back(runBench(stage.first, stage.second));
+        printResult(results.back());
+        printf("%-28s %10.1f Mpkts/s\n", "", kBatch * 1e3 / results.back().ns_per_op);
+    }
+}
+
+/**
+ * @brief hardware counter of this thread, user space only
+ *  perf_event_open 不可用时（容器、perf_event_paranoid）Valid() 为 false
+ */
+class PerfCounter {
+  public:
+    PerfCounter(uint32_t type, uint64_t config) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type = type;
+        attr.size = sizeof(attr);
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (fd_ < 0) error_ = strerror(errno);
+    }
+
+    ~PerfCounter() {
+        if (fd_ >= 0) close(fd_);
+    }
+
+    bool Valid() const { return fd_ >= 0; }
+
+    const std::string& Error() const { return error_; }
+
+    void Start() {
+        ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    uint64_t Stop() {
+        ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t value = 0;
+        if (read(fd_, &value, sizeof(value)) != sizeof(value)) return 0;
+        return value;
+    }
+
+  private:
+    int         fd_ = -1;
+    std::string error_;
+};  // class PerfCounter
+
+// what ToString and the packers read: every codec, fmtp, rtcp-fb, track and extmap
+static size_t walkGraph(const SessionDescription& session) {
+    size_t sum = 0;
+    for (auto& media_pair : session.Medias) {
+        const MediaDescription& media = *media_pair.second;
+        sum += media.Port + media.IceUfrag.size() + media.IcePwd.size();
+        for (auto& codec_pair : media.Codecs) {
+            const CodecDescription& codec = *codec_pair.second;
+            sum += codec.Format + codec.SampleRate + codec.Name.size() + codec.Feedbacks.size();
+            for (auto& param : codec.FormatParams) sum += param.second.size();
+        }
+        for (auto& track_pair : media.Tracks) sum += track_pair.first + track_pair.second->GetAttributes().size();
+        for (auto& ext : media.ExtMap) sum += ext.first + ext.second.size();
+    }
+    return sum;
+}
+
+static size_t walkFlat(const FlatSessionDescription& session) {
+    size_t sum = 0;
+    for (auto& media : session.Medias) {
+        sum += media.Port + media.IceUfrag.Size + media.IcePwd.Size;
+        if (media.IceUfrag.Size > kFlatShortStrCap) sum += media.IceUfrag.Spill.Size - media.IceUfrag.Size;
+        if (media.IcePwd.Size > kFlatShortStrCap) sum += media.IcePwd.Spill.Size - media.IcePwd.Size;
+        for (uint32_t i = 0; i < media.Codecs.Size; i++) {
+            const FlatCodec& codec = session.Codecs[media.Codecs.Begin + i];
+            sum += codec.Format + codec.SampleRate + codec.Name.Size + __builtin_popcount(codec.Feedbacks) +
+                   codec.ExtraFeedbacks.Size;
+            for (uint32_t j = 0; j < codec.FormatParams.Size; j++) {
+                sum += session.Attrs[codec.FormatParams.Begin + j].Value.Size;
+            }
+        }
+        for (uint32_t i = 0; i < media.Tracks.Size; i++) {
+            const FlatTrack& track = session.Tracks[media.Tracks.Begin + i];
+            sum += track.Ssrc + track.Attributes.Size;
+        }
+        for (uint32_t i = 0; i < media.ExtMap.Size; i++) {
+            const FlatExt& ext = session.Exts[media.ExtMap.Begin + i];
+            sum += ext.Id + ext.Uri.Size;
+        }
+    }
+    return sum;
+}
+
+/*
+ * flat session description
+ *  - flat_to_string / flat_assign: 单个描述，cache 中
+ *  - walk_graph / walk_flat: 4096 个描述随机顺序访问，工作集超出 cache，ns/op 为每个描述；
+ *    同时以 perf_event 统计每个描述的 cache miss，并给出每个描述的内存块数
+ */
+static void benchFlat(const std::string& label, const OriginSdpAttr& origin, std::vector<BenchResult>& results,
+                      const std::string& filter) {
+    auto run = [&](const std::string& name, const std::function<void()>& func) {
+        if (!filter.empty() && name.find(filter) == std::string::npos) return false;
+        results.push_back(runBench(name, func));
+        printResult(results.back());
+        return true;
+    };
+    const std::string& sdp = origin.origin_sdp;
+    SdpParser parser(sdp.data(), sdp.size());
+    parser.Parse();
+    SessionDescriptionPtr sdp_info = parser.GetSessionDescription();
+    FlatSessionDescription flat;
+    flat.Assign(*sdp_info);
+    run("flat_to_string/" + label, [&] { g_sink = flat.ToString().size(); });
+    run("flat_assign/" + label, [&] { flat.Assign(*sdp_info); g_sink = flat.Strings.size(); });
+
+    std::string graph_name = "walk_graph/" + label, flat_name = "walk_flat/" + label;
+    bool run_graph = filter.empty() || graph_name.find(filter) != std::string::npos;
+    bool run_flat = filter.empty() || flat_name.find(filter) != std::string::npos;
+    if (!run_graph && !run_flat) return;
+
+    constexpr size_t kSessions = 4096;
+    std::vector<SessionDescriptionPtr> graphs;
+    std::vector<FlatSessionDescription> flats(kSessions);
+    uint64_t graph_blocks = 0, flat_blocks = 0;
+    for (size_t i = 0; i < kSessions; i++) {
+        AllocScope graph_scope;
+        SdpParser copy_parser(sdp.data(), sdp.size());
+        copy_parser.Parse();
+        graphs.push_back(copy_parser.GetSessionDescription());
+        graph_blocks += graph_scope.Allocs();
+        AllocScope flat_scope;
+        flats[i].Assign(*graphs.back());
+        flat_blocks += flat_scope.Allocs();
+    }
+    std::vector<uint32_t> order(kSessions);
+    for (size_t i = 0; i < kSessions; i++) order[i] = uint32_t(i);
+    std::shuffle(order.begin(), order.end(), std::mt19937(20261019));
+    if (walkGraph(*graphs[0]) != walkFlat(flats[0])) printf("walk_graph and walk_flat differ\n");
+
+    // blocks of the parser itself are counted for the graph, the flat copy is built from a parsed graph
+    printf("%-28s %10.1f heap blocks/description graph, %.1f flat\n", "", double(graph_blocks) / kSessions,
+           double(flat_blocks) / kSessions);
+
+    size_t cursor = 0;
+    PerfCounter llc_misses(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    PerfCounter l1d_misses(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                               (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    auto count_misses = [&](const std::string& name, const std::function<void()>& walk) {
+        if (!llc_misses.Valid() || !l1d_misses.Valid()) {
+            printf("%-28s cache misses n/a: perf_event_open: %s\n", name.c_str(),
+                   (llc_misses.Valid() ? l1d_misses.Error() : llc_misses.Error()).c_str());
+            return;
+        }
+        constexpr size_t kPasses = 8;
+        l1d_misses.Start();
+        llc_misses.Start();
+        for (size_t i = 0; i < kPasses * kSessions; i++) walk();
+        uint64_t llc = llc_misses.Stop(), l1d = l1d_misses.Stop();
+        printf("%-28s %10.2f L1D read misses/op %8.2f cache misses/op\n", name.c_str(),
+               double(l1d) / (kPasses * kSessions), double(llc) / (kPasses * kSessions));
+    };
+    auto walk_graph = [&] { g_sink = walkGraph(*graphs[order[cursor++ % kSessions]]); };
+    auto walk_flat = [&] { g_sink = walkFlat(flats[order[cursor++ % kSessions]]); };
+    if (run_graph && run(graph_name, walk_graph)) count_misses(graph_name, walk_graph);
+    if (run_flat && run(flat_name, walk_flat)) count_misses(flat_name, walk_flat);
+}
+
+// sfu style offer, media_num sections with a=mid 0..n-1, audio and video in turn
+static std::string makeManyMedias(int media_num) {
+    std::string sdp = "v=0\r\no=- 4611731400430051336 2 IN IP4 127.0.0.1\r\ns=-\r\nt=0 0\r\na=group:BUNDLE";
+    for (int mid = 0; mid < media_num; mid++) sdp += " " + std::to_string(mid);
+    sdp += "\r\n";
+    for (int mid = 0; mid < media_num; mid++) {
+        bool is_audio = mid % 2 == 0;
+        sdp += is_audio ? "m=audio 9 UDP/TLS/RTP/SAVPF 111\r\n" : "m=video 9 UDP/TLS/RTP/SAVPF 96\r\n";
+        sdp += "c=IN IP4 0.0.0.0\r\na=ice-ufrag:Zh1u\r\na=ice-pwd:2P3Ww8ytUu1Sz6NUy1mWOUZr\r\n";
+        sdp += kFingerprint;
+        sdp += "a=setup:actpass\r\na=mid:" + std::to_string(mid) + "\r\n";
+        sdp += kExtmaps;
+        sdp += "a=sendonly\r\na=rtcp-mux\r\n";
+        sdp += is_audio ? "a=rtpmap:111 opus/48000/2\r\na=rtcp-fb:111 transport-cc\r\n"
+                        : "a=rtpmap:96 H264/90000\r\na=rtcp-fb:96 nack\r\na=rtcp-fb:96 transport-cc\r\n";
+        sdp += "a=ssrc:" + std::to_string(10000 + mid) + " cname:4TOk42mSjXCkVIa6\r\n";
+    }
+    return sdp;
+}
+
+/*
+ * m-line sweep
+ *  1 到 1000 个 media section，ns/op 为每个 media 的耗时，线性扩展时各规模基本持平；
+ *  pack / load 只在 mini sdp 装得下时运行（v0 / v1 最多 255 个 media）
+ */
+static void benchMediaSweep(std::vector<BenchResult>& results, const std::string& filter) {
+    auto run = [&](const std::string& name, int media_num, const std::function<void()>& func) {
+        if (!filter.empty() && name.find(filter) == std::string::npos) return;
+        BenchResult result = runBench(name, func);
+        double num = media_num;
+        result.ns_per_op /= num;
+        result.ops_per_sec *= num;
+        result.p50_ns /= num;
+        result.p99_ns /= num;
+        result.allocs_per_op /= num;
+        result.bytes_per_op /= num;
+        results.push_back(result);
+        printResult(results.back());
+    };
+    std::vector<char> buff(1 << 16);
+    for (int media_num : {1, 10, 100, 1000}) {
+        std::string label = std::to_string(media_num);
+        OriginSdpAttr attr = makeAttr(makeManyMedias(media_num), SdpType::kOffer);
+        const std::string& sdp = attr.origin_sdp;
+        run("sweep_parse/" + label, media_num, [&] {
+            SdpParser parser(sdp.data(), sdp.size());
+            parser.Parse();
+            g_sink = parser.GetSessionDescription()->Medias.size();
+        });
+
+        SdpParser parser(sdp.data(), sdp.size());
+        parser.Parse();
+        SessionDescriptionPtr sdp_info = parser.GetSessionDescription();
+        run("sweep_to_string/" + label, media_num, [&] { g_sink = sdp_info->ToString().size(); });
+        FlatSessionDescription flat;
+        flat.Assign(*sdp_info);
+        run("sweep_flat_to_string/" + label, media_num, [&] { g_sink = flat.ToString().size(); });
+
+        for (uint8_t version = 0; version < 2; version++) {
+            attr.version = version;
+            std::string suffix = version == 0 ? "/" : "_v1/";
+            ssize_t size = ParseOriginSdpToMiniSdp(attr, buff.data(), buff.size());
+            if (size <= 0) continue;
+            run("sweep_pack" + suffix + label, media_num,
+                [&] { g_sink = ParseOriginSdpToMiniSdp(attr, buff.data(), buff.size()); });
+            run("sweep_load" + suffix + label, media_num, [&] {
+                OriginSdpAttr loaded;
+                g_sink = LoadMiniSdpToOriginSdp(buff.data(), size, loaded);
+            });
+        }
+    }
+}
+
+/*
+ * answer rewrite
+ *  替换 candidate 地址、删除 playout-delay extmap 和 flexfec、强制 sendonly：
+ *  SdpRewriter 在原文上逐行改写，对比 Parse → 修改 → ToString
+ */
+static void benchRewrite(const std::string& label, const OriginSdpAttr& origin, std::vector<BenchResult>& results,
+                         const std::string& filter) {
+    auto run = [&](const std::string& stage, const std::function<void()>& func) {
+        std::string name = stage + "/" + label;
+        if (!filter.empty() && name.find(filter) == std::string::npos) return;
+        results.push_back(runBench(name, func));
+        printResult(results.back());
+    };
+    const std::string& sdp = origin.origin_sdp;
+
+    SdpRewriter rewriter;
+    rewriter.SetCandidateAddress("203.0.113.7", 9000);
+    rewriter.DropLine("a=extmap:", "playout-delay");
+    rewriter.DropCodec(kSdpCodecFlexFec);
+    rewriter.SetDirection(SdpTransType::kSendOnly);
+    std::string dst;
+    run("rewrite", [&] { g_sink = rewriter.Rewrite(sdp, dst) + dst.size(); });
+
+    run("parse_mutate", [&] {
+        SdpParser parser(sdp.data(), sdp.size());
+        parser.Parse();
+        SessionDescriptionPtr sdp_info = parser.GetSessionDescription();
+        for (auto& media_pair : sdp_info->Medias) {
+            MediaDescription& media = *media_pair.second;
+            if (!media.Candidate.first.empty()) media.Candidate = {"203.0.113.7", 9000};
+            for (auto it = media.ExtMap.begin(); it != media.ExtMap.end();) {
+                it = it->second.find("playout-delay") != std::string::npos ? media.ExtMap.erase(it) : std::next(it);
+            }
+            for (auto it = media.Codecs.begin(); it != media.Codecs.end();) {
+                it = it->second->Name == kSdpCodecFlexFec ? media.Codecs.erase(it) : std::next(it);
+            }
+            media.TransType = SdpTransType::kSendOnly;
+        }
+        g_sink = sdp_info->ToString().size();
+    });
+}
+
+/*
+ * cross-process handoff of a parsed description
+ *  - handoff_text: ToString → SdpParser::Parse，对端得到 SessionDescription
+ *  - snapshot_write: Assign → WriteSdpSnapshot 到预分配的 buffer（共享内存 / 文件）
+ *  - snapshot_read: Open 校验后原地访问所有 media 的 codec 与 ice-ufrag
+ *  - snapshot_to_session: Open → ToSessionDescription，对端需要对象模型时
+ */
+static void benchSnapshot(const std::string& label, const OriginSdpAttr& origin, std::vector<BenchResult>& results,
+                          const std::string& filter) {
+    auto run = [&](const std::string& stage, const std::function<void()>& func) {
+        std::string name = stage + "/" + label;
+        if (!filter.empty() && name.find(filter) == std::string::npos) return;
+        results.push_back(runBench(name, func));
+        printResult(results.back());
+    };
+    const std::string& sdp = origin.origin_sdp;
+    SdpParser parser(sdp.data(), sdp.size());
+    parser.Parse();
+    SessionDescriptionPtr sdp_info = parser.GetSessionDescription();
+
+    run("handoff_text", [&] {
+        std::string text = sdp_info->ToString();
+        SdpParser peer(text.data(), text.size());
+        peer.Parse();
+        g_sink = peer.GetSessionDescription()->Medias.size();
+    });
+
+    FlatSessionDescription flat;
+    flat.Assign(*sdp_info);
+    std::vector<uint64_t> buff(SdpSnapshotSize(flat) / sizeof(uint64_t) + 1);
+    char* data = reinterpret_cast<char*>(buff.data());
+    size_t size = WriteSdpSnapshot(flat, data, buff.size() * sizeof(uint64_t));
+    if (filter.empty() || ("snapshot_write/" + label).find(filter) != std::string::npos) {
+        printf("%-28s %10lu bytes text, %lu bytes snapshot\n", "", (unsigned long)sdp_info->ToString().size(),
+               (unsigned long)size);
+    }
+
+    run("snapshot_write", [&] {
+        flat.Assign(*sdp_info);
+        g_sink = WriteSdpSnapshot(flat, data, buff.size() * sizeof(uint64_t));
+    });
+    run("snapshot_read", [&] {
+        SdpSnapshotView view;
+        view.Open(data, size);
+        size_t sum = 0;
+        for (auto& media : view.Medias()) {
+            sum += view.Str(media.IceUfrag).len;
+            for (auto& codec : view.Codecs(media.Codecs)) sum += codec.Format + view.Str(codec.Name).len;
+        }
+        g_sink = sum;
+    });
+    run("snapshot_to_session", [&] {
+        SdpSnapshotView view;
+        view.Open(data, size);
+        g_sink = view.ToSessionDescription()->Medias.size();
+    });
+}
+
+/*
+ * per-call cost through the C interface
+ *  embed_*: C++ 接口在嵌入方（cgo、nginx 模块）的用法，输入为指针 + 长度，每次调用先构造 OriginSdpAttr /
+ *  StopStreamAttr 拷入字符串，解码后再把字符串拷出到调用方的 buffer；c_*: mini_sdp_c.h，原地读取输入，
+ *  写入调用方 buffer 或返回视图
+ */
+static void benchCApi(const std::string& label, const OriginSdpAttr& origin, std::vector<BenchResult>& results,
+                      const std::string& filter) {
+    auto run = [&](const std::string& stage, const std::function<void()>& func) {
+        std::string name = stage + "/" + label;
+        if (!filter.empty() && name.find(filter) == std::string::npos) return;
+        results.push_back(runBench(name, func));
+        printResult(results.back());
+    };
+    // the request as the embedder holds it
+    minisdp_attr c_attr;
+    minisdp_attr_init(&c_attr);
+    c_attr.sdp_type = int(origin.sdp_type);
+    c_attr.origin_sdp = minisdp_str{origin.origin_sdp.data(), origin.origin_sdp.size()};
+    c_attr.stream_url = minisdp_str{origin.stream_url.data(), origin.stream_url.size()};
+    c_attr.svrsig = minisdp_str{origin.svrsig.data(), origin.svrsig.size()};
+    c_attr.status_code = origin.status_code;
+    c_attr.is_imm_send = origin.is_imm_send;
+    c_attr.is_compact_fingerprint = origin.is_compact_fingerprint;
+    char buff[1400];
+    std::vector<char> dst(64 * 1024);
+
+    TranscodeContext ctx;
+    run("embed_pack", [&] {
+        OriginSdpAttr attr;
+        attr.sdp_type = SdpType(c_attr.sdp_type);
+        attr.origin_sdp.assign(c_attr.origin_sdp.data, c_attr.origin_sdp.len);
+        attr.stream_url.assign(c_attr.stream_url.data, c_attr.stream_url.len);
+        attr.svrsig.assign(c_attr.svrsig.data, c_attr.svrsig.len);
+        attr.status_code = c_attr.status_code;
+        attr.is_imm_send = c_attr.is_imm_send;
+        attr.is_compact_fingerprint = c_attr.is_compact_fingerprint;
+        g_sink = ParseOriginSdpToMiniSdp(ctx, attr, buff, sizeof(buff));
+    });
+    run("c_pack", [&] { g_sink = minisdp_pack(&c_attr, buff, sizeof(buff), nullptr); });
+
+    ssize_t size = minisdp_pack(&c_attr, buff, sizeof(buff), nullptr);
+    run("embed_load", [&] {
+        OriginSdpAttr attr;
+        g_sink = LoadMiniSdpToOriginSdp(ctx, buff, size, attr);
+        char* out = dst.data();
+        for (const std::string* str : {&attr.origin_sdp, &attr.stream_url, &attr.svrsig}) {
+            memcpy(out, str->data(), str->size());
+            out += str->size();
+        }
+    });
+    minisdp_attr loaded;
+    run("c_load", [&] { g_sink = minisdp_load(buff, size, &loaded, dst.data(), dst.size(), nullptr); });
+    run("c_load_view", [&] { g_sink = minisdp_load_view(buff, size, &loaded); });
+
+    const std::string svrsig = "127.0.0.1:0_xxxx_d71956d9cc93e4a467b11e06fdaf039a_de71a64097d807c3:1h8s";
+    minisdp_stop_attr c_stop = {minisdp_str{svrsig.data(), svrsig.size()}, 0, 1, 0};
+    run("embed_stop_build", [&] {
+        StopStreamAttr attr;
+        attr.svrsig.assign(c_stop.svrsig.data, c_stop.svrsig.len);
+        attr.seq = c_stop.seq;
+        g_sink = BuildStopStreamPacket(buff, sizeof(buff), attr);
+    });
+    run("c_stop_build", [&] { g_sink = minisdp_stop_build(&c_stop, buff, sizeof(buff), nullptr); });
+
+    size = minisdp_stop_build(&c_stop, buff, sizeof(buff), nullptr);
+    run("embed_stop_load", [&] {
+        StopStreamAttr attr;
+        g_sink = LoadStopStreamPacket(buff, size, attr);
+        memcpy(dst.data(), attr.svrsig.data(), attr.svrsig.size());
+    });
+    minisdp_stop_attr stop_loaded;
+    run("c_stop_load", [&] { g_sink = minisdp_stop_load(buff, size, &stop_loaded); });
+}
+
+static uint64_t monotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint64_t(ts.tv_sec) * 1000000000ull + uint64_t(ts.tv_nsec);
+}
+
+// written by the consumer process
+struct XprocResult {
+    uint64_t    count;
+    uint64_t    bytes;
+    uint64_t    p50_ns;
+    uint64_t    p99_ns;
+};
+
+// a request on the socket: the fixed fields, then the strings
+struct XprocMessage {
+    SessionRingMeta meta;
+    uint32_t        lens[3];
+};
+
+/*
+ * cross-process handoff of decoded requests, the consumer in a child process
+ *  - xproc_ring: SessionRing，消费者批量原地读取；xproc_socket: AF_UNIX SOCK_SEQPACKET，序列化后 send，
+ *    recv 到缓冲区后原地读取，即原先经本地 socket 的两次拷贝和每个请求两次系统调用
+ *  - burst: 生产者全速写入（队列满时让出 cpu），ns/op 为生产者每个请求的耗时；
+ *    paced: 请求间隔至少 20us，消费者空闲时阻塞在 eventfd / recv 上
+ *  p50 / p99 为生产者写入到消费者读到的延迟
+ */
+static void benchXproc(const OriginSdpAttr& attr, std::vector<BenchResult>& results, const std::string& filter) {
+    const uint64_t kPacedGapNs = 20000;
+    void* shared = mmap(nullptr, sizeof(XprocResult), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED) return;
+    XprocResult* result = static_cast<XprocResult*>(shared);
+
+    // consume in a child, produce in this process
+    auto run = [&](const std::string& name, bool paced, const std::function<void(uint64_t)>& consume,
+                   const std::function<void(uint64_t, uint64_t)>& produce) {
+        if (!filter.empty() && name.find(filter) == std::string::npos) return;
+        uint64_t count = paced ? uint64_t(g_min_time_ms * 1e6 / kPacedGapNs) : uint64_t(g_min_time_ms * 1000);
+        memset(result, 0, sizeof(*result));
+        pid_t pid = fork();
+        if (pid == 0) {
+            consume(count);
+            _exit(0);
+        }
+        uint64_t start = monotonicNs();
+        produce(count, paced ? kPacedGapNs : 0);
+        double ns = double(monotonicNs() - start);
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (result->count != count) {
+            printf("%s: %lu of %lu consumed\n", name.c_str(), (unsigned long)result->count, (unsigned long)count);
+            return;
+        }
+        BenchResult bench;
+        bench.name = name;
+        bench.iterations = count;
+        bench.ns_per_op = ns / count;
+        bench.ops_per_sec = 1e9 / bench.ns_per_op;
+        bench.p50_ns = double(result->p50_ns);
+        bench.p99_ns = double(result->p99_ns);
+        results.push_back(bench);
+        printResult(bench);
+    };
+    auto finish = [&](const Histogram& latency, uint64_t count, uint64_t bytes) {
+        HistogramSnapshot snapshot;
+        latency.Snapshot(snapshot);
+        result->bytes = bytes;
+        result->p50_ns = snapshot.Percentile(0.5);
+        result->p99_ns = snapshot.Percentile(0.99);
+        result->count = count;
+    };
+    // sleeps rather than spins, the consumer may share the cpu
+    auto pace = [](uint64_t& next, uint64_t gap) {
+        if (gap == 0) return;
+        uint64_t now = monotonicNs();
+        if (now < next) {
+            struct timespec ts = {0, long(next - now)};
+            nanosleep(&ts, nullptr);
+        }
+        next += gap;
+    };
+    RingSourceAddr source;
+    source.family = AF_INET;
+    source.port = 5000;
+
+    for (bool paced : {false, true}) {
+        const char* mode = paced ? "paced" : "burst";
+        SessionRing ring;
+        if (!ring.Create(1024, 1 << 22)) {
+            printf("create session ring failed\n");
+            break;
+        }
+        run(std::string("xproc_ring_") + mode, paced, [&](uint64_t count) {
+            Histogram latency;
+            SessionRingEntry entries[64];
+            uint64_t consumed = 0, bytes = 0;
+            while (consumed < count && ring.Wait(5000)) {
+                size_t n = ring.Peek(entries, 64);
+                uint64_t now = monotonicNs();
+                for (size_t i = 0; i < n; i++) {
+                    latency.Record(now - entries[i].meta->enqueue_ns);
+                    bytes += entries[i].origin_sdp.len + entries[i].stream_url.len;
+                }
+                ring.Release(n);
+                consumed += n;
+            }
+            finish(latency, consumed, bytes);
+        }, [&](uint64_t count, uint64_t gap) {
+            uint64_t next = monotonicNs();
+            for (uint64_t i = 0; i < count;) {
+                pace(next, gap);
+                while (!ring.TryPush(attr, source)) sched_yield();
+                i++;
+            }
+        });
+
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds) != 0) {
+            printf("socketpair failed\n");
+            break;
+        }
+        run(std::string("xproc_socket_") + mode, paced, [&](uint64_t count) {
+            close(fds[0]);
+            Histogram latency;
+            std::vector<char> buff(1 << 16);
+            uint64_t consumed = 0, bytes = 0;
+            while (consumed < count) {
+                ssize_t len = recv(fds[1], buff.data(), buff.size(), 0);
+                if (len < ssize_t(sizeof(XprocMessage))) break;
+                const XprocMessage* message = reinterpret_cast<const XprocMessage*>(buff.data());
+                latency.Record(monotonicNs() - message->meta.enqueue_ns);
+                bytes += message->lens[0] + message->lens[1];
+                consumed++;
+            }
+            finish(latency, consumed, bytes);
+        }, [&](uint64_t count, uint64_t gap) {
+            std::vector<char> buff;
+            uint64_t next = monotonicNs();
+            for (uint64_t i = 0; i < count; i++) {
+                pace(next, gap);
+                XprocMessage message;
+                message.meta.Assign(attr);
+                message.meta.source = source;
+                message.lens[0] = uint32_t(attr.origin_sdp.size());
+                message.lens[1] = uint32_t(attr.stream_url.size());
+                message.lens[2] = uint32_t(attr.svrsig.size());
+                buff.resize(sizeof(message));
+                buff.insert(buff.end(), attr.origin_sdp.begin(), attr.origin_sdp.end());
+                buff.insert(buff.end(), attr.stream_url.begin(), attr.stream_url.end());
+                buff.insert(buff.end(), attr.svrsig.begin(), attr.svrsig.end());
+                message.meta.enqueue_ns = monotonicNs();
+                memcpy(buff.data(), &message, sizeof(message));
+                if (send(fds[0], buff.data(), buff.size(), 0) < 0) break;
+            }
+        });
+        close(fds[0]);
+        close(fds[1]);
+    }
+    munmap(shared, sizeof(XprocResult));
+}
+
+// what a scraper sees, see stage_stats.h
+static void printStageStats() {
+    auto snapshot = GetStageStatsSnapshot();
+    printf("\nstage stats of this run:\n");
+    for (size_t i = 0; i < kSdpStageNum; i++) {
+        auto& latency = snapshot.latency[i];
+        if (latency.count == 0) continue;
+        printf("%-12s count %10lu  mean %8.0f ns  p50 %8lu ns  p99 %8lu ns  max %10lu ns\n",
+               SdpStageName(SdpStage(i)), (unsigned long)latency.count, latency.Mean(),
+               (unsigned long)latency.Percentile(0.5), (unsigned long)latency.Percentile(0.99),
+               (unsigned long)latency.max);
+    }
+}
+
+static bool writeJson(const std::string& path, const std::vector<BenchResult>& results) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) return false;
+    fprintf(file, "{\n  \"unit\": \"ns\",\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        auto& result = results[i];
+        fprintf(file,
+                "    {\"name\": \"%s\", \"iterations\": %lu, \"ns_per_op\": %.1f, \"ops_per_sec\": %.1f, "
+                "\"p50_ns\": %.1f, \"p99_ns\": %.1f, \"allocs_per_op\": %.2f, \"bytes_per_op\": %.1f}%s\n",
+                result.name.c_str(), (unsigned long)result.iterations, result.ns_per_op, result.ops_per_sec,
+                result.p50_ns, result.p99_ns, result.allocs_per_op, result.bytes_per_op,
+                i + 1 == results.size() ? "" : ",");
+    }
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    std::string json_path, filter;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--json") && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (!strcmp(argv[i], "--filter") && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (!strcmp(argv[i], "--min-time") && i + 1 < argc) {
+            g_min_time_ms = atof(argv[++i]);
+        } else {
+            printf("usage: %s [--json <file>] [--filter <substr>] [--min-time <ms>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<BenchResult> results;
+    benchSdp("answer", makeAttr(makeAnswer(), SdpType::kAnswer), results, filter);
+    benchSdp("offer", makeAttr(makeOffer(8), SdpType::kOffer), results, filter);
+    benchStop(results, filter);
+    benchOverhead("stats_overhead", SetStageStatsEnabled, "answer", makeAttr(makeAnswer(), SdpType::kAnswer),
+                  results, filter);
+    // requests take the duplicate check
+    benchOverhead("metrics_overhead", SetSignalingMetricsEnabled, "offer", makeAttr(makeOffer(8), SdpType::kOffer),
+                  results, filter);
+    benchMetrics(makeAttr(makeOffer(8), SdpType::kOffer), results, filter);
+    benchClassify(results, filter);
+    benchMalformed(results, filter);
+    benchFlat("offer", makeAttr(makeOffer(8), SdpType::kOffer), results, filter);
+    benchMediaSweep(results, filter);
+    benchRewrite("answer", makeAttr(makeAnswer(), SdpType::kAnswer), results, filter);
+    benchSnapshot("offer", makeAttr(makeOffer(8), SdpType::kOffer), results, filter);
+    benchXproc(makeAttr(makeOffer(8), SdpType::kOffer), results, filter);
+    benchCApi("answer", makeAttr(makeAnswer(), SdpType::kAnswer), results, filter);
+    printStageStats();
+
+    if (!json_path.empty()) {
+        if (!writeJson(json_path, results)) {
+            printf("write %s failed\n", json_path.c_str());
+            return 1;
+        }
+        printf("results written to %s\n", json_path.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,45 @@
+/**
+ * @file mini_sdp/alloc_stats.cc
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include "alloc_stats.h"
+
+namespace mini_sdp {
+
+// trivial types only, operator new must not allocate to initialize them
+static thread_local uint64_t t_allocs = 0;
+static thread_local uint64_t t_frees = 0;
+static thread_local uint64_t t_bytes = 0;
+static bool g_alloc_hooked = false;
+
+bool IsAllocHooked() {
+    return g_alloc_hooked;
+}
+
+AllocCounter GetThreadAllocCounter() {
+    AllocCounter counter;
+    counter.allocs = t_allocs;
+    counter.frees = t_frees;
+    counter.bytes = t_bytes;
+    return counter;
+}
+
+void OnAllocHook(size_t size) {
+    t_allocs++;
+    t_bytes += size;
+}
+
+void OnFreeHook() {
+    t_frees++;
+}
+
+void SetAllocHooked() {
+    g_alloc_hooked = true;
+}
+
+}  // namespace mini_sdp
@@ -0,0 +1,67 @@
+/**
+ * @file mini_sdp/alloc_stats.h
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#ifndef MINI_SDP_ALLOC_STATS_H_
+#define MINI_SDP_ALLOC_STATS_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mini_sdp {
+
+/*
+ * 堆分配统计
+ *  - 计数由全局 operator new/delete 的替换实现（mini_sdp/hooks/alloc_hooks.cc），
+ *    仅当可执行文件链接了 minisdp_alloc_hooks 时生效，否则计数恒为 0
+ *  - 计数按线程独立，AllocScope 只统计当前线程
+ */
+struct AllocCounter {
+    uint64_t allocs = 0;
+    uint64_t frees  = 0;
+    uint64_t bytes  = 0;    // bytes requested by operator new
+};  // struct AllocCounter
+
+// true if the counting operator new/delete is linked
+bool IsAllocHooked();
+
+// counters of current thread since it starts
+AllocCounter GetThreadAllocCounter();
+
+// called by the hooks only
+void OnAllocHook(size_t size);
+void OnFreeHook();
+void SetAllocHooked();
+
+/**
+ * @brief Alloc Scope
+ *  统计构造之后当前线程的堆分配
+ *
+ *  AllocScope scope;
+ *  ParseOriginSdpToMiniSdp(attr, buff, len);
+ *  printf("%lu allocs, %lu bytes\n", scope.Allocs(), scope.Bytes());
+ */
+class AllocScope {
+  public:
+    AllocScope() : start_(GetThreadAllocCounter()) {}
+
+    uint64_t Allocs() const { return GetThreadAllocCounter().allocs - start_.allocs; }
+
+    uint64_t Frees() const { return GetThreadAllocCounter().frees - start_.frees; }
+
+    uint64_t Bytes() const { return GetThreadAllocCounter().bytes - start_.bytes; }
+
+    void Reset() { start_ = GetThreadAllocCounter(); }
+
+  private:
+    AllocCounter start_;
+};  // class AllocScope
+
+}  // namespace mini_sdp
+
+#endif  // MINI_SDP_ALLOC_STATS_H_
@@ -0,0 +1,685 @@
+/**
+ * @file mini_sdp/flat_sdp.cc
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include "flat_sdp.h"
+#include <algorithm>
+#include <cstring>
+#include "sdp_parser.h"
+
+namespace mini_sdp {
+
+static const char* flat_feedback_names[kFlatFbNum] = {"ccm fir", "goog-remb", "nack", "nack pli", "transport-cc"};
+
+const char* FlatFeedbackName(FlatFeedback feedback) {
+    return feedback < kFlatFbNum ? flat_feedback_names[feedback] : "unknown";
+}
+
+static int findFeedback(const std::string& feedback) {
+    for (int i = 0; i < kFlatFbNum; i++) {
+        if (feedback == flat_feedback_names[i]) return i;
+    }
+    return -1;
+}
+
+static void appendUint(std::string& dst, uint64_t value) {
+    char buff[20];
+    size_t pos = sizeof(buff);
+    do {
+        buff[--pos] = char('0' + value % 10);
+        value /= 10;
+    } while (value);
+    dst.append(buff + pos, sizeof(buff) - pos);
+}
+
+static FlatRange makeRange(size_t begin, size_t end) {
+    FlatRange range;
+    range.Begin = uint32_t(begin);
+    range.Size = uint32_t(end - begin);
+    return range;
+}
+
+/**
+ * FlatSessionDescription
+ */
+
+void FlatSessionDescription::Clear() {
+    *this = FlatSessionDescription();
+}
+
+std::string FlatSessionDescription::Str(const FlatShortStr& str) const {
+    return str.Size <= kFlatShortStrCap ? std::string(str.Data, str.Size) : Str(str.Spill);
+}
+
+FlatStr FlatSessionDescription::addStr(const std::string& str) {
+    FlatStr flat;
+    flat.Offset = uint32_t(Strings.size());
+    flat.Size = uint32_t(str.size());
+    Strings += str;
+    return flat;
+}
+
+void FlatSessionDescription::setShortStr(const std::string& str, FlatShortStr& dst) {
+    if (str.size() <= kFlatShortStrCap) {
+        dst.Size = uint8_t(str.size());
+        memcpy(dst.Data, str.data(), str.size());
+    } else {
+        dst.Size = kFlatShortStrCap + 1;
+        dst.Spill = addStr(str);
+    }
+}
+
+template <typename Map>
+FlatRange FlatSessionDescription::addAttrs(const Map& attrs) {
+    size_t begin = Attrs.size();
+    for (auto& attr : attrs) {
+        FlatAttr flat;
+        flat.Key = addStr(attr.first);
+        flat.Value = addStr(attr.second);
+        Attrs.push_back(flat);
+    }
+    return makeRange(begin, Attrs.size());
+}
+
+void FlatSessionDescription::Assign(const SessionDescription& session) {
+    Medias.clear();
+    Codecs.clear();
+    Tracks.clear();
+    Exts.clear();
+    SsrcGroups.clear();
+    Rids.clear();
+    Attrs.clear();
+    StrPool.clear();
+    Ssrcs.clear();
+    Strings.clear();
+
+    Version = session.Version;
+    AddrType = session.AddrType;
+    TransType = session.TransType;
+    RoleType = session.RoleType;
+    UserName = addStr(session.UserName);
+    SessionId = addStr(session.SessionId);
+    SessionVersion = addStr(session.SessionVersion);
+    SessionName = addStr(session.SessionName);
+    SessionInfo = addStr(session.SessionInfo);
+    MediaStreamId = addStr(session.MediaStreamId);
+    size_t begin = StrPool.size();
+    for (auto& mid : session.GroupBundle) StrPool.push_back(addStr(mid));
+    GroupBundle = makeRange(begin, StrPool.size());
+    Attributes = addAttrs(session.GetAttributes());
+
+    Medias.resize(session.Medias.size());
+    size_t i = 0;
+    for (auto& media_pair : session.Medias) {
+        assignMedia(*media_pair.second, Medias[i]);
+        Medias[i].Key = addStr(media_pair.first);
+        i++;
+    }
+}
+
+void FlatSessionDescription::assignMedia(const MediaDescription& media, FlatMedia& dst) {
+    dst = FlatMedia();
+    dst.MediaType = media.MediaType;
+    dst.AddrType = media.AddrType;
+    dst.TransType = media.TransType;
+    dst.RoleType = media.RoleType;
+    dst.Port = media.Port;
+    dst.CandidatePort = media.Candidate.second;
+    dst.Protos = addStr(media.Protos);
+    dst.MediaId = addStr(media.MediaId);
+    dst.MediaName = addStr(media.MediaName);
+    setShortStr(media.IceUfrag, dst.IceUfrag);
+    setShortStr(media.IcePwd, dst.IcePwd);
+    dst.IceOptions = addStr(media.IceOptions);
+    dst.StreamId = addStr(media.StreamId);
+    dst.TrackId = addStr(media.TrackId);
+    dst.CandidateIp = addStr(media.Candidate.first);
+    dst.FingerprintMethod = addStr(media.Fingerprint.first);
+    dst.FingerprintValue = addStr(media.Fingerprint.second);
+    dst.Simulcast = addStr(media.Simulcast);
+
+    size_t begin = Codecs.size();
+    for (auto& codec_pair : media.Codecs) {
+        const CodecDescription& codec = *codec_pair.second;
+        FlatCodec flat;
+        flat.Format = codec_pair.first;
+        flat.Channels = codec.Channels;
+        flat.SampleRate = codec.SampleRate;
+        flat.Name = addStr(codec.Name);
+        size_t fb_begin = StrPool.size();
+        for (auto& feedback : codec.Feedbacks) {
+            int known = findFeedback(feedback);
+            if (known >= 0) {
+                flat.Feedbacks |= 1u << known;
+            } else {
+                StrPool.push_back(addStr(feedback));
+            }
+        }
+        flat.ExtraFeedbacks = makeRange(fb_begin, StrPool.size());
+        flat.FormatParams = addAttrs(codec.FormatParams);
+        flat.Attributes = addAttrs(codec.GetAttributes());
+        Codecs.push_back(flat);
+    }
+    dst.Codecs = makeRange(begin, Codecs.size());
+
+    begin = Tracks.size();
+    for (auto& track_pair : media.Tracks) {
+        FlatTrack flat;
+        flat.Ssrc = track_pair.first;
+        flat.Attributes = addAttrs(track_pair.second->GetAttributes());
+        Tracks.push_back(flat);
+    }
+    dst.Tracks = makeRange(begin, Tracks.size());
+
+    begin = Ssrcs.size();
+    Ssrcs.insert(Ssrcs.end(), media.TracksOrder.begin(), media.TracksOrder.end());
+    dst.TracksOrder = makeRange(begin, Ssrcs.size());
+
+    begin = Exts.size();
+    for (auto& ext_pair : media.ExtMap) {
+        FlatExt flat;
+        flat.Id = ext_pair.first;
+        flat.Uri = addStr(ext_pair.second);
+        Exts.push_back(flat);
+    }
+    dst.ExtMap = makeRange(begin, Exts.size());
+
+    begin = SsrcGroups.size();
+    for (auto& group : media.SsrcGroups) {
+        FlatSsrcGroup flat;
+        flat.Semantics = addStr(group.Semantics);
+        size_t ssrc_begin = Ssrcs.size();
+        Ssrcs.insert(Ssrcs.end(), group.Ssrcs.begin(), group.Ssrcs.end());
+        flat.Ssrcs = makeRange(ssrc_begin, Ssrcs.size());
+        SsrcGroups.push_back(flat);
+    }
+    dst.SsrcGroups = makeRange(begin, SsrcGroups.size());
+
+    begin = Rids.size();
+    for (auto& rid : media.Rids) {
+        FlatRid flat;
+        flat.Id = addStr(rid.Id);
+        flat.Direction = addStr(rid.Direction);
+        flat.Params = addStr(rid.Params);
+        Rids.push_back(flat);
+    }
+    dst.Rids = makeRange(begin, Rids.size());
+
+    dst.Attributes = addAttrs(media.GetAttributes());
+}
+
+SessionDescriptionPtr FlatSessionDescription::ToSessionDescription() const {
+    SessionDescriptionPtr session = MakeSessionDescription();
+    session->Version = Version;
+    session->AddrType = AddrType;
+    session->TransType = TransType;
+    session->RoleType = RoleType;
+    session->UserName = Str(UserName);
+    session->SessionId = Str(SessionId);
+    session->SessionVersion = Str(SessionVersion);
+    session->SessionName = Str(SessionName);
+    session->SessionInfo = Str(SessionInfo);
+    session->MediaStreamId = Str(MediaStreamId);
+    for (uint32_t i = 0; i < GroupBundle.Size; i++) {
+        session->GroupBundle.push_back(Str(StrPool[GroupBundle.Begin + i]));
+    }
+    for (uint32_t i = 0; i < Attributes.Size; i++) {
+        auto& attr = Attrs[Attributes.Begin + i];
+        session->SetAttribute(Str(attr.Key), Str(attr.Value));
+    }
+
+    for (auto& flat : Medias) {
+        MediaDescriptionPtr media = MakeMediaDescription();
+        media->MediaType = flat.MediaType;
+        media->AddrType = flat.AddrType;
+        media->TransType = flat.TransType;
+        media->RoleType = flat.RoleType;
+        media->Port = flat.Port;
+        media->Protos = Str(flat.Protos);
+        media->MediaId = Str(flat.MediaId);
+        media->MediaName = Str(flat.MediaName);
+        media->IceUfrag = Str(flat.IceUfrag);
+        media->IcePwd = Str(flat.IcePwd);
+        media->IceOptions = Str(flat.IceOptions);
+        media->StreamId = Str(flat.StreamId);
+        media->TrackId = Str(flat.TrackId);
+        media->Candidate = IpPort(Str(flat.CandidateIp), flat.CandidatePort);
+        media->Fingerprint = std::make_pair(Str(flat.FingerprintMethod), Str(flat.FingerprintValue));
+        media->Simulcast = Str(flat.Simulcast);
+
+        for (uint32_t i = 0; i < flat.Codecs.Size; i++) {
+            const FlatCodec& flat_codec = Codecs[flat.Codecs.Begin + i];
+            CodecDescriptionPtr codec = MakeCodecDescription();
+            codec->Format = flat_codec.Format;
+            codec->Channels = flat_codec.Channels;
+            codec->SampleRate = flat_codec.SampleRate;
+            codec->Name = Str(flat_codec.Name);
+            for (int fb = 0; fb < kFlatFbNum; fb++) {
+                if (flat_codec.Feedbacks & (1u << fb)) codec->Feedbacks.insert(flat_feedback_names[fb]);
+            }
+            for (uint32_t j = 0; j < flat_codec.ExtraFeedbacks.Size; j++) {
+                codec->Feedbacks.insert(Str(StrPool[flat_codec.ExtraFeedbacks.Begin + j]));
+            }
+            for (uint32_t j = 0; j < flat_codec.FormatParams.Size; j++) {
+                auto& attr = Attrs[flat_codec.FormatParams.Begin + j];
+                codec->FormatParams[Str(attr.Key)] = Str(attr.Value);
+            }
+            for (uint32_t j = 0; j < flat_codec.Attributes.Size; j++) {
+                auto& attr = Attrs[flat_codec.Attributes.Begin + j];
+                codec->SetAttribute(Str(attr.Key), Str(attr.Value));
+            }
+            media->Codecs[flat_codec.Format] = codec;
+        }
+        for (uint32_t i = 0; i < flat.Tracks.Size; i++) {
+            const FlatTrack& flat_track = Tracks[flat.Tracks.Begin + i];
+            TrackDescriptionPtr track = std::make_shared<TrackDescription>(flat_track.Ssrc);
+            for (uint32_t j = 0; j < flat_track.Attributes.Size; j++) {
+                auto& attr = Attrs[flat_track.Attributes.Begin + j];
+                track->SetAttribute(Str(attr.Key), Str(attr.Value));
+            }
+            media->Tracks[flat_track.Ssrc] = track;
+        }
+        media->TracksOrder.assign(Ssrcs.begin() + flat.TracksOrder.Begin,
+                                  Ssrcs.begin() + flat.TracksOrder.Begin + flat.TracksOrder.Size);
+        for (uint32_t i = 0; i < flat.ExtMap.Size; i++) {
+            auto& ext = Exts[flat.ExtMap.Begin + i];
+            media->ExtMap[ext.Id] = Str(ext.Uri);
+        }
+        for (uint32_t i = 0; i < flat.SsrcGroups.Size; i++) {
+            auto& flat_group = SsrcGroups[flat.SsrcGroups.Begin + i];
+            SsrcGroup group;
+            group.Semantics = Str(flat_group.Semantics);
+            group.Ssrcs.assign(Ssrcs.begin() + flat_group.Ssrcs.Begin,
+                               Ssrcs.begin() + flat_group.Ssrcs.Begin + flat_group.Ssrcs.Size);
+            media->SsrcGroups.push_back(group);
+        }
+        for (uint32_t i = 0; i < flat.Rids.Size; i++) {
+            auto& flat_rid = Rids[flat.Rids.Begin + i];
+            RidDescription rid;
+            rid.Id = Str(flat_rid.Id);
+            rid.Direction = Str(flat_rid.Direction);
+            rid.Params = Str(flat_rid.Params);
+            media->Rids.push_back(rid);
+        }
+        for (uint32_t i = 0; i < flat.Attributes.Size; i++) {
+            auto& attr = Attrs[flat.Attributes.Begin + i];
+            media->SetAttribute(Str(attr.Key), Str(attr.Value));
+        }
+        session->Medias[Str(flat.Key)] = media;
+    }
+    return session;
+}
+
+std::string FlatSessionDescription::ToString() const {
+    std::string sdp;
+    sdp.reserve(Strings.size() * 2 + 1024);
+    AppendString(sdp);
+    return sdp;
+}
+
+void FlatSessionDescription::appendStr(const FlatShortStr& str, std::string& dst) const {
+    if (str.Size <= kFlatShortStrCap) {
+        dst.append(str.Data, str.Size);
+    } else {
+        appendStr(str.Spill, dst);
+    }
+}
+
+void FlatSessionDescription::AppendString(std::string& dst) const {
+    dst += "v=";
+    dst += std::to_string(Version);
+    dst += kSdpEndOfLine;
+
+    auto append_or = [&](const FlatStr& str, const char* def_val) {
+        if (str.Size) {
+            appendStr(str, dst);
+        } else {
+            dst += def_val;
+        }
+    };
+    dst += "o=";
+    append_or(UserName, kSdpPlaceholder);
+    dst += ' ';
+    append_or(SessionId, "0");
+    dst += ' ';
+    append_or(SessionVersion, "0");
+    dst += AddrType == SdpAddrType::kIPv4 ? " IN IP4 127.0.0.1" : " IN IP6 ::1";
+    dst += kSdpEndOfLine;
+
+    dst += "s=";
+    append_or(SessionName, kSdpPlaceholder);
+    dst += kSdpEndOfLine;
+    dst += "t=0 0";
+    dst += kSdpEndOfLine;
+    if (SessionInfo.Size) {
+        dst += "i=";
+        appendStr(SessionInfo, dst);
+        dst += kSdpEndOfLine;
+    }
+
+    dst += "a=group:BUNDLE";
+    for (uint32_t i = 0; i < GroupBundle.Size; i++) {
+        dst += ' ';
+        appendStr(StrPool[GroupBundle.Begin + i], dst);
+    }
+    dst += kSdpEndOfLine;
+    dst += "a=msid-semantic: WMS ";
+    appendStr(MediaStreamId, dst);
+    dst += kSdpEndOfLine;
+
+    for (uint32_t i = 0; i < Attributes.Size; i++) {
+        auto& attr = Attrs[Attributes.Begin + i];
+        dst += "a=";
+        appendStr(attr.Key, dst);
+        if (attr.Value.Size) {
+            dst += ':';
+            appendStr(attr.Value, dst);
+        }
+        dst += kSdpEndOfLine;
+    }
+
+    // medias of the bundle first, in bundle order, then the others in key order
+    // Medias is sorted by key, compared as std::string
+    auto less = [this](const FlatMedia& media, const FlatStr& mid) {
+        int ret = memcmp(Data(media.Key), Data(mid), std::min(media.Key.Size, mid.Size));
+        return ret < 0 || (ret == 0 && media.Key.Size < mid.Size);
+    };
+    std::vector<bool> used(Medias.size(), false);
+    for (uint32_t i = 0; i < GroupBundle.Size; i++) {
+        const FlatStr& mid = StrPool[GroupBundle.Begin + i];
+        auto it = std::lower_bound(Medias.begin(), Medias.end(), mid, less);
+        if (it != Medias.end() && it->Key.Size == mid.Size && memcmp(Data(it->Key), Data(mid), mid.Size) == 0) {
+            appendMedia(*it, dst);
+            used[it - Medias.begin()] = true;
+        }
+    }
+    for (size_t j = 0; j < Medias.size(); j++) {
+        if (!used[j]) appendMedia(Medias[j], dst);
+    }
+}
+
+void FlatSessionDescription::appendMedia(const FlatMedia& media, std::string& dst) const {
+    dst += "m=";
+    switch (media.MediaType) {
+    case SdpMediaType::kAudio:
+        dst += kSdpMediaAudio;
+        break;
+    case SdpMediaType::kVideo:
+        dst += kSdpMediaVideo;
+        break;
+    case SdpMediaType::kData:
+        dst += kSdpMediaData;
+        break;
+    default:
+        dst += "unknown";
+        break;
+    }
+    dst += ' ';
+    appendUint(dst, media.Port);
+    dst += ' ';
+    appendStr(media.Protos, dst);
+    if (media.MediaType == SdpMediaType::kAudio || media.MediaType == SdpMediaType::kVideo) {
+        for (uint32_t i = 0; i < media.Codecs.Size; i++) {
+            dst += ' ';
+            appendUint(dst, Codecs[media.Codecs.Begin + i].Format);
+        }
+    } else if (media.MediaType == SdpMediaType::kData) {
+        dst += ' ';
+        appendStr(media.MediaName, dst);
+    }
+    dst += kSdpEndOfLine;
+
+    const char* addr = media.AddrType == SdpAddrType::kIPv4 ? " IN IP4 0.0.0.0" : " IN IP6 ::";
+    dst += media.AddrType == SdpAddrType::kIPv4 ? "c=IN IP4 0.0.0.0" : "c=IN IP6 ::";
+    dst += kSdpEndOfLine;
+    dst += "a=rtcp:";
+    appendUint(dst, media.Port);
+    dst += addr;
+    dst += kSdpEndOfLine;
+
+    if (media.CandidateIp.Size) {
+        dst += "a=candidate:foundation 1 udp 100 ";
+        appendStr(media.CandidateIp, dst);
+        dst += ' ';
+        appendUint(dst, media.CandidatePort);
+        dst += " typ srflx raddr ";
+        appendStr(media.CandidateIp, dst);
+        dst += " rport ";
+        appendUint(dst, media.CandidatePort);
+        dst += " generation 0";
+        dst += kSdpEndOfLine;
+    }
+
+    if (media.IceUfrag.Size) {
+        dst += "a=ice-ufrag:";
+        appendStr(media.IceUfrag, dst);
+        dst += kSdpEndOfLine;
+    }
+    if (media.IcePwd.Size) {
+        dst += "a=ice-pwd:";
+        appendStr(media.IcePwd, dst);
+        dst += kSdpEndOfLine;
+    }
+    if (media.IceOptions.Size) {
+        dst += "a=ice-options:";
+        appendStr(media.IceOptions, dst);
+        dst += kSdpEndOfLine;
+    }
+    if (media.FingerprintMethod.Size) {
+        dst += "a=fingerprint:";
+        appendStr(media.FingerprintMethod, dst);
+        dst += ' ';
+        appendStr(media.FingerprintValue, dst);
+        dst += kSdpEndOfLine;
+    }
+
+    switch (media.RoleType) {
+    case SdpRoleType::kActpass:
+        dst += "a=setup:actpass";
+        dst += kSdpEndOfLine;
+        break;
+    case SdpRoleType::kActive:
+        dst += "a=setup:active";
+        dst += kSdpEndOfLine;
+        break;
+    case SdpRoleType::kPassive:
+        dst += "a=setup:passive";
+        dst += kSdpEndOfLine;
+        break;
+    case SdpRoleType::kRoleNone:
+    default:
+        break;
+    }
+
+    if (media.MediaId.Size) {
+        dst += "a=mid:";
+        appendStr(media.MediaId, dst);
+        dst += kSdpEndOfLine;
+    }
+
+    switch (media.TransType) {
+    case SdpTransType::kSendRecv:
+        dst += "a=sendrecv";
+        dst += kSdpEndOfLine;
+        break;
+    case SdpTransType::kRecvOnly:
+        dst += "a=recvonly";
+        dst += kSdpEndOfLine;
+        break;
+    case SdpTransType::kSendOnly:
+        dst += "a=sendonly";
+        dst += kSdpEndOfLine;
+        break;
+    case SdpTransType::kInactive:
+        dst += "a=inactive";
+        dst += kSdpEndOfLine;
+        break;
+    case SdpTransType::kTransNone:
+    default:
+        break;
+    }
+
+    dst += "a=rtcp-mux";
+    dst += kSdpEndOfLine;
+    if (media.MediaType == SdpMediaType::kVideo) {
+        dst += "a=rtcp-rsize";
+        dst += kSdpEndOfLine;
+    }
+
+    for (uint32_t i = 0; i < media.ExtMap.Size; i++) {
+        auto& ext = Exts[media.ExtMap.Begin + i];
+        dst += "a=extmap:";
+        appendUint(dst, ext.Id);
+        dst += ' ';
+        appendStr(ext.Uri, dst);
+        dst += kSdpEndOfLine;
+    }
+
+    for (uint32_t i = 0; i < media.Attributes.Size; i++) {
+        auto& attr = Attrs[media.Attributes.Begin + i];
+        dst += "a=";
+        appendStr(attr.Key, dst);
+        dst += ':';
+        appendStr(attr.Value, dst);
+        dst += kSdpEndOfLine;
+    }
+
+    bool flex_fec_enable = false;
+    for (uint32_t i = 0; i < media.Codecs.Size; i++) {
+        const FlatCodec& codec = Codecs[media.Codecs.Begin + i];
+        appendCodec(codec, dst);
+        if (codec.Name.Size == strlen(kSdpCodecFlexFec) && memcmp(Data(codec.Name), kSdpCodecFlexFec, codec.Name.Size) == 0) {
+            flex_fec_enable = true;
+        }
+    }
+
+    for (uint32_t i = 0; i < media.Rids.Size; i++) {
+        auto& rid = Rids[media.Rids.Begin + i];
+        dst += "a=rid:";
+        appendStr(rid.Id, dst);
+        dst += ' ';
+        appendStr(rid.Direction, dst);
+        if (rid.Params.Size) {
+            dst += ' ';
+            appendStr(rid.Params, dst);
+        }
+        dst += kSdpEndOfLine;
+    }
+    if (media.Simulcast.Size) {
+        dst += "a=simulcast:";
+        appendStr(media.Simulcast, dst);
+        dst += kSdpEndOfLine;
+    }
+
+    if (media.SsrcGroups.Size) {
+        for (uint32_t i = 0; i < media.SsrcGroups.Size; i++) {
+            auto& group = SsrcGroups[media.SsrcGroups.Begin + i];
+            dst += "a=ssrc-group:";
+            appendStr(group.Semantics, dst);
+            for (uint32_t j = 0; j < group.Ssrcs.Size; j++) {
+                dst += ' ';
+                appendUint(dst, Ssrcs[group.Ssrcs.Begin + j]);
+            }
+            dst += kSdpEndOfLine;
+        }
+    } else if (flex_fec_enable && media.Tracks.Size > 1) {
+        dst += "a=ssrc-group:FEC-FR";
+        for (uint32_t i = 0; i < media.TracksOrder.Size; i++) {
+            dst += ' ';
+            appendUint(dst, Ssrcs[media.TracksOrder.Begin + i]);
+        }
+        dst += kSdpEndOfLine;
+    }
+
+    // tracks in TracksOrder, binary search in the sorted range
+    auto tracks_begin = Tracks.begin() + media.Tracks.Begin;
+    auto tracks_end = tracks_begin + media.Tracks.Size;
+    for (uint32_t i = 0; i < media.TracksOrder.Size; i++) {
+        uint32_t ssrc = Ssrcs[media.TracksOrder.Begin + i];
+        auto it = std::lower_bound(tracks_begin, tracks_end, ssrc,
+                                   [](const FlatTrack& track, uint32_t value) { return track.Ssrc < value; });
+        if (it == tracks_end || it->Ssrc != ssrc) continue;
+        for (uint32_t j = 0; j < it->Attributes.Size; j++) {
+            auto& attr = Attrs[it->Attributes.Begin + j];
+            dst += "a=ssrc:";
+            appendUint(dst, ssrc);
+            dst += ' ';
+            appendStr(attr.Key, dst);
+            dst += ':';
+            appendStr(attr.Value, dst);
+            dst += kSdpEndOfLine;
+        }
+    }
+}
+
+void FlatSessionDescription::appendCodec(const FlatCodec& codec, std::string& dst) const {
+    dst += "a=rtpmap:";
+    appendUint(dst, codec.Format);
+    dst += ' ';
+    appendStr(codec.Name, dst);
+    dst += '/';
+    appendUint(dst, codec.SampleRate);
+    if (codec.Channels > 0) {
+        dst += '/';
+        appendUint(dst, codec.Channels);
+    }
+    dst += kSdpEndOfLine;
+
+    // known and extra feedbacks merged in lexicographic order, as in std::set
+    auto append_feedback = [&](const char* data, size_t size) {
+        dst += "a=rtcp-fb:";
+        appendUint(dst, codec.Format);
+        dst += ' ';
+        dst.append(data, size);
+        dst += kSdpEndOfLine;
+    };
+    uint32_t extra = 0;
+    for (int fb = 0; fb < kFlatFbNum; fb++) {
+        if (!(codec.Feedbacks & (1u << fb))) continue;
+        const char* name = flat_feedback_names[fb];
+        size_t name_len = strlen(name);
+        for (; extra < codec.ExtraFeedbacks.Size; extra++) {
+            const FlatStr& str = StrPool[codec.ExtraFeedbacks.Begin + extra];
+            int cmp = memcmp(Data(str), name, std::min<size_t>(str.Size, name_len));
+            if (cmp > 0 || (cmp == 0 && str.Size > name_len)) break;
+            append_feedback(Data(str), str.Size);
+        }
+        append_feedback(name, name_len);
+    }
+    for (; extra < codec.ExtraFeedbacks.Size; extra++) {
+        const FlatStr& str = StrPool[codec.ExtraFeedbacks.Begin + extra];
+        append_feedback(Data(str), str.Size);
+    }
+
+    if (codec.FormatParams.Size) {
+        dst += "a=fmtp:";
+        appendUint(dst, codec.Format);
+        dst += ' ';
+        for (uint32_t i = 0; i < codec.FormatParams.Size; i++) {
+            auto& param = Attrs[codec.FormatParams.Begin + i];
+            if (i) dst += ';';
+            appendStr(param.Key, dst);
+            dst += '=';
+            appendStr(param.Value, dst);
+        }
+        dst += kSdpEndOfLine;
+    }
+
+    for (uint32_t i = 0; i < codec.Attributes.Size; i++) {
+        auto& attr = Attrs[codec.Attributes.Begin + i];
+        dst += "a=";
+        appendStr(attr.Key, dst);
+        dst += ':';
+        appendUint(dst, codec.Format);
+        dst += ' ';
+        appendStr(attr.Value, dst);
+        dst += kSdpEndOfLine;
+    }
+}
+
+}  // namespace mini_sdp
@@ -0,0 +1,209 @@
+/**
+ * @file mini_sdp/flat_sdp.h
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#ifndef MINI_SDP_FLAT_SDP_H_
+#define MINI_SDP_FLAT_SDP_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "sdp.h"
+
+namespace mini_sdp {
+
+// a string in FlatSessionDescription::Strings
+struct FlatStr {
+    uint32_t    Offset = 0;
+    uint32_t    Size = 0;
+};
+
+// [Begin, Begin + Size) of a pool of FlatSessionDescription
+struct FlatRange {
+    uint32_t    Begin = 0;
+    uint32_t    Size = 0;
+};
+
+/*
+ * short string
+ *  不超过 kFlatShortStrCap 的字符串（如 ice-ufrag / ice-pwd）内联存储，读取时不访问字符串池，
+ *  更长的存入字符串池
+ */
+constexpr size_t kFlatShortStrCap = 55;
+
+struct FlatShortStr {
+    char        Data[kFlatShortStrCap];
+    uint8_t     Size = 0;
+    FlatStr     Spill;      // Size > kFlatShortStrCap
+};
+
+/*
+ * known rtcp-fb
+ *  常见的 rtcp-fb 以位图表示，其余存入 FlatCodec::ExtraFeedbacks；
+ *  按字典序排列，与 std::set 的遍历顺序一致
+ */
+enum FlatFeedback {
+    kFlatFbCcmFir = 0,      // ccm fir
+    kFlatFbGoogRemb,        // goog-remb
+    kFlatFbNack,            // nack
+    kFlatFbNackPli,         // nack pli
+    kFlatFbTransportCc,     // transport-cc
+    kFlatFbNum
+};
+
+const char* FlatFeedbackName(FlatFeedback feedback);
+
+// <key> <value>, sorted by key in a range
+struct FlatAttr {
+    FlatStr     Key;
+    FlatStr     Value;
+};
+
+struct FlatCodec {
+    uint8_t     Format = 0;
+    uint16_t    Channels = 0;
+    uint32_t    SampleRate = 0;
+    FlatStr     Name;
+    uint32_t    Feedbacks = 0;      // 1 << FlatFeedback
+    FlatRange   ExtraFeedbacks;     // of StrPool, sorted
+    FlatRange   FormatParams;       // of Attrs
+    FlatRange   Attributes;         // of Attrs
+};
+
+struct FlatTrack {
+    uint32_t    Ssrc = 0;
+    FlatRange   Attributes;         // of Attrs
+};
+
+struct FlatExt {
+    uint8_t     Id = 0;
+    FlatStr     Uri;
+};
+
+struct FlatSsrcGroup {
+    FlatStr     Semantics;
+    FlatRange   Ssrcs;              // of Ssrcs
+};
+
+struct FlatRid {
+    FlatStr     Id;
+    FlatStr     Direction;
+    FlatStr     Params;
+};
+
+struct FlatMedia {
+    SdpMediaType    MediaType = SdpMediaType::kAudio;
+    SdpAddrType     AddrType = SdpAddrType::kIPv4;
+    SdpTransType    TransType = SdpTransType::kTransNone;
+    SdpRoleType     RoleType = SdpRoleType::kRoleNone;
+    uint16_t        Port = kSdpMediaPortDefault;
+    uint16_t        CandidatePort = 0;
+
+    FlatStr         Key;            // of SessionDescription::Medias, a=mid unless missing or duplicated
+    FlatStr         Protos;
+    FlatStr         MediaId;
+    FlatStr         MediaName;
+    FlatShortStr    IceUfrag;
+    FlatShortStr    IcePwd;
+    FlatStr         IceOptions;
+    FlatStr         StreamId;
+    FlatStr         TrackId;
+    FlatStr         CandidateIp;
+    FlatStr         FingerprintMethod;
+    FlatStr         FingerprintValue;
+    FlatStr         Simulcast;
+
+    FlatRange       Codecs;         // of Codecs, sorted by format
+    FlatRange       Tracks;         // of Tracks, sorted by ssrc
+    FlatRange       TracksOrder;    // of Ssrcs
+    FlatRange       ExtMap;         // of Exts, sorted by id
+    FlatRange       SsrcGroups;     // of SsrcGroups
+    FlatRange       Rids;           // of Rids
+    FlatRange       Attributes;     // of Attrs
+};
+
+/**
+ * @brief Flat Session Description
+ *  SessionDescription 的扁平表示，所有 media / codec / track / extmap / 属性分别存放在少数几个连续数组中，
+ *  以下标区间引用，字符串存放在一个字符串池中
+ *  - 与 SessionDescription 的遍历顺序一致：区间内按 key 排序，Medias 按 SessionDescription::Medias 的 key 排序
+ *  - 内存块只有十余个（每个池一个），重复 Assign 时复用，遍历时没有指针跳转
+ *  - ToString 的结果与 SessionDescription::ToString 相同
+ */
+class FlatSessionDescription {
+  public:
+    FlatSessionDescription() = default;
+
+    // rebuild from a session description, pools are reused
+    void Assign(const SessionDescription& session);
+
+    SessionDescriptionPtr ToSessionDescription() const;
+
+    std::string ToString() const;
+
+    // appended to dst
+    void AppendString(std::string& dst) const;
+
+    void Clear();
+
+    std::string Str(const FlatStr& str) const { return std::string(Strings.data() + str.Offset, str.Size); }
+
+    std::string Str(const FlatShortStr& str) const;
+
+    const char* Data(const FlatStr& str) const { return Strings.data() + str.Offset; }
+
+  public:
+    int             Version = 0;
+    SdpAddrType     AddrType = SdpAddrType::kIPv4;
+    SdpTransType    TransType = SdpTransType::kTransNone;
+    SdpRoleType     RoleType = SdpRoleType::kRoleNone;
+    FlatStr         UserName;
+    FlatStr         SessionId;
+    FlatStr         SessionVersion;
+    FlatStr         SessionName;
+    FlatStr         SessionInfo;
+    FlatStr         MediaStreamId;
+    FlatRange       GroupBundle;    // of StrPool
+    FlatRange       Attributes;     // of Attrs
+
+    // sorted by key
+    std::vector<FlatMedia>      Medias;
+
+    // pools
+    std::vector<FlatCodec>      Codecs;
+    std::vector<FlatTrack>      Tracks;
+    std::vector<FlatExt>        Exts;
+    std::vector<FlatSsrcGroup>  SsrcGroups;
+    std::vector<FlatRid>        Rids;
+    std::vector<FlatAttr>       Attrs;
+    std::vector<FlatStr>        StrPool;
+    std::vector<uint32_t>       Ssrcs;
+    std::string                 Strings;
+
+  private:
+    FlatStr addStr(const std::string& str);
+
+    void setShortStr(const std::string& str, FlatShortStr& dst);
+
+    template <typename Map>
+    FlatRange addAttrs(const Map& attrs);
+
+    void assignMedia(const MediaDescription& media, FlatMedia& dst);
+
+    void appendMedia(const FlatMedia& media, std::string& dst) const;
+
+    void appendCodec(const FlatCodec& codec, std::string& dst) const;
+
+    void appendStr(const FlatStr& str, std::string& dst) const { dst.append(Data(str), str.Size); }
+
+    void appendStr(const FlatShortStr& str, std::string& dst) const;
+};  // class FlatSessionDescription
+
+}  // namespace mini_sdp
+
+#endif  // MINI_SDP_FLAT_SDP_H_
@@ -0,0 +1,64 @@
+/**
+ * @file mini_sdp/histogram.cc
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include "histogram.h"
+#include <algorithm>
+#include <limits>
+
+namespace mini_sdp {
+
+uint64_t HistogramBucketLowerBound(size_t idx) {
+    if (idx < (1u << kHistogramSubBits)) return idx;
+    int shift = int(idx >> kHistogramSubBits) - 1;
+    uint64_t sub = idx & ((1u << kHistogramSubBits) - 1);
+    return ((1ull << kHistogramSubBits) + sub) << shift;
+}
+
+uint64_t HistogramBucketUpperBound(size_t idx) {
+    if (idx + 1 >= kHistogramBucketNum) return std::numeric_limits<uint64_t>::max();
+    return HistogramBucketLowerBound(idx + 1) - 1;
+}
+
+void HistogramSnapshot::Merge(const HistogramSnapshot &rhs) {
+    for (size_t i = 0; i < kHistogramBucketNum; i++) {
+        buckets[i] += rhs.buckets[i];
+    }
+    count += rhs.count;
+    sum += rhs.sum;
+    max = std::max(max, rhs.max);
+}
+
+uint64_t HistogramSnapshot::Percentile(double q) const {
+    if (count == 0) return 0;
+    uint64_t rank = std::max<uint64_t>(1, uint64_t(q * count + 0.5));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kHistogramBucketNum; i++) {
+        seen += buckets[i];
+        if (seen >= rank) return std::min(HistogramBucketUpperBound(i), max);
+    }
+    return max;
+}
+
+Histogram::Histogram() {
+    for (auto &bucket : buckets_) bucket.store(0, std::memory_order_relaxed);
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+void Histogram::Snapshot(HistogramSnapshot &snapshot) const {
+    for (size_t i = 0; i < kHistogramBucketNum; i++) {
+        snapshot.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+    }
+    snapshot.count = count_.load(std::memory_order_relaxed);
+    snapshot.sum = sum_.load(std::memory_order_relaxed);
+    snapshot.max = max_.load(std::memory_order_relaxed);
+}
+
+}  // namespace mini_sdp
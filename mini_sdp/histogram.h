@@ -0,0 +1,89 @@
+/**
+ * @file mini_sdp/histogram.h
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#ifndef MINI_SDP_HISTOGRAM_H_
+#define MINI_SDP_HISTOGRAM_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "per_thread_stats.h"
+
+namespace mini_sdp {
+
+/*
+ * log-linear 直方图
+ *  每个 2 的幂区间再均分为 2^kHistogramSubBits 个桶，相对误差不超过 1/2^kHistogramSubBits；
+ *  [0, 2^kHistogramSubBits) 的值各占一个桶，超过 2^kHistogramMaxBits 的值记入最后一个桶
+ */
+constexpr int kHistogramSubBits = 3;
+constexpr int kHistogramMaxBits = 40;   // about 18 minutes in ns
+constexpr size_t kHistogramBucketNum = size_t(kHistogramMaxBits - kHistogramSubBits + 1) << kHistogramSubBits;
+
+inline size_t HistogramBucketIndex(uint64_t value) {
+    if (value < (1u << kHistogramSubBits)) return value;
+    int msb = 63 - __builtin_clzll(value);
+    if (msb >= kHistogramMaxBits) return kHistogramBucketNum - 1;
+    int shift = msb - kHistogramSubBits;
+    return (size_t(shift + 1) << kHistogramSubBits) + ((value >> shift) & ((1u << kHistogramSubBits) - 1));
+}
+
+// smallest value of the bucket
+uint64_t HistogramBucketLowerBound(size_t idx);
+
+// largest value of the bucket
+uint64_t HistogramBucketUpperBound(size_t idx);
+
+/**
+ * @brief Histogram Snapshot
+ *  可合并的直方图数据，用于导出和跨线程/进程汇总
+ */
+struct HistogramSnapshot {
+    std::vector<uint64_t>   buckets = std::vector<uint64_t>(kHistogramBucketNum, 0);
+    uint64_t                count   = 0;
+    uint64_t                sum     = 0;
+    uint64_t                max     = 0;
+
+    void Merge(const HistogramSnapshot &rhs);
+
+    double Mean() const { return count ? double(sum) / count : 0; }
+
+    // upper bound of the bucket holding the q-th (0 ~ 1) value, 0 if empty
+    uint64_t Percentile(double q) const;
+};  // struct HistogramSnapshot
+
+/**
+ * @brief Histogram
+ *  单写多读：Record 只能由一个线程调用，Snapshot 可在任意线程调用。
+ *  写入使用 relaxed load + store，不加锁也不使用原子读改写指令
+ */
+class Histogram {
+  public:
+    Histogram();
+
+    void Record(uint64_t value) {
+        StatsBump(buckets_[HistogramBucketIndex(value)]);
+        StatsBump(count_);
+        StatsBump(sum_, value);
+        if (value > max_.load(std::memory_order_relaxed)) max_.store(value, std::memory_order_relaxed);
+    }
+
+    void Snapshot(HistogramSnapshot &snapshot) const;
+
+  private:
+    std::atomic<uint64_t> buckets_[kHistogramBucketNum];
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> sum_;
+    std::atomic<uint64_t> max_;
+};  // class Histogram
+
+}  // namespace mini_sdp
+
+#endif  // MINI_SDP_HISTOGRAM_H_
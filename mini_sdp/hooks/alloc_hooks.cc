@@ -0,0 +1,63 @@
+/**
+ * @file mini_sdp/hooks/alloc_hooks.cc
+ * @brief counting global operator new/delete, see alloc_stats.h
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ * 不属于 minisdp 库，链接 minisdp_alloc_hooks 后替换进程内所有的 operator new/delete
+ *
+ */
+#include <cstdlib>
+#include <new>
+#include "alloc_stats.h"
+
+namespace {
+
+struct AllocHookRegister {
+    AllocHookRegister() { mini_sdp::SetAllocHooked(); }
+};
+
+AllocHookRegister g_alloc_hook_register;
+
+void* countedAlloc(size_t size) {
+    mini_sdp::OnAllocHook(size);
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void countedFree(void* ptr) {
+    if (!ptr) return;
+    mini_sdp::OnFreeHook();
+    free(ptr);
+}
+
+}  // namespace
+
+void* operator new(size_t size) { return countedAlloc(size); }
+
+void* operator new[](size_t size) { return countedAlloc(size); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    mini_sdp::OnAllocHook(size);
+    return malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    mini_sdp::OnAllocHook(size);
+    return malloc(size ? size : 1);
+}
+
+void operator delete(void* ptr) noexcept { countedFree(ptr); }
+
+void operator delete[](void* ptr) noexcept { countedFree(ptr); }
+
+void operator delete(void* ptr, size_t) noexcept { countedFree(ptr); }
+
+void operator delete[](void* ptr, size_t) noexcept { countedFree(ptr); }
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { countedFree(ptr); }
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { countedFree(ptr); }
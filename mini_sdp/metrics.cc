@@ -0,0 +1,301 @@
+/**
+ * @file mini_sdp/metrics.cc
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include "metrics.h"
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include "per_thread_stats.h"
+#include "util.h"
+
+namespace mini_sdp {
+
+static const int g_status_codes[kStatusCodeSlots - 1] = {
+    kStatCodeSuccess, kStatCodeFormatError, kStatCodeParamError, kStatCodeInfoError, kStatCodeAuthError,
+    kStatCodeNotFound
+};
+
+static const char* g_status_names[kStatusCodeSlots] = {
+    "success", "format_error", "param_error", "info_error", "auth_error", "not_found", "other"
+};
+
+// label of SdpRetcodeSlot
+static const char* g_retcode_names[kSdpRetcodeSlots] = {
+    "ok", "wrong_format", "size_exceeded", "url_exceeded", "sdp_param_error", "sdp_unknown_line",
+    "version_unsupported", "other"
+};
+
+size_t StatusCodeSlot(int status_code) {
+    for (size_t i = 0; i < kStatusCodeSlots - 1; i++) {
+        if (g_status_codes[i] == status_code) return i;
+    }
+    return kStatusCodeSlots - 1;
+}
+
+size_t PackedSizeBucket(size_t size) {
+    size_t idx = 0;
+    while (idx < kPackedSizeBucketNum - 1 && size > kPackedSizeBounds[idx]) idx++;
+    return idx;
+}
+
+namespace {
+
+// recently seen packets of a thread, direct mapped
+constexpr size_t kSeenPacketSlots = 1024;
+
+// written by the owner thread only
+struct ThreadSignalingMetrics {
+    std::atomic<uint64_t>   request_packets;
+    std::atomic<uint64_t>   stop_packets;
+    std::atomic<uint64_t>   duplicate_seq;
+    std::atomic<uint64_t>   decode_failures[kSdpRetcodeSlots];
+    std::atomic<uint64_t>   encode_failures[kSdpRetcodeSlots];
+    std::atomic<uint64_t>   answers_packed[kStatusCodeSlots];
+    std::atomic<uint64_t>   answers_loaded[kStatusCodeSlots];
+    std::atomic<uint64_t>   packed_size[kPackedSizeBucketNum];
+    std::atomic<uint64_t>   packed_size_sum;
+    uint64_t                seen_packets[kSeenPacketSlots] = {};
+
+    ThreadSignalingMetrics() {
+        request_packets.store(0, std::memory_order_relaxed);
+        stop_packets.store(0, std::memory_order_relaxed);
+        duplicate_seq.store(0, std::memory_order_relaxed);
+        packed_size_sum.store(0, std::memory_order_relaxed);
+        for (auto &counter : decode_failures) counter.store(0, std::memory_order_relaxed);
+        for (auto &counter : encode_failures) counter.store(0, std::memory_order_relaxed);
+        for (auto &counter : answers_packed) counter.store(0, std::memory_order_relaxed);
+        for (auto &counter : answers_loaded) counter.store(0, std::memory_order_relaxed);
+        for (auto &counter : packed_size) counter.store(0, std::memory_order_relaxed);
+    }
+
+    template <size_t N>
+    static void load(const std::atomic<uint64_t> (&counters)[N], uint64_t (&values)[N]) {
+        for (size_t i = 0; i < N; i++) values[i] = counters[i].load(std::memory_order_relaxed);
+    }
+
+    void Snapshot(SignalingMetricsSnapshot &snapshot) const {
+        snapshot.request_packets = request_packets.load(std::memory_order_relaxed);
+        snapshot.stop_packets = stop_packets.load(std::memory_order_relaxed);
+        snapshot.duplicate_seq = duplicate_seq.load(std::memory_order_relaxed);
+        snapshot.packed_size_sum = packed_size_sum.load(std::memory_order_relaxed);
+        load(decode_failures, snapshot.decode_failures);
+        load(encode_failures, snapshot.encode_failures);
+        load(answers_packed, snapshot.answers_packed);
+        load(answers_loaded, snapshot.answers_loaded);
+        load(packed_size, snapshot.packed_size);
+    }
+
+    // true if the same packet was seen recently
+    bool IsSeen(const char* data, size_t len) {
+        uint64_t hash = packetHash(data, len);
+        uint64_t &slot = seen_packets[hash % kSeenPacketSlots];
+        if (slot == hash) return true;
+        slot = hash;
+        return false;
+    }
+
+    static uint64_t packetHash(const char* data, size_t len) {
+        const uint64_t kMul = 0x9e3779b97f4a7c15ull;
+        uint64_t hash = len * kMul;
+        size_t i = 0;
+        for (; i + 8 <= len; i += 8) {
+            uint64_t word;
+            memcpy(&word, data + i, 8);
+            hash = (hash ^ word) * kMul;
+            hash ^= hash >> 29;
+        }
+        uint64_t tail = 0;
+        memcpy(&tail, data + i, len - i);
+        hash = (hash ^ tail) * kMul;
+        hash ^= hash >> 32;
+        return hash | 1;  // never equal to an empty slot
+    }
+};
+
+typedef PerThreadStats<ThreadSignalingMetrics, SignalingMetricsSnapshot> SignalingMetricsShards;
+
+std::atomic<bool> g_metrics_enabled(true);
+
+template <size_t N>
+void mergeArray(uint64_t (&lhs)[N], const uint64_t (&rhs)[N]) {
+    for (size_t i = 0; i < N; i++) lhs[i] += rhs[i];
+}
+
+}  // namespace
+
+void SignalingMetricsSnapshot::Merge(const SignalingMetricsSnapshot &rhs) {
+    request_packets += rhs.request_packets;
+    stop_packets += rhs.stop_packets;
+    duplicate_seq += rhs.duplicate_seq;
+    packed_size_sum += rhs.packed_size_sum;
+    mergeArray(decode_failures, rhs.decode_failures);
+    mergeArray(encode_failures, rhs.encode_failures);
+    mergeArray(answers_packed, rhs.answers_packed);
+    mergeArray(answers_loaded, rhs.answers_loaded);
+    mergeArray(packed_size, rhs.packed_size);
+}
+
+SignalingMetricsSnapshot GetSignalingMetricsSnapshot() {
+    return SignalingMetricsShards::Collect();
+}
+
+void SetSignalingMetricsEnabled(bool enabled) {
+    g_metrics_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool IsSignalingMetricsEnabled() {
+    return g_metrics_enabled.load(std::memory_order_relaxed);
+}
+
+void RecordPackMetrics(const OriginSdpAttr& attr, ssize_t ret) {
+    if (!IsSignalingMetricsEnabled()) return;
+    auto &metrics = SignalingMetricsShards::Local();
+    if (ret <= 0) {
+        StatsBump(metrics.encode_failures[SdpRetcodeSlot(ret)]);
+        return;
+    }
+    StatsBump(metrics.packed_size[PackedSizeBucket(ret)]);
+    StatsBump(metrics.packed_size_sum, ret);
+    if (attr.sdp_type == SdpType::kAnswer) StatsBump(metrics.answers_packed[StatusCodeSlot(attr.status_code)]);
+}
+
+void RecordLoadMetrics(const char* buff, const OriginSdpAttr& attr, ssize_t ret) {
+    if (!IsSignalingMetricsEnabled()) return;
+    auto &metrics = SignalingMetricsShards::Local();
+    if (ret <= 0) {
+        StatsBump(metrics.decode_failures[SdpRetcodeSlot(ret)]);
+        return;
+    }
+    if (attr.sdp_type == SdpType::kAnswer) {
+        StatsBump(metrics.answers_loaded[StatusCodeSlot(attr.status_code)]);
+        return;
+    }
+    StatsBump(metrics.request_packets);
+    if (metrics.IsSeen(buff, ret)) StatsBump(metrics.duplicate_seq);
+}
+
+void RecordStopLoadMetrics(const char* buff, ssize_t ret) {
+    if (!IsSignalingMetricsEnabled()) return;
+    auto &metrics = SignalingMetricsShards::Local();
+    if (ret <= 0) {
+        StatsBump(metrics.decode_failures[SdpRetcodeSlot(ret)]);
+        return;
+    }
+    StatsBump(metrics.stop_packets);
+    if (metrics.IsSeen(buff, ret)) StatsBump(metrics.duplicate_seq);
+}
+
+namespace {
+
+/**
+ * @brief Text Writer
+ *  格式化写入调用方 buffer，超出后只计数
+ */
+class TextWriter {
+  public:
+    TextWriter(char* buff, size_t len) : writer_(buff, len) {}
+
+    __attribute__((format(printf, 2, 3))) void Printf(const char* fmt, ...) {
+        char line[256];
+        va_list args;
+        va_start(args, fmt);
+        int size = vsnprintf(line, sizeof(line), fmt, args);
+        va_end(args);
+        if (size > 0) writer_.Put(line, std::min(size_t(size), sizeof(line) - 1));
+    }
+
+    void Header(const char* name, const char* type, const char* help) {
+        Printf("# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+    }
+
+    BufferWriter& Writer() { return writer_; }
+
+  private:
+    BufferWriter writer_;
+};  // class TextWriter
+
+void renderSignaling(TextWriter& out, const SignalingMetricsSnapshot& metrics) {
+    out.Header("minisdp_request_packets_received_total", "counter", "Mini SDP requests (offers) decoded.");
+    out.Printf("minisdp_request_packets_received_total %lu\n", (unsigned long)metrics.request_packets);
+
+    out.Header("minisdp_stop_packets_received_total", "counter", "Stop stream packets decoded.");
+    out.Printf("minisdp_stop_packets_received_total %lu\n", (unsigned long)metrics.stop_packets);
+
+    out.Header("minisdp_duplicate_seq_total", "counter",
+               "Decoded requests and stop packets identical to one recently seen by the same thread.");
+    out.Printf("minisdp_duplicate_seq_total %lu\n", (unsigned long)metrics.duplicate_seq);
+
+    out.Header("minisdp_decode_failures_total", "counter", "Mini SDP and stop packets failed to decode.");
+    for (size_t i = 1; i < kSdpRetcodeSlots; i++) {
+        out.Printf("minisdp_decode_failures_total{reason=\"%s\"} %lu\n", g_retcode_names[i],
+                   (unsigned long)metrics.decode_failures[i]);
+    }
+
+    out.Header("minisdp_encode_failures_total", "counter", "Origin SDP failed to pack.");
+    for (size_t i = 1; i < kSdpRetcodeSlots; i++) {
+        out.Printf("minisdp_encode_failures_total{reason=\"%s\"} %lu\n", g_retcode_names[i],
+                   (unsigned long)metrics.encode_failures[i]);
+    }
+
+    out.Header("minisdp_answers_total", "counter", "Answers packed and decoded by status code.");
+    for (size_t i = 0; i < kStatusCodeSlots; i++) {
+        out.Printf("minisdp_answers_total{op=\"pack\",status=\"%s\"} %lu\n", g_status_names[i],
+                   (unsigned long)metrics.answers_packed[i]);
+    }
+    for (size_t i = 0; i < kStatusCodeSlots; i++) {
+        out.Printf("minisdp_answers_total{op=\"load\",status=\"%s\"} %lu\n", g_status_names[i],
+                   (unsigned long)metrics.answers_loaded[i]);
+    }
+
+    out.Header("minisdp_packed_size_bytes", "histogram", "Size of packed mini SDP, the limit is 1400 bytes.");
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < kPackedSizeBucketNum; i++) {
+        cumulative += metrics.packed_size[i];
+        if (i + 1 < kPackedSizeBucketNum) {
+            out.Printf("minisdp_packed_size_bytes_bucket{le=\"%lu\"} %lu\n", (unsigned long)kPackedSizeBounds[i],
+                       (unsigned long)cumulative);
+        } else {
+            out.Printf("minisdp_packed_size_bytes_bucket{le=\"+Inf\"} %lu\n", (unsigned long)cumulative);
+        }
+    }
+    out.Printf("minisdp_packed_size_bytes_sum %lu\n", (unsigned long)metrics.packed_size_sum);
+    out.Printf("minisdp_packed_size_bytes_count %lu\n", (unsigned long)cumulative);
+}
+
+void renderStages(TextWriter& out, const StageStatsSnapshot& stats) {
+    static const double kQuantiles[] = {0.5, 0.9, 0.99};
+    out.Header("minisdp_stage_latency_seconds", "summary", "Latency of library stages.");
+    for (size_t i = 0; i < kSdpStageNum; i++) {
+        auto &latency = stats.latency[i];
+        if (latency.count == 0) continue;
+        const char* stage = SdpStageName(SdpStage(i));
+        for (double q : kQuantiles) {
+            out.Printf("minisdp_stage_latency_seconds{stage=\"%s\",quantile=\"%g\"} %.9f\n", stage, q,
+                       latency.Percentile(q) / 1e9);
+        }
+        out.Printf("minisdp_stage_latency_seconds_sum{stage=\"%s\"} %.9f\n", stage, latency.sum / 1e9);
+        out.Printf("minisdp_stage_latency_seconds_count{stage=\"%s\"} %lu\n", stage, (unsigned long)latency.count);
+    }
+}
+
+}  // namespace
+
+ssize_t RenderPrometheusMetrics(char* buff, size_t len) {
+    TextWriter out(buff, len);
+    renderSignaling(out, GetSignalingMetricsSnapshot());
+    if (MINI_SDP_STAGE_STATS) renderStages(out, GetStageStatsSnapshot());
+
+    auto &writer = out.Writer();
+    if (writer.Exceeded()) return kSdpRetSizeExceeded;
+    if (writer.Offset() < len) buff[writer.Offset()] = '\0';
+    return writer.Offset();
+}
+
+}  // namespace mini_sdp
@@ -0,0 +1,83 @@
+/**
+ * @file mini_sdp/metrics.h
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#ifndef MINI_SDP_METRICS_H_
+#define MINI_SDP_METRICS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <sys/types.h>
+#include "mini_sdp.h"
+#include "stage_stats.h"
+
+namespace mini_sdp {
+
+/*
+ * UDP 信令指标
+ *  - 由 mini_sdp.h 的打包/解包接口自动记录，每个线程写自己的数据块，读取时才汇总
+ *  - 重复包按线程判定：同一线程最近收到过内容完全相同的请求或停流包即视为重复（客户端重传），
+ *    服务端按来源地址把包分到固定线程（如 SO_REUSEPORT）时等价于全局判定
+ *  - RenderPrometheusMetrics 输出 Prometheus 文本格式，包含本文件的指标和各阶段耗时 (stage_stats.h)
+ */
+
+// answer 按 StatusCode 计数的下标，0 ~ 5: kStatCodeSuccess ~ kStatCodeNotFound，6: 其他
+constexpr size_t kStatusCodeSlots = 7;
+
+size_t StatusCodeSlot(int status_code);
+
+// packed size histogram, upper bounds in bytes, the last one is the 1400 bytes limit of mini sdp
+constexpr size_t kPackedSizeBounds[] = {200, 400, 600, 800, 1000, 1100, 1200, 1300, 1400};
+constexpr size_t kPackedSizeBucketNum = sizeof(kPackedSizeBounds) / sizeof(kPackedSizeBounds[0]) + 1;
+
+size_t PackedSizeBucket(size_t size);
+
+/**
+ * @brief Signaling Metrics Snapshot
+ *  进程启动以来的累计值，可合并
+ */
+struct SignalingMetricsSnapshot {
+    uint64_t    request_packets = 0;                        // loaded offers
+    uint64_t    stop_packets = 0;                           // loaded stop packets
+    uint64_t    duplicate_seq = 0;                          // loaded requests/stop packets seen before
+    uint64_t    decode_failures[kSdpRetcodeSlots] = {};     // by SdpRetcodeSlot, slot 0 unused
+    uint64_t    encode_failures[kSdpRetcodeSlots] = {};     // by SdpRetcodeSlot, slot 0 unused
+    uint64_t    answers_packed[kStatusCodeSlots] = {};      // by StatusCodeSlot
+    uint64_t    answers_loaded[kStatusCodeSlots] = {};      // by StatusCodeSlot
+    uint64_t    packed_size[kPackedSizeBucketNum] = {};     // by PackedSizeBucket, not cumulative
+    uint64_t    packed_size_sum = 0;
+
+    void Merge(const SignalingMetricsSnapshot &rhs);
+};  // struct SignalingMetricsSnapshot
+
+SignalingMetricsSnapshot GetSignalingMetricsSnapshot();
+
+// runtime switch, metrics are recorded by default
+void SetSignalingMetricsEnabled(bool enabled);
+
+bool IsSignalingMetricsEnabled();
+
+// for instrumentation of the library, ret is the return value of the interface
+void RecordPackMetrics(const OriginSdpAttr& attr, ssize_t ret);
+
+void RecordLoadMetrics(const char* buff, const OriginSdpAttr& attr, ssize_t ret);
+
+void RecordStopLoadMetrics(const char* buff, ssize_t ret);
+
+/**
+ * @brief Render metrics in Prometheus text format
+ *  将信令指标和各阶段耗时以 Prometheus 文本格式写入 buff，空间足够时末尾补 '\0'（不计入返回值）
+ * @param buff
+ * @param len
+ * @return ssize_t size of text or kSdpRetSizeExceeded
+ */
+ssize_t RenderPrometheusMetrics(char* buff, size_t len);
+
+}  // namespace mini_sdp
+
+#endif  // MINI_SDP_METRICS_H_
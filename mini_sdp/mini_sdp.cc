@@ -8,9 +8,14 @@
  * 
  */
 #include "mini_sdp.h"
+#include <algorithm>
 #include <cstring>
 #include <limits>
+#include "mini_sdp_codec.h"
 #include "mini_sdp_impl.h"
+#include "metrics.h"
+#include "stage_stats.h"
+#include "transcode_context.h"
 #include "util.h"
 
 namespace mini_sdp {
@@ -19,39 +24,169 @@ bool IsMiniSdpReqPack(const char* data, size_t len) {
     return len >= 4 && (uint8_t)data[0] == kMiniSdpPacketType && data[1] == 'S' && data[2] == 'D' && data[3] == 'P';
 }
 
-ssize_t ParseOriginSdpToMiniSdp(const OriginSdpAttr& attr, char* buff, size_t len) {
+// reason of a sdp failed to parse
+static ssize_t parseRetcode(const SdpParser::ErrorInfo& error) {
+    switch (error.code) {
+    case SdpParser::StatCode::kParamError:  return kSdpRetSdpParamError;
+    case SdpParser::StatCode::kUnknownLine: return kSdpRetSdpUnknownLine;
+    default:                                return kSdpRetWrongFormat;
+    }
+}
+
+ssize_t PackOriginSdp(const OriginSdpAttr& attr, const char* origin_sdp, size_t origin_sdp_len,
+                      char* buff, size_t len) {
     if (attr.stream_url.size() > kMiniSdpUrlMaxLen) {
         return kSdpRetUrlExceeded;
     }
-    MiniSdpPacker packer;
-    int pack_size = packer.PackToDstMem(buff, len, attr.origin_sdp, attr.sdp_type, attr.stream_url, attr.svrsig, attr.seq, attr.status_code, attr.is_imm_send, attr.is_support_aac_fmtp, attr.is_push);
+    const MiniSdpCodec* codec = MiniSdpCodecRegistry::Instance().Find(attr.version);
+    if (!codec) {
+        return kSdpRetVersionUnsupported;
+    }
+    SessionDescriptionPtr sdp_info;
+    if (attr.sdp_type != SdpType::kSdpNone) {
+        SdpParser sdp_parser(origin_sdp, origin_sdp_len);
+        if (!sdp_parser.Parse()) {
+            return parseRetcode(sdp_parser.GetError());
+        }
+        sdp_info = sdp_parser.GetSessionDescription();
+    }
+    int pack_size = codec->Pack(attr, sdp_info, buff, len);
     if (pack_size == 0) {
         return kSdpRetWrongFormat;
     }
-    if (pack_size > kMiniMiniSdpMaxLen || pack_size > len) {
+    if (size_t(pack_size) > kMiniMiniSdpMaxLen || size_t(pack_size) > len) {
+        return kSdpRetSizeExceeded;
+    }
+    return pack_size;
+}
+
+static ssize_t packOriginSdp(const OriginSdpAttr& attr, char* buff, size_t len,
+                             const PackBudget& budget, PackDegradeReport* report) {
+    if (attr.sdp_type == SdpType::kSdpNone) {
+        ssize_t pack_size = PackOriginSdp(attr, attr.origin_sdp.data(), attr.origin_sdp.size(), buff,
+                                          std::min(len, budget.max_size));
+        if (report && pack_size > 0) {
+            report->full_size = report->packed_size = pack_size;
+            report->dropped.clear();
+        }
+        return pack_size;
+    }
+    if (attr.stream_url.size() > kMiniSdpUrlMaxLen) {
+        return kSdpRetUrlExceeded;
+    }
+    const MiniSdpCodec* codec = MiniSdpCodecRegistry::Instance().Find(attr.version);
+    if (!codec) {
+        return kSdpRetVersionUnsupported;
+    }
+    size_t limit = std::min(len, budget.max_size);
+    MiniSdpPacker packer;
+    int pack_size = packer.PackToDstMem(buff, limit, attr, budget, report, *codec);
+    if (pack_size == 0) {
+        return packer.GetParseError().code == SdpParser::StatCode::kSuccess ? ssize_t(kSdpRetWrongFormat)
+                                                                             : parseRetcode(packer.GetParseError());
+    }
+    if (size_t(pack_size) > limit) {
         return kSdpRetSizeExceeded;
     }
     return pack_size;
 }
 
+ssize_t ParseOriginSdpToMiniSdp(const OriginSdpAttr& attr, char* buff, size_t len) {
+    return ParseOriginSdpToMiniSdp(attr, attr.origin_sdp.data(), attr.origin_sdp.size(), buff, len);
+}
+
+ssize_t ParseOriginSdpToMiniSdp(const OriginSdpAttr& attr, const char* origin_sdp, size_t origin_sdp_len,
+                                char* buff, size_t len) {
+    StageTimer timer(SdpStage::kPack);
+    ssize_t ret = PackOriginSdp(attr, origin_sdp, origin_sdp_len, buff, len);
+    RecordPackMetrics(attr, ret);
+    return timer.Result(ret);
+}
+
+ssize_t ParseOriginSdpToMiniSdp(const OriginSdpAttr& attr, char* buff, size_t len,
+                                const PackBudget& budget, PackDegradeReport* report) {
+    StageTimer timer(SdpStage::kPack);
+    ssize_t ret = packOriginSdp(attr, buff, len, budget, report);
+    RecordPackMetrics(attr, ret);
+    return timer.Result(ret);
+}
+
+static ssize_t loadMiniSdp(const char* buff, size_t len, OriginSdpAttr& attr) {
+    if (len <= 4) {
+        return kSdpRetSizeExceeded;
+    }
+    if (!IsMiniSdpReqPack(buff, len)) {
+        return kSdpRetWrongFormat;
+    }
+    const MiniSdpCodec* codec = MiniSdpCodecRegistry::Instance().Find((uint8_t)buff[4]);
+    if (!codec) {
+        return kSdpRetWrongFormat;
+    }
+    int parse_size = codec->Load(buff, len, attr);
+    return parse_size > 0 ? parse_size : kSdpRetWrongFormat;
+}
+
 ssize_t LoadMiniSdpToOriginSdp(const char* buff, size_t len, OriginSdpAttr& attr) {
-    MiniSdpLoader loader;
-    int parse_size = loader.ParseToString(const_cast<char *>(buff), len, attr.seq, attr.sdp_type, attr.origin_sdp, attr.stream_url, attr.svrsig, attr.status_code, attr.is_imm_send, attr.is_support_aac_fmtp, attr.is_push);
-    return parse_size;
+    StageTimer timer(SdpStage::kLoad);
+    ssize_t ret = loadMiniSdp(buff, len, attr);
+    RecordLoadMetrics(buff, attr, ret);
+    return timer.Result(ret);
+}
+
+ssize_t ParseOriginSdpToMiniSdp(TranscodeContext& ctx, const OriginSdpAttr& attr, char* buff, size_t len) {
+    SdpRecycleScope scope(ctx.Recycler());
+    return ParseOriginSdpToMiniSdp(attr, buff, len);
+}
+
+ssize_t LoadMiniSdpToOriginSdp(TranscodeContext& ctx, const char* buff, size_t len, OriginSdpAttr& attr) {
+    SdpRecycleScope scope(ctx.Recycler());
+    return LoadMiniSdpToOriginSdp(buff, len, attr);
+}
+
+static ssize_t peekMiniSdp(const char* buff, size_t len, MiniSdpDispatchInfo& info) {
+    if (len <= 4) {
+        return kSdpRetSizeExceeded;
+    }
+    if (!IsMiniSdpReqPack(buff, len)) {
+        return kSdpRetWrongFormat;
+    }
+    const MiniSdpCodec* codec = MiniSdpCodecRegistry::Instance().Find((uint8_t)buff[4]);
+    if (!codec) {
+        return kSdpRetWrongFormat;
+    }
+    int peek_size = codec->Peek(buff, len, info);
+    return peek_size > 0 ? peek_size : kSdpRetWrongFormat;
+}
+
+ssize_t PeekMiniSdp(const char* buff, size_t len, MiniSdpDispatchInfo& info) {
+    StageTimer timer(SdpStage::kPeek);
+    return timer.Result(peekMiniSdp(buff, len, info));
+}
+
+ssize_t LoadMiniSdpToOriginSdp(const char* buff, size_t len, OriginSdpAttr& attr,
+                               const MiniSdpDispatchHandler& on_dispatch) {
+    MiniSdpDispatchInfo info;
+    ssize_t ret = PeekMiniSdp(buff, len, info);
+    if (ret <= 0) {
+        return ret;
+    }
+    if (on_dispatch) on_dispatch(info);
+    return LoadMiniSdpToOriginSdp(buff, len, attr);
 }
 
 bool IsMiniSdpStopPack(const char* data, size_t len) {
     return len >= 4 && (uint8_t)data[0] == kMiniSdpPacketType && data[1] == 'S' && data[2] == 'T' && data[3] == 'P';
 }
 
-ssize_t BuildStopStreamPacket(char* buff, size_t len, const StopStreamAttr& attr) {
+static ssize_t buildStopStream(char* buff, size_t len, const StopStreamAttr& attr) {
+    if (!MiniSdpCodecRegistry::Instance().Find(attr.version)) return kSdpRetVersionUnsupported;
     size_t total_bytes = sizeof(StopStreamSignalHeader) + attr.svrsig.size() + kMiniSdpAuthLength;
     if (total_bytes > len || attr.svrsig.size() > std::numeric_limits<uint16_t>::max()) return kSdpRetSizeExceeded;
 
     StopStreamSignalHeader* hdr = (StopStreamSignalHeader*)buff;
     hdr->pack_type = kMiniSdpPacketType;
     memcpy(hdr->magic_word, "STP", 3);
-    hdr->version = 0;
+    hdr->version = attr.version;
     hdr->status = htons(attr.status);
     hdr->seq = htons(attr.seq);
     hdr->svrsig_len = htons((uint16_t)attr.svrsig.size());
@@ -65,15 +200,21 @@ ssize_t BuildStopStreamPacket(char* buff, size_t len, const StopStreamAttr& attr
     return total_bytes;
 }
 
-ssize_t LoadStopStreamPacket(const char* buff, size_t len, StopStreamAttr& attr) {
+ssize_t BuildStopStreamPacket(char* buff, size_t len, const StopStreamAttr& attr) {
+    StageTimer timer(SdpStage::kStopBuild);
+    return timer.Result(buildStopStream(buff, len, attr));
+}
+
+static ssize_t loadStopStream(const char* buff, size_t len, StopStreamAttr& attr) {
     if (len < sizeof(StopStreamSignalHeader) + kMiniSdpAuthLength) return kSdpRetSizeExceeded;
     if ((uint8_t)*buff != kMiniSdpPacketType || buff[1] != 'S' || buff[2] != 'T' || buff[3] != 'P') {
         return kSdpRetWrongFormat;
     }
 
     const StopStreamSignalHeader* hdr = (const StopStreamSignalHeader*)buff;
-    if (hdr->version != 0) return kSdpRetWrongFormat;
+    if (!MiniSdpCodecRegistry::Instance().Find(hdr->version)) return kSdpRetWrongFormat;
 
+    attr.version = hdr->version;
     attr.status = ntohs(hdr->status);
     attr.seq = ntohs(hdr->seq);
     uint16_t length = ntohs(hdr->svrsig_len);
@@ -86,4 +227,11 @@ ssize_t LoadStopStreamPacket(const char* buff, size_t len, StopStreamAttr& attr)
     return sizeof(StopStreamSignalHeader) + kMiniSdpAuthLength + length;
 }
 
+ssize_t LoadStopStreamPacket(const char* buff, size_t len, StopStreamAttr& attr) {
+    StageTimer timer(SdpStage::kStopLoad);
+    ssize_t ret = loadStopStream(buff, len, attr);
+    RecordStopLoadMetrics(buff, ret);
+    return timer.Result(ret);
+}
+
 }  // namespace mini_sdp
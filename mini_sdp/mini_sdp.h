@@ -10,6 +10,7 @@
 #ifndef MINI_SDP_MINI_SDP_H_
 #define MINI_SDP_MINI_SDP_H_
 
+#include <functional>
 #include <string>
 #include <vector>
 #include "sdp.h"
@@ -21,9 +22,13 @@ namespace mini_sdp {
  *  统一返回码
  */
 enum SdpRetcode {
-    kSdpRetWrongFormat    = -1,     // 格式错误
-    kSdpRetSizeExceeded   = -2,     // 打包结果超过所提供的 buffer 大小
-    kSdpRetUrlExceeded    = -3      // 流 URL 过长，使得无法存入所有提供的 buffer
+    kSdpRetWrongFormat        = -1,     // 格式错误，打包时为 SDP 行的格式错误或无法打包的内容
+    kSdpRetSizeExceeded       = -2,     // 打包结果超过所提供的 buffer 大小
+    kSdpRetUrlExceeded        = -3,     // 流 URL 过长，使得无法存入所有提供的 buffer
+    kSdpRetSdpParamError      = -4,     // SDP 中的取值错误，如数值越界、不支持的媒体类型或 a=setup
+    kSdpRetSdpUnknownLine     = -5,     // SDP 中有无法识别的行
+    kSdpRetVersionUnsupported = -6,     // 打包时 attr.version 不受支持
+    kSdpRetBusy               = -7      // MiniSdpClient 中该 peer 没有可用的 seq，待进行中的请求完成后重试
 };
 
 /**
@@ -88,10 +93,23 @@ struct OriginSdpAttr {
     // - 这是用于 v0 版本兼容不同子版本的标志位，v1 版本将不再需要
     bool                is_support_aac_fmtp = true;
 
+    // Flag: Compact Fingerprint
+    // - 紧凑指纹标志位
+    // - 开启后 fingerprint 以 <hash id><digest> 的二进制形式传输，sha-256 可节省约 70 字节
+    // - 旧版本解码器不支持该格式，需确认对端支持后再开启，默认关闭
+    // - 解码时由包内标志位决定，无需设置
+    bool                is_compact_fingerprint = false;
+
     // Flag: Stream Direction
     // - 流类型标志位，指示拉流或者推流
     // - 默认表示依据原始 SDP 的描述
     StreamDirection     is_push = kStreamDefault;   // -1 not have field , 0 false, 1 true
+
+    // Mini SDP Version
+    // - mini sdp 格式版本，打包时选择版本，默认 v0
+    // - 解码时由包头决定，无需设置
+    // - 对端需支持所选版本，v1 包更小，fingerprint 总是以紧凑形式传输
+    uint8_t             version = 0;
 };  // struct OriginSdpAttr
 
 /**
@@ -127,6 +145,57 @@ bool IsMiniSdpReqPack(const char* data, size_t len);
  */
 ssize_t LoadMiniSdpToOriginSdp(const char* buff, size_t len, OriginSdpAttr& attr);
 
+/**
+ * @brief Dispatch Info
+ *  提前分发信息，直接从 mini sdp 读取，不生成 SDP 文本
+ *  - 0-RTT (is_imm_send) 请求据此即可开始向请求的源地址发送媒体，完整 SDP 随后再生成
+ */
+struct MiniSdpDispatchInfo {
+    struct Media {
+        SdpMediaType            media_type = SdpMediaType::kAudio;
+        // 与完整解析结果的 TracksOrder 一致
+        std::vector<uint32_t>   ssrcs;
+        // mini sdp 中的顺序，当前版本不支持的 codec 不包含在内
+        std::vector<uint8_t>    payload_types;
+    };
+
+    SdpType             sdp_type = SdpType::kSdpNone;
+    uint8_t             version = 0;
+    uint16_t            seq = 0;
+    bool                is_imm_send = false;
+    StreamDirection     is_push = kStreamDefault;
+    // 与 OriginSdpAttr::stream_url 一致，含 webrtc:// 前缀
+    std::string         stream_url;
+    std::vector<Media>  medias;
+};  // struct MiniSdpDispatchInfo
+
+/**
+ * @brief Peek mini_sdp
+ *  解码的第一阶段，校验 mini sdp 并读取提前分发信息，耗时为完整解码的一小部分
+ *  - 与 LoadMiniSdpToOriginSdp 相互独立，完整解码可延后或在其他线程进行
+ * @param buff mini_sdp
+ * @param len mini_sdp
+ * @param info result
+ * @return ssize_t SdpRetCode or size of mini_sdp
+ */
+ssize_t PeekMiniSdp(const char* buff, size_t len, MiniSdpDispatchInfo& info);
+
+using MiniSdpDispatchHandler = std::function<void(const MiniSdpDispatchInfo&)>;
+
+/**
+ * @brief Load mini_sdp to origin_sdp in two stages
+ *  先 PeekMiniSdp 并回调 on_dispatch，再完整解码
+ *  - 回调中 attr 尚未填充，0-RTT 与否由 MiniSdpDispatchInfo::is_imm_send 判断
+ *  - 第一阶段失败时不回调，也不进行完整解码
+ * @param buff mini_sdp
+ * @param len mini_sdp
+ * @param attr result
+ * @param on_dispatch nullable
+ * @return ssize_t SdpRetCode or size of mini_sdp
+ */
+ssize_t LoadMiniSdpToOriginSdp(const char* buff, size_t len, OriginSdpAttr& attr,
+                               const MiniSdpDispatchHandler& on_dispatch);
+
 /**
  * @brief Parse origin_sdp to mini_sdp
  *  将原始 SDP 转换成 mini sdp
@@ -137,6 +206,103 @@ ssize_t LoadMiniSdpToOriginSdp(const char* buff, size_t len, OriginSdpAttr& attr
  */
 ssize_t ParseOriginSdpToMiniSdp(const OriginSdpAttr& attr, char* buff, size_t len);
 
+/**
+ * @brief Parse origin_sdp in a buffer to mini_sdp
+ *  与 ParseOriginSdpToMiniSdp 相同，原始 SDP 从 origin_sdp 读取，不读取 attr.origin_sdp，
+ *  调用方不需要先把 SDP 拷贝到 std::string 中（如 C 接口，见 mini_sdp_c.h）
+ * @return ssize_t SdpRetCode or size of mini_sdp
+ */
+ssize_t ParseOriginSdpToMiniSdp(const OriginSdpAttr& attr, const char* origin_sdp, size_t origin_sdp_len,
+                                char* buff, size_t len);
+
+// see mini_sdp/transcode_context.h
+class TranscodeContext;
+
+/**
+ * @brief Parse origin_sdp to mini_sdp with a context
+ *  结果与 ParseOriginSdpToMiniSdp 相同，解析出的描述在 ctx 中原地重建
+ * @param ctx reused by the calling thread
+ * @return ssize_t SdpRetCode or size of mini_sdp
+ */
+ssize_t ParseOriginSdpToMiniSdp(TranscodeContext& ctx, const OriginSdpAttr& attr, char* buff, size_t len);
+
+/**
+ * @brief Load mini_sdp to origin_sdp with a context
+ *  结果与 LoadMiniSdpToOriginSdp 相同，描述在 ctx 中原地重建，attr 的字符串容量也被复用
+ * @param ctx reused by the calling thread
+ * @return ssize_t SdpRetCode or size of mini_sdp
+ */
+ssize_t LoadMiniSdpToOriginSdp(TranscodeContext& ctx, const char* buff, size_t len, OriginSdpAttr& attr);
+
+/**
+ * @brief Pack Drop Step
+ *  超出包大小限制时，可丢弃的可选内容
+ */
+enum PackDropStep {
+    kPackDropRedundantProfile = 0,  // 与已保留的视频 codec 在 mini sdp 中描述相同的 codec，如多个 H264 profile
+    kPackDropUnusedExtension  = 1,  // 不在 PackBudget::keep_extensions 中的 extmap
+    kPackDropAacConfig        = 2,  // AAC fmtp 中的 config
+    kPackDropSecondSsrc       = 3,  // 除第一个 ssrc 外的 track
+    kPackDropStepNum
+};
+
+/**
+ * @brief Pack Budget
+ *  打包预算，超出时依次按 order 丢弃可选内容
+ */
+struct PackBudget {
+    // Max Size
+    // - 打包结果的大小上限，实际上限为 min(max_size, len)
+    size_t                      max_size = 1400;
+
+    // Drop Order
+    // - 丢弃顺序，每一步按需逐项丢弃，满足大小限制后停止
+    std::vector<PackDropStep>   order = {kPackDropRedundantProfile, kPackDropUnusedExtension,
+                                         kPackDropAacConfig, kPackDropSecondSsrc};
+
+    // Used Extensions
+    // - kPackDropUnusedExtension 不会丢弃的 extmap uri
+    std::vector<std::string>    keep_extensions = {
+        "http://www.ietf.org/id/draft-holmer-rmcat-transport-wide-cc-extensions-01",
+        "http://www.webrtc.org/experiments/rtp-hdrext/abs-send-time"
+    };
+};  // struct PackBudget
+
+/**
+ * @brief Pack Drop Record
+ *  被丢弃的内容
+ */
+struct PackDropRecord {
+    PackDropStep    step;
+    SdpMediaType    media_type;
+    uint32_t        value;  // payload type / extmap id / payload type / ssrc
+    size_t          saved;  // 节省的字节数
+};
+
+/**
+ * @brief Pack Degrade Report
+ *  降级打包结果
+ */
+struct PackDegradeReport {
+    size_t                      full_size = 0;      // 未丢弃任何内容时的打包大小
+    size_t                      packed_size = 0;    // 实际打包大小
+    std::vector<PackDropRecord> dropped;
+};
+
+/**
+ * @brief Parse origin_sdp to mini_sdp within budget
+ *  将原始 SDP 转换成 mini sdp，超出大小限制时按预算丢弃可选内容
+ *  - 仅在超出限制时丢弃，内容大小增量计算，只会额外打包一次
+ * @param attr origin sdp
+ * @param buff mini_sdp
+ * @param len mini_sdp
+ * @param budget
+ * @param report nullable, what was dropped
+ * @return int SdpRetCode or size of mini_sdp
+ */
+ssize_t ParseOriginSdpToMiniSdp(const OriginSdpAttr& attr, char* buff, size_t len,
+                                const PackBudget& budget, PackDegradeReport* report = nullptr);
+
 /**
  * @brief Stop Stream Attribute
  *  停流参数
@@ -155,6 +321,10 @@ struct StopStreamAttr {
     // - 请求序号
     // * 与请求的 seq 保持一致
     uint16_t    seq = 0;
+
+    // Mini SDP Version
+    // - 与请求的 mini sdp 版本保持一致，停流包格式与版本无关
+    uint8_t     version = 0;
 };  // struct StopStreamAttr
 
 /**
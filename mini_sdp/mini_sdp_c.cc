@@ -0,0 +1,216 @@
+/**
+ * @file mini_sdp/mini_sdp_c.cc
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include "mini_sdp_c.h"
+#include <cstring>
+#include <vector>
+#include "mini_sdp.h"
+#include "mini_sdp_impl.h"
+#include "sdp_recycler.h"
+#include "transcode_context.h"
+
+using namespace mini_sdp;
+
+static_assert(MINISDP_OFFER == int(SdpType::kOffer) && MINISDP_ANSWER == int(SdpType::kAnswer) &&
+              MINISDP_SDP_NONE == int(SdpType::kSdpNone), "minisdp_sdp_type");
+static_assert(MINISDP_RET_WRONG_FORMAT == int(kSdpRetWrongFormat) &&
+              MINISDP_RET_SIZE_EXCEEDED == int(kSdpRetSizeExceeded) &&
+              MINISDP_RET_URL_EXCEEDED == int(kSdpRetUrlExceeded) &&
+              MINISDP_RET_SDP_PARAM_ERROR == int(kSdpRetSdpParamError) &&
+              MINISDP_RET_SDP_UNKNOWN_LINE == int(kSdpRetSdpUnknownLine) &&
+              MINISDP_RET_VERSION_UNSUPPORTED == int(kSdpRetVersionUnsupported) &&
+              MINISDP_RET_BUSY == int(kSdpRetBusy), "minisdp_ret");
+static_assert(MINISDP_STREAM_DEFAULT == int(kStreamDefault) && MINISDP_STREAM_PULL == int(kStreamPull) &&
+              MINISDP_STREAM_PUSH == int(kStreamPush), "minisdp_direction");
+static_assert(MINISDP_MEDIA_AUDIO == int(SdpMediaType::kAudio) && MINISDP_MEDIA_VIDEO == int(SdpMediaType::kVideo) &&
+              MINISDP_MEDIA_DATA == int(SdpMediaType::kData), "minisdp_media_type");
+static_assert(MINISDP_MAX_PACKET == kMiniMiniSdpMaxLen, "MINISDP_MAX_PACKET");
+
+namespace {
+
+// state of a thread, the capacity of the strings and the descriptions are reused between calls
+struct CApiState {
+    TranscodeContext                    ctx;
+    OriginSdpAttr                       pack_attr;      // origin_sdp is not used, read in place
+    OriginSdpAttr                       load_attr;      // of minisdp_load / minisdp_load_view
+    StopStreamAttr                      stop_attr;
+    MiniSdpDispatchInfo                 dispatch;
+    std::vector<minisdp_media_view>     medias;
+    char                                packet[kMiniMiniSdpMaxLen];     // to find the required size
+};
+
+}  // namespace
+
+static thread_local CApiState t_state;
+
+// no exception crosses the C boundary, e.g. std::bad_alloc
+template <typename Func>
+static ssize_t guarded(Func func) {
+    try {
+        return func();
+    } catch (...) {
+        return kSdpRetWrongFormat;
+    }
+}
+
+static minisdp_str toStr(const std::string& str) {
+    return minisdp_str{str.data(), str.size()};
+}
+
+static void assign(std::string& dst, const minisdp_str& src) {
+    dst.assign(src.data ? src.data : "", src.data ? src.len : 0);
+}
+
+static void toAttr(const OriginSdpAttr& src, minisdp_attr* dst) {
+    dst->sdp_type = int(src.sdp_type);
+    dst->origin_sdp = toStr(src.origin_sdp);
+    dst->stream_url = toStr(src.stream_url);
+    dst->svrsig = toStr(src.svrsig);
+    dst->status_code = src.status_code;
+    dst->seq = src.seq;
+    dst->is_imm_send = src.is_imm_send;
+    dst->is_support_aac_fmtp = src.is_support_aac_fmtp;
+    dst->is_compact_fingerprint = src.is_compact_fingerprint;
+    dst->is_push = int8_t(src.is_push);
+    dst->version = src.version;
+}
+
+extern "C" {
+
+void minisdp_attr_init(minisdp_attr* attr) {
+    toAttr(OriginSdpAttr(), attr);
+    attr->sdp_type = MINISDP_OFFER;
+    attr->origin_sdp = attr->stream_url = attr->svrsig = minisdp_str{nullptr, 0};
+}
+
+int minisdp_is_req_pack(const char* data, size_t len) {
+    return IsMiniSdpReqPack(data, len) ? 1 : 0;
+}
+
+int minisdp_is_stop_pack(const char* data, size_t len) {
+    return IsMiniSdpStopPack(data, len) ? 1 : 0;
+}
+
+ssize_t minisdp_pack(const minisdp_attr* attr, char* buf, size_t buf_len, size_t* required) {
+    return guarded([&]() -> ssize_t {
+        if (required) *required = 0;
+        if (attr->sdp_type < MINISDP_OFFER || attr->sdp_type > MINISDP_SDP_NONE) return kSdpRetSdpParamError;
+        OriginSdpAttr& pack_attr = t_state.pack_attr;
+        pack_attr.sdp_type = SdpType(attr->sdp_type);
+        assign(pack_attr.stream_url, attr->stream_url);
+        assign(pack_attr.svrsig, attr->svrsig);
+        pack_attr.status_code = attr->status_code;
+        pack_attr.seq = attr->seq;
+        pack_attr.is_imm_send = attr->is_imm_send;
+        pack_attr.is_support_aac_fmtp = attr->is_support_aac_fmtp;
+        pack_attr.is_compact_fingerprint = attr->is_compact_fingerprint;
+        pack_attr.is_push = StreamDirection(attr->is_push);
+        pack_attr.version = attr->version;
+
+        const char* sdp = attr->origin_sdp.data ? attr->origin_sdp.data : "";
+        size_t sdp_len = attr->origin_sdp.data ? attr->origin_sdp.len : 0;
+        SdpRecycleScope scope(t_state.ctx.Recycler());
+        ssize_t ret = ParseOriginSdpToMiniSdp(pack_attr, sdp, sdp_len, buf, buf_len);
+        if (ret == kSdpRetSizeExceeded && buf_len < sizeof(t_state.packet)) {
+            // packed again at the max size to report it, a packet larger than that is never built,
+            // unmetered as it is the same request
+            ssize_t size = PackOriginSdp(pack_attr, sdp, sdp_len, t_state.packet, sizeof(t_state.packet));
+            if (required && size > 0) *required = size;
+        } else if (required && ret > 0) {
+            *required = ret;
+        }
+        return ret;
+    });
+}
+
+ssize_t minisdp_load(const char* buf, size_t len, minisdp_attr* attr, char* dst, size_t dst_len,
+                     size_t* required) {
+    return guarded([&]() -> ssize_t {
+        if (required) *required = 0;
+        ssize_t ret = minisdp_load_view(buf, len, attr);
+        if (ret <= 0) return ret < 0 ? ret : ssize_t(kSdpRetWrongFormat);
+
+        size_t total = attr->origin_sdp.len + attr->stream_url.len + attr->svrsig.len;
+        if (required) *required = total;
+        if (total > dst_len) return kSdpRetSizeExceeded;
+        for (minisdp_str* str : {&attr->origin_sdp, &attr->stream_url, &attr->svrsig}) {
+            if (str->len > 0) memcpy(dst, str->data, str->len);
+            str->data = dst;
+            dst += str->len;
+        }
+        return ret;
+    });
+}
+
+ssize_t minisdp_load_view(const char* buf, size_t len, minisdp_attr* attr) {
+    return guarded([&]() -> ssize_t {
+        // the bounds are checked before the loader reads the packet, as LoadMiniSdpToOriginSdp with on_dispatch
+        if (PeekMiniSdp(buf, len, t_state.dispatch) <= 0) return kSdpRetWrongFormat;
+        ssize_t ret = LoadMiniSdpToOriginSdp(t_state.ctx, buf, len, t_state.load_attr);
+        if (ret <= 0) return ret < 0 ? ret : ssize_t(kSdpRetWrongFormat);
+        toAttr(t_state.load_attr, attr);
+        return ret;
+    });
+}
+
+ssize_t minisdp_peek(const char* buf, size_t len, minisdp_dispatch_view* view) {
+    return guarded([&]() -> ssize_t {
+        MiniSdpDispatchInfo& info = t_state.dispatch;
+        ssize_t ret = PeekMiniSdp(buf, len, info);
+        if (ret < 0) return ret;
+
+        std::vector<minisdp_media_view>& medias = t_state.medias;
+        medias.resize(info.medias.size());
+        for (size_t i = 0; i < info.medias.size(); i++) {
+            const MiniSdpDispatchInfo::Media& media = info.medias[i];
+            medias[i].media_type = int(media.media_type);
+            medias[i].ssrcs = media.ssrcs.data();
+            medias[i].ssrc_num = media.ssrcs.size();
+            medias[i].payload_types = media.payload_types.data();
+            medias[i].payload_type_num = media.payload_types.size();
+        }
+        view->sdp_type = int(info.sdp_type);
+        view->version = info.version;
+        view->seq = info.seq;
+        view->is_imm_send = info.is_imm_send;
+        view->is_push = int8_t(info.is_push);
+        view->stream_url = toStr(info.stream_url);
+        view->medias = medias.data();
+        view->media_num = medias.size();
+        return ret;
+    });
+}
+
+ssize_t minisdp_stop_build(const minisdp_stop_attr* attr, char* buf, size_t buf_len, size_t* required) {
+    return guarded([&]() -> ssize_t {
+        StopStreamAttr& stop_attr = t_state.stop_attr;
+        assign(stop_attr.svrsig, attr->svrsig);
+        stop_attr.status = attr->status;
+        stop_attr.seq = attr->seq;
+        stop_attr.version = attr->version;
+        if (required) *required = sizeof(StopStreamSignalHeader) + stop_attr.svrsig.size() + kMiniSdpAuthLength;
+        return BuildStopStreamPacket(buf, buf_len, stop_attr);
+    });
+}
+
+ssize_t minisdp_stop_load(const char* buf, size_t len, minisdp_stop_attr* attr) {
+    return guarded([&]() -> ssize_t {
+        StopStreamAttr& stop_attr = t_state.stop_attr;
+        ssize_t ret = LoadStopStreamPacket(buf, len, stop_attr);
+        if (ret < 0) return ret;
+        // in the packet, following the header
+        attr->svrsig = minisdp_str{buf + sizeof(StopStreamSignalHeader), stop_attr.svrsig.size()};
+        attr->status = stop_attr.status;
+        attr->seq = stop_attr.seq;
+        attr->version = stop_attr.version;
+        return ret;
+    });
+}
+
+}  // extern "C"
@@ -0,0 +1,171 @@
+/**
+ * @file mini_sdp/mini_sdp_c.h
+ * @brief C interface of mini sdp, for servers not written in C++ (Go cgo, nginx modules)
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#ifndef MINI_SDP_MINI_SDP_C_H_
+#define MINI_SDP_MINI_SDP_C_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * C 接口
+ *  - 输入均为指针 + 长度，不要求以 '\0' 结尾；输出写入调用方提供的 buffer，不在接口间转移内存所有权
+ *  - buffer 不足时返回 MINISDP_RET_SIZE_EXCEEDED，并通过 required（可为 NULL）返回所需大小
+ *  - *_view 接口返回指向库内线程局部存储或输入包的视图，不拷贝；有效期见各接口说明
+ *  - 返回值与 C++ 接口相同：负数为 minisdp_ret，否则为处理的字节数
+ *  - 线程安全：每个线程使用各自的线程局部状态，可在多个线程中同时调用
+ */
+
+// SdpType
+enum minisdp_sdp_type {
+    MINISDP_OFFER    = 0,
+    MINISDP_ANSWER   = 1,
+    MINISDP_SDP_NONE = 2
+};
+
+// SdpRetcode
+enum minisdp_ret {
+    MINISDP_RET_WRONG_FORMAT        = -1,
+    MINISDP_RET_SIZE_EXCEEDED       = -2,
+    MINISDP_RET_URL_EXCEEDED        = -3,
+    MINISDP_RET_SDP_PARAM_ERROR     = -4,
+    MINISDP_RET_SDP_UNKNOWN_LINE    = -5,
+    MINISDP_RET_VERSION_UNSUPPORTED = -6,
+    MINISDP_RET_BUSY                = -7
+};
+
+// StreamDirection
+enum minisdp_direction {
+    MINISDP_STREAM_DEFAULT = -1,
+    MINISDP_STREAM_PULL    = 0,
+    MINISDP_STREAM_PUSH    = 1
+};
+
+// SdpMediaType
+enum minisdp_media_type {
+    MINISDP_MEDIA_AUDIO = 0,
+    MINISDP_MEDIA_VIDEO = 1,
+    MINISDP_MEDIA_DATA  = 2
+};
+
+// max size of a mini sdp packet
+#define MINISDP_MAX_PACKET 1400
+
+// a string not owned, not terminated by '\0'
+typedef struct minisdp_str {
+    const char* data;
+    size_t      len;
+} minisdp_str;
+
+// OriginSdpAttr, the meaning of the fields is the same as mini_sdp.h
+typedef struct minisdp_attr {
+    int         sdp_type;               // minisdp_sdp_type
+    minisdp_str origin_sdp;
+    minisdp_str stream_url;             // webrtc://<domain>/[<path>/]<stream id>
+    minisdp_str svrsig;
+    int         status_code;
+    uint16_t    seq;
+    uint8_t     is_imm_send;
+    uint8_t     is_support_aac_fmtp;
+    uint8_t     is_compact_fingerprint;
+    int8_t      is_push;                // minisdp_direction
+    uint8_t     version;
+} minisdp_attr;
+
+// StopStreamAttr
+typedef struct minisdp_stop_attr {
+    minisdp_str svrsig;
+    uint16_t    status;
+    uint16_t    seq;
+    uint8_t     version;
+} minisdp_stop_attr;
+
+// MiniSdpDispatchInfo::Media
+typedef struct minisdp_media_view {
+    int             media_type;         // minisdp_media_type
+    const uint32_t* ssrcs;
+    size_t          ssrc_num;
+    const uint8_t*  payload_types;
+    size_t          payload_type_num;
+} minisdp_media_view;
+
+// MiniSdpDispatchInfo
+typedef struct minisdp_dispatch_view {
+    int                         sdp_type;
+    uint8_t                     version;
+    uint16_t                    seq;
+    uint8_t                     is_imm_send;
+    int8_t                      is_push;
+    minisdp_str                 stream_url;
+    const minisdp_media_view*   medias;
+    size_t                      media_num;
+} minisdp_dispatch_view;
+
+// the defaults of OriginSdpAttr: offer, aac fmtp supported, is_push -1, version 0, empty strings
+void minisdp_attr_init(minisdp_attr* attr);
+
+// IsMiniSdpReqPack / IsMiniSdpStopPack, 1 or 0
+int minisdp_is_req_pack(const char* data, size_t len);
+int minisdp_is_stop_pack(const char* data, size_t len);
+
+/**
+ * @brief origin sdp to mini sdp
+ *  attr 的字符串原地读取
+ * @param required size of the packet, also set if buf_len is not enough; 0 if it can not be packed
+ * @return ssize_t minisdp_ret or size of mini sdp
+ */
+ssize_t minisdp_pack(const minisdp_attr* attr, char* buf, size_t buf_len, size_t* required);
+
+/**
+ * @brief mini sdp to origin sdp, strings copied to dst
+ *  origin_sdp、stream_url、svrsig 依次写入 dst，attr 中的字符串指向 dst
+ * @param required total length of the strings, also set if dst_len is not enough
+ * @return ssize_t minisdp_ret or size of mini sdp
+ */
+ssize_t minisdp_load(const char* buf, size_t len, minisdp_attr* attr, char* dst, size_t dst_len,
+                     size_t* required);
+
+/**
+ * @brief mini sdp to origin sdp, strings not copied
+ *  attr 中的字符串指向线程局部的解码结果，有效至本线程下一次调用 minisdp_load / minisdp_load_view
+ * @return ssize_t minisdp_ret or size of mini sdp
+ */
+ssize_t minisdp_load_view(const char* buf, size_t len, minisdp_attr* attr);
+
+/**
+ * @brief PeekMiniSdp, dispatch info without generating sdp text
+ *  view 指向线程局部存储，有效至本线程下一次调用 minisdp_peek
+ * @return ssize_t minisdp_ret or size of mini sdp
+ */
+ssize_t minisdp_peek(const char* buf, size_t len, minisdp_dispatch_view* view);
+
+/**
+ * @brief build a stop stream packet
+ * @param required size of the packet, also set if buf_len is not enough
+ * @return ssize_t minisdp_ret or size of packet
+ */
+ssize_t minisdp_stop_build(const minisdp_stop_attr* attr, char* buf, size_t buf_len, size_t* required);
+
+/**
+ * @brief load a stop stream packet
+ *  attr->svrsig 直接指向 buf 中的 svrsig，有效期与 buf 相同
+ * @return ssize_t minisdp_ret or size of packet
+ */
+ssize_t minisdp_stop_load(const char* buf, size_t len, minisdp_stop_attr* attr);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // MINI_SDP_MINI_SDP_C_H_
@@ -0,0 +1,194 @@
+/**
+ * @file mini_sdp/mini_sdp_client.cc
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include "mini_sdp_client.h"
+#include <algorithm>
+#include <random>
+#include "mini_sdp_impl.h"
+
+namespace mini_sdp {
+
+uint64_t MiniSdpPeerKey(const struct sockaddr_in& addr) {
+    return uint64_t(ntohl(addr.sin_addr.s_addr)) << 16 | ntohs(addr.sin_port);
+}
+
+/**
+ * MiniSdpSeqAllocator
+ */
+
+MiniSdpSeqAllocator::MiniSdpSeqAllocator(uint32_t seed) {
+    std::mt19937 rng(seed);
+    for (auto& seq : seqs_) seq.store(uint16_t(rng()), std::memory_order_relaxed);
+}
+
+MiniSdpSeqAllocator::MiniSdpSeqAllocator() : MiniSdpSeqAllocator(std::random_device()()) {
+    // nothing
+}
+
+uint16_t MiniSdpSeqAllocator::Next(uint64_t peer) {
+    size_t slot = (peer * 0x9E3779B97F4A7C15ull) >> 56;
+    return seqs_[slot % kSlotNum].fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * MiniSdpClient
+ */
+
+MiniSdpClient::MiniSdpClient(SendFunc send, MiniSdpSeqAllocator& seqs, const Options& options, uint64_t now_ms)
+: send_(std::move(send)), seqs_(seqs), options_(options), wheel_(options.tick_ms, options.wheel_slots, now_ms) {
+    // nothing
+}
+
+bool MiniSdpClient::allocSeq(uint64_t peer, uint16_t& seq) {
+    // 65536 requests pending for one peer is not expected, give up after a few
+    for (int i = 0; i < 16; i++) {
+        seq = seqs_.Next(peer);
+        if (!pending_.count(pendingKey(peer, seq))) return true;
+    }
+    return false;
+}
+
+ssize_t MiniSdpClient::Request(uint64_t peer, const OriginSdpAttr& attr, uint64_t now_ms, Callback callback) {
+    uint16_t seq = 0;
+    if (!allocSeq(peer, seq)) {
+        return kSdpRetBusy;
+    }
+    OriginSdpAttr request = attr;
+    request.seq = seq;
+    std::string packet(kMiniMiniSdpMaxLen, 0);
+    ssize_t size = ParseOriginSdpToMiniSdp(request, &packet[0], packet.size());
+    if (size <= 0) {
+        return size;
+    }
+    packet.resize(size);
+    return start(peer, seq, false, std::move(packet), now_ms, std::move(callback));
+}
+
+ssize_t MiniSdpClient::Stop(uint64_t peer, const StopStreamAttr& attr, uint64_t now_ms, Callback callback) {
+    uint16_t seq = 0;
+    if (!allocSeq(peer, seq)) {
+        return kSdpRetBusy;
+    }
+    StopStreamAttr request = attr;
+    request.seq = seq;
+    std::string packet(kMiniMiniSdpMaxLen, 0);
+    ssize_t size = BuildStopStreamPacket(&packet[0], packet.size(), request);
+    if (size <= 0) {
+        return size;
+    }
+    packet.resize(size);
+    return start(peer, seq, true, std::move(packet), now_ms, std::move(callback));
+}
+
+ssize_t MiniSdpClient::start(uint64_t peer, uint16_t seq, bool is_stop, std::string&& packet, uint64_t now_ms,
+                             Callback&& callback) {
+    uint64_t key = pendingKey(peer, seq);
+    Pending& pending = pending_[key];
+    pending.peer = peer;
+    pending.seq = seq;
+    pending.is_stop = is_stop;
+    pending.retransmits = 0;
+    pending.rto_ms = options_.initial_rto_ms;
+    pending.first_ms = now_ms;
+    pending.deadline_ms = now_ms + pending.rto_ms;
+    pending.packet = std::move(packet);
+    pending.callback = std::move(callback);
+    pending.timer_tick = wheel_.Schedule(key, pending.deadline_ms);
+    stats_.requests++;
+    send_(peer, pending.packet.data(), pending.packet.size());
+    return seq;
+}
+
+void MiniSdpClient::complete(std::unordered_map<uint64_t, Pending>::iterator it, Response& response,
+                             uint64_t now_ms) {
+    response.seq = it->second.seq;
+    response.retransmits = it->second.retransmits;
+    response.rtt_ms = now_ms - it->second.first_ms;
+    // fired already if it is a timeout
+    if (response.status != Status::kTimeout) wheel_.Cancel(it->first, it->second.timer_tick);
+    Callback callback = std::move(it->second.callback);
+    // the callback may start new requests
+    pending_.erase(it);
+    if (callback) callback(response);
+}
+
+bool MiniSdpClient::OnPacket(uint64_t peer, const char* data, size_t len, uint64_t now_ms) {
+    Response response;
+    bool is_stop = IsMiniSdpStopPack(data, len);
+    uint16_t seq = 0;
+    if (is_stop) {
+        if (LoadStopStreamPacket(data, len, response.stop) <= 0) {
+            stats_.errors++;
+            return false;
+        }
+        seq = response.stop.seq;
+    } else if (IsMiniSdpReqPack(data, len)) {
+        // seq first, a duplicate answer is not decoded
+        MiniSdpDispatchInfo info;
+        if (PeekMiniSdp(data, len, info) <= 0) {
+            stats_.errors++;
+            return false;
+        }
+        seq = info.seq;
+    } else {
+        return false;
+    }
+
+    auto it = pending_.find(pendingKey(peer, seq));
+    if (it == pending_.end() || it->second.is_stop != is_stop) {
+        stats_.unmatched++;
+        return false;
+    }
+    if (!is_stop && LoadMiniSdpToOriginSdp(data, len, response.answer) <= 0) {
+        stats_.errors++;
+        return false;
+    }
+    stats_.answered++;
+    response.status = Status::kAnswered;
+    complete(it, response, now_ms);
+    return true;
+}
+
+void MiniSdpClient::Advance(uint64_t now_ms) {
+    // callbacks may advance again
+    std::vector<uint64_t> expired;
+    expired.swap(expired_);
+    wheel_.Advance(now_ms, expired);
+    for (auto key : expired) {
+        auto it = pending_.find(key);
+        if (it == pending_.end() || now_ms < it->second.deadline_ms) continue;
+        Pending& pending = it->second;
+        if (pending.retransmits >= options_.max_retransmits) {
+            stats_.timeouts++;
+            Response response;
+            response.status = Status::kTimeout;
+            complete(it, response, now_ms);
+            continue;
+        }
+        pending.retransmits++;
+        pending.rto_ms = std::min(pending.rto_ms * 2, options_.max_rto_ms);
+        pending.deadline_ms = now_ms + pending.rto_ms;
+        pending.timer_tick = wheel_.Schedule(key, pending.deadline_ms);
+        stats_.retransmits++;
+        send_(pending.peer, pending.packet.data(), pending.packet.size());
+    }
+    if (expired_.empty()) expired_.swap(expired);
+}
+
+bool MiniSdpClient::Cancel(uint64_t peer, uint16_t seq, uint64_t now_ms) {
+    auto it = pending_.find(pendingKey(peer, seq));
+    if (it == pending_.end()) return false;
+    stats_.cancelled++;
+    Response response;
+    response.status = Status::kCancelled;
+    complete(it, response, now_ms);
+    return true;
+}
+
+}  // namespace mini_sdp
@@ -0,0 +1,182 @@
+/**
+ * @file mini_sdp/mini_sdp_client.h
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#ifndef MINI_SDP_MINI_SDP_CLIENT_H_
+#define MINI_SDP_MINI_SDP_CLIENT_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <netinet/in.h>
+#include "mini_sdp.h"
+#include "timer_wheel.h"
+
+namespace mini_sdp {
+
+// peer key of an ipv4 address, ip << 16 | port, peer keys of MiniSdpClient take 48 bits at most
+uint64_t MiniSdpPeerKey(const struct sockaddr_in& addr);
+
+/**
+ * @brief Seq Allocator
+ *  按目的地址分配请求序号，线程安全
+ *  - 目的地址按哈希分到固定数量的原子计数器，同一地址的序号递增且在 65536 个请求内不重复
+ *  - 初始值随机，避免进程重启后与服务端记录的最近序号相同而被当作重传
+ */
+class MiniSdpSeqAllocator {
+  public:
+    explicit MiniSdpSeqAllocator(uint32_t seed);
+
+    MiniSdpSeqAllocator();
+
+    uint16_t Next(uint64_t peer);
+
+  private:
+    static constexpr size_t kSlotNum = 256;
+
+    std::atomic<uint16_t> seqs_[kSlotNum];
+};  // class MiniSdpSeqAllocator
+
+/**
+ * @brief Client Engine
+ *  mini sdp 客户端请求引擎，不阻塞，不持有 socket
+ *  - 请求打包后由 SendFunc 发出，收到的包由调用方交给 OnPacket，按 <peer, seq> 匹配等待中的请求
+ *  - 未收到响应时以相同 seq 重传，超时时间指数退避，由时间轮驱动，调用方按 NextTimeoutMs 调用 Advance
+ *  - 请求完成（收到响应、超时或取消）时回调一次，回调中可以发起新的请求
+ *  - 同一目的地址的序号都在等待中时，新请求失败，不覆盖等待中的请求
+ *  - 非线程安全，每个事件循环线程一个实例，seq 分配器可在实例间共享
+ */
+class MiniSdpClient {
+  public:
+    struct Options {
+        uint32_t    initial_rto_ms      = 200;      // 首次重传的等待时间
+        uint32_t    max_rto_ms          = 3200;     // 退避后的上限
+        uint32_t    max_retransmits     = 5;        // 最后一次重传后再等待一个 rto 即超时
+        uint32_t    tick_ms             = 10;       // 时间轮精度
+        size_t      wheel_slots         = 1024;
+    };
+
+    enum class Status : int {
+        kAnswered = 0,
+        kTimeout,
+        kCancelled
+    };
+
+    struct Response {
+        Status          status = Status::kAnswered;
+        uint16_t        seq = 0;
+        uint32_t        retransmits = 0;
+        uint64_t        rtt_ms = 0;     // 从首次发送到完成
+
+        // kAnswered of Request
+        OriginSdpAttr   answer;
+        // kAnswered of Stop
+        StopStreamAttr  stop;
+    };
+
+    struct Stats {
+        uint64_t requests       = 0;
+        uint64_t retransmits    = 0;
+        uint64_t answered       = 0;
+        uint64_t timeouts       = 0;
+        uint64_t cancelled      = 0;
+        uint64_t unmatched      = 0;    // 没有匹配请求的响应，如重传引起的重复响应
+        uint64_t errors         = 0;    // 无法解析的响应
+    };
+
+    using Callback = std::function<void(const Response&)>;
+    using SendFunc = std::function<void(uint64_t peer, const char* data, size_t len)>;
+
+    /**
+     * @param send
+     * @param seqs shared by engines, outlives the engine
+     * @param options
+     * @param now_ms monotonic time
+     */
+    MiniSdpClient(SendFunc send, MiniSdpSeqAllocator& seqs, const Options& options, uint64_t now_ms);
+
+    /**
+     * @brief Send a request
+     *  attr.seq 由分配器设置，打包并发送
+     * @param peer
+     * @param attr offer, or a request without sdp
+     * @param now_ms
+     * @param callback
+     * @return ssize_t SdpRetcode or seq of the request, kSdpRetBusy if no seq is free for peer
+     */
+    ssize_t Request(uint64_t peer, const OriginSdpAttr& attr, uint64_t now_ms, Callback callback);
+
+    /**
+     * @brief Send a stop request
+     *  attr.seq 由分配器设置
+     * @return ssize_t SdpRetcode or seq of the request, kSdpRetBusy if no seq is free for peer
+     */
+    ssize_t Stop(uint64_t peer, const StopStreamAttr& attr, uint64_t now_ms, Callback callback);
+
+    /**
+     * @brief Feed a received packet
+     * @return true if it completes a pending request
+     */
+    bool OnPacket(uint64_t peer, const char* data, size_t len, uint64_t now_ms);
+
+    // retransmit or time out requests due by now_ms
+    void Advance(uint64_t now_ms);
+
+    // complete a pending request with kCancelled, false if not found
+    bool Cancel(uint64_t peer, uint16_t seq, uint64_t now_ms);
+
+    // when Advance is due next, UINT64_MAX if nothing is pending
+    uint64_t NextTimeoutMs() const { return wheel_.NextTickMs(); }
+
+    size_t PendingCount() const { return pending_.size(); }
+
+    const Stats& GetStats() const { return stats_; }
+
+  private:
+    struct Pending {
+        uint64_t    peer;
+        uint16_t    seq;
+        bool        is_stop;
+        uint32_t    retransmits;
+        uint32_t    rto_ms;
+        uint64_t    first_ms;
+        uint64_t    deadline_ms;    // timers fired before it are stale
+        uint64_t    timer_tick;     // of the timer in the wheel, to cancel it
+        std::string packet;
+        Callback    callback;
+    };
+
+    static uint64_t pendingKey(uint64_t peer, uint16_t seq) { return peer << 16 | seq; }
+
+    // a seq not pending for peer, false if none is found
+    bool allocSeq(uint64_t peer, uint16_t& seq);
+
+    ssize_t start(uint64_t peer, uint16_t seq, bool is_stop, std::string&& packet, uint64_t now_ms,
+                  Callback&& callback);
+
+    void complete(std::unordered_map<uint64_t, Pending>::iterator it, Response& response, uint64_t now_ms);
+
+  private:
+    SendFunc                                send_;
+    MiniSdpSeqAllocator&                    seqs_;
+    Options                                 options_;
+    TimerWheel                              wheel_;
+    std::vector<uint64_t>                   expired_;
+
+    // <peer, seq> => request, a timer of the wheel is the key of its request
+    std::unordered_map<uint64_t, Pending>   pending_;
+
+    Stats                                   stats_;
+};  // class MiniSdpClient
+
+}  // namespace mini_sdp
+
+#endif  // MINI_SDP_MINI_SDP_CLIENT_H_
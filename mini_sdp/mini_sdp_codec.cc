@@ -0,0 +1,74 @@
+/**
+ * @file mini_sdp/mini_sdp_codec.cc
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include "mini_sdp_codec.h"
+#include "mini_sdp_impl.h"
+#include "mini_sdp_v1.h"
+
+namespace mini_sdp {
+
+MiniSdpCodecRegistry& MiniSdpCodecRegistry::Instance() {
+    static MiniSdpCodecRegistry registry;
+    return registry;
+}
+
+MiniSdpCodecRegistry::MiniSdpCodecRegistry() {
+    Register(std::make_shared<MiniSdpCodecV0>());
+    Register(std::make_shared<MiniSdpCodecV1>());
+}
+
+void MiniSdpCodecRegistry::Register(MiniSdpCodecPtr codec) {
+    if (!codec) return;
+    codecs_[codec->Version()] = codec;
+}
+
+int MiniSdpCodecV0::Pack(const OriginSdpAttr &attr, SessionDescriptionPtr sdp_info, char *buff, size_t len) const {
+    MiniSdpPacker packer;
+    if (attr.sdp_type == SdpType::kSdpNone || !sdp_info) {
+        return packer.PackToDstMem(buff, len, std::string(), SdpType::kSdpNone, attr.stream_url, attr.svrsig,
+                                   attr.seq, attr.status_code);
+    }
+    return packer.PackToDstMem(buff, len, sdp_info, attr.sdp_type, attr.stream_url, attr.svrsig, attr.seq,
+                               attr.status_code, attr.is_imm_send, attr.is_support_aac_fmtp, attr.is_push,
+                               attr.is_compact_fingerprint);
+}
+
+int MiniSdpCodecV0::Load(const char *buff, size_t len, OriginSdpAttr &attr) const {
+    MiniSdpLoader loader;
+    attr.version = 0;
+    return loader.ParseToString(const_cast<char *>(buff), len, attr.seq, attr.sdp_type, attr.origin_sdp,
+                                attr.stream_url, attr.svrsig, attr.status_code, attr.is_imm_send,
+                                attr.is_support_aac_fmtp, attr.is_push, attr.is_compact_fingerprint);
+}
+
+int MiniSdpCodecV0::Peek(const char *buff, size_t len, MiniSdpDispatchInfo &info) const {
+    MiniSdpLoader loader;
+    return loader.Peek(buff, len, info);
+}
+
+size_t MiniSdpCodecV0::CodecSize(const CodecDescription &codec, bool is_support_aac_fmtp) const {
+    MiniCodecDesc mini_codec_desc;
+    if (!PackMiniCodecDesc(codec, mini_codec_desc)) return 0;
+    size_t size = sizeof(MiniCodecDesc);
+    if (is_support_aac_fmtp && (codec.Name == kSdpCodecLatm || codec.Name == kSdpCodecAdts)) {
+        size += sizeof(MiniAacConfig) + codec.GetFormatParam("config", "").size();
+    }
+    return size;
+}
+
+size_t MiniSdpCodecV0::ExtSize(const std::string &uri) const {
+    uint8_t mini_uri;
+    return PackMiniExtUri(uri, mini_uri) ? sizeof(MiniExtDesc) : 0;
+}
+
+size_t MiniSdpCodecV0::TrackSize(size_t track_idx) const {
+    return track_idx < 2 ? 0 : sizeof(uint32_t);
+}
+
+}  // namespace mini_sdp
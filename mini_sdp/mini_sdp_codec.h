@@ -0,0 +1,117 @@
+/**
+ * @file mini_sdp/mini_sdp_codec.h
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#ifndef MINI_SDP_MINI_SDP_CODEC_H_
+#define MINI_SDP_MINI_SDP_CODEC_H_
+
+#include <memory>
+#include <string>
+#include "mini_sdp.h"
+
+namespace mini_sdp {
+
+/**
+ * @brief Mini SDP Codec
+ *  mini sdp 某一版本二进制格式的编解码，以 MiniSdpHdr::version 区分
+ *  - 实现需要无状态，可被多线程同时使用
+ */
+class MiniSdpCodec {
+  public:
+    virtual ~MiniSdpCodec() = default;
+
+    // MiniSdpHdr::version
+    virtual uint8_t Version() const = 0;
+
+    /**
+     * @brief pack to mini sdp
+     *
+     * @param attr
+     * @param sdp_info parsed attr.origin_sdp, nullptr if attr.sdp_type is kSdpNone
+     * @param buff
+     * @param len
+     * @return >0 size of mini sdp, larger than len if the buffer is not enough
+     * @return =0 pack error
+     */
+    virtual int Pack(const OriginSdpAttr &attr, SessionDescriptionPtr sdp_info, char *buff, size_t len) const = 0;
+
+    /**
+     * @brief load mini sdp, version of buff is checked by caller
+     *
+     * @return >0 size of mini sdp
+     * @return =0 parse error
+     */
+    virtual int Load(const char *buff, size_t len, OriginSdpAttr &attr) const = 0;
+
+    /**
+     * @brief read dispatch info of mini sdp without building the sdp, version of buff is checked by caller
+     *  - every read is bounds checked, the same packets as Load are accepted
+     *
+     * @return >0 size of mini sdp
+     * @return =0 parse error
+     */
+    virtual int Peek(const char *buff, size_t len, MiniSdpDispatchInfo &info) const = 0;
+
+    // bytes of a codec in mini sdp, 0 if not supported
+    virtual size_t CodecSize(const CodecDescription &codec, bool is_support_aac_fmtp) const = 0;
+
+    // bytes of an extmap in mini sdp, 0 if not supported
+    virtual size_t ExtSize(const std::string &uri) const = 0;
+
+    // bytes of the track_idx-th track of a media in mini sdp, at least those saved by dropping it
+    virtual size_t TrackSize(size_t track_idx) const = 0;
+};  // class MiniSdpCodec
+
+using MiniSdpCodecPtr = std::shared_ptr<MiniSdpCodec>;
+
+/**
+ * @brief Codec Registry
+ *  版本号到编解码实现的映射，内置 v0 和 v1
+ *  - Register 非线程安全，需在使用前（如进程启动时）完成注册
+ */
+class MiniSdpCodecRegistry {
+  public:
+    static MiniSdpCodecRegistry& Instance();
+
+    // replace the codec with the same version
+    void Register(MiniSdpCodecPtr codec);
+
+    // nullptr if not registered
+    const MiniSdpCodec* Find(uint8_t version) const { return codecs_[version].get(); }
+
+  private:
+    MiniSdpCodecRegistry();
+
+    MiniSdpCodecPtr codecs_[256];
+};  // class MiniSdpCodecRegistry
+
+/**
+ * @brief Codec v0
+ *  v0 格式，由 MiniSdpPacker/MiniSdpLoader 实现
+ */
+class MiniSdpCodecV0 : public MiniSdpCodec {
+  public:
+    uint8_t Version() const override { return 0; }
+
+    int Pack(const OriginSdpAttr &attr, SessionDescriptionPtr sdp_info, char *buff, size_t len) const override;
+
+    int Load(const char *buff, size_t len, OriginSdpAttr &attr) const override;
+
+    int Peek(const char *buff, size_t len, MiniSdpDispatchInfo &info) const override;
+
+    size_t CodecSize(const CodecDescription &codec, bool is_support_aac_fmtp) const override;
+
+    size_t ExtSize(const std::string &uri) const override;
+
+    // ssrc1/ssrc2 are always in MiniMediaHdr, the others take 4 bytes in the track section
+    size_t TrackSize(size_t track_idx) const override;
+};  // class MiniSdpCodecV0
+
+}  // namespace mini_sdp
+
+#endif  // MINI_SDP_MINI_SDP_CODEC_H_
@@ -0,0 +1,304 @@
+/**
+ * @file mini_sdp/mini_sdp_delta.cc
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include "mini_sdp_delta.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <map>
+#include "mini_sdp_impl.h"
+#include "util.h"
+
+namespace mini_sdp {
+
+static bool isAacCodec(const std::string &name) {
+    return name == kSdpCodecLatm || name == kSdpCodecAdts;
+}
+
+// what a codec looks like in mini sdp, MiniCodecDesc with MiniAacConfig for aac
+static bool miniCodecBytes(const CodecDescription &codec, std::string &dst) {
+    MiniCodecDesc mini_codec_desc;
+    if (!PackMiniCodecDesc(codec, mini_codec_desc)) return false;
+    dst.assign(reinterpret_cast<const char*>(&mini_codec_desc), sizeof(MiniCodecDesc));
+    if (isAacCodec(codec.Name)) {
+        std::string aac_config;
+        PackMiniAacConfig(codec, aac_config);
+        dst += aac_config;
+    }
+    return true;
+}
+
+static void diffCodecs(const MediaDescription &base, const MediaDescription &target, SdpMediaDelta &media_delta) {
+    std::map<uint8_t, std::string> base_codecs;
+    std::string bytes;
+    for (auto &codec_pair : base.Codecs) {
+        if (miniCodecBytes(*codec_pair.second, bytes)) base_codecs.emplace(codec_pair.first, bytes);
+    }
+    for (auto &codec_pair : target.Codecs) {
+        if (!miniCodecBytes(*codec_pair.second, bytes)) continue;
+        auto it = base_codecs.find(codec_pair.first);
+        if (it != base_codecs.end()) {
+            if (it->second == bytes) {
+                base_codecs.erase(it);
+                continue;
+            }
+            media_delta.removed_codecs.push_back(codec_pair.first);
+            base_codecs.erase(it);
+        }
+        media_delta.added_codecs.push_back(codec_pair.second);
+    }
+    for (auto &codec_pair : base_codecs) {
+        media_delta.removed_codecs.push_back(codec_pair.first);
+    }
+}
+
+static void diffTracks(const MediaDescription &base, const MediaDescription &target, SdpMediaDelta &media_delta) {
+    for (auto ssrc : base.TracksOrder) {
+        if (!target.Tracks.count(ssrc)) media_delta.removed_ssrcs.push_back(ssrc);
+    }
+    for (auto ssrc : target.TracksOrder) {
+        if (!base.Tracks.count(ssrc)) media_delta.added_ssrcs.push_back(ssrc);
+    }
+}
+
+// attributes of the tracks added to media, a track without any is not rendered.
+// the same stream as the other tracks of media, or the cname of the session if media has none
+static std::map<std::string, std::string> addedTrackAttributes(const SessionDescription &sdp,
+                                                                const MediaDescription &media) {
+    for (auto ssrc : media.TracksOrder) {
+        auto it = media.Tracks.find(ssrc);
+        if (it != media.Tracks.end() && it->second->HasAttribute("cname")) return it->second->GetAttributes();
+    }
+    std::map<std::string, std::string> attributes;
+    attributes["cname"] = media.IceUfrag;
+    for (auto &media_pair : sdp.Medias) {
+        for (auto &track_pair : media_pair.second->Tracks) {
+            if (track_pair.second->HasAttribute("cname")) {
+                attributes["cname"] = track_pair.second->GetAttribute("cname");
+                return attributes;
+            }
+        }
+    }
+    return attributes;
+}
+
+bool DiffSessionDescription(const SessionDescription& base, const SessionDescription& target, SdpDelta& delta) {
+    delta = SdpDelta();
+    if (base.Medias.size() != target.Medias.size()) return false;
+    bool ice_changed = false;
+
+    for (auto &media_pair : target.Medias) {
+        auto base_it = base.Medias.find(media_pair.first);
+        if (base_it == base.Medias.end()) return false;
+        auto &base_media = *base_it->second;
+        auto &target_media = *media_pair.second;
+        if (base_media.MediaType != target_media.MediaType) return false;
+
+        SdpMediaDelta media_delta;
+        media_delta.mid = media_pair.first;
+        media_delta.media_type = target_media.MediaType;
+        diffCodecs(base_media, target_media, media_delta);
+        diffTracks(base_media, target_media, media_delta);
+        if (!media_delta.Empty()) delta.medias.push_back(std::move(media_delta));
+        if (base_media.IceUfrag != target_media.IceUfrag || base_media.IcePwd != target_media.IcePwd) {
+            ice_changed = true;
+        }
+    }
+
+    // ufrag and pwd of a delta are of all medias, medias restarted with different ones need a full offer
+    if (ice_changed) {
+        auto &first_media = *target.Medias.begin()->second;
+        for (auto &media_pair : target.Medias) {
+            auto &target_media = *media_pair.second;
+            if (target_media.IceUfrag != first_media.IceUfrag || target_media.IcePwd != first_media.IcePwd) {
+                return false;
+            }
+        }
+        delta.ice_ufrag = first_media.IceUfrag;
+        delta.ice_pwd = first_media.IcePwd;
+    }
+    return true;
+}
+
+bool ApplySdpDelta(const SdpDelta& delta, SessionDescription& sdp) {
+    for (auto &media_delta : delta.medias) {
+        auto it = sdp.Medias.find(media_delta.mid);
+        if (it == sdp.Medias.end() || it->second->MediaType != media_delta.media_type) return false;
+    }
+
+    if (!delta.ice_ufrag.empty() || !delta.ice_pwd.empty()) {
+        for (auto &media_pair : sdp.Medias) {
+            media_pair.second->IceUfrag = delta.ice_ufrag;
+            media_pair.second->IcePwd = delta.ice_pwd;
+        }
+    }
+
+    for (auto &media_delta : delta.medias) {
+        auto &media = *sdp.Medias[media_delta.mid];
+        for (auto pt : media_delta.removed_codecs) {
+            media.Codecs.erase(pt);
+        }
+        for (auto &codec : media_delta.added_codecs) {
+            media.Codecs[codec->Format] = codec;
+        }
+        for (auto ssrc : media_delta.removed_ssrcs) {
+            if (media.Tracks.erase(ssrc)) {
+                media.TracksOrder.erase(std::find(media.TracksOrder.begin(), media.TracksOrder.end(), ssrc));
+            }
+            for (auto &group : media.SsrcGroups) {
+                group.Ssrcs.erase(std::remove(group.Ssrcs.begin(), group.Ssrcs.end(), ssrc), group.Ssrcs.end());
+            }
+        }
+        // a group of one ssrc groups nothing
+        media.SsrcGroups.erase(std::remove_if(media.SsrcGroups.begin(), media.SsrcGroups.end(),
+                                              [](const SsrcGroup &group) { return group.Ssrcs.size() < 2; }),
+                               media.SsrcGroups.end());
+        if (media_delta.added_ssrcs.empty()) continue;
+        auto attributes = addedTrackAttributes(sdp, media);
+        for (auto ssrc : media_delta.added_ssrcs) {
+            if (media.Tracks.count(ssrc)) continue;
+            TrackDescriptionPtr track = MakeTrackDescription();
+            track->Ssrc = ssrc;
+            for (auto &attr : attributes) track->SetAttribute(attr.first, attr.second);
+            media.Tracks.emplace(ssrc, track);
+            media.TracksOrder.push_back(ssrc);
+        }
+    }
+    return true;
+}
+
+bool IsMiniSdpDeltaPack(const char* data, size_t len) {
+    return len >= 4 && (uint8_t)data[0] == kMiniSdpPacketType && data[1] == 'D' && data[2] == 'L' && data[3] == 'T';
+}
+
+/*
+ * Body, after MiniSdpDeltaHdr and svrsig
+ *  str16 ufrag, str16 pwd, u8 media_num
+ *  media: str8 mid, u8 media_type,
+ *         u8 num, payload types of removed codecs,
+ *         u8 num, MiniCodecDesc [MiniAacConfig] of added codecs,
+ *         u8 num, removed ssrcs,
+ *         u8 num, added ssrcs
+ *  auth
+ */
+ssize_t BuildSdpDeltaPacket(char* buff, size_t len, const SdpDeltaAttr& attr) {
+    const SdpDelta &delta = attr.delta;
+    constexpr size_t kU8Max = std::numeric_limits<uint8_t>::max();
+    constexpr size_t kU16Max = std::numeric_limits<uint16_t>::max();
+    if (attr.svrsig.size() > kU16Max || delta.ice_ufrag.size() > kU16Max || delta.ice_pwd.size() > kU16Max ||
+        delta.medias.size() > kU8Max) {
+        return kSdpRetWrongFormat;
+    }
+
+    BufferWriter writer(buff, len);
+    MiniSdpDeltaHdr hdr;
+    hdr.pack_type = kMiniSdpPacketType;
+    memcpy(hdr.magic_word, "DLT", 3);
+    hdr.version = 0;
+    hdr.status = htons(attr.status);
+    hdr.seq = htons(attr.seq);
+    hdr.svrsig_len = htons((uint16_t)attr.svrsig.size());
+    writer.Put(&hdr, sizeof(hdr));
+    writer.Put(attr.svrsig.data(), attr.svrsig.size());
+
+    writer.PutU16(delta.ice_ufrag.size());
+    writer.Put(delta.ice_ufrag.data(), delta.ice_ufrag.size());
+    writer.PutU16(delta.ice_pwd.size());
+    writer.Put(delta.ice_pwd.data(), delta.ice_pwd.size());
+
+    writer.PutU8(delta.medias.size());
+    std::string bytes;
+    for (auto &media_delta : delta.medias) {
+        if (media_delta.mid.size() > kU8Max || media_delta.removed_codecs.size() > kU8Max ||
+            media_delta.added_codecs.size() > kU8Max || media_delta.removed_ssrcs.size() > kU8Max ||
+            media_delta.added_ssrcs.size() > kU8Max) {
+            return kSdpRetWrongFormat;
+        }
+        writer.PutU8(media_delta.mid.size());
+        writer.Put(media_delta.mid.data(), media_delta.mid.size());
+        writer.PutU8((uint8_t)media_delta.media_type);
+
+        writer.PutU8(media_delta.removed_codecs.size());
+        writer.Put(media_delta.removed_codecs.data(), media_delta.removed_codecs.size());
+
+        writer.PutU8(media_delta.added_codecs.size());
+        for (auto &codec : media_delta.added_codecs) {
+            if (!miniCodecBytes(*codec, bytes)) return kSdpRetWrongFormat;
+            writer.Put(bytes.data(), bytes.size());
+        }
+
+        writer.PutU8(media_delta.removed_ssrcs.size());
+        for (auto ssrc : media_delta.removed_ssrcs) writer.PutU32(ssrc);
+        writer.PutU8(media_delta.added_ssrcs.size());
+        for (auto ssrc : media_delta.added_ssrcs) writer.PutU32(ssrc);
+    }
+
+    if (writer.Offset() + kMiniSdpAuthLength > len) return kSdpRetSizeExceeded;
+    memset(buff + writer.Offset(), 0, kMiniSdpAuthLength);
+    return writer.Offset() + kMiniSdpAuthLength;
+}
+
+ssize_t LoadSdpDeltaPacket(const char* buff, size_t len, SdpDeltaAttr& attr) {
+    if (len < sizeof(MiniSdpDeltaHdr) + kMiniSdpAuthLength) return kSdpRetSizeExceeded;
+    if (!IsMiniSdpDeltaPack(buff, len)) return kSdpRetWrongFormat;
+
+    const MiniSdpDeltaHdr* hdr = (const MiniSdpDeltaHdr*)buff;
+    if (hdr->version != 0) return kSdpRetWrongFormat;
+
+    attr.status = ntohs(hdr->status);
+    attr.seq = ntohs(hdr->seq);
+    attr.delta = SdpDelta();
+    SdpDelta &delta = attr.delta;
+
+    // the auth is not a part of body
+    BufferReader reader(buff, len - kMiniSdpAuthLength);
+    reader.Get(sizeof(MiniSdpDeltaHdr));
+    reader.GetStr(attr.svrsig, ntohs(hdr->svrsig_len));
+    reader.GetStr(delta.ice_ufrag, reader.GetU16());
+    reader.GetStr(delta.ice_pwd, reader.GetU16());
+
+    uint8_t media_num = reader.GetU8();
+    for (uint8_t i = 0; i < media_num && !reader.Failed(); i++) {
+        SdpMediaDelta media_delta;
+        reader.GetStr(media_delta.mid, reader.GetU8());
+        uint8_t media_type = reader.GetU8();
+        if (media_type > (uint8_t)SdpMediaType::kData) return kSdpRetWrongFormat;
+        media_delta.media_type = (SdpMediaType)media_type;
+
+        uint8_t num = reader.GetU8();
+        const char *pts = reader.Get(num);
+        if (pts) media_delta.removed_codecs.assign(pts, pts + num);
+
+        num = reader.GetU8();
+        for (uint8_t j = 0; j < num && !reader.Failed(); j++) {
+            const MiniCodecDesc *codec_desc = (const MiniCodecDesc*)reader.Get(sizeof(MiniCodecDesc));
+            if (!codec_desc) break;
+            CodecDescriptionPtr codec = LoadMiniCodecDesc(*codec_desc, nullptr, media_delta.media_type);
+            if (!codec) return kSdpRetWrongFormat;
+            if (isAacCodec(codec->Name)) {
+                const MiniAacConfig *aac_config = (const MiniAacConfig*)reader.Get(sizeof(MiniAacConfig));
+                if (!aac_config || !reader.Get(aac_config->config_len)) break;
+                codec = LoadMiniCodecDesc(*codec_desc, aac_config, media_delta.media_type);
+            }
+            media_delta.added_codecs.push_back(codec);
+        }
+
+        num = reader.GetU8();
+        for (uint8_t j = 0; j < num && !reader.Failed(); j++) media_delta.removed_ssrcs.push_back(reader.GetU32());
+        num = reader.GetU8();
+        for (uint8_t j = 0; j < num && !reader.Failed(); j++) media_delta.added_ssrcs.push_back(reader.GetU32());
+
+        delta.medias.push_back(std::move(media_delta));
+    }
+
+    if (reader.Failed()) return kSdpRetSizeExceeded;
+    return reader.Offset() + kMiniSdpAuthLength;
+}
+
+}  // namespace mini_sdp
@@ -0,0 +1,149 @@
+/**
+ * @file mini_sdp/mini_sdp_delta.h
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#ifndef MINI_SDP_MINI_SDP_DELTA_H_
+#define MINI_SDP_MINI_SDP_DELTA_H_
+
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#include "sdp.h"
+
+namespace mini_sdp {
+
+/**
+ * @brief Delta Header
+ *  mini sdp 增量更新包头，用于 ICE restart 和重协商
+ *  - 以 svrsig 关联已建立的 Session，只携带变化的内容
+ */
+struct MiniSdpDeltaHdr {
+    uint8_t     pack_type;
+    char        magic_word[3];  // "DLT"
+    uint8_t     version;
+    uint16_t    status;
+    uint16_t    seq;
+    uint16_t    svrsig_len;
+} __attribute__((packed));
+
+/**
+ * @brief Media Delta
+ *  单个 media 的变化，media 以 mid 标识
+ *  - 参数变化的 codec 表示为先删除再添加
+ */
+struct SdpMediaDelta {
+    std::string                     mid;
+    SdpMediaType                    media_type = SdpMediaType::kAudio;
+    std::vector<uint8_t>            removed_codecs;     // payload type
+    std::vector<CodecDescriptionPtr> added_codecs;
+    std::vector<uint32_t>           removed_ssrcs;
+    std::vector<uint32_t>           added_ssrcs;
+
+    bool Empty() const {
+        return removed_codecs.empty() && added_codecs.empty() && removed_ssrcs.empty() && added_ssrcs.empty();
+    }
+};  // struct SdpMediaDelta
+
+/**
+ * @brief Session Delta
+ *  Session 的变化
+ */
+struct SdpDelta {
+    // ICE
+    // - 为空表示未变化，ICE restart 时两者均不为空
+    std::string                 ice_ufrag;
+    std::string                 ice_pwd;
+
+    // Medias
+    // - 只包含有变化的 media
+    std::vector<SdpMediaDelta>  medias;
+
+    bool Empty() const { return ice_ufrag.empty() && ice_pwd.empty() && medias.empty(); }
+};  // struct SdpDelta
+
+/**
+ * @brief Delta Attribute
+ *  增量更新包参数
+ */
+struct SdpDeltaAttr {
+    // Server Signature
+    // - 服务端标识
+    // * 与 answer （响应 UDP）的 svrsig 保持一致
+    std::string svrsig;
+
+    // Status Code
+    // - 响应状态码，仅在响应中为有效值
+    uint16_t    status = 0;
+
+    // Sequence
+    // - 请求序号
+    uint16_t    seq = 0;
+
+    SdpDelta    delta;
+};  // struct SdpDeltaAttr
+
+/**
+ * @brief Diff SessionDescription
+ *  计算 base 到 target 的变化，只比较 mini sdp 可表达的内容
+ *  - media 以 mid 对应，mid 集合或者 media 类型不同时无法增量表达
+ *  - mini sdp 不支持的 codec 被忽略，与完整打包一致
+ *  - 每个 media 的 ufrag/pwd 分别比较，ice 重启后各 media 不一致时无法增量表达
+ * @param base
+ * @param target
+ * @param delta result
+ * @return true
+ * @return false if it can not be expressed by a delta, a full offer is needed
+ */
+bool DiffSessionDescription(const SessionDescription& base, const SessionDescription& target, SdpDelta& delta);
+
+/**
+ * @brief Apply Delta
+ *  将变化应用到已保存的 SessionDescription
+ *  - 校验全部通过后才修改 sdp
+ *  - 删除的 ssrc 同时从 ssrc-group 中移除，只剩一个 ssrc 的 group 被删除
+ *  - 新增的 track 沿用同一 media 中已有 track 的 cname、msid 等属性
+ * @param delta
+ * @param sdp
+ * @return true
+ * @return false if a media in delta is not found, sdp is unchanged
+ */
+bool ApplySdpDelta(const SdpDelta& delta, SessionDescription& sdp);
+
+/**
+ * @brief Check Delta Packet
+ *  检查 UDP 包是否为 mini sdp 增量更新包
+ * @param data
+ * @param len
+ * @return true
+ * @return false
+ */
+bool IsMiniSdpDeltaPack(const char* data, size_t len);
+
+/**
+ * @brief Build Delta Packet
+ *  构建 mini sdp 增量更新 UDP 包
+ * @param buff packet
+ * @param len packet
+ * @param attr
+ * @return ssize_t SdpRetCode or size of packet
+ */
+ssize_t BuildSdpDeltaPacket(char* buff, size_t len, const SdpDeltaAttr& attr);
+
+/**
+ * @brief Load Delta Packet
+ *  解析 mini sdp 增量更新 UDP 包
+ * @param buff
+ * @param len
+ * @param attr
+ * @return ssize_t SdpRetCode or size of packet
+ */
+ssize_t LoadSdpDeltaPacket(const char* buff, size_t len, SdpDeltaAttr& attr);
+
+}  // namespace mini_sdp
+
+#endif  // MINI_SDP_MINI_SDP_DELTA_H_
@@ -0,0 +1,199 @@
+/**
+ * @file mini_sdp/mini_sdp_frag.cc
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include "mini_sdp_frag.h"
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include "mini_sdp_impl.h"
+#include "util.h"
+
+namespace mini_sdp {
+
+bool IsMiniSdpFragPack(const char* data, size_t len) {
+    return len >= 4 && (uint8_t)data[0] == kMiniSdpPacketType && data[1] == 'F' && data[2] == 'R' && data[3] == 'G';
+}
+
+size_t GetMiniSdpFragCount(size_t len, size_t max_frag_size) {
+    if (max_frag_size <= sizeof(MiniSdpFragHdr) || len == 0 || len > std::numeric_limits<uint16_t>::max()) return 0;
+    size_t chunk = max_frag_size - sizeof(MiniSdpFragHdr);
+    size_t count = (len + chunk - 1) / chunk;
+    return count <= kMiniSdpFragMaxCount ? count : 0;
+}
+
+ssize_t BuildMiniSdpFragPacket(char* buff, size_t len, const char* data, size_t data_len,
+                               uint32_t msg_id, uint8_t index, size_t max_frag_size) {
+    size_t count = GetMiniSdpFragCount(data_len, max_frag_size);
+    if (count == 0) return kSdpRetSizeExceeded;
+    if (index >= count) return kSdpRetWrongFormat;
+
+    size_t chunk = max_frag_size - sizeof(MiniSdpFragHdr);
+    size_t offset = index * chunk;
+    size_t payload_len = std::min(chunk, data_len - offset);
+    size_t total_bytes = sizeof(MiniSdpFragHdr) + payload_len;
+    if (total_bytes > len) return kSdpRetSizeExceeded;
+
+    MiniSdpFragHdr* hdr = (MiniSdpFragHdr*)buff;
+    hdr->pack_type = kMiniSdpPacketType;
+    memcpy(hdr->magic_word, "FRG", 3);
+    hdr->version = 0;
+    hdr->index = index;
+    hdr->count = (uint8_t)count;
+    hdr->msg_id = htonl(msg_id);
+    hdr->total_len = htons((uint16_t)data_len);
+    hdr->offset = htons((uint16_t)offset);
+
+    memcpy(buff + sizeof(MiniSdpFragHdr), data + offset, payload_len);
+    return total_bytes;
+}
+
+ssize_t LoadMiniSdpFragPacket(const char* buff, size_t len, MiniSdpFragAttr& attr) {
+    if (len < sizeof(MiniSdpFragHdr)) return kSdpRetSizeExceeded;
+    if (!IsMiniSdpFragPack(buff, len)) return kSdpRetWrongFormat;
+
+    const MiniSdpFragHdr* hdr = (const MiniSdpFragHdr*)buff;
+    if (hdr->version != 0) return kSdpRetWrongFormat;
+
+    attr.msg_id = ntohl(hdr->msg_id);
+    attr.index = hdr->index;
+    attr.count = hdr->count;
+    attr.total_len = ntohs(hdr->total_len);
+    attr.offset = ntohs(hdr->offset);
+    attr.payload = buff + sizeof(MiniSdpFragHdr);
+    attr.payload_len = len - sizeof(MiniSdpFragHdr);
+
+    if (attr.count == 0 || attr.index >= attr.count || attr.payload_len == 0 ||
+        (size_t)attr.offset + attr.payload_len > attr.total_len) {
+        return kSdpRetWrongFormat;
+    }
+    return len;
+}
+
+// payload size of every fragment but the last, 0 if the fragment is not where BuildMiniSdpFragPacket puts it
+static size_t fragChunk(const MiniSdpFragAttr& attr) {
+    size_t chunk = 0;
+    if (attr.index + 1 < attr.count) {
+        chunk = attr.payload_len;
+    } else if (attr.index == 0) {
+        chunk = attr.total_len;
+    } else if (attr.offset % attr.index == 0) {
+        chunk = attr.offset / attr.index;
+    }
+    if (chunk == 0 || attr.index * chunk != attr.offset) return 0;
+    // the last one carries the rest
+    if (attr.payload_len != std::min<size_t>(chunk, attr.total_len - attr.offset)) return 0;
+    if ((attr.total_len + chunk - 1) / chunk != attr.count) return 0;
+    return chunk;
+}
+
+// a completed_ node with its completed_order_ record
+constexpr size_t kCompletedRecordSize = 64;
+
+MiniSdpReassembler::MiniSdpReassembler(size_t max_memory, uint32_t timeout_ms)
+: max_memory_(max_memory), timeout_ms_(timeout_ms) {
+    // nothing
+}
+
+MiniSdpReassembler::FeedResult MiniSdpReassembler::Feed(uint64_t source, const char* data, size_t len,
+                                                        uint64_t now_ms, std::string& out) {
+    Expire(now_ms);
+
+    MiniSdpFragAttr attr;
+    size_t chunk = 0;
+    if (LoadMiniSdpFragPacket(data, len, attr) < 0 || (chunk = fragChunk(attr)) == 0) {
+        stats_.errors++;
+        return FeedResult::kWrongFormat;
+    }
+
+    MsgKey key{source, attr.msg_id};
+    if (completed_.count(key)) {
+        stats_.duplicates++;
+        return FeedResult::kDuplicate;
+    }
+
+    auto idx_it = index_.find(key);
+    if (idx_it == index_.end()) {
+        if (attr.total_len > max_memory_) {
+            stats_.dropped++;
+            return FeedResult::kDropped;
+        }
+        // evict the oldest messages
+        while (memory_usage_ + attr.total_len > max_memory_) {
+            removeMessage(messages_.begin());
+            stats_.evicted++;
+        }
+        messages_.emplace_back();
+        auto msg_it = std::prev(messages_.end());
+        msg_it->key = key;
+        msg_it->first_ms = now_ms;
+        msg_it->count = attr.count;
+        msg_it->total_len = attr.total_len;
+        msg_it->chunk = chunk;
+        msg_it->data.resize(attr.total_len);
+        memory_usage_ += attr.total_len;
+        idx_it = index_.emplace(key, msg_it).first;
+    }
+
+    Message& msg = *idx_it->second;
+    if (msg.count != attr.count || msg.total_len != attr.total_len || msg.chunk != chunk) {
+        stats_.errors++;
+        return FeedResult::kWrongFormat;
+    }
+
+    uint64_t bit = 1ull << (attr.index % 64);
+    uint64_t& bits = msg.recv_bits[attr.index / 64];
+    if (bits & bit) {
+        stats_.duplicates++;
+        return FeedResult::kDuplicate;
+    }
+    bits |= bit;
+    msg.recv_num++;
+    msg.recv_bytes += attr.payload_len;
+    memcpy(&msg.data[attr.offset], attr.payload, attr.payload_len);
+
+    if (msg.recv_num < msg.count || msg.recv_bytes < msg.total_len) return FeedResult::kIncomplete;
+
+    out.swap(msg.data);
+    while (!completed_order_.empty() && (completed_order_.size() + 1) * kCompletedRecordSize > max_memory_) {
+        popCompleted();
+    }
+    completed_[key] = ++completed_generation_;
+    completed_order_.push_back(Completed{now_ms, completed_generation_, key});
+    removeMessage(idx_it->second);
+    stats_.completed++;
+    return FeedResult::kComplete;
+}
+
+void MiniSdpReassembler::Expire(uint64_t now_ms) {
+    while (!messages_.empty() && messages_.front().first_ms + timeout_ms_ <= now_ms) {
+        removeMessage(messages_.begin());
+        stats_.expired++;
+    }
+    // retransmitted fragments of a completed message arrive within the timeout
+    while (!completed_order_.empty() && completed_order_.front().complete_ms + timeout_ms_ <= now_ms) {
+        popCompleted();
+    }
+}
+
+void MiniSdpReassembler::popCompleted() {
+    const Completed& record = completed_order_.front();
+    auto it = completed_.find(record.key);
+    if (it != completed_.end() && it->second == record.generation) {
+        completed_.erase(it);
+    }
+    completed_order_.pop_front();
+}
+
+void MiniSdpReassembler::removeMessage(MessageList::iterator it) {
+    memory_usage_ -= it->total_len;
+    index_.erase(it->key);
+    messages_.erase(it);
+}
+
+}  // namespace mini_sdp
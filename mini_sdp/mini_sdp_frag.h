@@ -0,0 +1,213 @@
+/**
+ * @file mini_sdp/mini_sdp_frag.h
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#ifndef MINI_SDP_MINI_SDP_FRAG_H_
+#define MINI_SDP_MINI_SDP_FRAG_H_
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <sys/types.h>
+
+namespace mini_sdp {
+
+/**
+ * @brief Fragment Header
+ *  mini sdp 分片头，超过一个 UDP 包的 mini sdp 被拆分为多个分片
+ *  - 分片负载为完整 mini sdp 中 [offset, offset + len) 的部分
+ */
+struct MiniSdpFragHdr {
+    uint8_t     pack_type;
+    char        magic_word[3];  // "FRG"
+    uint8_t     version;
+    uint8_t     index;          // 分片序号，从 0 开始
+    uint8_t     count;          // 分片总数
+    uint32_t    msg_id;         // 消息 id，同一个 mini sdp 的分片保持一致，重传时也保持一致
+    uint16_t    total_len;      // 完整 mini sdp 的长度
+    uint16_t    offset;         // 分片负载在完整 mini sdp 中的偏移
+} __attribute__((packed));
+
+constexpr size_t kMiniSdpFragMaxCount = 255;
+
+/**
+ * @brief Fragment Attribute
+ *  分片参数
+ */
+struct MiniSdpFragAttr {
+    uint32_t    msg_id = 0;
+    uint8_t     index = 0;
+    uint8_t     count = 0;
+    uint16_t    total_len = 0;
+    uint16_t    offset = 0;
+
+    // 分片负载，指向输入 buffer
+    const char* payload = nullptr;
+    size_t      payload_len = 0;
+};  // struct MiniSdpFragAttr
+
+/**
+ * @brief Check Fragment Packet
+ *  检查 UDP 包是否为 mini sdp 分片
+ * @param data
+ * @param len
+ * @return true
+ * @return false
+ */
+bool IsMiniSdpFragPack(const char* data, size_t len);
+
+/**
+ * @brief Get Fragment Count
+ *  获取 mini sdp 需要的分片数
+ * @param len size of mini sdp
+ * @param max_frag_size max size of a fragment packet, including MiniSdpFragHdr
+ * @return size_t 0 if it can not be fragmented
+ */
+size_t GetMiniSdpFragCount(size_t len, size_t max_frag_size);
+
+/**
+ * @brief Build Fragment Packet
+ *  构建第 index 个分片
+ * @param buff packet
+ * @param len packet, not less than max_frag_size is always enough
+ * @param data mini sdp
+ * @param data_len mini sdp
+ * @param msg_id
+ * @param index
+ * @param max_frag_size max size of a fragment packet, including MiniSdpFragHdr
+ * @return ssize_t SdpRetCode or size of packet
+ */
+ssize_t BuildMiniSdpFragPacket(char* buff, size_t len, const char* data, size_t data_len,
+                               uint32_t msg_id, uint8_t index, size_t max_frag_size);
+
+/**
+ * @brief Load Fragment Packet
+ *  解析分片，负载不做拷贝
+ * @param buff
+ * @param len
+ * @param attr
+ * @return ssize_t SdpRetCode or size of packet
+ */
+ssize_t LoadMiniSdpFragPacket(const char* buff, size_t len, MiniSdpFragAttr& attr);
+
+/**
+ * @brief Fragment Reassembler
+ *  分片重组表
+ *  - 以 <source, msg_id> 区分消息，source 由调用方给出，如对端 ip:port
+ *  - 内存占用超出上限时淘汰最早的未完成消息
+ *  - 超时未完成的消息在 Feed/Expire 时清理
+ *  - 分片须位于 BuildMiniSdpFragPacket 给出的位置，覆盖完整消息后才算完成
+ *  - 已完成消息的记录同样受内存上限约束，超出时淘汰最早的记录
+ *  - 非线程安全
+ */
+class MiniSdpReassembler {
+  public:
+    enum class FeedResult : int {
+        kIncomplete = 0,    // 等待更多分片
+        kComplete,          // 消息完整，结果写入 out
+        kDuplicate,         // 重复分片，或者已完成消息的分片
+        kDropped,           // 内存不足，无法容纳该消息
+        kWrongFormat        // 格式错误，或与同一消息的其他分片冲突
+    };
+
+    struct Stats {
+        uint64_t completed  = 0;
+        uint64_t duplicates = 0;
+        uint64_t expired    = 0;
+        uint64_t evicted    = 0;
+        uint64_t dropped    = 0;
+        uint64_t errors     = 0;
+    };
+
+    /**
+     * @param max_memory bytes of payload buffers of incomplete messages, also of the records of completed messages
+     * @param timeout_ms an incomplete message expires after timeout_ms since the first fragment
+     */
+    explicit MiniSdpReassembler(size_t max_memory = 1 << 20, uint32_t timeout_ms = 3000);
+
+    /**
+     * @brief Feed a fragment packet
+     *
+     * @param source
+     * @param data fragment packet
+     * @param len fragment packet
+     * @param now_ms monotonic time
+     * @param out complete mini sdp when kComplete
+     * @return FeedResult
+     */
+    FeedResult Feed(uint64_t source, const char* data, size_t len, uint64_t now_ms, std::string& out);
+
+    // remove expired messages
+    void Expire(uint64_t now_ms);
+
+    size_t MemoryUsage() const { return memory_usage_; }
+
+    size_t PendingCount() const { return messages_.size(); }
+
+    const Stats& GetStats() const { return stats_; }
+
+  private:
+    struct MsgKey {
+        uint64_t source;
+        uint32_t msg_id;
+
+        bool operator==(const MsgKey& rhs) const { return source == rhs.source && msg_id == rhs.msg_id; }
+    };
+
+    struct MsgKeyHash {
+        size_t operator()(const MsgKey& key) const { return std::hash<uint64_t>()(key.source * 31 + key.msg_id); }
+    };
+
+    struct Message {
+        MsgKey      key;
+        uint64_t    first_ms;
+        uint8_t     count;
+        uint16_t    total_len;
+        size_t      chunk;      // payload size of every fragment but the last
+        size_t      recv_num = 0;
+        size_t      recv_bytes = 0;
+        uint64_t    recv_bits[4] = {0, 0, 0, 0};
+        std::string data;
+    };
+
+    // a record of completed_order_, generation tells it from a later completion of the same key
+    struct Completed {
+        uint64_t    complete_ms;
+        uint64_t    generation;
+        MsgKey      key;
+    };
+
+    using MessageList = std::list<Message>;
+
+    void removeMessage(MessageList::iterator it);
+
+    void popCompleted();
+
+  private:
+    size_t      max_memory_;
+    uint32_t    timeout_ms_;
+    size_t      memory_usage_ = 0;
+
+    // ordered by first_ms, the front is the oldest
+    MessageList messages_;
+    std::unordered_map<MsgKey, MessageList::iterator, MsgKeyHash> index_;
+
+    // recently completed messages, to tell duplicates from a new message
+    std::unordered_map<MsgKey, uint64_t, MsgKeyHash> completed_;    // <key, generation>
+    std::deque<Completed> completed_order_;
+    uint64_t    completed_generation_ = 0;
+
+    Stats       stats_;
+};  // class MiniSdpReassembler
+
+}  // namespace mini_sdp
+
+#endif  // MINI_SDP_MINI_SDP_FRAG_H_
@@ -8,14 +8,16 @@
  * 
  */
 #include "mini_sdp_impl.h"
+#include <algorithm>
 #include <cstring>
 #include <limits>
+#include "mini_sdp_codec.h"
+#include "sdp_recycler.h"
+#include "stage_stats.h"
 #include "util.h"
 
 namespace mini_sdp {
 
-uint16_t MiniSdpPacker::sdp_seq = 0;
-
 static std::unordered_map<std::string, uint8_t> mini_sdp_codec_name_map = {
     {kSdpCodecOpus, 0},
     {kSdpCodecLatm, 1},
@@ -87,6 +89,133 @@ static std::vector<std::string> mini_sdp_ext_vec = {
     kSdpExtCts2
 };
 
+// fingerprint hash function, index is <hash id> of compact fingerprint
+static std::unordered_map<std::string, uint8_t> mini_sdp_hash_func_map = {
+    {"md5", 0}, {"sha-1", 1}, {"sha-224", 2}, {"sha-256", 3}, {"sha-384", 4}, {"sha-512", 5}
+};
+
+static std::vector<std::pair<std::string, uint8_t>> mini_sdp_hash_func_vec = {
+    {"md5", 16}, {"sha-1", 20}, {"sha-224", 28}, {"sha-256", 32}, {"sha-384", 48}, {"sha-512", 64}
+};
+
+// ssrc-group semantics of track section, others are carried as string
+static std::vector<std::string> mini_sdp_ssrc_group_vec = {
+    "SIM", "FID", "FEC-FR", "FEC", "DUP"
+};
+
+uint32_t GetFormatParamUint(const CodecDescription &codec, const std::string &key) {
+    static const std::string empty;
+    const std::string &value = codec.GetFormatParam(key, empty);
+    uint64_t number = 0;
+    return StrToUint(value.data(), value.size(), std::numeric_limits<uint32_t>::max(), number) ? uint32_t(number) : 0;
+}
+
+bool PackMiniCodecDesc(const CodecDescription &codec, MiniCodecDesc &mini_codec_desc) {
+    auto name_it = mini_sdp_codec_name_map.find(codec.Name);
+    auto freq_it = mini_sdp_frequency_map.find(codec.SampleRate);
+    if (name_it == mini_sdp_codec_name_map.end() || freq_it == mini_sdp_frequency_map.end()) {
+        return false;
+    }
+    mini_codec_desc.mark_a = 0;
+    mini_codec_desc.mark_b = 0;
+    mini_codec_desc.reversed = 0;
+    mini_codec_desc.codec = name_it->second;
+    mini_codec_desc.payload_type = codec.Format;
+    mini_codec_desc.channels = codec.Channels;
+    mini_codec_desc.frequency = freq_it->second;
+    mini_codec_desc.nack = (codec.Feedbacks.count(kSdpCodecNack)) ? 1u : 0u;
+    mini_codec_desc.flex_fec = codec.Name.compare(kSdpCodecFlexFec) == 0 ? 1u: 0u;
+    mini_codec_desc.transport_cc = (codec.Feedbacks.count(kSdpCodecTransportCc)) ? 1u : 0u;
+    mini_codec_desc.goog_remb = (codec.Feedbacks.count(kSdpCodecGoogleRemb)) ? 1u : 0u;
+    mini_codec_desc.bfame_enable = GetFormatParamUint(codec, kSdpCodecBFrameEnabled) ||
+                                   GetFormatParamUint(codec, kSdpCodecBFrameEnabled2) ? 1u : 0u;
+    return true;
+}
+
+void PackMiniAacConfig(const CodecDescription &codec, std::string &dst) {
+    auto config = codec.GetFormatParam("config", "");
+    dst.resize(sizeof(MiniAacConfig) + config.size());
+    MiniAacConfig *aac_config = reinterpret_cast<MiniAacConfig*>(&dst[0]);
+    aac_config->object = GetFormatParamUint(codec, "object");
+    aac_config->flag = 0;
+    aac_config->flag |= GetFormatParamUint(codec, "PS-enabled") ? kMiniAacFlagPs : 0;
+    aac_config->flag |= GetFormatParamUint(codec, "SBR-enabled") ? kMiniAacFlagSbr : 0;
+    aac_config->flag |= GetFormatParamUint(codec, "stereo") ? kMiniAacFlagStereo : 0;
+    aac_config->flag |= GetFormatParamUint(codec, "cpresent") ? kMiniAacFlagCPresent : 0;
+    aac_config->config_len = config.size();
+    if (!config.empty()) {
+        memcpy(aac_config->config_data, config.c_str(), aac_config->config_len);
+        dst.resize(sizeof(MiniAacConfig) + aac_config->config_len);
+    }
+}
+
+static bool isMiniCodecDescSupported(const MiniCodecDesc &codec_desc) {
+    return codec_desc.codec < mini_sdp_codec_name_vec.size() &&
+           codec_desc.frequency < mini_sdp_frequency_vec.size();
+}
+
+static void addFormatParam(CodecDescription &codec, const char *key, const char *value) {
+    AddFormatParam(codec, key, strlen(key), value, strlen(value));
+}
+
+static void loadMiniCodecDesc(const MiniCodecDesc &codec_desc, const MiniAacConfig *aac_config,
+                              SdpMediaType media_type, CodecDescription &code_info) {
+    code_info.Name = mini_sdp_codec_name_vec[codec_desc.codec];
+    code_info.Format = codec_desc.payload_type;
+    code_info.Channels = codec_desc.channels;
+    code_info.SampleRate = mini_sdp_frequency_vec[codec_desc.frequency];
+    if (codec_desc.nack) {
+        AddFeedback(code_info, kSdpCodecNack, sizeof(kSdpCodecNack) - 1);
+    }
+    if (codec_desc.flex_fec) {
+        //code_info.Feedbacks.emplace(kSdpCodecFlexFec);
+    }
+    if (codec_desc.transport_cc) {
+        AddFeedback(code_info, kSdpCodecTransportCc, sizeof(kSdpCodecTransportCc) - 1);
+    }
+    if (codec_desc.goog_remb) {
+        AddFeedback(code_info, kSdpCodecGoogleRemb, sizeof(kSdpCodecGoogleRemb) - 1);
+    }
+    if (codec_desc.bfame_enable) {
+        addFormatParam(code_info, kSdpCodecBFrameEnabled, "1");
+    }
+    if (media_type == SdpMediaType::kVideo) {
+        addFormatParam(code_info, "level-asymmetry-allowed", "1");
+        addFormatParam(code_info, "packetization-mode", "1");
+        addFormatParam(code_info, "profile-level-id", "42e01f");
+    }
+    if (media_type == SdpMediaType::kAudio) {
+        if (aac_config) {
+            if (aac_config->object) addFormatParam(code_info, "object", std::to_string((int)aac_config->object).c_str());
+            addFormatParam(code_info, "PS-enabled", (aac_config->flag & kMiniAacFlagPs) ? "1" : "0");
+            addFormatParam(code_info, "SBR-enabled", (aac_config->flag & kMiniAacFlagSbr) ? "1" : "0");
+            addFormatParam(code_info, "stereo", (aac_config->flag & kMiniAacFlagStereo) ? "1" : "0");
+            addFormatParam(code_info, "cpresent", (aac_config->flag & kMiniAacFlagCPresent) ? "1" : "0");
+            if (aac_config->config_len > 0) {
+                AddFormatParam(code_info, "config", 6, aac_config->config_data, aac_config->config_len);
+            }
+        } else if (!codec_desc.flex_fec){
+            addFormatParam(code_info, "stereo", "1");
+        }
+    }
+}
+
+CodecDescriptionPtr LoadMiniCodecDesc(const MiniCodecDesc &codec_desc, const MiniAacConfig *aac_config,
+                                      SdpMediaType media_type) {
+    if (!isMiniCodecDescSupported(codec_desc)) return nullptr;
+    CodecDescriptionPtr code_info = MakeCodecDescription();
+    loadMiniCodecDesc(codec_desc, aac_config, media_type, *code_info);
+    return code_info;
+}
+
+bool LoadMiniCodecDesc(const MiniCodecDesc &codec_desc, const MiniAacConfig *aac_config, MediaDescription &media) {
+    if (!isMiniCodecDescSupported(codec_desc)) return false;
+    bool added = false;
+    CodecDescriptionPtr code_info = FindOrAddCodec(media, codec_desc.payload_type, &added);
+    if (added) loadMiniCodecDesc(codec_desc, aac_config, media.MediaType, *code_info);
+    return true;
+}
+
 MiniSdp::MiniSdp() {
     mini_sdp_hdr.packet_type = kMiniSdpPacketType;
     memcpy(mini_sdp_hdr.magic_word, kMiniSdpMagic, 3 * sizeof(char));
@@ -136,20 +265,22 @@ void MiniSdp::HdrNtoh() {
 int MiniSdpPacker::PackToDstMem(char *data, size_t len, const std::string &origin_sdp, SdpType sdp_type,
                                 const std::string &stream_url, const std::string &svrsig, uint16_t seq, 
                                 int status_code, bool imm_send, bool is_support_aac_fmtp,
-                                StreamDirection is_push) {
+                                StreamDirection is_push, bool is_compact_fingerprint) {
     MiniSdp mini_sdp;
     uint32_t offset = 0;
 
-    std::string mini_stream_url = std::string(stream_url.begin() + 9, stream_url.end());
-    mini_sdp.stream_url_len = mini_stream_url.size();
-    mini_sdp.stream_url = mini_stream_url.c_str();
+    // without webrtc://
+    mini_sdp.stream_url_len = stream_url.size() - 9;
+    mini_sdp.stream_url = stream_url.c_str() + 9;
 
     // for error code
     if (sdp_type == SdpType::kSdpNone) {
         mini_sdp.mini_sdp_hdr.status_code = status_code;
         mini_sdp.mini_sdp_hdr.seq = seq;
         mini_sdp.HdrHton();
-        if (offset + sizeof(MiniSdpHdr) > len) return offset + sizeof(MiniSdpHdr);
+        // header, four empty strings and the url with their length prefixes (2 + 2 + 4 + 2 + 2), auth
+        size_t mem_len = offset + sizeof(MiniSdpHdr) + mini_sdp.stream_url_len + 12 + 16;
+        if (mem_len > len) return mem_len;
         memcpy(data + offset, &(mini_sdp.mini_sdp_hdr), sizeof(MiniSdpHdr));
         offset += sizeof(MiniSdpHdr);
         std::string empty_str;
@@ -158,20 +289,112 @@ int MiniSdpPacker::PackToDstMem(char *data, size_t len, const std::string &origi
         copyStr32(mini_sdp.stream_url_len, const_cast<char *>(mini_sdp.stream_url), data, offset);
         copyStr16(empty_str.size(), const_cast<char *>(empty_str.c_str()), data, offset);
         copyStr16(empty_str.size(), const_cast<char *>(empty_str.c_str()), data, offset);
-        if (offset + 16 > len) return offset + 16;
         memcpy(data+offset, mini_sdp.auth, 16);
         offset += 16;
         return offset;
     }
 
     SdpParser sdp_parser(origin_sdp.c_str(), origin_sdp.size());
-    if (!sdp_parser.Parse()) {
+    bool parsed = sdp_parser.Parse();
+    parse_error_ = sdp_parser.GetError();
+    if (!parsed) {
         return 0;
     }
 
-    SessionDescriptionPtr sdp_info = sdp_parser.GetSessionDescription();
+    return PackToDstMem(data, len, sdp_parser.GetSessionDescription(), sdp_type, stream_url, svrsig, seq,
+                        status_code, imm_send, is_support_aac_fmtp, is_push, is_compact_fingerprint);
+}
+
+bool MiniSdpPacker::packMedia(MediaDescription &media_info, bool is_support_aac_fmtp, char *data, size_t len,
+                              uint32_t &offset) {
+    MiniMediaHdr mini_media_hdr;
+    mini_media_hdr.media_type = uint8_t(media_info.MediaType);
+    mini_media_hdr.ssrc1 = 0;
+    mini_media_hdr.ssrc2 = 0;
+    int i = 0;
+    for (auto it = media_info.TracksOrder.begin(); it != media_info.TracksOrder.end(); it++) {
+        if (i == 0)
+            mini_media_hdr.ssrc1 = htonl(*it);
+        else if (i == 1)
+            mini_media_hdr.ssrc2 = htonl(*it);
+        else
+            break;
+        i++;
+    }
+    char *media_hdr_pos = data + offset;
+    mini_media_hdr.codec_num = uint8_t(media_info.Codecs.size());
+    offset += sizeof(MiniMediaHdr);
+
+    for (auto it = media_info.Codecs.begin(); it != media_info.Codecs.end(); it++) {
+        if (!mini_sdp_codec_name_map.count(it->second->Name) ||
+            !mini_sdp_frequency_map.count(it->second->SampleRate)) {
+            mini_media_hdr.codec_num--;
+            continue;
+        }
+        MiniCodecDesc mini_codec_desc;
+        PackMiniCodecDesc(*it->second, mini_codec_desc);
+        if (offset + sizeof(MiniCodecDesc) > len) {
+            offset += sizeof(MiniCodecDesc);
+            return false;
+        }
+        memcpy(data + offset, &mini_codec_desc, sizeof(MiniCodecDesc));
+        offset += sizeof(MiniCodecDesc);
+
+        if (is_support_aac_fmtp && (it->second->Name == kSdpCodecLatm || it->second->Name == kSdpCodecAdts)) {
+            std::string aac_config;
+            PackMiniAacConfig(*it->second, aac_config);
+            if (offset + aac_config.size() > len) {
+                offset += aac_config.size();
+                return false;
+            }
+            memcpy(data + offset, aac_config.data(), aac_config.size());
+            offset += aac_config.size();
+        }
+    }
+    if (offset + sizeof(MiniMediaHdr) > len) {
+        offset += sizeof(MiniMediaHdr);
+        return false;
+    }
+    memcpy(media_hdr_pos, &mini_media_hdr, sizeof(MiniMediaHdr));
+
+    uint8_t ext_num = media_info.ExtMap.size();
+    char *ext_pos = data + offset;
+    offset += sizeof(uint8_t);
+    for(auto it = media_info.ExtMap.begin(); it != media_info.ExtMap.end(); it++) {
+        MiniExtDesc mini_ext_desc;
+        Trim(it->second);
+        if (!mini_sdp_ext_map.count(it->second)) {
+            ext_num--;
+            continue;
+        }
+        mini_ext_desc.id = it->first;
+        mini_ext_desc.uri = mini_sdp_ext_map[it->second];
+        if (offset + sizeof(MiniExtDesc) > len) {
+            offset += sizeof(MiniExtDesc);
+            return false;
+        }
+        memcpy(data + offset, &mini_ext_desc, sizeof(MiniExtDesc));
+        offset += sizeof(MiniExtDesc);
+    }
+    if (offset + sizeof(uint8_t) > len) {
+        offset += sizeof(uint8_t);
+        return false;
+    }
+    memcpy(ext_pos, &ext_num, sizeof(uint8_t));
+    return true;
+}
+
+int MiniSdpPacker::PackToDstMem(char *data, size_t len, SessionDescriptionPtr sdp_info, SdpType sdp_type,
+                                const std::string &stream_url, const std::string &svrsig, uint16_t seq,
+                                int status_code, bool imm_send, bool is_support_aac_fmtp,
+                                StreamDirection is_push, bool is_compact_fingerprint) {
+    MiniSdp mini_sdp;
+    uint32_t offset = 0;
+
+    // without webrtc://
+    mini_sdp.stream_url_len = stream_url.size() - 9;
+    mini_sdp.stream_url = stream_url.c_str() + 9;
 
-    mini_sdp.mini_sdp_hdr.version = (sdp_info->Version <= 0) ? 0 : sdp_info->Version;
     mini_sdp.mini_sdp_hdr.ip_type = uint8_t(sdp_info->AddrType);
     mini_sdp.mini_sdp_hdr.status_code = status_code;
     mini_sdp.mini_sdp_hdr.seq = seq;
@@ -180,8 +403,10 @@ int MiniSdpPacker::PackToDstMem(char *data, size_t len, const std::string &origi
     mini_sdp.mini_sdp_hdr.not_support_aac_fmtp = !is_support_aac_fmtp;
     mini_sdp.mini_sdp_hdr.not_seq_align = !(sdp_info->SessionId == "1");
 
-    for (auto media_info_pair : sdp_info->Medias) {
-        auto media_info = media_info_pair.second;
+    bool is_binary_key = false;
+
+    for (const auto &media_info_pair : sdp_info->Medias) {
+        const auto &media_info = media_info_pair.second;
         if (media_info->Protos == kSdpMediaProtoEncryptDefault) {
             mini_sdp.mini_sdp_hdr.encrypt_switch = 1;
         }
@@ -203,7 +428,9 @@ int MiniSdpPacker::PackToDstMem(char *data, size_t len, const std::string &origi
         
         mini_sdp.mini_sdp_hdr.video_audio_data_flag |= mini_sdp_media_type_map[uint8_t(media_info->MediaType)];
 
-        mini_sdp.mini_sdp_hdr.direction = mini_sdp_trans_type_map[uint8_t(media_info->TransType)];
+        if (media_info->TransType != SdpTransType::kTransNone) {
+            mini_sdp.mini_sdp_hdr.direction = mini_sdp_trans_type_map[uint8_t(media_info->TransType)];
+        }
         mini_sdp.mini_sdp_hdr.role =  mini_sdp_role_type_map[uint8_t(media_info->RoleType)];
 
         mini_sdp.ufrag_len = media_info->IceUfrag.size();
@@ -211,8 +438,11 @@ int MiniSdpPacker::PackToDstMem(char *data, size_t len, const std::string &origi
         mini_sdp.pwd_len = media_info->IcePwd.size();
         mini_sdp.pwd = media_info->IcePwd.c_str();
 
-        std::string fingerprint = media_info->Fingerprint.first + " " + media_info->Fingerprint.second;
-        if (fingerprint.size() > 1) encrypt_key = fingerprint;
+        const auto &fingerprint = media_info->Fingerprint;
+        if (!fingerprint.first.empty() || !fingerprint.second.empty()) {
+            is_binary_key = is_compact_fingerprint && PackMiniFingerprint(fingerprint, encrypt_key);
+            if (!is_binary_key) encrypt_key.assign(fingerprint.first).append(" ").append(fingerprint.second);
+        }
     }  // sdp_hdr
     
     mini_sdp.key_len = encrypt_key.size();
@@ -223,97 +453,41 @@ int MiniSdpPacker::PackToDstMem(char *data, size_t len, const std::string &origi
     memcpy(data + offset, &(mini_sdp.mini_sdp_hdr), sizeof(MiniSdpHdr));
     offset += sizeof(MiniSdpHdr);
     
+    // tracks beyond ssrc1/ssrc2, ssrc-group, rid and simulcast
+    std::string track_sections;
+    bool has_track_section = false;
 
-    for (auto media_info_pair : sdp_info->Medias) {
-        auto media_info = media_info_pair.second;
-
-        MiniMediaHdr mini_media_hdr;
-        mini_media_hdr.media_type = uint8_t(media_info->MediaType);
-        mini_media_hdr.ssrc1 = 0;
-        mini_media_hdr.ssrc2 = 0;
-        int i = 0;
-        for (auto it = media_info->TracksOrder.begin(); it != media_info->TracksOrder.end(); it++) {
-            if (i == 0)
-                mini_media_hdr.ssrc1 = htonl(*it);
-            else if (i == 1)
-                mini_media_hdr.ssrc2 = htonl(*it);
-            else
-                break;
-            i++;
-        }
-        char *media_hdr_pos = data + offset;
-        mini_media_hdr.codec_num = uint8_t(media_info->Codecs.size());
-        offset += sizeof(MiniMediaHdr);
+    // the header has one bit for each type, medias of a type after the first go to the extra media section
+    std::vector<MediaDescription*> extra_medias;
+    std::vector<std::string> extra_track_sections;
+    uint8_t packed_types = 0;
 
-        for (auto it = media_info->Codecs.begin(); it != media_info->Codecs.end(); it++) {
-            if (!mini_sdp_codec_name_map.count(it->second->Name) ||
-                !mini_sdp_frequency_map.count(it->second->SampleRate)) {
-                mini_media_hdr.codec_num--;
-                continue;
-            }
-            MiniCodecDesc mini_codec_desc;
-            mini_codec_desc.mark_a = 0;
-            mini_codec_desc.mark_b = 0;
-            mini_codec_desc.reversed = 0;
-            mini_codec_desc.codec = mini_sdp_codec_name_map[it->second->Name];
-            mini_codec_desc.payload_type = it->second->Format;
-            mini_codec_desc.channels = it->second->Channels;
-            mini_codec_desc.frequency = mini_sdp_frequency_map[it->second->SampleRate];
-            mini_codec_desc.nack = (it->second->Feedbacks.count(kSdpCodecNack)) ? 1u : 0u;
-            mini_codec_desc.flex_fec = it->second->Name.compare(kSdpCodecFlexFec) == 0 ? 1u: 0u;
-            mini_codec_desc.transport_cc = (it->second->Feedbacks.count(kSdpCodecTransportCc)) ? 1u : 0u;
-            mini_codec_desc.goog_remb = (it->second->Feedbacks.count(kSdpCodecGoogleRemb)) ? 1u : 0u;
-            mini_codec_desc.bfame_enable = bool(std::stol(it->second->GetFormatParam(kSdpCodecBFrameEnabled, "0"))
-                                            || std::stol(it->second->GetFormatParam(kSdpCodecBFrameEnabled2, "0")));
-            if (offset + sizeof(MiniCodecDesc) > len) return offset + sizeof(MiniCodecDesc);
-            memcpy(data + offset, &mini_codec_desc, sizeof(MiniCodecDesc));
-            offset += sizeof(MiniCodecDesc);
+    for (const auto &media_info_pair : sdp_info->Medias) {
+        StageTimer timer(SdpStage::kPackMedia);
+        const auto &media_info = media_info_pair.second;
 
-            if (is_support_aac_fmtp && (it->second->Name == kSdpCodecLatm || it->second->Name == kSdpCodecAdts)) {
-                auto config = it->second->GetFormatParam("config", "");
-                auto aac_config = std::unique_ptr<MiniAacConfig>((MiniAacConfig*) new char[sizeof(MiniAacConfig) + config.size()]);
-                aac_config->object = std::stoul(it->second->GetFormatParam("object", "0"));
-                aac_config->flag |= std::stoul(it->second->GetFormatParam("PS-enabled", "0")) ? kMiniAacFlagPs : 0;
-                aac_config->flag |= std::stoul(it->second->GetFormatParam("SBR-enabled", "0")) ? kMiniAacFlagSbr : 0;
-                aac_config->flag |= std::stoul(it->second->GetFormatParam("stereo", "0")) ? kMiniAacFlagStereo : 0;
-                aac_config->flag |= std::stoul(it->second->GetFormatParam("cpresent", "0")) ? kMiniAacFlagCPresent : 0;
-                aac_config->config_len = config.size();
-
-                if (offset + sizeof(MiniAacConfig) + config.size() > len) return offset + sizeof(MiniAacConfig) + config.size();
-                memcpy(data + offset, aac_config.get(), sizeof(MiniAacConfig));
-                offset += sizeof(MiniAacConfig);
-                if (!config.empty()) {
-                    memcpy(data + offset, config.c_str(), config.size());
-                    offset += config.size();
-                }
-            }
-        }
-        if (offset + sizeof(MiniMediaHdr) > len) return offset + sizeof(MiniMediaHdr);         
-        memcpy(media_hdr_pos, &mini_media_hdr, sizeof(MiniMediaHdr));
+        std::string track_section;
+        if (PackMiniTrackSection(*media_info, 2, track_section)) has_track_section = true;
 
-        uint8_t ext_num = media_info->ExtMap.size();
-        char *ext_pos = data + offset;
-        offset += sizeof(uint8_t);
-        for(auto it = media_info->ExtMap.begin(); it != media_info->ExtMap.end(); it++) {
-            MiniExtDesc mini_ext_desc;
-            Trim(it->second);
-            if (!mini_sdp_ext_map.count(it->second)) {
-                ext_num--;
-                continue;
-            }
-            mini_ext_desc.id = it->first;
-            mini_ext_desc.uri = mini_sdp_ext_map[it->second];
-            if (offset + sizeof(MiniExtDesc) > len) return offset + sizeof(MiniExtDesc);         
-            memcpy(data + offset, &mini_ext_desc, sizeof(MiniExtDesc));
-            offset += sizeof(MiniExtDesc);
+        uint8_t type_flag = mini_sdp_media_type_map[uint8_t(media_info->MediaType)];
+        if (packed_types & type_flag) {
+            extra_medias.push_back(media_info.get());
+            extra_track_sections.push_back(std::move(track_section));
+            continue;
         }
-        if (offset + sizeof(uint8_t) > len) return offset + sizeof(uint8_t);         
-        memcpy(ext_pos, &ext_num, sizeof(uint8_t));
-
+        packed_types |= type_flag;
+        if (!packMedia(*media_info, is_support_aac_fmtp, data, len, offset)) return offset;
+        track_sections += track_section;
     }  // media descs
+    if (!has_track_section) track_sections.clear();
+    if (extra_medias.size() > std::numeric_limits<uint8_t>::max()) return 0;
 
-    size_t mem_len = offset + mini_sdp.ufrag_len + mini_sdp.pwd_len + mini_sdp.stream_url_len + mini_sdp.key_len + 16 + 1;
-    if (mem_len > len) return mem_len;         
+    bool has_extern_byte = is_push == kStreamPull || is_push == kStreamPush || is_binary_key || has_track_section ||
+                           !extra_medias.empty();
+    // the strings with their length prefixes (2 + 2 + 4 + 2 + 2), auth, extern byte and track sections
+    size_t mem_len = offset + mini_sdp.ufrag_len + mini_sdp.pwd_len + mini_sdp.stream_url_len + mini_sdp.key_len +
+                     svrsig.size() + 12 + 16 + (has_extern_byte ? 1 + track_sections.size() : 0);
+    if (mem_len > len) return mem_len;
     copyStr16(mini_sdp.ufrag_len, const_cast<char *>(mini_sdp.ufrag), data, offset);
     copyStr16(mini_sdp.pwd_len, const_cast<char *>(mini_sdp.pwd), data, offset);
     copyStr32(mini_sdp.stream_url_len, const_cast<char *>(mini_sdp.stream_url), data, offset);
@@ -322,16 +496,210 @@ int MiniSdpPacker::PackToDstMem(char *data, size_t len, const std::string &origi
     memcpy(data+offset, mini_sdp.auth, 16);
     offset += 16;
 
-    if (is_push == kStreamPull || is_push == kStreamPush) {
+    if (has_extern_byte) {
         uint8_t extern_byte = 0;
-        extern_byte |= (is_push ? 1u : 0u) << 0u;
+        if (is_push == kStreamPush) {
+            extern_byte |= kMiniExternFlagPush;
+        } else if (is_push == kStreamDefault) {
+            extern_byte |= kMiniExternFlagNoDirection;
+        }
+        if (is_binary_key) extern_byte |= kMiniExternFlagBinaryKey;
+        if (has_track_section) extern_byte |= kMiniExternFlagTracks;
+        if (!extra_medias.empty()) extern_byte |= kMiniExternFlagMedias;
         memcpy(data+offset, &extern_byte, 1);
         offset += 1;
+        memcpy(data + offset, track_sections.data(), track_sections.size());
+        offset += track_sections.size();
+    }
+
+    if (!extra_medias.empty()) {
+        if (offset + sizeof(uint8_t) > len) return offset + sizeof(uint8_t);
+        data[offset++] = char(extra_medias.size());
+        for (size_t i = 0; i < extra_medias.size(); i++) {
+            StageTimer timer(SdpStage::kPackMedia);
+            if (!packMedia(*extra_medias[i], is_support_aac_fmtp, data, len, offset)) return offset;
+            if (!has_track_section) continue;
+            const std::string &track_section = extra_track_sections[i];
+            if (offset + track_section.size() > len) return offset + track_section.size();
+            memcpy(data + offset, track_section.data(), track_section.size());
+            offset += track_section.size();
+        }
     }
 
     return offset;
 }
 
+// codecs with the same key are the same in mini sdp except payload type
+static std::string miniCodecKey(const CodecDescriptionPtr &codec) {
+    std::string key = codec->Name + "/" + std::to_string(codec->SampleRate) + "/" + std::to_string(codec->Channels);
+    key += codec->Feedbacks.count(kSdpCodecNack) ? "/1" : "/0";
+    key += codec->Feedbacks.count(kSdpCodecTransportCc) ? "1" : "0";
+    key += codec->Feedbacks.count(kSdpCodecGoogleRemb) ? "1" : "0";
+    key += (codec->GetFormatParam(kSdpCodecBFrameEnabled, "0") != "0" ||
+            codec->GetFormatParam(kSdpCodecBFrameEnabled2, "0") != "0") ? "1" : "0";
+    return key;
+}
+
+int MiniSdpPacker::PackToDstMem(char *data, size_t len, const OriginSdpAttr &attr, const PackBudget &budget,
+                                PackDegradeReport *report, const MiniSdpCodec &codec) {
+    SdpParser sdp_parser(attr.origin_sdp.c_str(), attr.origin_sdp.size());
+    bool parsed = sdp_parser.Parse();
+    parse_error_ = sdp_parser.GetError();
+    if (!parsed) {
+        return 0;
+    }
+    SessionDescriptionPtr sdp_info = sdp_parser.GetSessionDescription();
+
+    auto pack = [&](char *buff, size_t buff_len) {
+        return codec.Pack(attr, sdp_info, buff, buff_len);
+    };
+
+    int pack_size = pack(data, len);
+    if (report) {
+        report->full_size = pack_size;
+        report->packed_size = pack_size;
+        report->dropped.clear();
+    }
+    if (pack_size == 0 || (size_t)pack_size <= len) return pack_size;
+
+    // the exact size, a packer stops at the first field exceeding the buffer
+    std::vector<char> scratch(len);
+    while ((size_t)pack_size > scratch.size()) {
+        scratch.resize(pack_size * 2);
+        pack_size = pack(scratch.data(), scratch.size());
+    }
+    if (report) report->full_size = pack_size;
+
+    size_t size = pack_size;
+    std::vector<DropCandidate> candidates;
+    for (auto step : budget.order) {
+        if (size <= len) break;
+        candidates.clear();
+        collectDropCandidates(step, sdp_info, budget, attr.is_support_aac_fmtp, codec, candidates);
+        for (auto it = candidates.rbegin(); it != candidates.rend() && size > len; it++) {
+            if (it->cost == 0) continue;
+            dropCandidate(step, *it);
+            size -= it->cost;
+            if (report) {
+                report->dropped.push_back(PackDropRecord{step, it->media->MediaType, it->value, it->cost});
+            }
+        }
+    }
+    if (size > len) return size;
+
+    pack_size = pack(data, len);
+    if (report) report->packed_size = pack_size;
+    return pack_size;
+}
+
+void MiniSdpPacker::collectDropCandidates(PackDropStep step, SessionDescriptionPtr sdp_info, const PackBudget &budget,
+                                          bool is_support_aac_fmtp, const MiniSdpCodec &codec,
+                                          std::vector<DropCandidate> &candidates) {
+    for (auto &media_pair : sdp_info->Medias) {
+        auto &media = media_pair.second;
+        switch (step) {
+        case kPackDropRedundantProfile: {
+            if (media->MediaType != SdpMediaType::kVideo) break;
+            std::set<std::string> kept;
+            for (auto &codec_pair : media->Codecs) {
+                size_t cost = codec.CodecSize(*codec_pair.second, is_support_aac_fmtp);
+                if (cost > 0 && !kept.insert(miniCodecKey(codec_pair.second)).second) {
+                    candidates.push_back(DropCandidate{media, codec_pair.first, cost});
+                }
+            }
+            break;
+        }
+        case kPackDropUnusedExtension:
+            for (auto &ext : media->ExtMap) {
+                Trim(ext.second);
+                size_t cost = codec.ExtSize(ext.second);
+                if (cost > 0 &&
+                    std::find(budget.keep_extensions.begin(), budget.keep_extensions.end(), ext.second) ==
+                        budget.keep_extensions.end()) {
+                    candidates.push_back(DropCandidate{media, ext.first, cost});
+                }
+            }
+            break;
+        case kPackDropAacConfig:
+            if (!is_support_aac_fmtp) break;
+            for (auto &codec_pair : media->Codecs) {
+                auto &codec_info = *codec_pair.second;
+                if (codec_info.Name != kSdpCodecLatm && codec_info.Name != kSdpCodecAdts) continue;
+                if (codec_info.GetFormatParam("config", "").empty()) continue;
+                size_t size = codec.CodecSize(codec_info, is_support_aac_fmtp);
+                CodecDescription without_config = codec_info;
+                without_config.FormatParams.erase("config");
+                size_t cost = size - codec.CodecSize(without_config, is_support_aac_fmtp);
+                if (size > 0 && cost > 0) {
+                    candidates.push_back(DropCandidate{media, codec_pair.first, cost});
+                }
+            }
+            break;
+        case kPackDropSecondSsrc:
+            for (size_t idx = 1; idx < media->TracksOrder.size(); idx++) {
+                candidates.push_back(DropCandidate{media, media->TracksOrder[idx], codec.TrackSize(idx)});
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void MiniSdpPacker::dropCandidate(PackDropStep step, const DropCandidate &candidate) {
+    auto &media = candidate.media;
+    switch (step) {
+    case kPackDropRedundantProfile:
+        media->Codecs.erase(candidate.value);
+        break;
+    case kPackDropUnusedExtension:
+        media->ExtMap.erase(candidate.value);
+        break;
+    case kPackDropAacConfig:
+        media->Codecs[candidate.value]->FormatParams.erase("config");
+        break;
+    case kPackDropSecondSsrc:
+        media->Tracks.erase(candidate.value);
+        media->TracksOrder.erase(std::find(media->TracksOrder.begin(), media->TracksOrder.end(), candidate.value));
+        // a group left with one member groups nothing
+        for (auto it = media->SsrcGroups.begin(); it != media->SsrcGroups.end();) {
+            auto &ssrcs = it->Ssrcs;
+            ssrcs.erase(std::remove(ssrcs.begin(), ssrcs.end(), candidate.value), ssrcs.end());
+            it = ssrcs.size() < 2 ? media->SsrcGroups.erase(it) : it + 1;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+bool PackMiniExtUri(const std::string &uri, uint8_t &mini_uri) {
+    auto it = mini_sdp_ext_map.find(uri);
+    if (it == mini_sdp_ext_map.end()) return false;
+    mini_uri = it->second;
+    return true;
+}
+
+bool LoadMiniExtUri(uint8_t mini_uri, std::string &uri) {
+    if (mini_uri >= mini_sdp_ext_vec.size()) return false;
+    uri = mini_sdp_ext_vec[mini_uri];
+    return true;
+}
+
+bool PackMiniFingerprint(const std::pair<std::string, std::string>& fingerprint, std::string& dst) {
+    auto it = mini_sdp_hash_func_map.find(fingerprint.first);
+    if (it == mini_sdp_hash_func_map.end()) return false;
+
+    uint8_t digest[kMiniFingerprintMaxLen];
+    ssize_t digest_len = HexColonDecode(fingerprint.second.c_str(), fingerprint.second.size(), digest, sizeof(digest));
+    if (digest_len != mini_sdp_hash_func_vec[it->second].second) return false;
+
+    dst.resize(1 + digest_len);
+    dst[0] = (char)it->second;
+    memcpy(&dst[1], digest, digest_len);
+    return true;
+}
+
 void MiniSdpPacker::copyStr16(uint16_t len, char *str, char *data, uint32_t &offset) {
     uint16_t nlen = htons(len);
     memcpy(data + offset, &(nlen), sizeof(uint16_t));
@@ -348,12 +716,33 @@ void MiniSdpPacker::copyStr32(uint32_t len, char *str, char *data, uint32_t &off
     offset += len;
 }
 
+// track section of a loaded media, ssrcs and codec_name are scratch
+static bool loadTrackSection(BufferReader &reader, std::vector<uint32_t> &ssrcs, std::string &codec_name,
+                             MediaDescription &media) {
+    ssrcs = media.TracksOrder;
+    if (!LoadMiniTrackSection(reader, ssrcs, media)) return false;
+    codec_name.clear();
+    if (!media.TracksOrder.empty()) codec_name = media.Tracks[media.TracksOrder[0]]->GetAttribute("label");
+    for (size_t i = media.TracksOrder.size(); i < ssrcs.size(); i++) {
+        if (ssrcs[i] == 0) continue;
+        bool added = false;
+        TrackDescriptionPtr track_info = FindOrAddTrack(media, ssrcs[i], &added);
+        if (!added) continue;
+        SetAttribute(*track_info, "label", codec_name);
+        media.TracksOrder.push_back(ssrcs[i]);
+    }
+    return true;
+}
+
 int MiniSdpLoader::ParseToString(char *data, uint32_t data_len, uint16_t &seq, SdpType &sdp_type, 
                                  std::string &dst_sdp, std::string &dst_stream_url, std::string &svrsig, 
                                  int &status_code, bool &imm_send, bool &is_support_aac_fmtp,
-                                 StreamDirection &is_push) {
+                                 StreamDirection &is_push, bool &is_compact_fingerprint) {
+    if (data_len < sizeof(MiniSdpHdr)) {
+        return 0;
+    }
     uint32_t offset = 0;
-    SessionDescriptionPtr sdp_info = MakeSessionDescription();
+    SessionDescriptionPtr sdp_info = BeginSessionDescription();
 
     MiniSdp mini_sdp;
     MiniSdpHdr *mini_sdp_hdr = reinterpret_cast<MiniSdpHdr*>(data + offset);
@@ -362,7 +751,8 @@ int MiniSdpLoader::ParseToString(char *data, uint32_t data_len, uint16_t &seq, S
     mini_sdp.mini_sdp_hdr = *mini_sdp_hdr;
     sdp_type = (SdpType)mini_sdp_hdr->sdp_type;
     
-    sdp_info->Version = mini_sdp_hdr->version;
+    // version of mini sdp, not of sdp
+    sdp_info->Version = 0;
     addr_type = SdpAddrType(mini_sdp_hdr->ip_type);
     sdp_info->AddrType = addr_type;
     if (mini_sdp_hdr->direction >= mini_sdp_trans_type_vec.size()) {
@@ -385,58 +775,106 @@ int MiniSdpLoader::ParseToString(char *data, uint32_t data_len, uint16_t &seq, S
     ip_addr = (sdp_info->AddrType == SdpAddrType::kIPv4)
                   ? ip2strv4((mini_sdp_hdr->canditate_ip[0]))
                   : ip2strv6(reinterpret_cast<unsigned char *>(ipv6));
-    std::vector<MediaDescriptionPtr> medias;
-    if (mini_sdp.containVideo()) {
-        medias.push_back(parseMedia(data, offset, mini_sdp_hdr));
-    }
-    if (mini_sdp.containAudio()) {
-        medias.push_back(parseMedia(data, offset, mini_sdp_hdr));
-    }
-    if (mini_sdp.containData()) {
-        medias.push_back(parseMedia(data, offset, mini_sdp_hdr));
+    MediaDescriptionPtr medias[3];
+    size_t media_num = 0;
+    std::vector<MediaDescriptionPtr> extra_medias;  // kMiniExternFlagMedias
+    // parseMedia reads without checks, the bounds of each media are checked first
+    BufferReader fixed_reader(data, data_len);
+    fixed_reader.Get(offset);
+    bool contains[3] = {mini_sdp.containVideo(), mini_sdp.containAudio(), mini_sdp.containData()};
+    for (bool contain : contains) {
+        if (!contain) continue;
+        if (!PeekMiniMedia(fixed_reader, !mini_sdp_hdr->not_support_aac_fmtp, nullptr)) return 0;
+        medias[media_num++] = parseMedia(data, offset, mini_sdp_hdr);
     }
 
     std::string ice_ufrag;
     std::string ice_pwd;    
     std::string stream_url;    
     std::string encrypt_key;
-    readStr16(ice_ufrag, data, offset);
-    readStr16(ice_pwd, data, offset);
-    readStr32(stream_url, data, offset);
-    readStr16(encrypt_key, data, offset);
-    readStr16(svrsig, data, offset);
+    fixed_reader.GetStr(ice_ufrag, fixed_reader.GetU16());
+    fixed_reader.GetStr(ice_pwd, fixed_reader.GetU16());
+    fixed_reader.GetStr(stream_url, fixed_reader.GetU32());
+    fixed_reader.GetStr(encrypt_key, fixed_reader.GetU16());
+    fixed_reader.GetStr(svrsig, fixed_reader.GetU16());
     //auth
-    offset += 16;
+    fixed_reader.Get(kMiniSdpAuthLength);
+    if (fixed_reader.Failed()) {
+        return 0;
+    }
+    offset = fixed_reader.Offset();
 
     is_push = kStreamDefault;
+    is_compact_fingerprint = false;
     if (offset < data_len) {
         uint8_t extern_byte = 0;
         extern_byte = *reinterpret_cast<uint8_t*>(data + offset);
         offset += 1;
-        if (extern_byte & 1u) {
+        if (extern_byte & kMiniExternFlagPush) {
             is_push = kStreamPush;
-        } else {
+        } else if (!(extern_byte & kMiniExternFlagNoDirection)) {
             is_push = kStreamPull;
         }
+        if (extern_byte & kMiniExternFlagBinaryKey) {
+            std::string binary_key;
+            binary_key.swap(encrypt_key);
+            if (!LoadMiniFingerprint(binary_key, encrypt_key)) return 0;
+            is_compact_fingerprint = true;
+        }
+        BufferReader reader(data + offset, data_len - offset);
+        std::vector<uint32_t> ssrcs;
+        std::string codec_name;
+        if (extern_byte & kMiniExternFlagTracks) {
+            for (size_t m = 0; m < media_num; m++) {
+                if (!loadTrackSection(reader, ssrcs, codec_name, *medias[m])) return 0;
+            }
+        }
+        if (extern_byte & kMiniExternFlagMedias) {
+            uint8_t extra_num = reader.GetU8();
+            for (uint8_t i = 0; i < extra_num; i++) {
+                // parseMedia reads without checks, the bounds are checked first
+                uint32_t media_offset = offset + reader.Offset();
+                if (!PeekMiniMedia(reader, !mini_sdp_hdr->not_support_aac_fmtp, nullptr)) return 0;
+                extra_medias.push_back(parseMedia(data, media_offset, mini_sdp_hdr));
+                if ((extern_byte & kMiniExternFlagTracks) &&
+                    !loadTrackSection(reader, ssrcs, codec_name, *extra_medias.back())) {
+                    return 0;
+                }
+            }
+            if (reader.Failed()) return 0;
+        }
+        offset += reader.Offset();
     }
 
 
     uint32_t cur_media_id = 0;
-    for (auto media: medias) {
-        media->Protos = (mini_sdp_hdr->encrypt_switch ? kSdpMediaProtoEncryptDefault : kSdpMediaProtoNotEncryptDefault);
+    std::string value;
+    for (size_t m = 0; m < media_num + extra_medias.size(); m++) {
+        MediaDescriptionPtr &media = m < media_num ? medias[m] : extra_medias[m - media_num];
+        if (media->MediaType == SdpMediaType::kData) {
+            media->Protos = kSdpMediaProtoDataChannel;
+            media->MediaName = kSdpMediaNameDataChannel;
+        } else {
+            media->Protos = (mini_sdp_hdr->encrypt_switch ? kSdpMediaProtoEncryptDefault
+                                                          : kSdpMediaProtoNotEncryptDefault);
+        }
         media->IceUfrag = ice_ufrag;
         media->IcePwd = ice_pwd;
         media->RoleType = sdp_info->RoleType;
-        for (auto track: media->Tracks) {
-            track.second->SetAttribute("cname", media->IceUfrag);
-            std::string codec_name = track.second->GetAttribute("label");
+        for (auto &track: media->Tracks) {
+            TrackDescription &track_info = *track.second;
+            SetAttribute(track_info, "cname", media->IceUfrag);
+            const std::string &codec_name = track_info.GetAttribute("label");
             if (!codec_name.empty()) {
-                track.second->SetAttribute("msid", media->IceUfrag + " " + media->IceUfrag + "_" + codec_name);
-                track.second->SetAttribute("mslabel", media->IceUfrag);
-                track.second->SetAttribute("label", media->IceUfrag + "_" + codec_name);
+                // label is set last, codec_name refers to it
+                value.assign(media->IceUfrag).append(" ").append(media->IceUfrag).append("_").append(codec_name);
+                SetAttribute(track_info, "msid", value);
+                SetAttribute(track_info, "mslabel", media->IceUfrag);
+                value.assign(media->IceUfrag).append("_").append(codec_name);
+                SetAttribute(track_info, "label", value);
             }
         }
-        std::string mid = media->MediaId;
+        std::string &mid = media->MediaId;
         if (mid.empty()) {
             if (mini_sdp_hdr->is_string_bundle) {
                 if (media->MediaType == SdpMediaType::kVideo) {
@@ -450,35 +888,321 @@ int MiniSdpLoader::ParseToString(char *data, uint32_t data_len, uint16_t &seq, S
                 mid = std::to_string(cur_media_id++);
             }
         } 
-        media->MediaId = mid;
+        // medias of a type after the first take the next free number
+        while (!AddMedia(*sdp_info, mid, media)) {
+            mid = std::to_string(cur_media_id++);
+        }
         sdp_info->GroupBundle.push_back(mid);
-        sdp_info->Medias.emplace(mid, media);
 
         auto pos = encrypt_key.find(' ');
         if (pos != std::string::npos) {
-            media->Fingerprint.first = encrypt_key.substr(0, pos);
-            media->Fingerprint.second = encrypt_key.substr(pos + 1);
+            media->Fingerprint.first.assign(encrypt_key, 0, pos);
+            media->Fingerprint.second.assign(encrypt_key, pos + 1, std::string::npos);
         }
     }
+    EndSessionDescription(*sdp_info);
     //TODO auth    
-    dst_stream_url = kMiniSdpUrlPrefix + stream_url;
-    dst_sdp = sdp_info->ToString();
+    dst_stream_url.assign(kMiniSdpUrlPrefix).append(stream_url);
+    RenderSessionDescription(*sdp_info, dst_sdp);
     seq = ntohs(mini_sdp_hdr->seq);
     status_code = ntohs(mini_sdp_hdr->status_code);
     imm_send = !mini_sdp_hdr->not_imm_send;
     is_support_aac_fmtp = !mini_sdp_hdr->not_support_aac_fmtp;
-    svrsig = ip_addr + ":" + ice_ufrag + ":" + svrsig; 
+    // <ip>:<ice_ufrag>:<svrsig>
+    svrsig.insert(0, ip_addr.size() + ice_ufrag.size() + 2, ':');
+    svrsig.replace(0, ip_addr.size(), ip_addr);
+    svrsig.replace(ip_addr.size() + 1, ice_ufrag.size(), ice_ufrag);
     return offset;
 }
 
+bool LoadMiniFingerprint(const std::string& src, std::string& dst) {
+    if (src.empty() || (uint8_t)src[0] >= mini_sdp_hash_func_vec.size()) return false;
+    auto& hash_func = mini_sdp_hash_func_vec[(uint8_t)src[0]];
+    if (src.size() != 1u + hash_func.second) return false;
+
+    char hex[kMiniFingerprintMaxLen * 3];
+    size_t hex_len = HexColonEncode(reinterpret_cast<const uint8_t*>(src.data() + 1), hash_func.second, hex);
+    dst.reserve(hash_func.first.size() + 1 + hex_len);
+    dst.assign(hash_func.first);
+    dst.push_back(' ');
+    dst.append(hex, hex_len);
+    return true;
+}
+
+// a=simulcast generated from a=rid in order
+static std::string simulcastByRids(const std::vector<RidDescription> &rids) {
+    std::string send, recv;
+    for (auto &rid : rids) {
+        std::string &dst = rid.Direction == "recv" ? recv : send;
+        if (!dst.empty()) dst.push_back(';');
+        dst += rid.Id;
+    }
+    std::string simulcast;
+    if (!send.empty()) simulcast = "send " + send;
+    if (!recv.empty()) simulcast += (simulcast.empty() ? "recv " : " recv ") + recv;
+    return simulcast;
+}
+
+// the ssrc-group MediaDescription::ToString generates without SsrcGroups
+static bool isImplicitSsrcGroups(const MediaDescription &media) {
+    if (media.SsrcGroups.empty()) return true;
+    if (media.SsrcGroups.size() != 1 || media.Tracks.size() < 2) return false;
+    auto &group = media.SsrcGroups[0];
+    if (group.Semantics != "FEC-FR" || group.Ssrcs != media.TracksOrder) return false;
+    for (auto &codec_pair : media.Codecs) {
+        if (codec_pair.second->Name == kSdpCodecFlexFec) return true;
+    }
+    return false;
+}
+
+static void putVarStr(BufferWriter &writer, const std::string &str) {
+    writer.PutVarint(str.size());
+    writer.Put(str.data(), str.size());
+}
+
+static void getVarStr(BufferReader &reader, std::string &dst) {
+    uint32_t len = reader.GetVarint();
+    reader.GetStr(dst, len);
+}
+
+static uint8_t writeTrackSection(BufferWriter &writer, const MediaDescription &media, size_t first_track) {
+    auto &ssrcs = media.TracksOrder;
+    // members not in the tracks are dropped, so are the groups without members
+    std::vector<std::pair<const SsrcGroup*, std::vector<uint32_t>>> groups;
+    if (!isImplicitSsrcGroups(media)) {
+        for (auto &group : media.SsrcGroups) {
+            std::vector<uint32_t> members;
+            members.reserve(group.Ssrcs.size());
+            for (auto ssrc : group.Ssrcs) {
+                auto it = std::find(ssrcs.begin(), ssrcs.end(), ssrc);
+                if (it != ssrcs.end()) members.push_back(it - ssrcs.begin());
+            }
+            if (!members.empty()) groups.emplace_back(&group, std::move(members));
+        }
+    }
+
+    uint8_t flags = 0;
+    if (ssrcs.size() > first_track) flags |= kMiniTrackFlagSsrcs;
+    if (!groups.empty()) flags |= kMiniTrackFlagGroups;
+    if (!media.Rids.empty()) flags |= kMiniTrackFlagRids;
+    if (!media.Simulcast.empty()) {
+        flags |= media.Simulcast == simulcastByRids(media.Rids) ? kMiniTrackFlagSimulcastByRids
+                                                                : kMiniTrackFlagSimulcast;
+    }
+    writer.PutU8(flags);
+
+    if (flags & kMiniTrackFlagSsrcs) {
+        writer.PutVarint(ssrcs.size() - first_track);
+        for (size_t i = first_track; i < ssrcs.size(); i++) writer.PutU32(ssrcs[i]);
+    }
+    if (flags & kMiniTrackFlagGroups) {
+        writer.PutVarint(groups.size());
+        for (auto &group : groups) {
+            auto it = std::find(mini_sdp_ssrc_group_vec.begin(), mini_sdp_ssrc_group_vec.end(),
+                                group.first->Semantics);
+            if (it != mini_sdp_ssrc_group_vec.end()) {
+                writer.PutU8(it - mini_sdp_ssrc_group_vec.begin());
+            } else {
+                writer.PutU8(kMiniSsrcGroupCustom);
+                putVarStr(writer, group.first->Semantics);
+            }
+            writer.PutVarint(group.second.size());
+            for (auto idx : group.second) writer.PutVarint(idx);
+        }
+    }
+    if (flags & kMiniTrackFlagRids) {
+        writer.PutVarint(media.Rids.size());
+        for (auto &rid : media.Rids) {
+            uint8_t rid_flag = 0;
+            if (rid.Direction == "recv") rid_flag |= kMiniRidFlagRecv;
+            if (!rid.Params.empty()) rid_flag |= kMiniRidFlagParams;
+            writer.PutU8(rid_flag);
+            putVarStr(writer, rid.Id);
+            if (rid_flag & kMiniRidFlagParams) putVarStr(writer, rid.Params);
+        }
+    }
+    if (flags & kMiniTrackFlagSimulcast) putVarStr(writer, media.Simulcast);
+    return flags;
+}
+
+bool PackMiniTrackSection(const MediaDescription &media, size_t first_track, std::string &dst) {
+    // the size is known after writing, write twice
+    BufferWriter counter(nullptr, 0);
+    uint8_t flags = writeTrackSection(counter, media, first_track);
+    dst.resize(counter.Offset());
+    BufferWriter writer(&dst[0], dst.size());
+    writeTrackSection(writer, media, first_track);
+    return flags != 0;
+}
+
+bool LoadMiniTrackSection(BufferReader &reader, std::vector<uint32_t> &ssrcs, MediaDescription &media) {
+    uint8_t flags = reader.GetU8();
+    // every count is checked against the remaining bytes, an item takes at least one byte
+    if (flags & kMiniTrackFlagSsrcs) {
+        uint32_t ssrc_num = reader.GetVarint();
+        if (ssrc_num > reader.Remaining() / sizeof(uint32_t)) return false;
+        for (uint32_t i = 0; i < ssrc_num; i++) ssrcs.push_back(reader.GetU32());
+    }
+    if (flags & kMiniTrackFlagGroups) {
+        uint32_t group_num = reader.GetVarint();
+        if (group_num > reader.Remaining()) return false;
+        for (uint32_t i = 0; i < group_num && !reader.Failed(); i++) {
+            SsrcGroup group;
+            uint8_t semantics = reader.GetU8();
+            if (semantics == kMiniSsrcGroupCustom) {
+                getVarStr(reader, group.Semantics);
+            } else if (semantics < mini_sdp_ssrc_group_vec.size()) {
+                group.Semantics = mini_sdp_ssrc_group_vec[semantics];
+            } else {
+                return false;
+            }
+            uint32_t member_num = reader.GetVarint();
+            if (member_num > reader.Remaining()) return false;
+            group.Ssrcs.reserve(member_num);
+            for (uint32_t j = 0; j < member_num; j++) {
+                uint32_t idx = reader.GetVarint();
+                if (idx >= ssrcs.size()) return false;
+                group.Ssrcs.push_back(ssrcs[idx]);
+            }
+            media.SsrcGroups.push_back(std::move(group));
+        }
+    }
+    if (flags & kMiniTrackFlagRids) {
+        uint32_t rid_num = reader.GetVarint();
+        if (rid_num > reader.Remaining()) return false;
+        for (uint32_t i = 0; i < rid_num && !reader.Failed(); i++) {
+            RidDescription rid;
+            uint8_t rid_flag = reader.GetU8();
+            rid.Direction = (rid_flag & kMiniRidFlagRecv) ? "recv" : "send";
+            getVarStr(reader, rid.Id);
+            if (rid_flag & kMiniRidFlagParams) getVarStr(reader, rid.Params);
+            media.Rids.push_back(std::move(rid));
+        }
+    }
+    if (flags & kMiniTrackFlagSimulcastByRids) {
+        media.Simulcast = simulcastByRids(media.Rids);
+    } else if (flags & kMiniTrackFlagSimulcast) {
+        getVarStr(reader, media.Simulcast);
+    }
+    return !reader.Failed();
+}
+
+void AppendDispatchSsrcs(const std::vector<uint32_t> &ssrcs, size_t first, std::vector<uint32_t> &dst) {
+    for (size_t i = first; i < ssrcs.size(); i++) {
+        if (ssrcs[i] == 0 || std::find(dst.begin(), dst.end(), ssrcs[i]) != dst.end()) continue;
+        dst.push_back(ssrcs[i]);
+    }
+}
+
+bool PeekMiniMedia(BufferReader &reader, bool is_support_aac_fmtp, MiniSdpDispatchInfo::Media *media) {
+    const MiniMediaHdr *media_hdr = reinterpret_cast<const MiniMediaHdr*>(reader.Get(sizeof(MiniMediaHdr)));
+    if (!media_hdr) return false;
+    if (media) media->media_type = SdpMediaType(media_hdr->media_type);
+    for (int i = 0; i < media_hdr->codec_num; i++) {
+        const MiniCodecDesc *codec_desc = reinterpret_cast<const MiniCodecDesc*>(reader.Get(sizeof(MiniCodecDesc)));
+        if (!codec_desc) return false;
+        if (is_support_aac_fmtp && (codec_desc->codec == 1 || codec_desc->codec == 2)) {
+            const MiniAacConfig *aac_config = reinterpret_cast<const MiniAacConfig*>(reader.Get(sizeof(MiniAacConfig)));
+            if (!aac_config || !reader.Get(aac_config->config_len)) return false;
+        }
+        if (media && codec_desc->codec < mini_sdp_codec_name_vec.size() &&
+            codec_desc->frequency < mini_sdp_frequency_vec.size()) {
+            media->payload_types.push_back(codec_desc->payload_type);
+        }
+    }
+    uint8_t ext_num = reader.GetU8();
+    if (!reader.Get(ext_num * sizeof(MiniExtDesc))) return false;
+    if (!media) return true;
+    if (media_hdr->ssrc1) media->ssrcs.push_back(ntohl(media_hdr->ssrc1));
+    if (media_hdr->ssrc2) media->ssrcs.push_back(ntohl(media_hdr->ssrc2));
+    return true;
+}
+
+int MiniSdpLoader::Peek(const char *data, size_t data_len, MiniSdpDispatchInfo &info) {
+    BufferReader reader(data, data_len);
+    const MiniSdpHdr *hdr = reinterpret_cast<const MiniSdpHdr*>(reader.Get(sizeof(MiniSdpHdr)));
+    if (!hdr || hdr->packet_type != kMiniSdpPacketType || memcmp(hdr->magic_word, kMiniSdpMagic, 3) != 0 ||
+        hdr->version != 0 || hdr->sdp_type > uint8_t(SdpType::kSdpNone)) {
+        return 0;
+    }
+
+    // video, audio, data, the same order as ParseToString
+    info.medias.clear();
+    for (uint8_t flag = 4; flag; flag >>= 1) {
+        if (!(hdr->video_audio_data_flag & flag)) continue;
+        info.medias.emplace_back();
+        if (!PeekMiniMedia(reader, !hdr->not_support_aac_fmtp, &info.medias.back())) return 0;
+    }
+
+    reader.Get(reader.GetU16());    // ice_ufrag
+    reader.Get(reader.GetU16());    // ice_pwd
+    uint32_t stream_url_len = reader.GetU32();
+    const char *stream_url = reader.Get(stream_url_len);
+    uint16_t key_len = reader.GetU16();
+    const char *encrypt_key = reader.Get(key_len);
+    reader.Get(reader.GetU16());    // svrsig
+    reader.Get(kMiniSdpAuthLength);
+    if (reader.Failed()) return 0;
+
+    info.is_push = kStreamDefault;
+    if (reader.Remaining() > 0) {
+        uint8_t extern_byte = reader.GetU8();
+        if (extern_byte & kMiniExternFlagPush) {
+            info.is_push = kStreamPush;
+        } else if (!(extern_byte & kMiniExternFlagNoDirection)) {
+            info.is_push = kStreamPull;
+        }
+        if (extern_byte & kMiniExternFlagBinaryKey) {
+            std::string fingerprint;
+            if (!LoadMiniFingerprint(std::string(encrypt_key, key_len), fingerprint)) return 0;
+        }
+        // groups and rids are not needed to dispatch
+        auto peek_tracks = [&](MiniSdpDispatchInfo::Media &media) {
+            MediaDescription scratch;
+            std::vector<uint32_t> ssrcs = media.ssrcs;
+            size_t first = ssrcs.size();
+            if (!LoadMiniTrackSection(reader, ssrcs, scratch)) return false;
+            AppendDispatchSsrcs(ssrcs, first, media.ssrcs);
+            return true;
+        };
+        if (extern_byte & kMiniExternFlagTracks) {
+            for (auto &media : info.medias) {
+                if (!peek_tracks(media)) return 0;
+            }
+        }
+        if (extern_byte & kMiniExternFlagMedias) {
+            uint8_t extra_num = reader.GetU8();
+            for (uint8_t i = 0; i < extra_num; i++) {
+                info.medias.emplace_back();
+                if (!PeekMiniMedia(reader, !hdr->not_support_aac_fmtp, &info.medias.back())) return 0;
+                if ((extern_byte & kMiniExternFlagTracks) && !peek_tracks(info.medias.back())) return 0;
+            }
+            if (reader.Failed()) return 0;
+        }
+    }
+
+    info.version = 0;
+    info.sdp_type = SdpType(hdr->sdp_type);
+    info.seq = ntohs(hdr->seq);
+    info.is_imm_send = !hdr->not_imm_send;
+    info.stream_url.assign(kMiniSdpUrlPrefix);
+    info.stream_url.append(stream_url, stream_url_len);
+    return reader.Offset();
+}
+
 MediaDescriptionPtr MiniSdpLoader::parseMedia(char *data, uint32_t &offset, MiniSdpHdr *mini_sdp_hdr) {
+    StageTimer timer(SdpStage::kLoadMedia);
     MiniMediaHdr *media_hdr = reinterpret_cast<MiniMediaHdr *>(data + offset);
     offset += sizeof(MiniMediaHdr);
-    MediaDescriptionPtr media_info = MakeMediaDescription();
+    MediaDescriptionPtr media_info = NewMediaDescription();
     media_info->MediaType = SdpMediaType(media_hdr->media_type);
-    std::string codec_name;
+    const char *codec_name = "";
     media_info->AddrType = addr_type;
-    media_info->TransType = SdpTransType(mini_sdp_trans_type_vec[mini_sdp_hdr->direction]);
+    if (mini_sdp_hdr->direction >= mini_sdp_trans_type_vec.size()) {
+        media_info->TransType = SdpTransType::kSendRecv;
+    } else {
+        media_info->TransType = SdpTransType(mini_sdp_trans_type_vec[mini_sdp_hdr->direction]);
+    }
     if (!ip_addr.empty() && ip_addr != "0.0.0.0") {
         media_info->Candidate.first = ip_addr;
         media_info->Candidate.second = ntohs(mini_sdp_hdr->candidate_port);
@@ -494,51 +1218,10 @@ MediaDescriptionPtr MiniSdpLoader::parseMedia(char *data, uint32_t &offset, Mini
             aac_config = reinterpret_cast<MiniAacConfig*>(data + offset);
             offset += sizeof(MiniAacConfig) + aac_config->config_len;
         }
-        CodecDescriptionPtr code_info = MakeCodecDescription();
-        if (codec_desc->codec >= mini_sdp_codec_name_vec.size()) {
-            continue;
-        }
-        code_info->Name = mini_sdp_codec_name_vec[codec_desc->codec];
-        codec_name = code_info->Name;
-        code_info->Format = codec_desc->payload_type;
-        code_info->Channels = codec_desc->channels;
-        if (codec_desc->frequency >= mini_sdp_frequency_vec.size()) {
+        if (!LoadMiniCodecDesc(*codec_desc, aac_config, *media_info)) {
             continue;
         }
-        code_info->SampleRate = mini_sdp_frequency_vec[codec_desc->frequency];
-        if (codec_desc->nack) {
-            code_info->Feedbacks.emplace(kSdpCodecNack);
-        }
-        if (codec_desc->flex_fec) {
-            //code_info->Feedbacks.emplace(kSdpCodecFlexFec);
-        }
-        if (codec_desc->transport_cc) {
-            code_info->Feedbacks.emplace(kSdpCodecTransportCc);
-        }
-        if (codec_desc->goog_remb) {
-            code_info->Feedbacks.emplace(kSdpCodecGoogleRemb);
-        }
-        if (codec_desc->bfame_enable) {
-            code_info->FormatParams.emplace(kSdpCodecBFrameEnabled, "1");
-        }
-        if (media_info->MediaType == SdpMediaType::kVideo) {
-            code_info->FormatParams.emplace("level-asymmetry-allowed","1");
-            code_info->FormatParams.emplace("packetization-mode","1");
-            code_info->FormatParams.emplace("profile-level-id","42e01f");
-        }
-        if (media_info->MediaType == SdpMediaType::kAudio) {
-            if (aac_config) {
-                if (aac_config->object) code_info->FormatParams.emplace("object", std::to_string((int)aac_config->object));
-                code_info->FormatParams.emplace("PS-enabled", (aac_config->flag & kMiniAacFlagPs) ? "1" : "0");
-                code_info->FormatParams.emplace("SBR-enabled", (aac_config->flag & kMiniAacFlagSbr) ? "1" : "0");
-                code_info->FormatParams.emplace("stereo", (aac_config->flag & kMiniAacFlagStereo) ? "1" : "0");
-                code_info->FormatParams.emplace("cpresent", (aac_config->flag & kMiniAacFlagCPresent) ? "1" : "0");
-                if (aac_config->config_len > 0) code_info->FormatParams.emplace("config", std::string(aac_config->config_data, aac_config->config_len));
-            } else if (!codec_desc->flex_fec){
-                code_info->FormatParams.emplace("stereo","1");
-            }
-        }
-        media_info->Codecs.emplace(code_info->Format, code_info);
+        codec_name = mini_sdp_codec_name_vec[codec_desc->codec].c_str();
     }
     uint8_t *ext_num = reinterpret_cast<uint8_t *>(data + offset);
     offset += sizeof(uint8_t);
@@ -549,47 +1232,21 @@ MediaDescriptionPtr MiniSdpLoader::parseMedia(char *data, uint32_t &offset, Mini
         if (ext_desc->uri >= mini_sdp_ext_vec.size()) {
             continue;
         }
-        media_info->ExtMap.emplace(ext_id, mini_sdp_ext_vec[ext_desc->uri]);
+        const std::string &uri = mini_sdp_ext_vec[ext_desc->uri];
+        AddExtMap(*media_info, ext_id, uri.data(), uri.size());
     }
     //todo add stream_id to track
-    TrackDescriptionPtr track_info = MakeTrackDescription();
-    track_info->Ssrc = ntohl(media_hdr->ssrc1);
-    if (track_info->Ssrc) {
+    uint32_t ssrcs[2] = {ntohl(media_hdr->ssrc1), ntohl(media_hdr->ssrc2)};
+    for (uint32_t ssrc : ssrcs) {
+        if (!ssrc) continue;
         // track_info->SetAttribute("msid", "- " + codec_name);
         // track_info->SetAttribute("mslabel", "-");
-        track_info->SetAttribute("label", codec_name);
-        media_info->Tracks.emplace(ntohl(media_hdr->ssrc1), track_info);
-        media_info->TracksOrder.push_back(ntohl(media_hdr->ssrc1));
-    }
-    TrackDescriptionPtr track_info2 = MakeTrackDescription();
-    track_info2->Ssrc = ntohl(media_hdr->ssrc2);
-    if (track_info2->Ssrc) {
-        // track_info2->SetAttribute("msid", "- " + codec_name);
-        // track_info2->SetAttribute("mslabel", "-");
-        track_info2->SetAttribute("label", codec_name);
-        media_info->Tracks.emplace(ntohl(media_hdr->ssrc2), track_info2);
-        media_info->TracksOrder.push_back(ntohl(media_hdr->ssrc2));
+        TrackDescriptionPtr track_info = FindOrAddTrack(*media_info, ssrc);
+        SetAttribute(*track_info, "label", 5, codec_name, strlen(codec_name));
+        media_info->TracksOrder.push_back(ssrc);
     }
 
     return media_info;
 }
 
-void MiniSdpLoader::readStr16(std::string &dst, char *data,
-                                 uint32_t &offset) {
-    uint16_t *nlen = reinterpret_cast<uint16_t *>(data + offset);
-    uint16_t len = ntohs(*nlen);
-    offset += sizeof(uint16_t);
-    dst.assign(data + offset, len);
-    offset += len;
-}
-
-void MiniSdpLoader::readStr32(std::string &dst, char *data,
-                                 uint32_t &offset) {
-    uint32_t *nlen = reinterpret_cast<uint32_t *>(data + offset);
-    uint32_t len = ntohl(*nlen);
-    offset += sizeof(uint32_t);
-    dst.assign(data + offset, len);
-    offset += len;
-}
-
 }  // namespace mini_sdp
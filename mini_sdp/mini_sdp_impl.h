@@ -17,6 +17,8 @@
 
 namespace mini_sdp {
 
+class MiniSdpCodec;
+class BufferReader;
 
 constexpr uint8_t kMiniSdpPacketType = 0xFF;
 constexpr uint8_t kMiniSdpAuthLength = 16;
@@ -75,6 +77,43 @@ constexpr uint16_t kMiniAacFlagSbr      = 0x2;
 constexpr uint16_t kMiniAacFlagStereo   = 0x4;
 constexpr uint16_t kMiniAacFlagCPresent = 0x8;
 
+// extern byte, appended after auth
+// - 旧版本仅识别 kMiniExternFlagPush，存在该字节即表示设置了推拉流方向
+constexpr uint8_t kMiniExternFlagPush        = 0x1;
+constexpr uint8_t kMiniExternFlagNoDirection = 0x2;  // 未设置推拉流方向，仅因其他标志位而携带该字节
+constexpr uint8_t kMiniExternFlagBinaryKey   = 0x4;  // encrypt_key 为 <hash id:1><digest>
+constexpr uint8_t kMiniExternFlagTracks      = 0x8;  // extern byte 后按 media 顺序跟随 track section
+constexpr uint8_t kMiniExternFlagMedias      = 0x10; // track section 后跟随 extra media section
+
+/*
+ * extra media section，头部每种类型只有一个标志位，同类型的多个 media 中第一个按原位置打包，其余追加在末尾
+ *  media_num:u8 | (MiniMediaHdr codec_desc * codec_num [aac config] ext_num:u8 ext_desc * ext_num [track section]) * n
+ *  - media 的编码与原位置相同，track section 仅在设置 kMiniExternFlagTracks 时存在
+ *  - 旧版本忽略该 section，只还原每种类型的第一个 media
+ */
+
+/*
+ * track section，携带 MiniMediaHdr 容纳不下的 track 信息，varint 为 unsigned LEB128
+ *  flags:u8 | [ssrc_num:v ssrc:u32 * n]
+ *           | [group_num:v (semantics:u8 [len:v str] member_num:v ssrc_idx:v * m) * k]
+ *           | [rid_num:v (rid_flag:u8 len:v id [len:v params]) * r]
+ *           | [len:v simulcast]
+ *  - ssrc 为 first_track 之后的 track，ssrc_idx 为在该 media 全部 ssrc 中的下标
+ *  - 各部分仅在 flags 中对应位设置时存在
+ */
+constexpr uint8_t kMiniTrackFlagSsrcs           = 0x1;
+constexpr uint8_t kMiniTrackFlagGroups          = 0x2;
+constexpr uint8_t kMiniTrackFlagRids            = 0x4;
+constexpr uint8_t kMiniTrackFlagSimulcastByRids = 0x8;   // a=simulcast 可由 rid 还原，不携带字符串
+constexpr uint8_t kMiniTrackFlagSimulcast       = 0x10;
+
+constexpr uint8_t kMiniSsrcGroupCustom  = 0xFF;  // semantics 字符串跟随其后
+
+constexpr uint8_t kMiniRidFlagRecv      = 0x1;
+constexpr uint8_t kMiniRidFlagParams    = 0x2;
+
+constexpr size_t kMiniFingerprintMaxLen = 64;   // sha-512
+
 struct MiniCodecDesc {
     uint32_t frequency    :  4;
     uint32_t codec        :  4;
@@ -98,6 +137,79 @@ struct MiniExtDesc{
     uint16_t uri                     :  8;
 } __attribute__((packed));
 
+/**
+ * @brief numeric fmtp value of codec, like "object" of aac
+ * @return uint32_t 0 if the key is missing or the value is not a number
+ */
+uint32_t GetFormatParamUint(const CodecDescription &codec, const std::string &key);
+
+/**
+ * @brief codec to MiniCodecDesc
+ * @return false if codec is not supported by mini sdp
+ */
+bool PackMiniCodecDesc(const CodecDescription &codec, MiniCodecDesc &mini_codec_desc);
+
+/**
+ * @brief aac fmtp to MiniAacConfig with config data
+ */
+void PackMiniAacConfig(const CodecDescription &codec, std::string &dst);
+
+/**
+ * @brief MiniCodecDesc to codec
+ * @param aac_config nullable
+ * @return nullptr if codec_desc is not supported
+ */
+CodecDescriptionPtr LoadMiniCodecDesc(const MiniCodecDesc &codec_desc, const MiniAacConfig *aac_config,
+                                      SdpMediaType media_type);
+
+/**
+ * @brief MiniCodecDesc to a codec of media, the first codec of a payload type is kept
+ * @param aac_config nullable
+ * @return false if codec_desc is not supported
+ */
+bool LoadMiniCodecDesc(const MiniCodecDesc &codec_desc, const MiniAacConfig *aac_config, MediaDescription &media);
+
+// extmap uri <=> MiniExtDesc::uri
+bool PackMiniExtUri(const std::string &uri, uint8_t &mini_uri);
+
+bool LoadMiniExtUri(uint8_t mini_uri, std::string &uri);
+
+// <hash func> <hex digest> => <hash id><digest>
+bool PackMiniFingerprint(const std::pair<std::string, std::string>& fingerprint, std::string& dst);
+
+// <hash id><digest> => <hash func> <hex digest>
+bool LoadMiniFingerprint(const std::string& src, std::string& dst);
+
+/**
+ * @brief tracks from first_track, ssrc-group, rid and simulcast of media to track section
+ * @return false if nothing needs to be carried, dst is a section of flags only
+ */
+bool PackMiniTrackSection(const MediaDescription &media, size_t first_track, std::string &dst);
+
+/**
+ * @brief track section to media
+ * @param ssrcs ssrcs carried before the section, ssrcs in the section are appended
+ * @return false if format error
+ */
+bool LoadMiniTrackSection(BufferReader &reader, std::vector<uint32_t> &ssrcs, MediaDescription &media);
+
+/**
+ * @brief skip a media desc of v0, the same layout as MiniSdpLoader::parseMedia reads
+ * @param media nullptr to check the bounds only
+ * @return false if out of bounds
+ */
+bool PeekMiniMedia(BufferReader &reader, bool is_support_aac_fmtp, MiniSdpDispatchInfo::Media *media);
+
+/**
+ * @brief ssrcs[first, end) to dispatch ssrcs, skip 0 and those already in dst, as loaders do to TracksOrder
+ */
+void AppendDispatchSsrcs(const std::vector<uint32_t> &ssrcs, size_t first, std::vector<uint32_t> &dst);
+
+/**
+ * @brief ParseOriginSdpToMiniSdp without the stage stats and the metrics, for a pack that is not a request
+ */
+ssize_t PackOriginSdp(const OriginSdpAttr& attr, const char* origin_sdp, size_t origin_sdp_len, char* buff, size_t len);
+
 class MiniSdp {
 public:
     MiniSdp();
@@ -147,9 +259,45 @@ public:
     int PackToDstMem(char *data, size_t len, const std::string &origin_sdp, SdpType sdp_type, 
                      const std::string &stream_url,const std::string &svrsig, uint16_t seq = 0, 
                      int status_code = 0, bool imm_send = false, bool is_support_aac_fmtp = false,
-                     StreamDirection is_push = kStreamDefault);
+                     StreamDirection is_push = kStreamDefault, bool is_compact_fingerprint = false);
+
+    /**
+     * @brief packer parsed sdp to dst buffer, sdp_type should not be none
+     */
+    int PackToDstMem(char *data, size_t len, SessionDescriptionPtr sdp_info, SdpType sdp_type,
+                     const std::string &stream_url, const std::string &svrsig, uint16_t seq = 0,
+                     int status_code = 0, bool imm_send = false, bool is_support_aac_fmtp = false,
+                     StreamDirection is_push = kStreamDefault, bool is_compact_fingerprint = false);
+
+    /**
+     * @brief packer within budget by codec, drop optional contents by budget.order when exceeded
+     * 
+     * @return >0 buffer size, larger than len if it can not fit after all drops
+     * @return =0 pack error
+     */
+    int PackToDstMem(char *data, size_t len, const OriginSdpAttr &attr, const PackBudget &budget,
+                     PackDegradeReport *report, const MiniSdpCodec &codec);
+
+    // of the sdp parsed by the last PackToDstMem, code is kSuccess if it was parsed
+    const SdpParser::ErrorInfo &GetParseError() const { return parse_error_; }
 
 private:
+    struct DropCandidate {
+        MediaDescriptionPtr media;
+        uint32_t            value;
+        size_t              cost;
+    };
+
+    // collect droppable contents of step, sorted by drop priority from low to high
+    void collectDropCandidates(PackDropStep step, SessionDescriptionPtr sdp_info, const PackBudget &budget,
+                               bool is_support_aac_fmtp, const MiniSdpCodec &codec,
+                               std::vector<DropCandidate> &candidates);
+
+    void dropCandidate(PackDropStep step, const DropCandidate &candidate);
+
+    // MiniMediaHdr, codec descs and ext descs of a media, false if len is not enough and offset is the size needed
+    bool packMedia(MediaDescription &media_info, bool is_support_aac_fmtp, char *data, size_t len, uint32_t &offset);
+
     void copyStr16(uint16_t len, char *str, char *data, uint32_t &offset);
 
     void copyStr32(uint32_t len, char *str, char *data, uint32_t &offset);
@@ -158,7 +306,7 @@ private:
 
     std::string ip_addr;
 
-    static uint16_t sdp_seq;
+    SdpParser::ErrorInfo parse_error_;
 
 }; // class MiniSdpPacker
 
@@ -180,15 +328,19 @@ public:
     int ParseToString(char *data, uint32_t data_len, uint16_t &seq, SdpType &sdp_type, 
                       std::string &dst_sdp, std::string &dst_stream_url, std::string &svrsig, 
                       int &status_code, bool &imm_send, bool &is_support_aac_fmtp,
-                      StreamDirection &is_push);
+                      StreamDirection &is_push, bool &is_compact_fingerprint);
+
+    /**
+     * @brief Read dispatch info without building the sdp, every read is bounds checked
+     *
+     * @return >0 buffer size
+     * @return =0 parse error
+     */
+    int Peek(const char *data, size_t data_len, MiniSdpDispatchInfo &info);
 
 private:
     MediaDescriptionPtr parseMedia(char *data, uint32_t &offset, MiniSdpHdr *mini_sdp_hdr);
 
-    void readStr16(std::string &dst, char *data, uint32_t &offset);
-
-    void readStr32(std::string &dst, char *data, uint32_t &offset);
-
     std::string encrypt_key;
 
     SdpAddrType addr_type = SdpAddrType::kIPv4;
@@ -0,0 +1,680 @@
+/**
+ * @file mini_sdp/mini_sdp_v1.cc
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include "mini_sdp_v1.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include "mini_sdp_impl.h"
+#include "sdp_recycler.h"
+#include "stage_stats.h"
+#include "util.h"
+
+namespace mini_sdp {
+
+constexpr uint8_t kMiniV1PayloadTypeBase = 98;
+constexpr size_t kMiniV1MaxTrackNum = 127;
+constexpr size_t kMiniV1MaxCodecNum = 63;
+
+// codec 4b: 0-opus，1-MP4A-LATM，2-MP4A-ADTS，3-h264，4-h265，5-flexfec
+static const std::vector<std::string> mini_v1_codec_name_vec = {
+    kSdpCodecOpus, kSdpCodecLatm, kSdpCodecAdts, kSdpCodecH264, kSdpCodecH265, kSdpCodecFlexFec
+};
+
+// frequency 4b: 0-44k，1-48k，2-90k，...
+static const std::vector<uint32_t> mini_v1_frequency_vec = {
+    44100, 48000, 90000, 96000, 88200, 64000, 32000, 24000,
+    22050, 16000, 12000, 11025,  8000,  7350,     0
+};
+
+// direction 2b: 0-sendonly，1-recvonly，2-sendrecv，3-inactive
+static const std::vector<SdpTransType> mini_v1_trans_type_vec = {
+    SdpTransType::kSendOnly, SdpTransType::kRecvOnly, SdpTransType::kSendRecv, SdpTransType::kInactive
+};
+
+// role 2b: 0-actpass，1-active，2-passive
+static const std::vector<SdpRoleType> mini_v1_role_type_vec = {
+    SdpRoleType::kActpass, SdpRoleType::kActive, SdpRoleType::kPassive
+};
+
+template <typename T>
+static int findIndex(const std::vector<T> &vec, const T &value) {
+    auto it = std::find(vec.begin(), vec.end(), value);
+    return it == vec.end() ? -1 : int(it - vec.begin());
+}
+
+static bool isAacCodec(const std::string &name) {
+    return name == kSdpCodecLatm || name == kSdpCodecAdts;
+}
+
+static bool isFormatParamSet(const CodecDescription &codec, const char *key) {
+    auto it = codec.FormatParams.find(key);
+    return it != codec.FormatParams.end() && !it->second.empty() && it->second != "0";
+}
+
+const std::string* MiniV1CustomExt::GetStr(uint8_t id) const {
+    for (auto &str : strs) {
+        if (str.first == id) return &str.second;
+    }
+    return nullptr;
+}
+
+void MiniV1CustomExt::SetU32(uint8_t id, uint32_t value) {
+    value = htonl(value);
+    strs.emplace_back(id, std::string(reinterpret_cast<const char*>(&value), sizeof(value)));
+}
+
+uint32_t MiniV1CustomExt::GetU32(uint8_t id, uint32_t def_val) const {
+    const std::string *str = GetStr(id);
+    if (!str || str->size() != sizeof(uint32_t)) return def_val;
+    uint32_t value;
+    memcpy(&value, str->data(), sizeof(value));
+    return ntohl(value);
+}
+
+static void writeCustomExt(BufferWriter &writer, const MiniV1CustomExt &ext) {
+    writer.PutU8(ext.strs.size());
+    uint8_t bit_map_size = 0;
+    for (uint32_t bits = ext.bit_map; bits; bits >>= 8) bit_map_size++;
+    writer.PutU8(bit_map_size);
+    for (uint8_t i = 0; i < bit_map_size; i++) {
+        writer.PutU8(uint8_t(ext.bit_map >> (8 * i)));
+    }
+    for (auto &str : ext.strs) {
+        writer.PutU16(str.second.size());
+        writer.PutU8(str.first);
+        writer.Put(str.second.data(), str.second.size());
+    }
+}
+
+static void readCustomExt(BufferReader &reader, MiniV1CustomExt &ext) {
+    uint8_t str_num = reader.GetU8();
+    uint8_t bit_map_size = reader.GetU8();
+    for (uint8_t i = 0; i < bit_map_size; i++) {
+        uint8_t bits = reader.GetU8();
+        // bits not known by this version are ignored
+        if (i < sizeof(ext.bit_map)) ext.bit_map |= uint32_t(bits) << (8 * i);
+    }
+    for (uint8_t i = 0; i < str_num && !reader.Failed(); i++) {
+        uint16_t str_len = reader.GetU16();
+        uint8_t id = reader.GetU8();
+        std::string str;
+        reader.GetStr(str, str_len);
+        ext.strs.emplace_back(id, std::move(str));
+    }
+}
+
+static bool skipCustomExt(BufferReader &reader) {
+    uint8_t str_num = reader.GetU8();
+    reader.Get(reader.GetU8());
+    for (uint8_t i = 0; i < str_num && !reader.Failed(); i++) {
+        uint16_t str_len = reader.GetU16();
+        reader.Get(sizeof(uint8_t) + str_len);
+    }
+    return !reader.Failed();
+}
+
+// MiniSdpV1CodecDesc with codec_custom_extense
+static bool packCodec(const CodecDescription &codec, std::string &dst) {
+    int codec_idx = findIndex(mini_v1_codec_name_vec, codec.Name);
+    int frequency_idx = findIndex(mini_v1_frequency_vec, codec.SampleRate);
+    if (codec_idx < 0 || frequency_idx < 0) return false;
+
+    MiniV1CustomExt ext;
+    if (codec.Feedbacks.count(kSdpCodecNack)) ext.SetBit(kMiniV1CodecBitNack);
+    if (codec.Name == kSdpCodecFlexFec) ext.SetBit(kMiniV1CodecBitFlexFec);
+    if (codec.Feedbacks.count(kSdpCodecTransportCc)) ext.SetBit(kMiniV1CodecBitTransportCc);
+    if (codec.Feedbacks.count(kSdpCodecGoogleRemb)) ext.SetBit(kMiniV1CodecBitRemb);
+    if (isFormatParamSet(codec, kSdpCodecBFrameEnabled) || isFormatParamSet(codec, kSdpCodecBFrameEnabled2)) {
+        ext.SetBit(kMiniV1CodecBitBFrameEnable);
+    }
+    if (isFormatParamSet(codec, "stereo")) ext.SetBit(kMiniV1CodecBitStereo);
+    if (isFormatParamSet(codec, "useinbandfec")) ext.SetBit(kMiniV1CodecBitUseInbandFec);
+    if (isAacCodec(codec.Name)) {
+        if (isFormatParamSet(codec, "PS-enabled")) ext.SetBit(kMiniV1CodecBitPsEnable);
+        if (isFormatParamSet(codec, "SBR-enabled")) ext.SetBit(kMiniV1CodecBitSbrEnable);
+        if (isFormatParamSet(codec, "cpresent")) ext.SetBit(kMiniV1CodecBitCPresent);
+        uint32_t object = GetFormatParamUint(codec, "object");
+        if (object) ext.SetU32(kMiniV1CodecStrObject, object);
+        std::string config = codec.GetFormatParam("config", "");
+        if (!config.empty()) ext.strs.emplace_back(kMiniV1CodecStrConfig, config);
+    }
+
+    MiniSdpV1CodecDesc desc;
+    desc.codec = codec_idx;
+    desc.frequency = frequency_idx;
+    desc.payload_type = uint8_t(codec.Format - kMiniV1PayloadTypeBase);
+    desc.has_ext = ext.Empty() ? 0 : 1;
+    desc.channels = codec.Channels;
+    desc.reversed = 0;
+
+    dst.assign(reinterpret_cast<const char*>(&desc), sizeof(desc));
+    if (desc.has_ext) {
+        // the size is known after writing, write twice
+        BufferWriter counter(nullptr, 0);
+        writeCustomExt(counter, ext);
+        dst.resize(sizeof(desc) + counter.Offset());
+        BufferWriter writer(&dst[sizeof(desc)], counter.Offset());
+        writeCustomExt(writer, ext);
+    }
+    return true;
+}
+
+static void addFormatParam(CodecDescription &codec, const char *key, const char *value) {
+    AddFormatParam(codec, key, strlen(key), value, strlen(value));
+}
+
+// the codec name, nullptr if failed or not supported; the first codec of a payload type is kept
+static const std::string* loadCodec(BufferReader &reader, MediaDescription &media) {
+    const MiniSdpV1CodecDesc *desc = reinterpret_cast<const MiniSdpV1CodecDesc*>(reader.Get(sizeof(MiniSdpV1CodecDesc)));
+    if (!desc) return nullptr;
+    MiniV1CustomExt ext;
+    if (desc->has_ext) readCustomExt(reader, ext);
+    if (desc->codec >= mini_v1_codec_name_vec.size() || desc->frequency >= mini_v1_frequency_vec.size()) {
+        return nullptr;
+    }
+
+    const std::string &name = mini_v1_codec_name_vec[desc->codec];
+    bool added = false;
+    CodecDescriptionPtr code_info = FindOrAddCodec(media, uint8_t(desc->payload_type + kMiniV1PayloadTypeBase) & 0x7F,
+                                                   &added);
+    if (!added) return &name;
+    code_info->Name = name;
+    code_info->Channels = desc->channels;
+    code_info->SampleRate = mini_v1_frequency_vec[desc->frequency];
+    if (ext.HasBit(kMiniV1CodecBitNack)) AddFeedback(*code_info, kSdpCodecNack, sizeof(kSdpCodecNack) - 1);
+    if (ext.HasBit(kMiniV1CodecBitTransportCc)) {
+        AddFeedback(*code_info, kSdpCodecTransportCc, sizeof(kSdpCodecTransportCc) - 1);
+    }
+    if (ext.HasBit(kMiniV1CodecBitRemb)) AddFeedback(*code_info, kSdpCodecGoogleRemb, sizeof(kSdpCodecGoogleRemb) - 1);
+    if (ext.HasBit(kMiniV1CodecBitBFrameEnable)) addFormatParam(*code_info, kSdpCodecBFrameEnabled, "1");
+    if (media.MediaType == SdpMediaType::kVideo) {
+        addFormatParam(*code_info, "level-asymmetry-allowed", "1");
+        addFormatParam(*code_info, "packetization-mode", "1");
+        addFormatParam(*code_info, "profile-level-id", "42e01f");
+    }
+    if (media.MediaType == SdpMediaType::kAudio) {
+        if (isAacCodec(name)) {
+            uint32_t object = ext.GetU32(kMiniV1CodecStrObject, 0);
+            if (object) addFormatParam(*code_info, "object", std::to_string(object).c_str());
+            addFormatParam(*code_info, "PS-enabled", ext.HasBit(kMiniV1CodecBitPsEnable) ? "1" : "0");
+            addFormatParam(*code_info, "SBR-enabled", ext.HasBit(kMiniV1CodecBitSbrEnable) ? "1" : "0");
+            addFormatParam(*code_info, "stereo", ext.HasBit(kMiniV1CodecBitStereo) ? "1" : "0");
+            addFormatParam(*code_info, "cpresent", ext.HasBit(kMiniV1CodecBitCPresent) ? "1" : "0");
+            const std::string *config = ext.GetStr(kMiniV1CodecStrConfig);
+            if (config && !config->empty()) AddFormatParam(*code_info, "config", 6, config->data(), config->size());
+        } else if (ext.HasBit(kMiniV1CodecBitStereo)) {
+            addFormatParam(*code_info, "stereo", "1");
+        }
+        if (ext.HasBit(kMiniV1CodecBitUseInbandFec)) addFormatParam(*code_info, "useinbandfec", "1");
+    }
+    return &name;
+}
+
+int MiniSdpCodecV1::Pack(const OriginSdpAttr &attr, SessionDescriptionPtr sdp_info, char *buff, size_t len) const {
+    BufferWriter writer(buff, len);
+    std::string stream_url = attr.stream_url;
+    if (stream_url.compare(0, strlen(kMiniSdpUrlPrefix), kMiniSdpUrlPrefix) == 0) {
+        stream_url.erase(0, strlen(kMiniSdpUrlPrefix));
+    }
+    bool is_none = attr.sdp_type == SdpType::kSdpNone || !sdp_info;
+
+    MiniSdpV1Hdr hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.packet_type = kMiniSdpPacketType;
+    memcpy(hdr.magic_word, kMiniSdpMagic, 3);
+    hdr.version = Version();
+    hdr.sdp_type = is_none ? uint8_t(SdpType::kSdpNone) : uint8_t(attr.sdp_type);
+    hdr.plan_type = 1;
+    hdr.seq = htons(attr.seq);
+    hdr.status = htons(attr.status_code);
+
+    MiniSdpV1SessionHdr session_hdr;
+    memset(&session_hdr, 0, sizeof(session_hdr));
+    MiniV1CustomExt session_ext;
+
+    if (is_none) {
+        writer.Put(&hdr, sizeof(hdr));
+        writer.Put(&session_hdr, sizeof(session_hdr));
+        writer.PutU8(0);    // media_num
+        session_ext.strs.emplace_back(kMiniV1SessionStrStreamUrl, stream_url);
+        writeCustomExt(writer, session_ext);
+        return writer.Offset();
+    }
+
+    if (sdp_info->Medias.size() > std::numeric_limits<uint8_t>::max()) return 0;
+    if (sdp_info->SessionId != "1") hdr.header_flag |= kMiniV1HdrFlagNotSeqAlign;
+    if (attr.is_push != kStreamDefault) hdr.header_flag |= kMiniV1HdrFlagDirection;
+    if (attr.is_push == kStreamPush) hdr.header_flag |= kMiniV1HdrFlagPush;
+    if (sdp_info->AddrType == SdpAddrType::kIPv6) hdr.header_flag |= kMiniV1HdrFlagIpv6;
+    session_hdr.imm_send = attr.is_imm_send ? 1 : 0;
+
+    // session level attributes are the same in all medias, the last one takes effect like v0
+    MediaDescriptionPtr candidate_media;
+    std::string ice_ufrag, ice_pwd, encrypt_key;
+    session_hdr.direction = 2;
+    for (auto &media_pair : sdp_info->Medias) {
+        auto &media_info = media_pair.second;
+        if (media_info->Protos == kSdpMediaProtoEncryptDefault) session_hdr.encrypt_switch = 1;
+        if (media_pair.first == "video" || media_pair.first == "audio") session_hdr.is_string_bundle = 1;
+        if (!media_info->Candidate.first.empty() && media_info->Candidate.second != 0) candidate_media = media_info;
+
+        // a media without direction (m=application) keeps the direction of others
+        int direction = findIndex(mini_v1_trans_type_vec, media_info->TransType);
+        if (direction >= 0) session_hdr.direction = direction;
+        int role = findIndex(mini_v1_role_type_vec, media_info->RoleType);
+        session_hdr.role = role < 0 ? 0 : role;
+
+        ice_ufrag = media_info->IceUfrag;
+        ice_pwd = media_info->IcePwd;
+        if (!media_info->Fingerprint.first.empty() || !media_info->Fingerprint.second.empty()) {
+            if (PackMiniFingerprint(media_info->Fingerprint, encrypt_key)) {
+                session_ext.SetBit(kMiniV1SessionBitBinaryKey);
+            } else {
+                session_ext.bit_map = 0;
+                encrypt_key = media_info->Fingerprint.first + " " + media_info->Fingerprint.second;
+            }
+        }
+    }
+
+    MiniSdpV1Candidate candidate;
+    uint32_t candidate_ip[4] = {0};
+    size_t candidate_ip_len = 0;
+    if (candidate_media) {
+        candidate.ip_type = sdp_info->AddrType == SdpAddrType::kIPv6 ? 1 : 0;
+        candidate.candidate_flag = 0;
+        candidate.candidate_port = htons(candidate_media->Candidate.second);
+        candidate_ip_len = candidate.ip_type ? IPV6_ADDR_LEN : sizeof(uint32_t);
+        int ret = candidate.ip_type ? str2ipv6(candidate_media->Candidate.first.c_str(), candidate_ip)
+                                    : str2ipv4(candidate_media->Candidate.first.c_str(), candidate_ip);
+        if (ret == 0) {
+            session_hdr.has_candidate = 1;
+            session_hdr.candidate_num = 1;
+        }
+    }
+
+    writer.Put(&hdr, sizeof(hdr));
+    writer.Put(&session_hdr, sizeof(session_hdr));
+    if (session_hdr.candidate_num) {
+        writer.Put(&candidate, sizeof(candidate));
+        writer.Put(candidate_ip, candidate_ip_len);
+    }
+    writer.PutU8(sdp_info->Medias.size());
+
+    const std::pair<uint8_t, const std::string*> session_strs[] = {
+        {kMiniV1SessionStrIceUfrag, &ice_ufrag}, {kMiniV1SessionStrIcePwd, &ice_pwd},
+        {kMiniV1SessionStrEncryptKey, &encrypt_key}, {kMiniV1SessionStrSvrSig, &attr.svrsig},
+        {kMiniV1SessionStrStreamUrl, &stream_url}
+    };
+    for (auto &str : session_strs) {
+        if (str.second->empty()) continue;
+        if (str.second->size() > std::numeric_limits<uint16_t>::max()) return 0;
+        session_ext.strs.emplace_back(str.first, *str.second);
+    }
+    writeCustomExt(writer, session_ext);
+
+    std::vector<std::string> codecs;
+    std::vector<MiniExtDesc> exts;
+    for (auto &media_pair : sdp_info->Medias) {
+        StageTimer timer(SdpStage::kPackMedia);
+        auto &media_info = media_pair.second;
+        codecs.clear();
+        for (auto &codec_pair : media_info->Codecs) {
+            if (codecs.size() == kMiniV1MaxCodecNum) break;
+            codecs.emplace_back();
+            if (!packCodec(*codec_pair.second, codecs.back())) codecs.pop_back();
+        }
+        exts.clear();
+        for (auto &ext_pair : media_info->ExtMap) {
+            if (exts.size() == std::numeric_limits<uint8_t>::max()) break;
+            uint8_t mini_uri;
+            Trim(ext_pair.second);
+            if (!PackMiniExtUri(ext_pair.second, mini_uri)) continue;
+            MiniExtDesc ext_desc;
+            ext_desc.id = ext_pair.first;
+            ext_desc.uri = mini_uri;
+            exts.push_back(ext_desc);
+        }
+        size_t track_num = std::min(media_info->TracksOrder.size(), kMiniV1MaxTrackNum);
+
+        MiniV1CustomExt media_ext;
+        std::string track_section;
+        if (PackMiniTrackSection(*media_info, track_num, track_section)) {
+            media_ext.strs.emplace_back(kMiniV1MediaStrTracks, std::move(track_section));
+        }
+
+        MiniSdpV1MediaHdr media_hdr;
+        media_hdr.has_ext = media_ext.Empty() ? 0 : 1;
+        media_hdr.track_num = track_num;
+        media_hdr.media_type = uint8_t(media_info->MediaType);
+        media_hdr.codec_num = codecs.size();
+        media_hdr.rtp_ext_num = exts.size();
+        writer.Put(&media_hdr, sizeof(media_hdr));
+        if (media_hdr.has_ext) writeCustomExt(writer, media_ext);
+
+        for (size_t i = 0; i < track_num; i++) {
+            MiniSdpV1Track track;
+            track.ssrc = htonl(media_info->TracksOrder[i]);
+            track.track_order = i;
+            track.media_stream_id = 0;
+            writer.Put(&track, sizeof(track));
+        }
+        for (auto &codec : codecs) {
+            writer.Put(codec.data(), codec.size());
+        }
+        for (auto &ext_desc : exts) {
+            writer.Put(&ext_desc, sizeof(ext_desc));
+        }
+    }
+    return writer.Offset();
+}
+
+static MediaDescriptionPtr loadMedia(BufferReader &reader, const SessionDescription &sdp_info) {
+    StageTimer timer(SdpStage::kLoadMedia);
+    const MiniSdpV1MediaHdr *media_hdr = reinterpret_cast<const MiniSdpV1MediaHdr*>(reader.Get(sizeof(MiniSdpV1MediaHdr)));
+    if (!media_hdr || media_hdr->media_type > uint8_t(SdpMediaType::kData)) return nullptr;
+
+    MediaDescriptionPtr media_info = NewMediaDescription();
+    media_info->MediaType = SdpMediaType(media_hdr->media_type);
+    media_info->AddrType = sdp_info.AddrType;
+    media_info->TransType = sdp_info.TransType;
+    // bitrate is not a part of SessionDescription
+    MiniV1CustomExt media_ext;
+    if (media_hdr->has_ext) readCustomExt(reader, media_ext);
+
+    std::vector<uint32_t> ssrcs;
+    for (uint8_t i = 0; i < media_hdr->track_num; i++) {
+        const MiniSdpV1Track *track = reinterpret_cast<const MiniSdpV1Track*>(reader.Get(sizeof(MiniSdpV1Track)));
+        if (!track) return nullptr;
+        ssrcs.push_back(ntohl(track->ssrc));
+    }
+
+    static const std::string kNoCodec;
+    const std::string *codec_name = &kNoCodec;
+    for (uint8_t i = 0; i < media_hdr->codec_num; i++) {
+        const std::string *name = loadCodec(reader, *media_info);
+        if (reader.Failed()) return nullptr;
+        if (!name) continue;
+        codec_name = name;
+    }
+
+    std::string uri;
+    for (uint8_t i = 0; i < media_hdr->rtp_ext_num; i++) {
+        const MiniExtDesc *ext_desc = reinterpret_cast<const MiniExtDesc*>(reader.Get(sizeof(MiniExtDesc)));
+        if (!ext_desc) return nullptr;
+        if (LoadMiniExtUri(ext_desc->uri, uri)) AddExtMap(*media_info, ext_desc->id, uri.data(), uri.size());
+    }
+
+    const std::string *track_section = media_ext.GetStr(kMiniV1MediaStrTracks);
+    if (track_section) {
+        BufferReader section_reader(track_section->data(), track_section->size());
+        if (!LoadMiniTrackSection(section_reader, ssrcs, *media_info)) return nullptr;
+    }
+
+    for (auto ssrc : ssrcs) {
+        if (ssrc == 0) continue;
+        bool added = false;
+        TrackDescriptionPtr track_info = FindOrAddTrack(*media_info, ssrc, &added);
+        if (!added) continue;
+        SetAttribute(*track_info, "label", *codec_name);
+        media_info->TracksOrder.push_back(ssrc);
+    }
+    return media_info;
+}
+
+int MiniSdpCodecV1::Load(const char *buff, size_t len, OriginSdpAttr &attr) const {
+    BufferReader reader(buff, len);
+    const MiniSdpV1Hdr *hdr = reinterpret_cast<const MiniSdpV1Hdr*>(reader.Get(sizeof(MiniSdpV1Hdr)));
+    if (!hdr || hdr->packet_type != kMiniSdpPacketType || memcmp(hdr->magic_word, kMiniSdpMagic, 3) != 0 ||
+        hdr->version != Version() || hdr->sdp_type > uint8_t(SdpType::kSdpNone)) {
+        return 0;
+    }
+    const MiniSdpV1SessionHdr *session_hdr =
+        reinterpret_cast<const MiniSdpV1SessionHdr*>(reader.Get(sizeof(MiniSdpV1SessionHdr)));
+    if (!session_hdr) return 0;
+
+    SessionDescriptionPtr sdp_info = BeginSessionDescription();
+    sdp_info->Version = 0;
+    sdp_info->AddrType = (hdr->header_flag & kMiniV1HdrFlagIpv6) ? SdpAddrType::kIPv6 : SdpAddrType::kIPv4;
+    sdp_info->TransType = mini_v1_trans_type_vec[session_hdr->direction];
+    sdp_info->RoleType = session_hdr->role < mini_v1_role_type_vec.size() ? mini_v1_role_type_vec[session_hdr->role]
+                                                                           : SdpRoleType::kActpass;
+    if (!(hdr->header_flag & kMiniV1HdrFlagNotSeqAlign)) {
+        sdp_info->SessionId = "1";
+    }
+
+    // only the first candidate is used, all medias are bundled
+    std::string ip_addr;
+    uint16_t port = 0;
+    for (uint8_t i = 0; i < session_hdr->candidate_num; i++) {
+        const MiniSdpV1Candidate *candidate =
+            reinterpret_cast<const MiniSdpV1Candidate*>(reader.Get(sizeof(MiniSdpV1Candidate)));
+        if (!candidate) return 0;
+        const char *ip = reader.Get(candidate->ip_type ? IPV6_ADDR_LEN : sizeof(uint32_t));
+        if (!ip || i > 0) continue;
+        if (candidate->ip_type) {
+            ip_addr = ip2strv6(reinterpret_cast<const unsigned char*>(ip));
+        } else {
+            uint32_t ipv4;
+            memcpy(&ipv4, ip, sizeof(ipv4));
+            ip_addr = ip2strv4(ipv4);
+        }
+        port = ntohs(candidate->candidate_port);
+    }
+
+    uint8_t media_num = reader.GetU8();
+    MiniV1CustomExt session_ext;
+    readCustomExt(reader, session_ext);
+    if (reader.Failed()) return 0;
+
+    std::vector<MediaDescriptionPtr> medias;
+    for (uint8_t i = 0; i < media_num; i++) {
+        MediaDescriptionPtr media = loadMedia(reader, *sdp_info);
+        if (!media) return 0;
+        medias.push_back(media);
+    }
+
+    static const std::string kNoStr;
+    auto getStr = [&](uint8_t id) -> const std::string& {
+        const std::string *str = session_ext.GetStr(id);
+        return str ? *str : kNoStr;
+    };
+    const std::string &ice_ufrag = getStr(kMiniV1SessionStrIceUfrag);
+    const std::string &ice_pwd = getStr(kMiniV1SessionStrIcePwd);
+    const std::string *encrypt_key = &getStr(kMiniV1SessionStrEncryptKey);
+    const std::string &svrsig = getStr(kMiniV1SessionStrSvrSig);
+    const std::string &stream_url = getStr(kMiniV1SessionStrStreamUrl);
+
+    attr.is_compact_fingerprint = false;
+    std::string fingerprint;
+    if (session_ext.HasBit(kMiniV1SessionBitBinaryKey)) {
+        if (!LoadMiniFingerprint(*encrypt_key, fingerprint)) return 0;
+        encrypt_key = &fingerprint;
+        attr.is_compact_fingerprint = true;
+    }
+
+    uint32_t cur_media_id = 0;
+    std::string value;
+    for (auto &media : medias) {
+        if (media->MediaType == SdpMediaType::kData) {
+            media->Protos = kSdpMediaProtoDataChannel;
+            media->MediaName = kSdpMediaNameDataChannel;
+        } else {
+            media->Protos = (session_hdr->encrypt_switch ? kSdpMediaProtoEncryptDefault
+                                                         : kSdpMediaProtoNotEncryptDefault);
+        }
+        media->IceUfrag = ice_ufrag;
+        media->IcePwd = ice_pwd;
+        media->RoleType = sdp_info->RoleType;
+        if (!ip_addr.empty()) {
+            media->Candidate.first = ip_addr;
+            media->Candidate.second = port;
+        }
+        for (auto &track : media->Tracks) {
+            TrackDescription &track_info = *track.second;
+            SetAttribute(track_info, "cname", media->IceUfrag);
+            const std::string &codec_name = track_info.GetAttribute("label");
+            if (!codec_name.empty()) {
+                // label is set last, codec_name refers to it
+                value.assign(media->IceUfrag).append(" ").append(media->IceUfrag).append("_").append(codec_name);
+                SetAttribute(track_info, "msid", value);
+                SetAttribute(track_info, "mslabel", media->IceUfrag);
+                value.assign(media->IceUfrag).append("_").append(codec_name);
+                SetAttribute(track_info, "label", value);
+            }
+        }
+        std::string &mid = media->MediaId;
+        if (session_hdr->is_string_bundle) {
+            if (media->MediaType == SdpMediaType::kVideo) {
+                mid = "video";
+            } else if (media->MediaType == SdpMediaType::kAudio) {
+                mid = "audio";
+            } else {
+                mid = "data";
+            }
+        }
+        if (mid.empty() || !AddMedia(*sdp_info, mid, media)) {
+            mid = std::to_string(cur_media_id);
+            // taken by a mid carried before, numbers after the medias
+            for (size_t next = medias.size(); !AddMedia(*sdp_info, mid, media); next++) {
+                mid = std::to_string(next);
+            }
+        }
+        cur_media_id++;
+        sdp_info->GroupBundle.push_back(mid);
+
+        auto pos = encrypt_key->find(' ');
+        if (pos != std::string::npos) {
+            media->Fingerprint.first.assign(*encrypt_key, 0, pos);
+            media->Fingerprint.second.assign(*encrypt_key, pos + 1, std::string::npos);
+        }
+    }
+    EndSessionDescription(*sdp_info);
+
+    if (ip_addr.empty()) {
+        ip_addr = sdp_info->AddrType == SdpAddrType::kIPv6 ? "::" : "0.0.0.0";
+    }
+    attr.version = Version();
+    attr.sdp_type = SdpType(hdr->sdp_type);
+    attr.seq = ntohs(hdr->seq);
+    attr.status_code = ntohs(hdr->status);
+    attr.is_imm_send = session_hdr->imm_send;
+    attr.is_support_aac_fmtp = true;
+    if (hdr->header_flag & kMiniV1HdrFlagDirection) {
+        attr.is_push = (hdr->header_flag & kMiniV1HdrFlagPush) ? kStreamPush : kStreamPull;
+    } else {
+        attr.is_push = kStreamDefault;
+    }
+    attr.stream_url.assign(kMiniSdpUrlPrefix).append(stream_url);
+    RenderSessionDescription(*sdp_info, attr.origin_sdp);
+    attr.svrsig.assign(ip_addr).append(":").append(ice_ufrag).append(":").append(svrsig);
+    return reader.Offset();
+}
+
+// ssrcs and payload types only, the same checks as loadMedia
+static bool peekMedia(BufferReader &reader, MiniSdpDispatchInfo::Media &media) {
+    const MiniSdpV1MediaHdr *media_hdr = reinterpret_cast<const MiniSdpV1MediaHdr*>(reader.Get(sizeof(MiniSdpV1MediaHdr)));
+    if (!media_hdr || media_hdr->media_type > uint8_t(SdpMediaType::kData)) return false;
+    media.media_type = SdpMediaType(media_hdr->media_type);
+    MiniV1CustomExt media_ext;
+    if (media_hdr->has_ext) readCustomExt(reader, media_ext);
+
+    std::vector<uint32_t> ssrcs;
+    for (uint8_t i = 0; i < media_hdr->track_num; i++) {
+        const MiniSdpV1Track *track = reinterpret_cast<const MiniSdpV1Track*>(reader.Get(sizeof(MiniSdpV1Track)));
+        if (!track) return false;
+        ssrcs.push_back(ntohl(track->ssrc));
+    }
+
+    for (uint8_t i = 0; i < media_hdr->codec_num; i++) {
+        const MiniSdpV1CodecDesc *desc = reinterpret_cast<const MiniSdpV1CodecDesc*>(reader.Get(sizeof(MiniSdpV1CodecDesc)));
+        if (!desc || (desc->has_ext && !skipCustomExt(reader))) return false;
+        if (desc->codec < mini_v1_codec_name_vec.size() && desc->frequency < mini_v1_frequency_vec.size()) {
+            media.payload_types.push_back(uint8_t(desc->payload_type + kMiniV1PayloadTypeBase) & 0x7F);
+        }
+    }
+
+    if (!reader.Get(media_hdr->rtp_ext_num * sizeof(MiniExtDesc))) return false;
+
+    const std::string *track_section = media_ext.GetStr(kMiniV1MediaStrTracks);
+    if (track_section) {
+        // groups and rids are not needed to dispatch
+        MediaDescription scratch;
+        BufferReader section_reader(track_section->data(), track_section->size());
+        if (!LoadMiniTrackSection(section_reader, ssrcs, scratch)) return false;
+    }
+    AppendDispatchSsrcs(ssrcs, 0, media.ssrcs);
+    return true;
+}
+
+int MiniSdpCodecV1::Peek(const char *buff, size_t len, MiniSdpDispatchInfo &info) const {
+    BufferReader reader(buff, len);
+    const MiniSdpV1Hdr *hdr = reinterpret_cast<const MiniSdpV1Hdr*>(reader.Get(sizeof(MiniSdpV1Hdr)));
+    if (!hdr || hdr->packet_type != kMiniSdpPacketType || memcmp(hdr->magic_word, kMiniSdpMagic, 3) != 0 ||
+        hdr->version != Version() || hdr->sdp_type > uint8_t(SdpType::kSdpNone)) {
+        return 0;
+    }
+    const MiniSdpV1SessionHdr *session_hdr =
+        reinterpret_cast<const MiniSdpV1SessionHdr*>(reader.Get(sizeof(MiniSdpV1SessionHdr)));
+    if (!session_hdr) return 0;
+    for (uint8_t i = 0; i < session_hdr->candidate_num; i++) {
+        const MiniSdpV1Candidate *candidate =
+            reinterpret_cast<const MiniSdpV1Candidate*>(reader.Get(sizeof(MiniSdpV1Candidate)));
+        if (!candidate) return 0;
+        reader.Get(candidate->ip_type ? IPV6_ADDR_LEN : sizeof(uint32_t));
+    }
+
+    uint8_t media_num = reader.GetU8();
+    MiniV1CustomExt session_ext;
+    readCustomExt(reader, session_ext);
+    if (reader.Failed()) return 0;
+
+    info.medias.resize(media_num);
+    for (auto &media : info.medias) {
+        media = MiniSdpDispatchInfo::Media();
+        if (!peekMedia(reader, media)) return 0;
+    }
+
+    if (session_ext.HasBit(kMiniV1SessionBitBinaryKey)) {
+        const std::string *binary_key = session_ext.GetStr(kMiniV1SessionStrEncryptKey);
+        std::string fingerprint;
+        if (!LoadMiniFingerprint(binary_key ? *binary_key : std::string(), fingerprint)) return 0;
+    }
+
+    const std::string *stream_url = session_ext.GetStr(kMiniV1SessionStrStreamUrl);
+    info.version = Version();
+    info.sdp_type = SdpType(hdr->sdp_type);
+    info.seq = ntohs(hdr->seq);
+    info.is_imm_send = session_hdr->imm_send;
+    if (hdr->header_flag & kMiniV1HdrFlagDirection) {
+        info.is_push = (hdr->header_flag & kMiniV1HdrFlagPush) ? kStreamPush : kStreamPull;
+    } else {
+        info.is_push = kStreamDefault;
+    }
+    info.stream_url.assign(kMiniSdpUrlPrefix);
+    if (stream_url) info.stream_url.append(*stream_url);
+    return reader.Offset();
+}
+
+size_t MiniSdpCodecV1::CodecSize(const CodecDescription &codec, bool /*is_support_aac_fmtp*/) const {
+    std::string bytes;
+    return packCodec(codec, bytes) ? bytes.size() : 0;
+}
+
+size_t MiniSdpCodecV1::ExtSize(const std::string &uri) const {
+    uint8_t mini_uri;
+    return PackMiniExtUri(uri, mini_uri) ? sizeof(MiniExtDesc) : 0;
+}
+
+size_t MiniSdpCodecV1::TrackSize(size_t track_idx) const {
+    // tracks beyond kMiniV1MaxTrackNum are in the track section
+    return track_idx < kMiniV1MaxTrackNum ? sizeof(MiniSdpV1Track) : sizeof(uint32_t);
+}
+
+}  // namespace mini_sdp
@@ -0,0 +1,169 @@
+/**
+ * @file mini_sdp/mini_sdp_v1.h
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#ifndef MINI_SDP_MINI_SDP_V1_H_
+#define MINI_SDP_MINI_SDP_V1_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "mini_sdp_codec.h"
+
+namespace mini_sdp {
+
+/*
+ * mini sdp v1，参考 mini_sdp_spec_v1.pdf
+ *  mini_sdp header | session header | candidates | media_num | session_custom_extense | media * n
+ *  media: media header | media_custom_extense | tracks | codecs | rtp_extenses
+ *
+ * 规范未明确之处：
+ *  - custom_extense: custom_ext_total_len 为 key-value 个数，bit_map 低位在前
+ *  - payload_type: 7 位存储 (pt - 98) mod 128
+ *  - header_flag: 见 kMiniV1HdrFlag*
+ *  - session bit_map: 见 kMiniV1SessionBit*
+ *  - auth_digest 为空时不携带
+ *  - 超过 127 个的 track 以及 ssrc-group / rid / simulcast 由 media custom_extense 中的 track section 携带
+ */
+
+struct MiniSdpV1Hdr {
+    uint8_t     packet_type;
+    char        magic_word[3];      // "SDP"
+    uint8_t     version;            // 1
+    uint16_t    sub_version;
+
+    uint8_t     sdp_type        : 2;
+    uint8_t     plan_type       : 1;    // 0-plan-b，1-unified-plan
+    uint8_t     header_flag     : 5;
+
+    uint16_t    seq;
+    uint16_t    status;
+} __attribute__((packed));
+
+constexpr uint8_t kMiniV1HdrFlagNotSeqAlign = 0x1;
+constexpr uint8_t kMiniV1HdrFlagDirection   = 0x2;  // 设置了推拉流方向
+constexpr uint8_t kMiniV1HdrFlagPush        = 0x4;  // 推流
+constexpr uint8_t kMiniV1HdrFlagIpv6        = 0x8;  // SDP 地址类型
+
+struct MiniSdpV1SessionHdr {
+    uint8_t     encrypt_switch  : 1;
+    uint8_t     has_candidate   : 1;
+    uint8_t     is_string_bundle: 1;
+    uint8_t     imm_send        : 1;
+    uint8_t     role            : 2;    // 0-actpass，1-active，2-passive
+    uint8_t     direction       : 2;    // 0-sendonly，1-recvonly，2-sendrecv
+
+    uint8_t     candidate_num;
+    uint8_t     reversed;
+} __attribute__((packed));
+
+struct MiniSdpV1Candidate {
+    uint8_t     ip_type         : 1;    // 0-ipv4，1-ipv6
+    uint8_t     candidate_flag  : 7;
+    uint16_t    candidate_port;
+    // candidate_ip: 4B ipv4 / 16B ipv6
+} __attribute__((packed));
+
+struct MiniSdpV1MediaHdr {
+    uint8_t     has_ext         : 1;
+    uint8_t     track_num       : 7;
+    uint8_t     media_type      : 2;
+    uint8_t     codec_num       : 6;
+    uint8_t     rtp_ext_num;
+} __attribute__((packed));
+
+struct MiniSdpV1Track {
+    uint32_t    ssrc;
+    uint8_t     track_order;
+    uint8_t     media_stream_id;
+} __attribute__((packed));
+
+struct MiniSdpV1CodecDesc {
+    uint8_t     codec           : 4;
+    uint8_t     frequency       : 4;
+    uint8_t     payload_type    : 7;
+    uint8_t     has_ext         : 1;
+    uint8_t     channels        : 2;
+    uint8_t     reversed        : 6;
+} __attribute__((packed));
+
+// session custom extense
+constexpr uint8_t kMiniV1SessionBitBinaryKey    = 0;    // encrypt_key 为 <hash id:1><digest>
+
+constexpr uint8_t kMiniV1SessionStrIceUfrag     = 0;
+constexpr uint8_t kMiniV1SessionStrIcePwd       = 1;
+constexpr uint8_t kMiniV1SessionStrEncryptKey   = 2;
+constexpr uint8_t kMiniV1SessionStrSvrSig       = 3;
+constexpr uint8_t kMiniV1SessionStrStreamUrl    = 4;
+constexpr uint8_t kMiniV1SessionStrAuthDigest   = 5;
+
+// media custom extense
+constexpr uint8_t kMiniV1MediaStrBitrate        = 0;    // uint32_t
+constexpr uint8_t kMiniV1MediaStrTracks         = 1;    // track section，见 mini_sdp_impl.h
+
+// codec custom extense
+constexpr uint8_t kMiniV1CodecBitNack           = 0;
+constexpr uint8_t kMiniV1CodecBitFlexFec        = 1;
+constexpr uint8_t kMiniV1CodecBitTransportCc    = 2;
+constexpr uint8_t kMiniV1CodecBitRemb           = 3;
+constexpr uint8_t kMiniV1CodecBitBFrameEnable   = 4;
+constexpr uint8_t kMiniV1CodecBitPsEnable       = 5;
+constexpr uint8_t kMiniV1CodecBitSbrEnable      = 6;
+constexpr uint8_t kMiniV1CodecBitStereo         = 7;
+constexpr uint8_t kMiniV1CodecBitCPresent       = 8;
+constexpr uint8_t kMiniV1CodecBitUseInbandFec   = 9;
+
+constexpr uint8_t kMiniV1CodecStrObject         = 1;    // uint32_t
+constexpr uint8_t kMiniV1CodecStrConfig         = 2;
+
+/**
+ * @brief Custom Extense
+ *  bit_map + key-value，session/media/codec 共用
+ */
+struct MiniV1CustomExt {
+    uint32_t                                    bit_map = 0;
+    std::vector<std::pair<uint8_t, std::string>> strs;
+
+    bool Empty() const { return bit_map == 0 && strs.empty(); }
+
+    bool HasBit(uint8_t bit) const { return bit_map & (1u << bit); }
+
+    void SetBit(uint8_t bit) { bit_map |= (1u << bit); }
+
+    // nullptr if not found
+    const std::string* GetStr(uint8_t id) const;
+
+    void SetU32(uint8_t id, uint32_t value);
+
+    uint32_t GetU32(uint8_t id, uint32_t def_val) const;
+};  // struct MiniV1CustomExt
+
+/**
+ * @brief Codec v1
+ */
+class MiniSdpCodecV1 : public MiniSdpCodec {
+  public:
+    uint8_t Version() const override { return 1; }
+
+    int Pack(const OriginSdpAttr &attr, SessionDescriptionPtr sdp_info, char *buff, size_t len) const override;
+
+    int Load(const char *buff, size_t len, OriginSdpAttr &attr) const override;
+
+    int Peek(const char *buff, size_t len, MiniSdpDispatchInfo &info) const override;
+
+    // aac config is always carried in v1
+    size_t CodecSize(const CodecDescription &codec, bool is_support_aac_fmtp) const override;
+
+    size_t ExtSize(const std::string &uri) const override;
+
+    size_t TrackSize(size_t track_idx) const override;
+};  // class MiniSdpCodecV1
+
+}  // namespace mini_sdp
+
+#endif  // MINI_SDP_MINI_SDP_V1_H_
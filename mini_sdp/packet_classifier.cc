@@ -0,0 +1,134 @@
+/**
+ * @file mini_sdp/packet_classifier.cc
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include "packet_classifier.h"
+#include "mini_sdp_impl.h"
+
+namespace mini_sdp {
+
+static const char* g_class_names[kPacketClassNum] = {
+    "unknown", "stun", "zrtp", "dtls", "turn_channel", "rtp", "rtcp",
+    "mini_sdp_req", "mini_sdp_stop", "mini_sdp_frag", "mini_sdp_delta"
+};
+
+const char* PacketClassName(PacketClass cls) {
+    return cls < kPacketClassNum ? g_class_names[cls] : "unknown";
+}
+
+namespace {
+
+constexpr uint32_t magicWord(char a, char b, char c) {
+    return uint32_t(uint8_t(a)) << 16 | uint32_t(uint8_t(b)) << 8 | uint8_t(c);
+}
+
+/**
+ * @brief Classifier Tables
+ *  - first: 首字节 -> 协议，RTP/RTCP 统一为 kPacketRtp，mini sdp 统一为 kPacketMiniSdpReq，由第二阶段细分
+ *  - rtp: 第二字节 -> kPacketRtp / kPacketRtcp
+ *  - min_len: 各协议的最小长度，STUN 头 20，DTLS 记录头 13，RTP 头 12，RTCP 头 8
+ */
+struct ClassifierTables {
+    uint8_t     first[256];
+    uint8_t     rtp[256];
+    uint8_t     min_len[kPacketClassNum];
+
+    ClassifierTables() {
+        for (int byte = 0; byte < 256; byte++) {
+            PacketClass cls = kPacketUnknown;
+            if (byte <= 3) {
+                cls = kPacketStun;
+            } else if (byte >= 16 && byte <= 19) {
+                cls = kPacketZrtp;
+            } else if (byte >= 20 && byte <= 63) {
+                cls = kPacketDtls;
+            } else if (byte >= 64 && byte <= 79) {
+                cls = kPacketTurnChannel;
+            } else if (byte >= 128 && byte <= 191) {
+                cls = kPacketRtp;
+            } else if (byte == kMiniSdpPacketType) {
+                cls = kPacketMiniSdpReq;
+            }
+            first[byte] = cls;
+            rtp[byte] = byte >= 192 && byte <= 223 ? kPacketRtcp : kPacketRtp;
+        }
+        const uint8_t lens[kPacketClassNum] = {0, 20, 12, 13, 4, 12, 8, 4, 4, 4, 4};
+        for (int cls = 0; cls < kPacketClassNum; cls++) min_len[cls] = lens[cls];
+    }
+};  // struct ClassifierTables
+
+const ClassifierTables g_tables;
+
+// 只有查表和条件选择，编译为 cmov，批量处理时没有难以预测的分支
+inline uint8_t classify(const uint8_t* bytes, size_t len) {
+    if (len < 4) return kPacketUnknown;
+    uint8_t cls = g_tables.first[bytes[0]];
+    uint8_t rtp_cls = g_tables.rtp[bytes[1]];
+    uint32_t magic = uint32_t(bytes[1]) << 16 | uint32_t(bytes[2]) << 8 | bytes[3];
+    uint8_t sdp_cls = magic == magicWord('S', 'D', 'P') ? kPacketMiniSdpReq
+                    : magic == magicWord('S', 'T', 'P') ? kPacketMiniSdpStop
+                    : magic == magicWord('F', 'R', 'G') ? kPacketMiniSdpFrag
+                    : magic == magicWord('D', 'L', 'T') ? kPacketMiniSdpDelta
+                    : kPacketUnknown;
+    cls = cls == kPacketRtp ? rtp_cls : cls;
+    cls = cls == kPacketMiniSdpReq ? sdp_cls : cls;
+    return len < g_tables.min_len[cls] ? uint8_t(kPacketUnknown) : cls;
+}
+
+/*
+ * 先逐包分类并计数，再按计数排出各队列的起始位置，最后稳定地写入下标（计数排序）
+ */
+template <typename GetPacket>
+void classifyBatch(size_t num, PacketQueues& queues, const GetPacket& get_packet) {
+    queues.classes.resize(num);
+    queues.indexes.resize(num);
+
+    uint32_t counts[kPacketClassNum] = {};
+    for (size_t i = 0; i < num; i++) {
+        const uint8_t* data = nullptr;
+        size_t len = 0;
+        get_packet(i, data, len);
+        uint8_t cls = classify(data, len);
+        queues.classes[i] = cls;
+        counts[cls]++;
+    }
+
+    uint32_t pos[kPacketClassNum];
+    queues.offsets[0] = 0;
+    for (size_t cls = 0; cls < kPacketClassNum; cls++) {
+        pos[cls] = queues.offsets[cls];
+        queues.offsets[cls + 1] = queues.offsets[cls] + counts[cls];
+    }
+    for (size_t i = 0; i < num; i++) {
+        queues.indexes[pos[queues.classes[i]]++] = i;
+    }
+}
+
+}  // namespace
+
+PacketClass ClassifyPacket(const char* data, size_t len) {
+    return PacketClass(classify((const uint8_t*)data, len));
+}
+
+void ClassifyPacketBatch(const struct mmsghdr* msgs, size_t num, PacketQueues& queues) {
+    classifyBatch(num, queues, [msgs](size_t i, const uint8_t*& data, size_t& len) {
+        const struct msghdr& hdr = msgs[i].msg_hdr;
+        bool has_iov = hdr.msg_iovlen > 0;
+        data = has_iov ? (const uint8_t*)hdr.msg_iov[0].iov_base : nullptr;
+        len = has_iov && msgs[i].msg_len <= hdr.msg_iov[0].iov_len ? msgs[i].msg_len : 0;
+    });
+}
+
+void ClassifyPacketBatch(const struct iovec* packets, size_t num, PacketQueues& queues) {
+    classifyBatch(num, queues, [packets](size_t i, const uint8_t*& data, size_t& len) {
+        data = (const uint8_t*)packets[i].iov_base;
+        len = packets[i].iov_len;
+    });
+}
+
+}  // namespace mini_sdp
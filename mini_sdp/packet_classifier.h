@@ -0,0 +1,99 @@
+/**
+ * @file mini_sdp/packet_classifier.h
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#ifndef MINI_SDP_PACKET_CLASSIFIER_H_
+#define MINI_SDP_PACKET_CLASSIFIER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+namespace mini_sdp {
+
+/*
+ * 单端口收包分类
+ *  - mini sdp 信令与媒体共用一个 UDP 端口时，按 RFC 7983 的首字节范围区分各协议，
+ *    并增加 mini sdp 的 0xFF 类型：
+ *      0 ~ 3       STUN
+ *      16 ~ 19     ZRTP
+ *      20 ~ 63     DTLS
+ *      64 ~ 79     TURN Channel
+ *      128 ~ 191   RTP / RTCP，再按第二字节区分，192 ~ 223 为 RTCP (RFC 5761)
+ *      255         mini sdp，再按 magic word 区分请求、停流、分片、增量包
+ *  - 分类只查表和比较，不解析包体；长度不足各协议最小长度的包为 kPacketUnknown
+ */
+
+enum PacketClass {
+    kPacketUnknown = 0,
+    kPacketStun,
+    kPacketZrtp,
+    kPacketDtls,
+    kPacketTurnChannel,
+    kPacketRtp,
+    kPacketRtcp,
+    kPacketMiniSdpReq,      // IsMiniSdpReqPack
+    kPacketMiniSdpStop,     // IsMiniSdpStopPack
+    kPacketMiniSdpFrag,     // IsMiniSdpFragPack
+    kPacketMiniSdpDelta,    // IsMiniSdpDeltaPack
+    kPacketClassNum
+};
+
+const char* PacketClassName(PacketClass cls);
+
+/**
+ * @brief Classify Packet
+ *  判断单个 UDP 包的协议类型
+ * @param data
+ * @param len
+ * @return PacketClass
+ */
+PacketClass ClassifyPacket(const char* data, size_t len);
+
+/**
+ * @brief Packet Queues
+ *  一批包按协议分类后的结果
+ *  - 每个协议一个队列，队列元素为包在批内的下标，同一队列内保持接收顺序
+ *  - 内部 buffer 重复使用，批大小不超过历史最大值时不分配内存
+ */
+struct PacketQueues {
+    // class of each packet, in receiving order
+    std::vector<uint8_t>    classes;
+    // queue of cls is indexes[offsets[cls], offsets[cls + 1])
+    std::vector<uint32_t>   indexes;
+    uint32_t                offsets[kPacketClassNum + 1] = {};
+
+    size_t Size(PacketClass cls) const { return offsets[cls + 1] - offsets[cls]; }
+    const uint32_t* Begin(PacketClass cls) const { return indexes.data() + offsets[cls]; }
+    const uint32_t* End(PacketClass cls) const { return indexes.data() + offsets[cls + 1]; }
+};  // struct PacketQueues
+
+/**
+ * @brief Classify Packet Batch
+ *  对 recvmmsg 收到的一批包分类
+ *  - 每个包取 msg_iov[0] 的前 msg_len 字节，即每个 mmsghdr 只有一个 iovec 的常见用法
+ * @param msgs
+ * @param num 收到的包数，recvmmsg 的返回值
+ * @param queues
+ */
+void ClassifyPacketBatch(const struct mmsghdr* msgs, size_t num, PacketQueues& queues);
+
+/**
+ * @brief Classify Packet Batch
+ *  对一批包分类，每个 iovec 为一个完整的包
+ * @param packets
+ * @param num
+ * @param queues
+ */
+void ClassifyPacketBatch(const struct iovec* packets, size_t num, PacketQueues& queues);
+
+}  // namespace mini_sdp
+
+#endif  // MINI_SDP_PACKET_CLASSIFIER_H_
@@ -0,0 +1,90 @@
+/**
+ * @file mini_sdp/per_thread_stats.h
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#ifndef MINI_SDP_PER_THREAD_STATS_H_
+#define MINI_SDP_PER_THREAD_STATS_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace mini_sdp {
+
+// single writer counter, relaxed load + store instead of an atomic read-modify-write
+inline void StatsBump(std::atomic<uint64_t> &counter, uint64_t value = 1) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Per Thread Stats
+ *  按线程分片的统计数据，写入无锁，读取时才汇总
+ *  - Local() 返回当前线程的数据块，首次调用时创建并注册，只能由本线程写入
+ *  - Collect() 汇总所有存活线程及已退出线程的数据
+ *  - Block 需提供 void Snapshot(SnapshotT&) const，SnapshotT 需提供 void Merge(const SnapshotT&)
+ */
+template <class Block, class SnapshotT>
+class PerThreadStats {
+  public:
+    static Block& Local() {
+        static thread_local Holder holder;
+        return *holder.block;
+    }
+
+    static SnapshotT Collect() {
+        auto &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        SnapshotT total = reg.retired;
+        for (auto block : reg.blocks) {
+            SnapshotT snapshot;
+            block->Snapshot(snapshot);
+            total.Merge(snapshot);
+        }
+        return total;
+    }
+
+  private:
+    // live threads, and stats of exited threads
+    struct Registry {
+        std::mutex          mutex;
+        std::vector<Block*> blocks;
+        SnapshotT           retired;
+    };
+
+    static Registry& registry() {
+        // never destroyed, threads may exit after static destruction
+        static Registry* reg = new Registry();
+        return *reg;
+    }
+
+    struct Holder {
+        std::unique_ptr<Block> block;
+
+        Holder() : block(new Block()) {
+            auto &reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            reg.blocks.push_back(block.get());
+        }
+
+        ~Holder() {
+            auto &reg = registry();
+            SnapshotT snapshot;
+            block->Snapshot(snapshot);
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            reg.retired.Merge(snapshot);
+            reg.blocks.erase(std::remove(reg.blocks.begin(), reg.blocks.end(), block.get()), reg.blocks.end());
+        }
+    };
+};  // class PerThreadStats
+
+}  // namespace mini_sdp
+
+#endif  // MINI_SDP_PER_THREAD_STATS_H_
@@ -7,9 +7,11 @@
  * @copyright Copyright (c) 2021 Tencent. All rights reserved.
  * 
  */
+#include <algorithm>
 #include <sstream>
 #include "sdp.h"
 #include "sdp_parser.h"
+#include "stage_stats.h"
 
 namespace mini_sdp {
 
@@ -260,6 +262,14 @@ std::string MediaDescription::ToString() const {
             flex_fec_enable = true;
         }
     }
+    // simulcast
+    for (auto& rid : Rids) {
+        oss << "a=rid:" << rid.Id << ' ' << rid.Direction;
+        if (!rid.Params.empty()) oss << ' ' << rid.Params;
+        oss << kSdpEndOfLine;
+    }
+    if (!Simulcast.empty()) oss << "a=simulcast:" << Simulcast << kSdpEndOfLine;
+
     // tracks
     std::string ssrc_group;
     std::string ssrc_track;
@@ -271,7 +281,13 @@ std::string MediaDescription::ToString() const {
         }
     }
 
-    if (flex_fec_enable && Tracks.size()>1) {
+    if (!SsrcGroups.empty()) {
+        for (auto& group : SsrcGroups) {
+            oss << "a=ssrc-group:" << group.Semantics;
+            for (auto ssrc : group.Ssrcs) oss << ' ' << ssrc;
+            oss << kSdpEndOfLine;
+        }
+    } else if (flex_fec_enable && Tracks.size()>1) {
         ssrc_group = "a=ssrc-group:FEC-FR" + ssrc_group;
         oss << ssrc_group << kSdpEndOfLine;
     }
@@ -300,6 +316,7 @@ void SessionDescription::SetAttribute(const std::string& key, const std::string&
 }
 
 std::string SessionDescription::ToString() const {
+    StageTimer timer(SdpStage::kToString);
     std::ostringstream oss;
 
     // version
@@ -344,16 +361,20 @@ std::string SessionDescription::ToString() const {
             oss << media.second->ToString();
         }
     } else {
+        // entries of the bundle, sorted to be looked up by address
+        std::vector<const void*> used;
+        used.reserve(GroupBundle.size());
         for (auto& mid : GroupBundle) {
             auto it = Medias.find(mid);
             if (it != Medias.end()) {
                 oss << it->second->ToString();
+                used.push_back(&*it);
             }
         }
 
-        std::set<std::string> used_mid(GroupBundle.begin(), GroupBundle.end());
+        std::sort(used.begin(), used.end());
         for (auto& media : Medias) {
-            if (used_mid.count(media.first) == 0) {
+            if (!std::binary_search(used.begin(), used.end(), static_cast<const void*>(&media))) {
                 oss << media.second->ToString();
             }
         }
@@ -63,6 +63,9 @@ enum class SdpRoleType {
 
 using IpPort = std::pair<std::string, uint16_t>;
 
+// rebuilds descriptions in place, fields added to the classes below are also reset in sdp_recycler.cc
+class SdpRecycler;
+
 
 /**
  * @brief Codec Description
@@ -101,9 +104,13 @@ class CodecDescription {
 
     void SetAttribute(const std::string& key, const std::string& value);
 
+    const std::map<std::string, std::string>& GetAttributes() const { return attributes_; }
+
     std::string ToString() const;
 
   private:
+    friend class SdpRecycler;
+
     // all attributes: exclude a=rtcp and a=fmtp
     // a=<key>:<fmt> <value>
     std::map<std::string, std::string> attributes_;
@@ -138,9 +145,13 @@ class TrackDescription {
 
     void SetAttribute(const std::string& key, const std::string& value);
 
+    const std::map<std::string, std::string>& GetAttributes() const { return attributes_; }
+
     std::string ToString() const;
 
   private:
+    friend class SdpRecycler;
+
     // all attributes: exclude a=ssrc:<ssrc> cname
     // a=ssrc:<ssrc> <key>:<value>
     std::map<std::string, std::string> attributes_;
@@ -150,6 +161,25 @@ using TrackDescriptionPtr = std::shared_ptr<TrackDescription>;
 
 inline TrackDescriptionPtr MakeTrackDescription() { return std::make_shared<TrackDescription>(); }
 
+/**
+ * @brief Ssrc Group
+ *  a=ssrc-group:<semantics> <ssrc> ...
+ */
+struct SsrcGroup {
+    std::string             Semantics;  // SIM / FID / FEC-FR ...
+    std::vector<uint32_t>   Ssrcs;
+};  // struct SsrcGroup
+
+/**
+ * @brief Rid Description
+ *  a=rid:<id> <direction> [<params>]
+ */
+struct RidDescription {
+    std::string     Id;
+    std::string     Direction;  // send / recv
+    std::string     Params;     // pt=<fmt>,...;max-width=<value>;...
+};  // struct RidDescription
+
 
 /**
  * @brief Media Description
@@ -203,6 +233,16 @@ class MediaDescription {
 
     std::vector<uint32_t> TracksOrder;
 
+    // a=ssrc-group:<semantics> <ssrc> ...
+    // empty: FEC-FR of all tracks if flexfec is used, see ToString
+    std::vector<SsrcGroup> SsrcGroups;
+
+    // a=rid:<id> <direction> [<params>]
+    std::vector<RidDescription> Rids;
+
+    // a=simulcast:<value>
+    std::string   Simulcast;
+
     // a=fingerprint:<first:method> <second:value>
     std::pair<std::string, std::string> Fingerprint;
 
@@ -213,9 +253,13 @@ class MediaDescription {
 
     void SetAttribute(const std::string& key, const std::string& value);
 
+    const std::map<std::string, std::string>& GetAttributes() const { return attributes_; }
+
     std::string ToString() const;
   
   private:
+    friend class SdpRecycler;
+
     // a=<key>:<value>
     std::map<std::string, std::string> attributes_;
 };  // class MediaDescription
@@ -270,9 +314,13 @@ class SessionDescription {
 
     void SetAttribute(const std::string& key, const std::string& value);
 
+    const std::map<std::string, std::string>& GetAttributes() const { return attributes_; }
+
     std::string ToString() const;
 
   private:
+    friend class SdpRecycler;
+
     // a=<key>:<value>
     std::map<std::string, std::string> attributes_;
 };  // class SessionDescription
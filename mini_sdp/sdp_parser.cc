@@ -10,45 +10,65 @@
 #include <cstring>
 #include <limits>
 #include "sdp_parser.h"
+#include "sdp_recycler.h"
+#include "stage_stats.h"
 #include "util.h"
 
 namespace mini_sdp {
 
 constexpr size_t kSdpLineTypeSize = 2;
 
+template <typename Handle>
+struct AttrParseEntry {
+    Handle      handle;
+    SdpAttrId   id;
+};
+
 static
-std::unordered_map<std::string, SessionAttrParseHandle> g_sess_attr_parse_handles = {
-    {"group", SessionAttrParseGroup}
+std::unordered_map<std::string, AttrParseEntry<SessionAttrParseHandle>> g_sess_attr_parse_handles = {
+    {"group",       {SessionAttrParseGroup,     SdpAttrId::kGroup}}
 };
 
 static
-std::unordered_map<std::string, MediaAttrParseHandle> g_media_attr_parse_handles = {
-    {"ice-ufrag",   MediaAttrParseIceUfrag},
-    {"ice-pwd",     MediaAttrParseIcePwd},
-    {"ice-options", MediaAttrParseIceOptions},
-    {"fingerprint", MediaAttrParseFingerprint},
-    {"setup",       MediaAttrParseSetup},
-    {"mid",         MediaAttrParseMid},
-    {"extmap",      MediaAttrParseExtmap},
-    {"sendrecv",    MediaAttrParseTransType},
-    {"sendonly",    MediaAttrParseTransType},
-    {"recvonly",    MediaAttrParseTransType},
-    {"inactive",    MediaAttrParseTransType},
-    {"rtpmap",      MediaAttrParseRtpmap},
-    {"rtcp-fb",     MediaAttrParseRtcpFb},
-    {"fmtp",        MediaAttrParseFmtp},
-    {"ssrc",        MediaAttrParseSsrc},
-    {"candidate",   MediaAttrParseCandidate},
-    {"msid",        MediaAttrParseMsid}
+std::unordered_map<std::string, AttrParseEntry<MediaAttrParseHandle>> g_media_attr_parse_handles = {
+    {"ice-ufrag",   {MediaAttrParseIceUfrag,    SdpAttrId::kIceUfrag}},
+    {"ice-pwd",     {MediaAttrParseIcePwd,      SdpAttrId::kIcePwd}},
+    {"ice-options", {MediaAttrParseIceOptions,  SdpAttrId::kIceOptions}},
+    {"fingerprint", {MediaAttrParseFingerprint, SdpAttrId::kFingerprint}},
+    {"setup",       {MediaAttrParseSetup,       SdpAttrId::kSetup}},
+    {"mid",         {MediaAttrParseMid,         SdpAttrId::kMid}},
+    {"extmap",      {MediaAttrParseExtmap,      SdpAttrId::kExtmap}},
+    {"sendrecv",    {MediaAttrParseTransType,   SdpAttrId::kDirection}},
+    {"sendonly",    {MediaAttrParseTransType,   SdpAttrId::kDirection}},
+    {"recvonly",    {MediaAttrParseTransType,   SdpAttrId::kDirection}},
+    {"inactive",    {MediaAttrParseTransType,   SdpAttrId::kDirection}},
+    {"rtpmap",      {MediaAttrParseRtpmap,      SdpAttrId::kRtpmap}},
+    {"rtcp-fb",     {MediaAttrParseRtcpFb,      SdpAttrId::kRtcpFb}},
+    {"fmtp",        {MediaAttrParseFmtp,        SdpAttrId::kFmtp}},
+    {"ssrc",        {MediaAttrParseSsrc,        SdpAttrId::kSsrc}},
+    {"ssrc-group",  {MediaAttrParseSsrcGroup,   SdpAttrId::kSsrcGroup}},
+    {"rid",         {MediaAttrParseRid,         SdpAttrId::kRid}},
+    {"simulcast",   {MediaAttrParseSimulcast,   SdpAttrId::kSimulcast}},
+    {"candidate",   {MediaAttrParseCandidate,   SdpAttrId::kCandidate}},
+    {"msid",        {MediaAttrParseMsid,        SdpAttrId::kMsid}}
 };
 
+static const char* g_attr_names[size_t(SdpAttrId::kAttrNum)] = {
+    "", "group", "ice-ufrag", "ice-pwd", "ice-options", "fingerprint", "setup", "mid", "extmap", "direction",
+    "rtpmap", "rtcp-fb", "fmtp", "ssrc", "ssrc-group", "rid", "simulcast", "candidate", "msid"
+};
+
+const char* SdpAttrName(SdpAttrId id) {
+    return id < SdpAttrId::kAttrNum ? g_attr_names[size_t(id)] : "";
+}
+
 std::pair<SdpAddrType, bool> ParseSdpAddrType(const char* word, size_t len) {
     std::pair<SdpAddrType, bool> rpair;
     rpair.second = true;
     if (IsStrEqual(word, len, kSdpAddrIP4, sizeof(kSdpAddrIP4) - 1)) {
         rpair.first = SdpAddrType::kIPv4;
     } else if (IsStrEqual(word, len, kSdpAddrIP6, sizeof(kSdpAddrIP6) - 1)) {
-        rpair.first = SdpAddrType::kIPv4;
+        rpair.first = SdpAddrType::kIPv6;
     } else {
         rpair.second = false;
     }
@@ -103,7 +123,7 @@ std::pair<SdpRoleType, bool> ParseSdpRoleType(const char* word, size_t len) {
 }
 
 SdpParser::SdpParser(const char* data, size_t length)
-: data_(data), length_(length), stat_info_(StatCode::kNotParsed, "") {
+: begin_(data), data_(data), length_(length) {
     // nothing
 }
 
@@ -112,21 +132,43 @@ SdpParser::~SdpParser() {
 }
 
 bool SdpParser::Parse() {
-    sd_ptr_ = MakeSessionDescription();
+    StageTimer timer(SdpStage::kParse);
+    sd_ptr_ = BeginSessionDescription();
     while (loadNextLine()) {
-        if (!parseLine()) return false;
+        if (!parseLine()) {
+            RecordParseStat(int(error_.code));
+            return false;
+        }
     }
     // append the last media
     if (isInMediaLevel()) appendMedia();
+    EndSessionDescription(*sd_ptr_);
+    error_ = ErrorInfo();
+    error_.code = StatCode::kSuccess;
+    RecordParseStat(int(StatCode::kSuccess));
     return true;
 }
 
-void SdpParser::setStatInfo(StatCode code, const std::string& msg, size_t line) {
-    if (line != 0) {
-        stat_info_ = std::make_pair(code, msg + ", line " + std::to_string(line));
-    } else {
-        stat_info_ = std::make_pair(code, msg);
+void SdpParser::setError(StatCode code, const char* reason, SdpAttrId attr) {
+    error_.code = code;
+    error_.reason = reason;
+    error_.line = line_idx_;
+    error_.offset = line_data_ - begin_;
+    error_.length = line_length_;
+    error_.attr = attr;
+}
+
+std::string SdpParser::FormatError() const {
+    std::string text = error_.reason;
+    if (error_.line == 0) return text;
+    text += ", line " + std::to_string(error_.line) + ", offset " + std::to_string(error_.offset);
+    if (error_.attr != SdpAttrId::kNone) {
+        text += ", a=";
+        text += SdpAttrName(error_.attr);
     }
+    text += ": ";
+    text.append(begin_ + error_.offset, error_.length);
+    return text;
 }
 
 bool SdpParser::loadNextLine() {
@@ -168,7 +210,7 @@ bool SdpParser::parseLine() {
     case 'u': return true;  // Uri
     case 'z': return true;  // Time Zone
     default:
-        setStatInfo(StatCode::kUnknownLine, "unknown line", line_idx_);
+        setError(StatCode::kUnknownLine, "unknown line");
         return false;
     }
     return true;
@@ -176,17 +218,15 @@ bool SdpParser::parseLine() {
 
 bool SdpParser::parseLineOrigin() {
     // o=<username> <sess-id> <sess-version> <nettype> <addrtype> <unicast-address>
-    std::vector<StrSlice> slices = StrSplit(line_data_ + kSdpLineTypeSize,
-                                            line_length_ - kSdpLineTypeSize,
-                                            ' ');
-    if (slices.size() != 6) {
-        setStatInfo(StatCode::kFormatError, "format error", line_idx_);
+    StrSlice slices[6];
+    if (StrSplit(line_data_ + kSdpLineTypeSize, line_length_ - kSdpLineTypeSize, ' ', slices, 6) != 6) {
+        setError(StatCode::kFormatError, "format error");
         return false;
     }
 
-    sd_ptr_->UserName       = slices[0].ToString();
-    sd_ptr_->SessionId      = slices[1].ToString();
-    sd_ptr_->SessionVersion = slices[2].ToString();
+    sd_ptr_->UserName.assign(slices[0].ptr, slices[0].len);
+    sd_ptr_->SessionId.assign(slices[1].ptr, slices[1].len);
+    sd_ptr_->SessionVersion.assign(slices[2].ptr, slices[2].len);
 
     auto raddr  = ParseSdpAddrType(slices[4].ptr, slices[4].len);
     if (raddr.second) {
@@ -194,7 +234,7 @@ bool SdpParser::parseLineOrigin() {
     }
 
     if (!raddr.second) {
-        setStatInfo(StatCode::kParamError, "param error", line_idx_);
+        setError(StatCode::kParamError, "param error");
         return false;
     }
 
@@ -202,30 +242,32 @@ bool SdpParser::parseLineOrigin() {
 }
 
 bool SdpParser::parseLineSessionName() {
-    sd_ptr_->UserName = std::string(line_data_ + kSdpLineTypeSize, line_length_ - kSdpLineTypeSize);
+    sd_ptr_->UserName.assign(line_data_ + kSdpLineTypeSize, line_length_ - kSdpLineTypeSize);
     return true;
 }
 
 bool SdpParser::parseLineSessionInfo() {
-    sd_ptr_->SessionInfo = std::string(line_data_ + kSdpLineTypeSize, line_length_ - kSdpLineTypeSize);
+    sd_ptr_->SessionInfo.assign(line_data_ + kSdpLineTypeSize, line_length_ - kSdpLineTypeSize);
     return true;
 }
 
 bool SdpParser::parseLineConnection() {
     // c=<nettype> <addrtype> <connection-address>
-    std::vector<StrSlice> slices = StrSplit(line_data_ + kSdpLineTypeSize,
-                                            line_length_ - kSdpLineTypeSize,
-                                            ' ');
+    StrSlice slices[2];
+    if (StrSplit(line_data_ + kSdpLineTypeSize, line_length_ - kSdpLineTypeSize, ' ', slices, 2) < 2) {
+        setError(StatCode::kFormatError, "format error");
+        return false;
+    }
     auto raddr = ParseSdpAddrType(slices[1].ptr, slices[1].len);
     if (!raddr.second) {
-        setStatInfo(StatCode::kParamError, "param error", line_idx_);
+        setError(StatCode::kParamError, "param error");
         return false;
     }
 
     if (isInMediaLevel()) {
         cur_media_ptr_->AddrType = raddr.first;
     } else if (sd_ptr_->AddrType != raddr.first) {
-        setStatInfo(StatCode::kParamError, "addr type conflict", line_idx_);
+        setError(StatCode::kParamError, "addr type conflict");
         return false;
     }
 
@@ -234,30 +276,36 @@ bool SdpParser::parseLineConnection() {
 
 bool SdpParser::parseLineMedia() {
     // m=<media> <port> <proto> <fmt>
-    std::vector<StrSlice> slices = StrSplit(line_data_ + kSdpLineTypeSize,
-                                            line_length_ - kSdpLineTypeSize,
-                                            ' ');
-    if (slices.size() < 4) {
-        setStatInfo(StatCode::kFormatError, "format error", line_idx_);
+    StrSlice slices[4];
+    if (StrSplit(line_data_ + kSdpLineTypeSize, line_length_ - kSdpLineTypeSize, ' ', slices, 4) < 4) {
+        setError(StatCode::kFormatError, "format error");
         return false;
     }
 
     auto rmedia = ParseSdpMediaType(slices[0].ptr, slices[0].len);
     if (!rmedia.second) {
-        setStatInfo(StatCode::kParamError, "media type not supported", line_idx_);
+        setError(StatCode::kParamError, "media type not supported");
+        return false;
+    }
+
+    // <port>[/<number of ports>]
+    uint64_t port = 0;
+    const char* port_end = StrParseUint(slices[1].ptr, slices[1].len, std::numeric_limits<uint16_t>::max(), port);
+    if (port_end == nullptr || (port_end != slices[1].ptr + slices[1].len && *port_end != '/')) {
+        setError(StatCode::kParamError, "port error");
         return false;
     }
 
     // append pre media
     if (isInMediaLevel()) appendMedia();
 
-    cur_media_ptr_ = MakeMediaDescription();
+    cur_media_ptr_ = NewMediaDescription();
     cur_media_ptr_->MediaType = rmedia.first;
-    cur_media_ptr_->Port      = atoi(slices[1].ptr);
-    cur_media_ptr_->Protos    = slices[2].ToString();
+    cur_media_ptr_->Port      = uint16_t(port);
+    cur_media_ptr_->Protos.assign(slices[2].ptr, slices[2].len);
 
     if (rmedia.first == SdpMediaType::kData) {
-        cur_media_ptr_->MediaName = slices[3].ToString();
+        cur_media_ptr_->MediaName.assign(slices[3].ptr, slices[3].len);
     }
 
     return true;
@@ -273,30 +321,22 @@ bool SdpParser::parseLineAttribute() {
     if (isInSessionLevel()) {
         auto it = g_sess_attr_parse_handles.find(key);
         if (it != g_sess_attr_parse_handles.end()) {
-            if (!(it->second)(sd_ptr_, std::move(key), data, len)) {
-                std::string errmsg = std::string(line_data_, line_length_);
-                errmsg += ": param error";
-                setStatInfo(StatCode::kParamError, errmsg, line_idx_);
+            if (!it->second.handle(sd_ptr_, std::move(key), data, len)) {
+                setError(StatCode::kParamError, "param error", it->second.id);
                 return false;
             }
-        } else if (data != nullptr) {
-            sd_ptr_->SetAttribute(key, std::string(data, len));
         } else {
-            sd_ptr_->SetAttribute(key, "");
+            SetAttribute(*sd_ptr_, key.data(), key.size(), data ? data : "", len);
         }
     } else {
         auto it = g_media_attr_parse_handles.find(key);
         if (it != g_media_attr_parse_handles.end()) {
-            if (!(it->second)(cur_media_ptr_, std::move(key), data, len)) {
-                std::string errmsg = std::string(line_data_, line_length_);
-                errmsg += ": param error";
-                setStatInfo(StatCode::kParamError, errmsg, line_idx_);
+            if (!it->second.handle(cur_media_ptr_, std::move(key), data, len)) {
+                setError(StatCode::kParamError, "param error", it->second.id);
                 return false;
             }
-        } else if (data != nullptr) {
-            cur_media_ptr_->SetAttribute(key, std::string(data, len));
         } else {
-            cur_media_ptr_->SetAttribute(key, "");
+            SetAttribute(*cur_media_ptr_, key.data(), key.size(), data ? data : "", len);
         }
     }
 
@@ -304,21 +344,29 @@ bool SdpParser::parseLineAttribute() {
 }
 
 void SdpParser::appendMedia() {
-    std::string mid = cur_media_ptr_->MediaId;
-    if (mid.empty()) mid = std::to_string(cur_media_id_++);
-    while (sd_ptr_->Medias.count(mid) > 0) {
-        mid = std::to_string(cur_media_id_++);
+    // codecs referred by a=rtcp-fb / a=fmtp without a=rtpmap
+    for (auto it = cur_media_ptr_->Codecs.begin(); it != cur_media_ptr_->Codecs.end();) {
+        if (it->second->Name.empty()) {
+            it = cur_media_ptr_->Codecs.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    if (!cur_media_ptr_->MediaId.empty() && AddMedia(*sd_ptr_, cur_media_ptr_->MediaId, cur_media_ptr_)) return;
+    while (!AddMedia(*sd_ptr_, std::to_string(cur_media_id_++), cur_media_ptr_)) {
+        // the next id
     }
-    sd_ptr_->Medias.emplace(mid, cur_media_ptr_);
 }
 
 bool SessionAttrParseGroup(SessionDescriptionPtr sess, std::string&& key, const char* data, size_t len) {
     // a=group:BUNDLE <mid> <mid>
-    std::vector<StrSlice> slices = StrSplit(data, len, ' ');
-    if (slices.size() <= 1) return true;
+    StrSplitter splitter(data, len, ' ');
+    StrSlice slice;
+    if (!splitter.Next(slice)) return true;
 
-    for (size_t idx = 1; idx < slices.size(); idx++) {
-        sess->GroupBundle.emplace_back(slices[idx].ptr, slices[idx].len);
+    while (splitter.Next(slice)) {
+        sess->GroupBundle.emplace_back(slice.ptr, slice.len);
     }
     return true;
 }
@@ -343,12 +391,13 @@ bool MediaAttrParseIceOptions(MediaDescriptionPtr media, std::string&& key, cons
 
 bool MediaAttrParseFingerprint(MediaDescriptionPtr media, std::string&& key, const char* data, size_t len) {
     // a=fingerprint
-    std::vector<StrSlice> slices = StrSplit(data, len, ' ');
+    StrSlice slices[2];
+    size_t num = StrSplit(data, len, ' ', slices, 2);
 
-    if (slices.size() > 0) {
+    if (num > 0) {
         media->Fingerprint.first.assign(slices[0].ptr, slices[0].len);
     }
-    if (slices.size() > 1) {
+    if (num > 1) {
         media->Fingerprint.second.assign(slices[1].ptr, slices[1].len);
     }
     return true;
@@ -369,12 +418,13 @@ bool MediaAttrParseMid(MediaDescriptionPtr media, std::string&& key, const char*
 }
 
 bool MediaAttrParseExtmap(MediaDescriptionPtr media, std::string&& key, const char* data, size_t len) {
-    // a=extmap:<id> <uri>
-    std::vector<StrSlice> slices = StrSplit(data, len, ' ');
-    if (slices.size() != 2) return false;
-    int64_t id = atoi(slices[0].ptr);
-    if (id < 0 || id > 255) return false;
-    media->ExtMap.emplace((uint8_t)id, slices[1].ToString());
+    // a=extmap:<id>[/<direction>] <uri>
+    StrSlice slices[2];
+    if (StrSplit(data, len, ' ', slices, 2) != 2) return false;
+    uint64_t id = 0;
+    const char* id_end = StrParseUint(slices[0].ptr, slices[0].len, 255, id);
+    if (id_end == nullptr || (id_end != slices[0].ptr + slices[0].len && *id_end != '/')) return false;
+    AddExtMap(*media, (uint8_t)id, slices[1].ptr, slices[1].len);
     return true;
 }
 
@@ -388,64 +438,64 @@ bool MediaAttrParseTransType(MediaDescriptionPtr media, std::string&& key, const
 
 bool MediaAttrParseRtpmap(MediaDescriptionPtr media, std::string&& key, const char* data, size_t len) {
     // a=rtpmap:<fmt> <name>/<sample_rate>[/<channels>]
-    std::vector<StrSlice> slices = StrSplit(data, len, ' ');
-    if (slices.size() != 2) return false;
-    
-    int64_t fmt = atoi(slices[0].ptr);
-    if (fmt < 0 || fmt > 255) return false;
-
-    std::vector<StrSlice> codec_slices = StrSplit(slices[1].ptr, slices[1].len, '/');
-    if (codec_slices.size() < 2) return false;
-
-    auto codec = MakeCodecDescription();
-    codec->Format = fmt;
-    codec->Name = codec_slices[0].ToString();
-    codec->SampleRate = atol(codec_slices[1].ptr);
-
-    if (codec_slices.size() > 2) {
-        codec->Channels = atol(codec_slices[2].ptr);
-    }
+    StrSlice slices[2];
+    if (StrSplit(data, len, ' ', slices, 2) != 2) return false;
+
+    uint64_t fmt = 0;
+    if (!StrToUint(slices[0], 255, fmt)) return false;
+
+    StrSlice codec_slices[3];
+    size_t codec_num = StrSplit(slices[1].ptr, slices[1].len, '/', codec_slices, 3);
+    if (codec_num < 2) return false;
+
+    uint64_t sample_rate = 0, channels = 0;
+    if (!StrToUint(codec_slices[1], std::numeric_limits<uint32_t>::max(), sample_rate)) return false;
+    if (codec_num > 2 && !StrToUint(codec_slices[2], std::numeric_limits<uint16_t>::max(), channels)) return false;
+
+    // a=rtcp-fb / a=fmtp may come before a=rtpmap (firefox), codec without name is removed in appendMedia
+    auto codec = FindOrAddCodec(*media, fmt);
+    codec->Name.assign(codec_slices[0].ptr, codec_slices[0].len);
+    codec->SampleRate = uint32_t(sample_rate);
 
-    media->Codecs.emplace(fmt, codec);
+    if (codec_num > 2) {
+        codec->Channels = uint16_t(channels);
+    }
 
     return true;
 }
 
 bool MediaAttrParseRtcpFb(MediaDescriptionPtr media, std::string&& key, const char* data, size_t len) {
     // a=rtcp-fb:<fmt> <value>
-    auto rpair = StrGetFirstSplit(data, len, ' ');
-    if (rpair.second == nullptr) return false;
-
-    int64_t fmt = stol(rpair.first);
-    if (fmt < 0 || fmt > 255) return false;
+    const char* pos = (const char*)memchr(data, ' ', len);
+    if (pos == nullptr) return false;
 
-    auto it = media->Codecs.find(fmt);
-    if (it == media->Codecs.end()) return false;
+    uint64_t fmt = 0;
+    if (!StrToUint(data, pos - data, 255, fmt)) return false;
 
-    it->second->Feedbacks.emplace(rpair.second, data + len - rpair.second);
+    auto codec = FindOrAddCodec(*media, fmt);
+    AddFeedback(*codec, pos + 1, data + len - pos - 1);
 
     return true;
 }
 
 bool MediaAttrParseFmtp(MediaDescriptionPtr media, std::string&& key, const char* data, size_t len) {
     // a=fmtp:<fmt> <key>=<value>[;<key>=<value>]
-    std::vector<StrSlice> slices = StrSplit(data, len, ' ');
-    if (slices.size() != 2) return false;
+    StrSlice slices[2];
+    if (StrSplit(data, len, ' ', slices, 2) != 2) return false;
 
-    int64_t fmt = atoi(slices[0].ptr);
-    if (fmt < 0 || fmt > 255) return false;
+    uint64_t fmt = 0;
+    if (!StrToUint(slices[0], 255, fmt)) return false;
 
-    auto it = media->Codecs.find(fmt);
-    if (it == media->Codecs.end()) return false;
-    auto& codec = it->second;
+    auto codec = FindOrAddCodec(*media, fmt);
 
-    std::vector<StrSlice> kvs = StrSplit(slices[1].ptr, slices[1].len, ';');
-    for (auto& kv : kvs) {
+    StrSplitter kvs(slices[1].ptr, slices[1].len, ';');
+    StrSlice kv;
+    while (kvs.Next(kv)) {
         const char* pos = (const char*)memchr(kv.ptr, '=', kv.len);
         if (pos == nullptr) {
-            codec->FormatParams.emplace(kv.ToString(), "");
+            AddFormatParam(*codec, kv.ptr, kv.len, "", 0);
         } else {
-            codec->FormatParams.emplace(std::string(kv.ptr, pos - kv.ptr), std::string(pos + 1, kv.ptr + kv.len - pos - 1));
+            AddFormatParam(*codec, kv.ptr, pos - kv.ptr, pos + 1, kv.ptr + kv.len - pos - 1);
         }
     }
 
@@ -454,41 +504,75 @@ bool MediaAttrParseFmtp(MediaDescriptionPtr media, std::string&& key, const char
 
 bool MediaAttrParseSsrc(MediaDescriptionPtr media, std::string&& key, const char* data, size_t len) {
     // a=ssrc:<ssrc> <key>:<value>
-    std::vector<StrSlice> slices = StrSplit(data, len, ' ');
-    if (slices.size() < 2) return false;
-
-    int64_t ssrc = atoll(slices[0].ptr);
-    if (ssrc < 0 || ssrc > std::numeric_limits<uint32_t>::max()) return false;
-
-    TrackDescriptionPtr track;
-    auto it = media->Tracks.find(ssrc);
-    if (it == media->Tracks.end()) {
-        track = MakeTrackDescription();
-        track->Ssrc = ssrc;
-        media->Tracks.emplace(ssrc, track);
-        media->TracksOrder.push_back(ssrc);
+    StrSlice slices[2];
+    if (StrSplit(data, len, ' ', slices, 2) < 2) return false;
+
+    uint64_t ssrc = 0;
+    if (!StrToUint(slices[0], std::numeric_limits<uint32_t>::max(), ssrc)) return false;
+
+    bool added = false;
+    TrackDescriptionPtr track = FindOrAddTrack(*media, ssrc, &added);
+    if (added) media->TracksOrder.push_back(ssrc);
+
+    const char* pos = (const char*)memchr(slices[1].ptr, ':', slices[1].len);
+    if (pos != nullptr) {
+        SetAttribute(*track, slices[1].ptr, pos - slices[1].ptr, pos + 1, slices[1].ptr + slices[1].len - pos - 1);
     } else {
-        track = it->second;
+        SetAttribute(*track, slices[1].ptr, slices[1].len, "", 0);
     }
 
-    auto rpair = StrGetFirstSplit(slices[1].ptr, slices[1].len, ':');
-    auto& attr_key = rpair.first;
-    if (rpair.second != nullptr) {
-        track->SetAttribute(attr_key, std::string(rpair.second, slices[1].ptr + slices[1].len - rpair.second));
-    } else {
-        track->SetAttribute(attr_key, "");
+    return true;
+}
+
+bool MediaAttrParseSsrcGroup(MediaDescriptionPtr media, std::string&& key, const char* data, size_t len) {
+    // a=ssrc-group:<semantics> <ssrc> ...
+    StrSlice semantics;
+    size_t num = StrSplit(data, len, ' ', &semantics, 1);
+    if (num < 2) return false;
+
+    SsrcGroup group;
+    group.Semantics.assign(semantics.ptr, semantics.len);
+    group.Ssrcs.reserve(num - 1);
+    StrSplitter splitter(data, len, ' ');
+    StrSlice slice;
+    splitter.Next(slice);
+    while (splitter.Next(slice)) {
+        uint64_t ssrc = 0;
+        if (!StrToUint(slice, std::numeric_limits<uint32_t>::max(), ssrc) || ssrc == 0) return false;
+        group.Ssrcs.push_back(ssrc);
     }
+    media->SsrcGroups.push_back(std::move(group));
+    return true;
+}
+
+bool MediaAttrParseRid(MediaDescriptionPtr media, std::string&& key, const char* data, size_t len) {
+    // a=rid:<id> <direction> [<params>]
+    StrSlice slices[3];
+    size_t num = StrSplit(data, len, ' ', slices, 3);
+    if (num < 2) return false;
+    if (!slices[1].IsEqual("send", 4) && !slices[1].IsEqual("recv", 4)) return false;
+
+    RidDescription rid;
+    rid.Id.assign(slices[0].ptr, slices[0].len);
+    rid.Direction.assign(slices[1].ptr, slices[1].len);
+    if (num > 2) rid.Params.assign(slices[2].ptr, data + len - slices[2].ptr);
+    media->Rids.push_back(std::move(rid));
+    return true;
+}
 
+bool MediaAttrParseSimulcast(MediaDescriptionPtr media, std::string&& key, const char* data, size_t len) {
+    // a=simulcast:<direction> <rid>;<rid>... [<direction> <rid>;<rid>...]
+    media->Simulcast.assign(data, len);
     return true;
 }
 
 bool MediaAttrParseCandidate(MediaDescriptionPtr media, std::string&& key, const char* data, size_t len) {
     // a=candidate:foundation 1 udp 100 <ip> <port> ...
-    std::vector<StrSlice> slices = StrSplit(data, len, ' ');
-    if (slices.size() < 6) return false;
+    StrSlice slices[6];
+    if (StrSplit(data, len, ' ', slices, 6) < 6) return false;
 
-    int64_t port = atoll(slices[5].ptr);
-    if (port < 0 || port > std::numeric_limits<uint16_t>::max()) return false;
+    uint64_t port = 0;
+    if (!StrToUint(slices[5], std::numeric_limits<uint16_t>::max(), port)) return false;
 
     media->Candidate.first.assign(slices[4].ptr, slices[4].len);
     media->Candidate.second = port;
@@ -497,8 +581,8 @@ bool MediaAttrParseCandidate(MediaDescriptionPtr media, std::string&& key, const
 }
 
 bool MediaAttrParseMsid(MediaDescriptionPtr media, std::string&& key, const char* data, size_t len) {
-    std::vector<StrSlice> slices = StrSplit(data, len, ' ');
-    if (slices.size() < 2) return false;
+    StrSlice slices[2];
+    if (StrSplit(data, len, ' ', slices, 2) < 2) return false;
 
     media->StreamId.assign(slices[0].ptr, slices[0].len);
     media->TrackId.assign(slices[1].ptr, slices[1].len);   
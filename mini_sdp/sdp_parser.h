@@ -33,6 +33,8 @@ constexpr char kSdpRolePassive[] = "passive";
 
 constexpr char kSdpMediaProtoEncryptDefault[] = "UDP/TLS/RTP/SAVPF";
 constexpr char kSdpMediaProtoNotEncryptDefault[] = "RTP/AVPF";
+constexpr char kSdpMediaProtoDataChannel[] = "UDP/DTLS/SCTP";
+constexpr char kSdpMediaNameDataChannel[] = "webrtc-datachannel";
 
 constexpr char kSdpCodecOpus[] = "opus";
 constexpr char kSdpCodecLatm[] = "MP4A-LATM";
@@ -63,6 +65,35 @@ std::pair<SdpTransType, bool> ParseSdpTransType(const char* word, size_t len);
 std::pair<SdpMediaType, bool> ParseSdpMediaType(const char* word, size_t len);
 std::pair<SdpRoleType, bool> ParseSdpRoleType(const char* word, size_t len);
 
+/*
+ * attribute id
+ *  有解析函数的属性，记录出错的属性时使用
+ */
+enum class SdpAttrId : uint8_t {
+    kNone = 0,      // not an attribute line
+    kGroup,
+    kIceUfrag,
+    kIcePwd,
+    kIceOptions,
+    kFingerprint,
+    kSetup,
+    kMid,
+    kExtmap,
+    kDirection,     // sendrecv / sendonly / recvonly / inactive
+    kRtpmap,
+    kRtcpFb,
+    kFmtp,
+    kSsrc,
+    kSsrcGroup,
+    kRid,
+    kSimulcast,
+    kCandidate,
+    kMsid,
+    kAttrNum
+};
+
+const char* SdpAttrName(SdpAttrId id);
+
 /**
  * @brief SessionDescription Parser
  * 
@@ -80,7 +111,18 @@ class SdpParser {
         kUnknownLine  = 3
     };
 
-    using StatInfo = std::pair<StatCode, std::string>;  // <code, message>
+    /**
+     * @brief Parse Error
+     *  出错的位置和原因，记录时不分配内存，需要日志时由 FormatError() 生成文本
+     */
+    struct ErrorInfo {
+        StatCode    code    = StatCode::kNotParsed;
+        const char* reason  = "";                   // static string, like "port error"
+        size_t      line    = 0;                    // 1-based, 0 if not in a line
+        size_t      offset  = 0;                    // of the line in data
+        size_t      length  = 0;                    // of the line
+        SdpAttrId   attr    = SdpAttrId::kNone;     // attribute of the line
+    };
 
     /**
      * @brief Start Parse
@@ -90,16 +132,24 @@ class SdpParser {
      */
     bool Parse();
 
-    bool IsParsed() const { return stat_info_.first != StatCode::kNotParsed; }
+    bool IsParsed() const { return error_.code != StatCode::kNotParsed; }
 
-    bool IsSucess() const { return stat_info_.first == StatCode::kSuccess; }
+    bool IsSucess() const { return error_.code == StatCode::kSuccess; }
 
     SessionDescriptionPtr GetSessionDescription() { return sd_ptr_; }
 
-    const StatInfo& GetErrorMessage() const { return stat_info_; }
+    const ErrorInfo& GetError() const { return error_; }
+
+    /**
+     * @brief error text for logging
+     *  like "param error, line 12, offset 345, a=rtcp-fb: a=rtcp-fb:* nack"，
+     *  包含出错的行，data 须仍然有效
+     */
+    std::string FormatError() const;
 
   private:
-    void setStatInfo(StatCode code, const std::string& msg, size_t line = 0);
+    // of the current line
+    void setError(StatCode code, const char* reason, SdpAttrId attr = SdpAttrId::kNone);
 
     bool isInSessionLevel() { return !(bool)cur_media_ptr_; }
 
@@ -125,10 +175,11 @@ class SdpParser {
     void appendMedia();
 
   private:
+    const char* begin_;
     const char* data_;
     size_t      length_;
 
-    StatInfo stat_info_;
+    ErrorInfo   error_;
     SessionDescriptionPtr sd_ptr_;  
 
     MediaDescriptionPtr  cur_media_ptr_;
@@ -168,6 +219,12 @@ bool MediaAttrParseFmtp(MediaDescriptionPtr media, std::string&& key, const char
 
 bool MediaAttrParseSsrc(MediaDescriptionPtr media, std::string&& key, const char* data, size_t len);
 
+bool MediaAttrParseSsrcGroup(MediaDescriptionPtr media, std::string&& key, const char* data, size_t len);
+
+bool MediaAttrParseRid(MediaDescriptionPtr media, std::string&& key, const char* data, size_t len);
+
+bool MediaAttrParseSimulcast(MediaDescriptionPtr media, std::string&& key, const char* data, size_t len);
+
 bool MediaAttrParseCandidate(MediaDescriptionPtr media, std::string&& key, const char* data, size_t len);
 
 bool MediaAttrParseMsid(MediaDescriptionPtr media, std::string&& key, const char* data, size_t len);
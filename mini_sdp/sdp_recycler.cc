@@ -0,0 +1,476 @@
+/**
+ * @file mini_sdp/sdp_recycler.cc
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include "sdp_recycler.h"
+#include <algorithm>
+#include "stage_stats.h"
+
+namespace mini_sdp {
+
+// objects kept for later builds, beyond which they are freed
+constexpr size_t kSdpRecyclerMaxFree = 64;
+
+static thread_local SdpRecycler* t_recycler = nullptr;
+
+// as constructed, maps are left to the sweep
+static void resetSession(SessionDescription& session) {
+    session.Version = 0;
+    session.UserName.clear();
+    session.SessionId.clear();
+    session.SessionVersion.clear();
+    session.SessionName.clear();
+    session.SessionInfo.clear();
+    session.MediaStreamId.clear();
+    session.AddrType = SdpAddrType::kIPv4;
+    session.TransType = SdpTransType::kTransNone;
+    session.RoleType = SdpRoleType::kRoleNone;
+    session.GroupBundle.clear();
+}
+
+static void resetMedia(MediaDescription& media) {
+    media.MediaType = SdpMediaType();
+    media.Port = kSdpMediaPortDefault;
+    media.Protos.clear();
+    media.MediaId.clear();
+    media.MediaName.clear();
+    media.IceUfrag.clear();
+    media.IcePwd.clear();
+    media.IceOptions.clear();
+    media.StreamId.clear();
+    media.TrackId.clear();
+    media.AddrType = SdpAddrType::kIPv4;
+    media.TransType = SdpTransType::kTransNone;
+    media.RoleType = SdpRoleType::kRoleNone;
+    media.Candidate.first.clear();
+    media.Candidate.second = 0;
+    media.TracksOrder.clear();
+    media.SsrcGroups.clear();
+    media.Rids.clear();
+    media.Simulcast.clear();
+    media.Fingerprint.first.clear();
+    media.Fingerprint.second.clear();
+}
+
+static void resetCodec(CodecDescription& codec) {
+    codec.Name.clear();
+    codec.Format = 0;
+    codec.Channels = 0;
+    codec.SampleRate = 0;
+}
+
+template <typename T>
+static void release(std::vector<std::shared_ptr<T>>& pool, std::shared_ptr<T>&& obj) {
+    if (pool.size() < kSdpRecyclerMaxFree) pool.push_back(std::move(obj));
+}
+
+void SdpRecycler::MarkSet::Clear() {
+    if (size_ == 0) return;
+    std::fill(slots_.begin(), slots_.end(), nullptr);
+    size_ = 0;
+}
+
+size_t SdpRecycler::MarkSet::slot(const void* ptr) const {
+    uint64_t hash = (uint64_t(reinterpret_cast<uintptr_t>(ptr)) >> 4) * 0x9E3779B97F4A7C15ull;
+    return size_t(hash >> 32) & (slots_.size() - 1);
+}
+
+bool SdpRecycler::MarkSet::Insert(const void* ptr) {
+    if ((size_ + 1) * 2 > slots_.size()) {
+        // grow at half load
+        std::vector<const void*> slots(std::max<size_t>(256, slots_.size() * 2), nullptr);
+        slots_.swap(slots);
+        size_ = 0;
+        for (const void* old : slots) {
+            if (old) Insert(old);
+        }
+    }
+    for (size_t i = slot(ptr);; i = (i + 1) & (slots_.size() - 1)) {
+        if (slots_[i] == ptr) return false;
+        if (!slots_[i]) {
+            slots_[i] = ptr;
+            size_++;
+            return true;
+        }
+    }
+}
+
+bool SdpRecycler::MarkSet::Has(const void* ptr) const {
+    if (slots_.empty()) return false;
+    for (size_t i = slot(ptr);; i = (i + 1) & (slots_.size() - 1)) {
+        if (slots_[i] == ptr) return true;
+        if (!slots_[i]) return false;
+    }
+}
+
+void SdpRecycler::MarkSet::Release() {
+    std::vector<const void*>().swap(slots_);
+    size_ = 0;
+}
+
+SdpRecycler* SdpRecycler::Current() {
+    return t_recycler;
+}
+
+SdpRecycler* SdpRecycler::active() {
+    return t_recycler && t_recycler->building_ ? t_recycler : nullptr;
+}
+
+void SdpRecycler::Clear() {
+    session_.reset();
+    building_ = false;
+    dirty_ = false;
+    std::vector<MediaDescriptionPtr>().swap(medias_);
+    next_media_ = 0;
+    std::vector<MediaDescriptionPtr>().swap(free_medias_);
+    std::vector<CodecDescriptionPtr>().swap(free_codecs_);
+    std::vector<TrackDescriptionPtr>().swap(free_tracks_);
+    marks_.Release();
+    std::string().swap(key_);
+    flat_.Clear();
+}
+
+void SdpRecycler::begin() {
+    // a build that did not end leaves a half written graph, and a graph still referred to outside is left to
+    // its holders, start over
+    bool is_shared = session_ && session_.use_count() > 1;
+    if (session_ && !is_shared) {
+        for (auto& media : session_->Medias) {
+            if (media.second.use_count() > 1) is_shared = true;
+        }
+    }
+    if (!session_ || dirty_ || is_shared) {
+        session_ = MakeSessionDescription();
+    } else {
+        resetSession(*session_);
+    }
+    medias_.clear();
+    for (auto& media : session_->Medias) {
+        medias_.push_back(media.second);
+    }
+    next_media_ = 0;
+    marks_.Clear();
+    building_ = true;
+    dirty_ = true;
+}
+
+void SdpRecycler::end() {
+    building_ = false;
+    dirty_ = false;
+
+    SessionDescription& session = *session_;
+    sweepAttrs(session.attributes_);
+    for (auto it = session.Medias.begin(); it != session.Medias.end();) {
+        if (marks_.Has(&*it)) {
+            sweepMedia(*it->second);
+            ++it;
+        } else {
+            // the object is in medias_ if it was not taken
+            it = session.Medias.erase(it);
+        }
+    }
+    for (size_t i = next_media_; i < medias_.size(); i++) {
+        if (!marks_.Has(medias_[i].get())) release(free_medias_, std::move(medias_[i]));
+    }
+    medias_.clear();
+}
+
+MediaDescriptionPtr SdpRecycler::takeMedia() {
+    // medias of the last build in order, the common case is the same sdp shape
+    while (next_media_ < medias_.size()) {
+        MediaDescriptionPtr& media = medias_[next_media_++];
+        if (marks_.Insert(media.get())) return media;
+    }
+    MediaDescriptionPtr media;
+    if (!free_medias_.empty()) {
+        media = std::move(free_medias_.back());
+        free_medias_.pop_back();
+    } else {
+        media = MakeMediaDescription();
+    }
+    marks_.Insert(media.get());
+    return media;
+}
+
+CodecDescriptionPtr SdpRecycler::takeCodec(MediaDescription& media) {
+    for (auto it = media.Codecs.begin(); it != media.Codecs.end(); ++it) {
+        if (!marks_.Has(&*it)) {
+            CodecDescriptionPtr codec = std::move(it->second);
+            media.Codecs.erase(it);
+            return codec;
+        }
+    }
+    if (free_codecs_.empty()) return MakeCodecDescription();
+    CodecDescriptionPtr codec = std::move(free_codecs_.back());
+    free_codecs_.pop_back();
+    return codec;
+}
+
+TrackDescriptionPtr SdpRecycler::takeTrack(MediaDescription& media) {
+    for (auto it = media.Tracks.begin(); it != media.Tracks.end(); ++it) {
+        if (!marks_.Has(&*it)) {
+            TrackDescriptionPtr track = std::move(it->second);
+            media.Tracks.erase(it);
+            return track;
+        }
+    }
+    if (free_tracks_.empty()) return MakeTrackDescription();
+    TrackDescriptionPtr track = std::move(free_tracks_.back());
+    free_tracks_.pop_back();
+    return track;
+}
+
+void SdpRecycler::setAttr(std::map<std::string, std::string>& attrs, const char* key, size_t key_len,
+                          const char* value, size_t value_len) {
+    key_.assign(key, key_len);
+    auto it = attrs.find(key_);
+    if (it == attrs.end()) {
+        it = attrs.emplace(key_, std::string(value, value_len)).first;
+    } else {
+        it->second.assign(value, value_len);
+    }
+    marks_.Insert(&*it);
+}
+
+void SdpRecycler::sweepAttrs(std::map<std::string, std::string>& attrs) {
+    for (auto it = attrs.begin(); it != attrs.end();) {
+        if (marks_.Has(&*it)) {
+            ++it;
+        } else {
+            it = attrs.erase(it);
+        }
+    }
+}
+
+void SdpRecycler::sweepMedia(MediaDescription& media) {
+    sweepAttrs(media.attributes_);
+    for (auto it = media.ExtMap.begin(); it != media.ExtMap.end();) {
+        if (marks_.Has(&*it)) {
+            ++it;
+        } else {
+            it = media.ExtMap.erase(it);
+        }
+    }
+    for (auto it = media.Codecs.begin(); it != media.Codecs.end();) {
+        if (marks_.Has(&*it)) {
+            sweepCodec(*it->second);
+            ++it;
+        } else {
+            release(free_codecs_, std::move(it->second));
+            it = media.Codecs.erase(it);
+        }
+    }
+    for (auto it = media.Tracks.begin(); it != media.Tracks.end();) {
+        if (marks_.Has(&*it)) {
+            sweepAttrs(it->second->attributes_);
+            ++it;
+        } else {
+            release(free_tracks_, std::move(it->second));
+            it = media.Tracks.erase(it);
+        }
+    }
+}
+
+void SdpRecycler::sweepCodec(CodecDescription& codec) {
+    sweepAttrs(codec.attributes_);
+    for (auto it = codec.Feedbacks.begin(); it != codec.Feedbacks.end();) {
+        if (marks_.Has(&*it)) {
+            ++it;
+        } else {
+            it = codec.Feedbacks.erase(it);
+        }
+    }
+    sweepAttrs(codec.FormatParams);
+}
+
+SdpRecycleScope::SdpRecycleScope(SdpRecycler& recycler) : recycler_(&recycler), prev_(t_recycler) {
+    t_recycler = recycler_;
+}
+
+SdpRecycleScope::~SdpRecycleScope() {
+    // a build that failed is left dirty
+    recycler_->building_ = false;
+    t_recycler = prev_;
+}
+
+
+SessionDescriptionPtr BeginSessionDescription() {
+    // only the first description of a scope is recycled
+    if (!t_recycler || t_recycler->building()) return MakeSessionDescription();
+    t_recycler->begin();
+    return t_recycler->session_;
+}
+
+void EndSessionDescription(SessionDescription& session) {
+    SdpRecycler* recycler = SdpRecycler::active();
+    if (recycler && recycler->session_.get() == &session) recycler->end();
+}
+
+MediaDescriptionPtr NewMediaDescription() {
+    SdpRecycler* recycler = SdpRecycler::active();
+    if (!recycler) return MakeMediaDescription();
+    MediaDescriptionPtr media = recycler->takeMedia();
+    resetMedia(*media);
+    return media;
+}
+
+bool AddMedia(SessionDescription& session, const std::string& key, MediaDescriptionPtr media) {
+    SdpRecycler* recycler = SdpRecycler::active();
+    if (!recycler) return session.Medias.emplace(key, std::move(media)).second;
+
+    auto it = session.Medias.find(key);
+    if (it == session.Medias.end()) {
+        it = session.Medias.emplace(key, std::move(media)).first;
+    } else if (recycler->marks_.Has(&*it)) {
+        return false;
+    } else {
+        it->second = std::move(media);
+    }
+    recycler->marks_.Insert(&*it);
+    return true;
+}
+
+CodecDescriptionPtr FindOrAddCodec(MediaDescription& media, uint8_t fmt, bool* added) {
+    SdpRecycler* recycler = SdpRecycler::active();
+    bool is_added = false;
+    CodecDescriptionPtr codec;
+    if (!recycler) {
+        CodecDescriptionPtr& entry = media.Codecs[fmt];
+        if (!entry) {
+            entry = MakeCodecDescription();
+            entry->Format = fmt;
+            is_added = true;
+        }
+        codec = entry;
+    } else {
+        auto it = media.Codecs.find(fmt);
+        if (it == media.Codecs.end()) {
+            codec = recycler->takeCodec(media);
+            it = media.Codecs.emplace(fmt, codec).first;
+        } else {
+            codec = it->second;
+        }
+        is_added = recycler->marks_.Insert(&*it);
+        if (is_added) {
+            resetCodec(*codec);
+            codec->Format = fmt;
+        }
+    }
+    if (added) *added = is_added;
+    return codec;
+}
+
+TrackDescriptionPtr FindOrAddTrack(MediaDescription& media, uint32_t ssrc, bool* added) {
+    SdpRecycler* recycler = SdpRecycler::active();
+    bool is_added = false;
+    TrackDescriptionPtr track;
+    if (!recycler) {
+        TrackDescriptionPtr& entry = media.Tracks[ssrc];
+        if (!entry) {
+            entry = MakeTrackDescription();
+            entry->Ssrc = ssrc;
+            is_added = true;
+        }
+        track = entry;
+    } else {
+        auto it = media.Tracks.find(ssrc);
+        if (it == media.Tracks.end()) {
+            track = recycler->takeTrack(media);
+            it = media.Tracks.emplace(ssrc, track).first;
+        } else {
+            track = it->second;
+        }
+        is_added = recycler->marks_.Insert(&*it);
+        if (is_added) track->Ssrc = ssrc;
+    }
+    if (added) *added = is_added;
+    return track;
+}
+
+void AddFeedback(CodecDescription& codec, const char* data, size_t len) {
+    SdpRecycler* recycler = SdpRecycler::active();
+    if (!recycler) {
+        codec.Feedbacks.emplace(data, len);
+        return;
+    }
+    recycler->key_.assign(data, len);
+    auto it = codec.Feedbacks.find(recycler->key_);
+    if (it == codec.Feedbacks.end()) it = codec.Feedbacks.insert(recycler->key_).first;
+    recycler->marks_.Insert(&*it);
+}
+
+void AddFormatParam(CodecDescription& codec, const char* key, size_t key_len, const char* value, size_t value_len) {
+    SdpRecycler* recycler = SdpRecycler::active();
+    if (!recycler) {
+        codec.FormatParams.emplace(std::string(key, key_len), std::string(value, value_len));
+        return;
+    }
+    recycler->key_.assign(key, key_len);
+    auto it = codec.FormatParams.find(recycler->key_);
+    if (it == codec.FormatParams.end()) {
+        it = codec.FormatParams.emplace(recycler->key_, std::string(value, value_len)).first;
+        recycler->marks_.Insert(&*it);
+    } else if (recycler->marks_.Insert(&*it)) {
+        it->second.assign(value, value_len);
+    }
+}
+
+void AddExtMap(MediaDescription& media, uint8_t id, const char* uri, size_t len) {
+    SdpRecycler* recycler = SdpRecycler::active();
+    if (!recycler) {
+        media.ExtMap.emplace(id, std::string(uri, len));
+        return;
+    }
+    auto it = media.ExtMap.find(id);
+    if (it == media.ExtMap.end()) {
+        it = media.ExtMap.emplace(id, std::string(uri, len)).first;
+        recycler->marks_.Insert(&*it);
+    } else if (recycler->marks_.Insert(&*it)) {
+        it->second.assign(uri, len);
+    }
+}
+
+void SetAttribute(SessionDescription& session, const char* key, size_t key_len, const char* value, size_t value_len) {
+    SdpRecycler* recycler = SdpRecycler::active();
+    if (!recycler) {
+        session.SetAttribute(std::string(key, key_len), std::string(value, value_len));
+    } else {
+        recycler->setAttr(SdpRecycler::attrs(session), key, key_len, value, value_len);
+    }
+}
+
+void SetAttribute(MediaDescription& media, const char* key, size_t key_len, const char* value, size_t value_len) {
+    SdpRecycler* recycler = SdpRecycler::active();
+    if (!recycler) {
+        media.SetAttribute(std::string(key, key_len), std::string(value, value_len));
+    } else {
+        recycler->setAttr(SdpRecycler::attrs(media), key, key_len, value, value_len);
+    }
+}
+
+void SetAttribute(TrackDescription& track, const char* key, size_t key_len, const char* value, size_t value_len) {
+    SdpRecycler* recycler = SdpRecycler::active();
+    if (!recycler) {
+        track.SetAttribute(std::string(key, key_len), std::string(value, value_len));
+    } else {
+        recycler->setAttr(SdpRecycler::attrs(track), key, key_len, value, value_len);
+    }
+}
+
+void RenderSessionDescription(const SessionDescription& session, std::string& dst) {
+    if (!t_recycler) {
+        dst = session.ToString();
+        return;
+    }
+    StageTimer timer(SdpStage::kToString);
+    t_recycler->flat_.Assign(session);
+    dst.clear();
+    t_recycler->flat_.AppendString(dst);
+}
+
+}  // namespace mini_sdp
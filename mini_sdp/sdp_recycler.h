@@ -0,0 +1,190 @@
+/**
+ * @file mini_sdp/sdp_recycler.h
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#ifndef MINI_SDP_SDP_RECYCLER_H_
+#define MINI_SDP_SDP_RECYCLER_H_
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "flat_sdp.h"
+#include "sdp.h"
+
+namespace mini_sdp {
+
+/**
+ * @brief Session Description Recycler
+ *  在上一次构建的 SessionDescription 上原地重建，复用其中的 media / codec / track 对象、map 节点和字符串容量
+ *  - 重建开始时原有条目均视为过期，写入同 key 的条目时直接覆盖，结束时删除未被写入的条目，结果与新建的描述相同
+ *  - 由 SdpRecycleScope 在所在线程启用，期间解析器和解码器经下方的构建函数复用，每个 scope 只构建一个描述
+ *  - 多出的对象留作后用，内存随见过的最大描述增长，Clear() 释放
+ *  - 上一次的描述仍被外部持有（GetSessionDescription 的结果未释放）时不再复用，重新构建
+ */
+class SdpRecycler {
+  public:
+    SdpRecycler() = default;
+
+    SdpRecycler(const SdpRecycler&) = delete;
+    SdpRecycler& operator=(const SdpRecycler&) = delete;
+
+    // the description built last time, nullptr if none
+    SessionDescriptionPtr GetSessionDescription() const { return session_; }
+
+    // release everything retained
+    void Clear();
+
+    // enabled on this thread, nullptr if none
+    static SdpRecycler* Current();
+
+  private:
+    friend class SdpRecycleScope;
+    friend SessionDescriptionPtr BeginSessionDescription();
+    friend void EndSessionDescription(SessionDescription& session);
+    friend MediaDescriptionPtr NewMediaDescription();
+    friend bool AddMedia(SessionDescription& session, const std::string& key, MediaDescriptionPtr media);
+    friend CodecDescriptionPtr FindOrAddCodec(MediaDescription& media, uint8_t fmt, bool* added);
+    friend TrackDescriptionPtr FindOrAddTrack(MediaDescription& media, uint32_t ssrc, bool* added);
+    friend void AddFeedback(CodecDescription& codec, const char* data, size_t len);
+    friend void AddFormatParam(CodecDescription& codec, const char* key, size_t key_len,
+                               const char* value, size_t value_len);
+    friend void AddExtMap(MediaDescription& media, uint8_t id, const char* uri, size_t len);
+    friend void SetAttribute(SessionDescription& session, const char* key, size_t key_len,
+                             const char* value, size_t value_len);
+    friend void SetAttribute(MediaDescription& media, const char* key, size_t key_len,
+                             const char* value, size_t value_len);
+    friend void SetAttribute(TrackDescription& track, const char* key, size_t key_len,
+                             const char* value, size_t value_len);
+    friend void RenderSessionDescription(const SessionDescription& session, std::string& dst);
+
+    // entries and objects written since begin, open addressing
+    class MarkSet {
+      public:
+        void Clear();
+
+        // false if already marked
+        bool Insert(const void* ptr);
+
+        bool Has(const void* ptr) const;
+
+        void Release();
+
+      private:
+        size_t slot(const void* ptr) const;
+
+        std::vector<const void*> slots_;
+        size_t size_ = 0;
+    };  // class MarkSet
+
+    bool building() const { return building_; }
+
+    // the recycler of this thread if it is building
+    static SdpRecycler* active();
+
+    // attributes_ of the descriptions, for the building functions
+    static std::map<std::string, std::string>& attrs(SessionDescription& session) { return session.attributes_; }
+    static std::map<std::string, std::string>& attrs(MediaDescription& media) { return media.attributes_; }
+    static std::map<std::string, std::string>& attrs(TrackDescription& track) { return track.attributes_; }
+
+    void begin();
+
+    void end();
+
+    MediaDescriptionPtr takeMedia();
+
+    CodecDescriptionPtr takeCodec(MediaDescription& media);
+
+    TrackDescriptionPtr takeTrack(MediaDescription& media);
+
+    void setAttr(std::map<std::string, std::string>& attrs, const char* key, size_t key_len,
+                 const char* value, size_t value_len);
+
+    void sweepAttrs(std::map<std::string, std::string>& attrs);
+
+    void sweepMedia(MediaDescription& media);
+
+    void sweepCodec(CodecDescription& codec);
+
+    SessionDescriptionPtr               session_;
+    bool                                building_ = false;
+    bool                                dirty_ = false;     // the last build did not end
+    std::vector<MediaDescriptionPtr>    medias_;            // of session_ at begin, taken in order
+    size_t                              next_media_ = 0;
+    std::vector<MediaDescriptionPtr>    free_medias_;
+    std::vector<CodecDescriptionPtr>    free_codecs_;
+    std::vector<TrackDescriptionPtr>    free_tracks_;
+    MarkSet                             marks_;
+    std::string                         key_;               // lookup of string keys
+    FlatSessionDescription              flat_;              // RenderSessionDescription
+};  // class SdpRecycler
+
+/**
+ * @brief Recycle Scope
+ *  构造后到析构前，本线程构建的描述由 recycler 复用
+ */
+class SdpRecycleScope {
+  public:
+    explicit SdpRecycleScope(SdpRecycler& recycler);
+
+    ~SdpRecycleScope();
+
+    SdpRecycleScope(const SdpRecycleScope&) = delete;
+    SdpRecycleScope& operator=(const SdpRecycleScope&) = delete;
+
+  private:
+    SdpRecycler*    recycler_;
+    SdpRecycler*    prev_;
+};  // class SdpRecycleScope
+
+/*
+ * description building
+ *  解析器和解码器通过以下函数构建描述：没有启用的 SdpRecycler 时与直接操作容器相同，
+ *  否则复用其中的对象、节点和字符串；语义（同 key 时保留先写入的还是后写入的）与原有的容器操作一致
+ */
+
+// the root of a build, EndSessionDescription when it succeeds
+SessionDescriptionPtr BeginSessionDescription();
+
+// drop what was not rebuilt
+void EndSessionDescription(SessionDescription& session);
+
+MediaDescriptionPtr NewMediaDescription();
+
+// false if key exists
+bool AddMedia(SessionDescription& session, const std::string& key, MediaDescriptionPtr media);
+
+// Format is set when added
+CodecDescriptionPtr FindOrAddCodec(MediaDescription& media, uint8_t fmt, bool* added = nullptr);
+
+// Ssrc is set when added, TracksOrder is left to the caller
+TrackDescriptionPtr FindOrAddTrack(MediaDescription& media, uint32_t ssrc, bool* added = nullptr);
+
+void AddFeedback(CodecDescription& codec, const char* data, size_t len);
+
+// the first value of a key is kept
+void AddFormatParam(CodecDescription& codec, const char* key, size_t key_len, const char* value, size_t value_len);
+
+// the first uri of an id is kept
+void AddExtMap(MediaDescription& media, uint8_t id, const char* uri, size_t len);
+
+// the last value of a key is kept, as SetAttribute of these classes
+void SetAttribute(SessionDescription& session, const char* key, size_t key_len, const char* value, size_t value_len);
+void SetAttribute(MediaDescription& media, const char* key, size_t key_len, const char* value, size_t value_len);
+void SetAttribute(TrackDescription& track, const char* key, size_t key_len, const char* value, size_t value_len);
+
+inline void SetAttribute(TrackDescription& track, const char* key, const std::string& value) {
+    SetAttribute(track, key, strlen(key), value.data(), value.size());
+}
+
+// dst = session.ToString(), rendered by FlatSessionDescription into the capacity of dst if recycling
+void RenderSessionDescription(const SessionDescription& session, std::string& dst);
+
+}  // namespace mini_sdp
+
+#endif  // MINI_SDP_SDP_RECYCLER_H_
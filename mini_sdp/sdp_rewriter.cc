@@ -0,0 +1,341 @@
+/**
+ * @file mini_sdp/sdp_rewriter.cc
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include "sdp_rewriter.h"
+#include <algorithm>
+#include <cstring>
+#include <strings.h>
+#include "sdp_parser.h"
+#include "util.h"
+
+namespace mini_sdp {
+
+namespace {
+
+constexpr char kRtpmapPrefix[] = "a=rtpmap:";
+constexpr char kRtcpFbPrefix[] = "a=rtcp-fb:";
+constexpr char kFmtpPrefix[]   = "a=fmtp:";
+
+// lines of a payload type, dropped with it
+const StrSlice kCodecPrefixes[] = {
+    {kRtpmapPrefix, sizeof(kRtpmapPrefix) - 1},
+    {kRtcpFbPrefix, sizeof(kRtcpFbPrefix) - 1},
+    {kFmtpPrefix, sizeof(kFmtpPrefix) - 1},
+};
+
+inline bool startsWith(const char* data, size_t len, const char* prefix, size_t prefix_len) {
+    return len >= prefix_len && memcmp(data, prefix, prefix_len) == 0;
+}
+
+template <size_t N>
+inline bool startsWith(const char* data, size_t len, const char (&prefix)[N]) {
+    return startsWith(data, len, prefix, N - 1);
+}
+
+// [data, end) of the line at data, end excludes the line ending; next is the next line
+inline const char* lineEnd(const char* data, const char* end, const char*& next) {
+    const char* eol = static_cast<const char*>(memchr(data, '\n', end - data));
+    next = eol ? eol + 1 : end;
+    const char* line_end = eol ? eol : end;
+    if (line_end > data && line_end[-1] == '\r') line_end--;
+    return line_end;
+}
+
+// the token at index, split by ' '
+bool tokenAt(const char* line, size_t len, size_t index, StrSlice& token) {
+    StrSplitter splitter(line, len, ' ', false);
+    for (size_t i = 0; splitter.Next(token); i++) {
+        if (i == index) return true;
+    }
+    return false;
+}
+
+// payload type of a=rtpmap / a=rtcp-fb / a=fmtp after prefix, false if not a number
+bool payloadType(const char* line, size_t len, size_t prefix_len, uint64_t& pt) {
+    return StrParseUint(line + prefix_len, len - prefix_len, 255, pt) != nullptr;
+}
+
+uint8_t mediaScope(const char* line, size_t len) {
+    StrSlice media;
+    if (!tokenAt(line + 2, len - 2, 0, media)) return kRewriteMedias;
+    if (media.IsEqual(kSdpMediaAudio, sizeof(kSdpMediaAudio) - 1)) return kRewriteAudio;
+    if (media.IsEqual(kSdpMediaVideo, sizeof(kSdpMediaVideo) - 1)) return kRewriteVideo;
+    if (media.IsEqual(kSdpMediaData, sizeof(kSdpMediaData) - 1)) return kRewriteData;
+    return kRewriteMedias;
+}
+
+bool isDirection(const char* line, size_t len) {
+    if (len < 2 || line[0] != 'a' || line[1] != '=') return false;
+    for (const char* direction : {kSdpTransSendRecv, kSdpTransSendOnly, kSdpTransRecvOnly, kSdpTransInactive}) {
+        if (IsStrEqual(line + 2, len - 2, direction, strlen(direction))) return true;
+    }
+    return false;
+}
+
+}  // namespace
+
+void SdpRewriter::addRule(Rule&& rule) {
+    if (rule.prefix.empty() || (unsigned char)rule.prefix[0] >= 128) return;
+    buckets_[(unsigned char)rule.prefix[0]].push_back(uint16_t(rules_.size()));
+    rules_.push_back(std::move(rule));
+}
+
+void SdpRewriter::DropLine(const std::string& prefix, const std::string& contains, uint8_t scope) {
+    Rule rule;
+    rule.type = kRuleDropLine;
+    rule.scope = scope;
+    rule.prefix = prefix;
+    rule.pattern = contains;
+    addRule(std::move(rule));
+}
+
+void SdpRewriter::ReplaceToken(const std::string& prefix, size_t index, const std::string& value,
+                               const std::string& match, uint8_t scope) {
+    Rule rule;
+    rule.type = kRuleReplaceToken;
+    rule.scope = scope;
+    rule.prefix = prefix;
+    rule.pattern = match;
+    rule.value = value;
+    rule.index = index;
+    rule.match_index = index;
+    addRule(std::move(rule));
+}
+
+void SdpRewriter::SetCandidateAddress(const std::string& ip, uint16_t port, const std::string& from_ip,
+                                      uint8_t scope) {
+    // a=candidate:<foundation> <component> <transport> <priority> <address> <port> typ ...
+    for (size_t index : {4, 5}) {
+        Rule rule;
+        rule.type = kRuleReplaceToken;
+        rule.scope = scope;
+        rule.prefix = "a=candidate:";
+        rule.pattern = from_ip;
+        rule.value = index == 4 ? ip : std::to_string(port);
+        rule.index = index;
+        rule.match_index = 4;
+        addRule(std::move(rule));
+    }
+}
+
+void SdpRewriter::DropCodec(const std::string& name, uint8_t scope) {
+    codecs_.push_back({name, scope});
+}
+
+void SdpRewriter::SetDirection(SdpTransType direction, uint8_t scope) {
+    Rule rule;
+    rule.type = kRuleDirection;
+    rule.scope = scope;
+    // a direction line is a single token, replaced as a whole
+    rule.prefix = "a=";
+    switch (direction) {
+    case SdpTransType::kSendOnly:
+        rule.value = std::string("a=") + kSdpTransSendOnly;
+        break;
+    case SdpTransType::kRecvOnly:
+        rule.value = std::string("a=") + kSdpTransRecvOnly;
+        break;
+    case SdpTransType::kInactive:
+        rule.value = std::string("a=") + kSdpTransInactive;
+        break;
+    default:
+        rule.value = std::string("a=") + kSdpTransSendRecv;
+        break;
+    }
+    addRule(std::move(rule));
+}
+
+bool SdpRewriter::collectDropped(const char* data, const char* end, uint8_t scope, PayloadTypes& dropped) const {
+    bool has_codec = false;
+    for (auto& codec : codecs_) has_codec = has_codec || (codec.scope & scope);
+    if (!has_codec) return false;
+
+    // a=rtpmap:<pt> <name>/<rate>
+    bool has_dropped = false;
+    const char* next = nullptr;
+    for (const char* line = data; line < end; line = next) {
+        const char* line_end = lineEnd(line, end, next);
+        size_t len = line_end - line;
+        uint64_t pt = 0;
+        if (!startsWith(line, len, kRtpmapPrefix) || !payloadType(line, len, sizeof(kRtpmapPrefix) - 1, pt)) {
+            continue;
+        }
+        const char* name = static_cast<const char*>(memchr(line, ' ', len));
+        if (!name) continue;
+        name++;
+        const char* slash = static_cast<const char*>(memchr(name, '/', line_end - name));
+        size_t name_len = (slash ? slash : line_end) - name;
+        for (auto& codec : codecs_) {
+            if ((codec.scope & scope) && codec.name.size() == name_len &&
+                strncasecmp(codec.name.data(), name, name_len) == 0) {
+                dropped.Add(pt);
+                has_dropped = true;
+                break;
+            }
+        }
+    }
+    if (!has_dropped) return false;
+
+    // rtx of the dropped, a=fmtp:<pt> apt=<pt>
+    for (const char* line = data; line < end; line = next) {
+        const char* line_end = lineEnd(line, end, next);
+        size_t len = line_end - line;
+        uint64_t pt = 0, apt = 0;
+        if (!startsWith(line, len, kFmtpPrefix) || !payloadType(line, len, sizeof(kFmtpPrefix) - 1, pt)) continue;
+        const char* param = std::search(line, line_end, "apt=", "apt=" + 4);
+        if (param != line_end && StrParseUint(param + 4, line_end - param - 4, 255, apt) && dropped.Has(apt)) {
+            dropped.Add(pt);
+        }
+    }
+    return true;
+}
+
+bool SdpRewriter::appendMediaLine(const char* line, size_t len, const PayloadTypes& dropped,
+                                  std::string& dst) const {
+    // m=<media> <port> <proto> <fmt> ...
+    size_t begin = dst.size();
+    StrSplitter splitter(line, len, ' ', false);
+    StrSlice token;
+    size_t kept = 0;
+    for (size_t i = 0; splitter.Next(token); i++) {
+        uint64_t pt = 0;
+        if (i >= 3 && StrToUint(token, 255, pt) && dropped.Has(pt)) continue;
+        if (i > 0) dst.push_back(' ');
+        dst.append(token.ptr, token.len);
+        kept += i >= 3 ? 1 : 0;
+    }
+    if (kept > 0) return true;
+
+    // rejected, the line as it was with port 0
+    dst.resize(begin);
+    splitter = StrSplitter(line, len, ' ', false);
+    for (size_t i = 0; splitter.Next(token); i++) {
+        if (i > 0) dst.push_back(' ');
+        if (i == 1) {
+            dst.push_back('0');
+        } else {
+            dst.append(token.ptr, token.len);
+        }
+    }
+    return false;
+}
+
+bool SdpRewriter::applyRules(const char* line, size_t len, uint8_t scope, bool& drop, std::string& dst) const {
+    drop = false;
+    if (len == 0 || (unsigned char)line[0] >= 128) return false;
+    auto& bucket = buckets_[(unsigned char)line[0]];
+    if (bucket.empty()) return false;
+
+    // drop first
+    bool has_replace = false;
+    for (uint16_t idx : bucket) {
+        const Rule& rule = rules_[idx];
+        if (!(rule.scope & scope) || !startsWith(line, len, rule.prefix.data(), rule.prefix.size())) continue;
+        if (rule.type == kRuleDropLine) {
+            if (rule.pattern.empty() ||
+                std::search(line, line + len, rule.pattern.begin(), rule.pattern.end()) != line + len) {
+                drop = true;
+                return true;
+            }
+        } else {
+            has_replace = has_replace || rule.type == kRuleReplaceToken || isDirection(line, len);
+        }
+    }
+    if (!has_replace) return false;
+
+    // the first replacing rule of a token wins, conditions are checked on the original line
+    size_t begin = dst.size();
+    bool changed = false;
+    StrSplitter splitter(line, len, ' ', false);
+    StrSlice token;
+    for (size_t i = 0; splitter.Next(token); i++) {
+        const std::string* value = nullptr;
+        for (uint16_t idx : bucket) {
+            const Rule& rule = rules_[idx];
+            if (!(rule.scope & scope) || !startsWith(line, len, rule.prefix.data(), rule.prefix.size())) continue;
+            if (rule.type == kRuleDirection) {
+                if (i == 0 && isDirection(line, len)) value = &rule.value;
+            } else if (rule.type == kRuleReplaceToken && rule.index == i) {
+                StrSlice match;
+                if (rule.pattern.empty() ||
+                    (tokenAt(line, len, rule.match_index, match) && match.IsEqual(rule.pattern))) {
+                    value = &rule.value;
+                }
+            }
+            if (value) break;
+        }
+        if (i > 0) dst.push_back(' ');
+        if (!value) {
+            dst.append(token.ptr, token.len);
+            continue;
+        }
+        dst.append(*value);
+        changed = changed || !token.IsEqual(*value);
+    }
+    if (!changed) dst.resize(begin);
+    return changed;
+}
+
+size_t SdpRewriter::Rewrite(const char* data, size_t len, std::string& dst) const {
+    dst.clear();
+    dst.reserve(len);
+    const char* end = data + len;
+    uint8_t scope = kRewriteSession;
+    PayloadTypes dropped;
+    bool has_dropped = false;
+    size_t changed = 0;
+    const char* next = nullptr;
+    for (const char* line = data; line < end; line = next) {
+        const char* line_end = lineEnd(line, end, next);
+        size_t line_len = line_end - line;
+        bool drop = false;
+        bool is_changed = false;
+
+        if (startsWith(line, line_len, "m=")) {
+            scope = mediaScope(line, line_len);
+            dropped = PayloadTypes();
+            has_dropped = false;
+            if (!codecs_.empty()) {
+                // the section ends at the next m= line
+                const char* section_end = next;
+                while (section_end < end && !startsWith(section_end, end - section_end, "m=")) {
+                    lineEnd(section_end, end, section_end);
+                }
+                has_dropped = collectDropped(next, section_end, scope, dropped);
+            }
+            if (has_dropped) {
+                has_dropped = appendMediaLine(line, line_len, dropped, dst);
+                is_changed = true;
+            }
+        } else if (has_dropped) {
+            uint64_t pt = 0;
+            for (auto& prefix : kCodecPrefixes) {
+                if (startsWith(line, line_len, prefix.ptr, prefix.len)) {
+                    drop = payloadType(line, line_len, prefix.len, pt) && dropped.Has(pt);
+                    break;
+                }
+            }
+        }
+        if (!is_changed && !drop) is_changed = applyRules(line, line_len, scope, drop, dst);
+
+        if (drop) {
+            changed++;
+            continue;
+        }
+        if (is_changed) {
+            changed++;
+        } else {
+            dst.append(line, line_len);
+        }
+        dst.append(line_end, next);
+    }
+    return changed;
+}
+
+}  // namespace mini_sdp
@@ -0,0 +1,126 @@
+/**
+ * @file mini_sdp/sdp_rewriter.h
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#ifndef MINI_SDP_SDP_REWRITER_H_
+#define MINI_SDP_SDP_REWRITER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "sdp.h"
+
+namespace mini_sdp {
+
+// scope of a rule, the session part is the lines before the first m=
+constexpr uint8_t kRewriteSession = 0x1;
+constexpr uint8_t kRewriteAudio   = 0x2;
+constexpr uint8_t kRewriteVideo   = 0x4;
+constexpr uint8_t kRewriteData    = 0x8;
+constexpr uint8_t kRewriteMedias  = kRewriteAudio | kRewriteVideo | kRewriteData;
+constexpr uint8_t kRewriteAll     = kRewriteSession | kRewriteMedias;
+
+/**
+ * @brief SDP Rewriter
+ *  按规则逐行改写原始 SDP 文本，不构建 SessionDescription，结果写入一个 buffer
+ *  - 规则在启动时添加，按行首类型字符分桶；Rewrite 为 const，可多线程共用
+ *  - 每行先匹配删除规则，命中即删除；否则依次应用替换规则，未命中的行原样输出，保留原有的换行符
+ *  - DropCodec 在每个 media section 内先扫描 a=rtpmap（及 rtx 的 a=fmtp apt=），再从 m= 行删除对应的
+ *    payload type，并删除这些 payload type 的 a=rtpmap / a=rtcp-fb / a=fmtp；
+ *    payload type 全部被删除的 media 保留原样并把端口置 0（RFC 3264 的拒绝）
+ *  - 只做文本改写，不校验 SDP，改写结果与 Parse → 修改 → ToString 的差别在于不会规范化其他行
+ */
+class SdpRewriter {
+  public:
+    SdpRewriter() = default;
+
+    /**
+     * @brief drop lines starting with prefix
+     * @param prefix like "a=extmap:"
+     * @param contains only lines containing it if not empty
+     */
+    void DropLine(const std::string& prefix, const std::string& contains = "", uint8_t scope = kRewriteAll);
+
+    /**
+     * @brief replace a token of lines starting with prefix
+     *  token 以空格分隔，prefix 属于第 0 个 token，如 a=candidate 的地址和端口为第 4、5 个 token
+     * @param match only the token equal to it if not empty
+     */
+    void ReplaceToken(const std::string& prefix, size_t index, const std::string& value,
+                      const std::string& match = "", uint8_t scope = kRewriteAll);
+
+    // address and port of a=candidate, the candidates of from_ip only if it is not empty
+    void SetCandidateAddress(const std::string& ip, uint16_t port, const std::string& from_ip = "",
+                             uint8_t scope = kRewriteAll);
+
+    // payload types of the codec, case insensitive, like "VP8" or "flexfec-03"; rtx of them are dropped too
+    void DropCodec(const std::string& name, uint8_t scope = kRewriteMedias);
+
+    // a=sendrecv / a=sendonly / a=recvonly / a=inactive are replaced, no line is added
+    void SetDirection(SdpTransType direction, uint8_t scope = kRewriteAll);
+
+    /**
+     * @brief rewrite sdp to dst
+     *  dst 先被清空，capacity 足够时不分配内存
+     * @return size_t number of lines dropped or changed
+     */
+    size_t Rewrite(const char* data, size_t len, std::string& dst) const;
+
+    size_t Rewrite(const std::string& sdp, std::string& dst) const { return Rewrite(sdp.data(), sdp.size(), dst); }
+
+  private:
+    enum RuleType : uint8_t {
+        kRuleDropLine = 0,
+        kRuleReplaceToken,
+        kRuleDirection,
+    };
+
+    struct Rule {
+        RuleType    type;
+        uint8_t     scope;
+        std::string prefix;
+        std::string pattern;            // contains of kRuleDropLine, match of kRuleReplaceToken
+        std::string value;
+        size_t      index = 0;          // of the token replaced
+        size_t      match_index = 0;    // of the token compared with pattern
+    };
+
+    struct Codec {
+        std::string name;
+        uint8_t     scope;
+    };
+
+    // payload types of a media section
+    struct PayloadTypes {
+        uint64_t bits[4] = {};
+
+        bool Has(uint64_t pt) const { return pt < 256 && (bits[pt >> 6] >> (pt & 63)) & 1; }
+        void Add(uint64_t pt) { if (pt < 256) bits[pt >> 6] |= uint64_t(1) << (pt & 63); }
+    };
+
+    void addRule(Rule&& rule);
+
+    // payload types to drop of the section [data, end) after the m= line, false if none
+    bool collectDropped(const char* data, const char* end, uint8_t scope, PayloadTypes& dropped) const;
+
+    // m= line without the dropped payload types, false if all of them are dropped and the port is set to 0
+    bool appendMediaLine(const char* line, size_t len, const PayloadTypes& dropped, std::string& dst) const;
+
+    // true if the line is dropped or written to dst changed, dst is unchanged otherwise
+    bool applyRules(const char* line, size_t len, uint8_t scope, bool& drop, std::string& dst) const;
+
+    std::vector<Rule>       rules_;
+    // indexes of rules_ by the first char of the line
+    std::vector<uint16_t>   buckets_[128];
+    std::vector<Codec>      codecs_;
+};  // class SdpRewriter
+
+}  // namespace mini_sdp
+
+#endif  // MINI_SDP_SDP_REWRITER_H_
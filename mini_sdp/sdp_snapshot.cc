@@ -0,0 +1,291 @@
+/**
+ * @file mini_sdp/sdp_snapshot.cc
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include "sdp_snapshot.h"
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+namespace mini_sdp {
+
+static_assert(std::is_trivially_copyable<FlatMedia>::value && std::is_trivially_copyable<FlatCodec>::value &&
+              std::is_trivially_copyable<FlatTrack>::value && std::is_trivially_copyable<FlatExt>::value &&
+              std::is_trivially_copyable<FlatSsrcGroup>::value && std::is_trivially_copyable<FlatRid>::value &&
+              std::is_trivially_copyable<FlatAttr>::value && std::is_trivially_copyable<SdpSnapshotHeader>::value,
+              "records of a snapshot are copied as bytes");
+static_assert(alignof(FlatMedia) <= kSdpSnapshotAlign && alignof(FlatCodec) <= kSdpSnapshotAlign &&
+              alignof(SdpSnapshotHeader) <= kSdpSnapshotAlign, "sections are aligned by kSdpSnapshotAlign");
+
+static size_t alignUp(size_t size) {
+    return (size + kSdpSnapshotAlign - 1) & ~(kSdpSnapshotAlign - 1);
+}
+
+// pointer and record count of each pool of flat
+struct SnapshotPools {
+    const void* data[kSnapshotSectionNum];
+    size_t      count[kSnapshotSectionNum];
+    size_t      record_size[kSnapshotSectionNum];
+
+    template <typename Vector>
+    void set(SdpSnapshotSectionId id, const Vector& pool) {
+        data[id] = pool.data();
+        count[id] = pool.size();
+        record_size[id] = sizeof(pool[0]);
+    }
+
+    explicit SnapshotPools(const FlatSessionDescription& flat) {
+        set(kSnapshotMedias, flat.Medias);
+        set(kSnapshotCodecs, flat.Codecs);
+        set(kSnapshotTracks, flat.Tracks);
+        set(kSnapshotExts, flat.Exts);
+        set(kSnapshotSsrcGroups, flat.SsrcGroups);
+        set(kSnapshotRids, flat.Rids);
+        set(kSnapshotAttrs, flat.Attrs);
+        set(kSnapshotStrPool, flat.StrPool);
+        set(kSnapshotSsrcs, flat.Ssrcs);
+        set(kSnapshotStrings, flat.Strings);
+    }
+
+    size_t Size() const {
+        size_t size = alignUp(sizeof(SdpSnapshotHeader));
+        for (int i = 0; i < kSnapshotSectionNum; i++) size += alignUp(count[i] * record_size[i]);
+        return size;
+    }
+};
+
+size_t SdpSnapshotSize(const FlatSessionDescription& flat) {
+    return SnapshotPools(flat).Size();
+}
+
+size_t WriteSdpSnapshot(const FlatSessionDescription& flat, char* buff, size_t len) {
+    SnapshotPools pools(flat);
+    size_t size = pools.Size();
+    if (size > len || size > UINT32_MAX) return 0;
+
+    SdpSnapshotHeader header;
+    header.TotalSize = uint32_t(size);
+    header.Version = flat.Version;
+    header.AddrType = flat.AddrType;
+    header.TransType = flat.TransType;
+    header.RoleType = flat.RoleType;
+    header.UserName = flat.UserName;
+    header.SessionId = flat.SessionId;
+    header.SessionVersion = flat.SessionVersion;
+    header.SessionName = flat.SessionName;
+    header.SessionInfo = flat.SessionInfo;
+    header.MediaStreamId = flat.MediaStreamId;
+    header.GroupBundle = flat.GroupBundle;
+    header.Attributes = flat.Attributes;
+
+    size_t offset = alignUp(sizeof(SdpSnapshotHeader));
+    for (int i = 0; i < kSnapshotSectionNum; i++) {
+        SdpSnapshotSection& section = header.Sections[i];
+        size_t bytes = pools.count[i] * pools.record_size[i];
+        section.Offset = uint32_t(offset);
+        section.Count = uint32_t(pools.count[i]);
+        section.RecordSize = uint32_t(pools.record_size[i]);
+        if (bytes) memcpy(buff + offset, pools.data[i], bytes);
+        // the padding is zeroed, the same flat gives the same tail
+        memset(buff + offset + bytes, 0, alignUp(bytes) - bytes);
+        offset += alignUp(bytes);
+    }
+    memset(buff, 0, alignUp(sizeof(SdpSnapshotHeader)));
+    memcpy(buff, &header, sizeof(header));
+    return size;
+}
+
+bool WriteSdpSnapshot(const FlatSessionDescription& flat, std::string& dst) {
+    dst.resize(SdpSnapshotSize(flat));
+    return WriteSdpSnapshot(flat, &dst[0], dst.size()) == dst.size();
+}
+
+/**
+ * SdpSnapshotView
+ */
+
+bool SdpSnapshotView::checkStr(const FlatStr& str) const {
+    uint32_t size = count(kSnapshotStrings);
+    return str.Offset <= size && str.Size <= size - str.Offset;
+}
+
+bool SdpSnapshotView::checkStr(const FlatShortStr& str) const {
+    if (str.Size <= kFlatShortStrCap) return true;
+    return str.Size == kFlatShortStrCap + 1 && checkStr(str.Spill);
+}
+
+bool SdpSnapshotView::checkRange(const FlatRange& range, SdpSnapshotSectionId id) const {
+    uint32_t size = count(id);
+    return range.Begin <= size && range.Size <= size - range.Begin;
+}
+
+bool SdpSnapshotView::checkAttrs(const FlatRange& range) const {
+    if (!checkRange(range, kSnapshotAttrs)) return false;
+    for (auto& attr : Attrs(range)) {
+        if (!checkStr(attr.Key) || !checkStr(attr.Value)) return false;
+    }
+    return true;
+}
+
+bool SdpSnapshotView::checkMedia(const FlatMedia& media) const {
+    if (uint32_t(media.MediaType) > uint32_t(SdpMediaType::kData) ||
+        uint32_t(media.AddrType) > uint32_t(SdpAddrType::kIPv6) ||
+        uint32_t(media.TransType) > uint32_t(SdpTransType::kInactive) ||
+        uint32_t(media.RoleType) > uint32_t(SdpRoleType::kPassive)) {
+        return false;
+    }
+    const FlatStr* strs[] = {&media.Key, &media.Protos, &media.MediaId, &media.MediaName, &media.IceOptions,
+                             &media.StreamId, &media.TrackId, &media.CandidateIp, &media.FingerprintMethod,
+                             &media.FingerprintValue, &media.Simulcast};
+    for (const FlatStr* str : strs) {
+        if (!checkStr(*str)) return false;
+    }
+    if (!checkStr(media.IceUfrag) || !checkStr(media.IcePwd)) return false;
+
+    if (!checkRange(media.Codecs, kSnapshotCodecs) || !checkRange(media.Tracks, kSnapshotTracks) ||
+        !checkRange(media.TracksOrder, kSnapshotSsrcs) || !checkRange(media.ExtMap, kSnapshotExts) ||
+        !checkRange(media.SsrcGroups, kSnapshotSsrcGroups) || !checkRange(media.Rids, kSnapshotRids) ||
+        !checkAttrs(media.Attributes)) {
+        return false;
+    }
+    for (auto& codec : Codecs(media.Codecs)) {
+        if ((codec.Feedbacks >> kFlatFbNum) || !checkStr(codec.Name) ||
+            !checkRange(codec.ExtraFeedbacks, kSnapshotStrPool) || !checkAttrs(codec.FormatParams) ||
+            !checkAttrs(codec.Attributes)) {
+            return false;
+        }
+        for (auto& feedback : StrPool(codec.ExtraFeedbacks)) {
+            if (!checkStr(feedback)) return false;
+        }
+    }
+    for (auto& track : Tracks(media.Tracks)) {
+        if (!checkAttrs(track.Attributes)) return false;
+    }
+    for (auto& ext : Exts(media.ExtMap)) {
+        if (!checkStr(ext.Uri)) return false;
+    }
+    for (auto& group : SsrcGroups(media.SsrcGroups)) {
+        if (!checkStr(group.Semantics) || !checkRange(group.Ssrcs, kSnapshotSsrcs)) return false;
+    }
+    for (auto& rid : Rids(media.Rids)) {
+        if (!checkStr(rid.Id) || !checkStr(rid.Direction) || !checkStr(rid.Params)) return false;
+    }
+    return true;
+}
+
+bool SdpSnapshotView::Open(const void* data, size_t len) {
+    static const uint32_t record_sizes[kSnapshotSectionNum] = {
+        sizeof(FlatMedia), sizeof(FlatCodec), sizeof(FlatTrack), sizeof(FlatExt), sizeof(FlatSsrcGroup),
+        sizeof(FlatRid), sizeof(FlatAttr), sizeof(FlatStr), sizeof(uint32_t), 1};
+
+    data_ = nullptr;
+    header_ = nullptr;
+    strings_ = nullptr;
+    if (data == nullptr || len < sizeof(SdpSnapshotHeader) ||
+        reinterpret_cast<uintptr_t>(data) % kSdpSnapshotAlign != 0) {
+        return false;
+    }
+    const SdpSnapshotHeader* header = static_cast<const SdpSnapshotHeader*>(data);
+    if (header->Magic != kSdpSnapshotMagic || header->FormatVersion != kSdpSnapshotVersion ||
+        header->ByteOrder != kSdpSnapshotByteOrder || header->HeaderSize != sizeof(SdpSnapshotHeader) ||
+        header->TotalSize > len) {
+        return false;
+    }
+    for (int i = 0; i < kSnapshotSectionNum; i++) {
+        const SdpSnapshotSection& section = header->Sections[i];
+        if (section.RecordSize != record_sizes[i] || section.Offset % kSdpSnapshotAlign != 0 ||
+            section.Offset < sizeof(SdpSnapshotHeader) || section.Offset > header->TotalSize ||
+            uint64_t(section.Count) * section.RecordSize > header->TotalSize - section.Offset) {
+            return false;
+        }
+    }
+    if (uint32_t(header->AddrType) > uint32_t(SdpAddrType::kIPv6) ||
+        uint32_t(header->TransType) > uint32_t(SdpTransType::kInactive) ||
+        uint32_t(header->RoleType) > uint32_t(SdpRoleType::kPassive)) {
+        return false;
+    }
+
+    data_ = static_cast<const char*>(data);
+    header_ = header;
+    strings_ = data_ + header->Sections[kSnapshotStrings].Offset;
+    bool valid = checkStr(header->UserName) && checkStr(header->SessionId) && checkStr(header->SessionVersion) &&
+                 checkStr(header->SessionName) && checkStr(header->SessionInfo) &&
+                 checkStr(header->MediaStreamId) && checkRange(header->GroupBundle, kSnapshotStrPool) &&
+                 checkAttrs(header->Attributes);
+    for (auto& mid : StrPool(header->GroupBundle)) {
+        valid = valid && checkStr(mid);
+    }
+    for (auto& media : Medias()) {
+        valid = valid && checkMedia(media);
+    }
+    if (!valid) {
+        data_ = nullptr;
+        header_ = nullptr;
+        strings_ = nullptr;
+    }
+    return valid;
+}
+
+const FlatMedia* SdpSnapshotView::FindMedia(const char* key, size_t len) const {
+    FlatSpan<FlatMedia> medias = Medias();
+    // the same order as std::string
+    auto less = [this](const FlatMedia& media, const StrSlice& key) {
+        StrSlice str = Str(media.Key);
+        int ret = memcmp(str.ptr, key.ptr, std::min(str.len, key.len));
+        return ret < 0 || (ret == 0 && str.len < key.len);
+    };
+    const FlatMedia* it = std::lower_bound(medias.begin(), medias.end(), StrSlice{key, len}, less);
+    if (it == medias.end() || !Str(it->Key).IsEqual(key, len)) return nullptr;
+    return it;
+}
+
+template <typename Vector>
+static void assignSection(const FlatSpan<typename Vector::value_type>& span, Vector& dst) {
+    dst.assign(span.begin(), span.end());
+}
+
+void SdpSnapshotView::ToFlat(FlatSessionDescription& flat) const {
+    const SdpSnapshotHeader& header = *header_;
+    flat.Version = header.Version;
+    flat.AddrType = header.AddrType;
+    flat.TransType = header.TransType;
+    flat.RoleType = header.RoleType;
+    flat.UserName = header.UserName;
+    flat.SessionId = header.SessionId;
+    flat.SessionVersion = header.SessionVersion;
+    flat.SessionName = header.SessionName;
+    flat.SessionInfo = header.SessionInfo;
+    flat.MediaStreamId = header.MediaStreamId;
+    flat.GroupBundle = header.GroupBundle;
+    flat.Attributes = header.Attributes;
+
+    assignSection(Medias(), flat.Medias);
+    assignSection(section<FlatCodec>(kSnapshotCodecs, 0, count(kSnapshotCodecs)), flat.Codecs);
+    assignSection(section<FlatTrack>(kSnapshotTracks, 0, count(kSnapshotTracks)), flat.Tracks);
+    assignSection(section<FlatExt>(kSnapshotExts, 0, count(kSnapshotExts)), flat.Exts);
+    assignSection(section<FlatSsrcGroup>(kSnapshotSsrcGroups, 0, count(kSnapshotSsrcGroups)), flat.SsrcGroups);
+    assignSection(section<FlatRid>(kSnapshotRids, 0, count(kSnapshotRids)), flat.Rids);
+    assignSection(section<FlatAttr>(kSnapshotAttrs, 0, count(kSnapshotAttrs)), flat.Attrs);
+    assignSection(section<FlatStr>(kSnapshotStrPool, 0, count(kSnapshotStrPool)), flat.StrPool);
+    assignSection(section<uint32_t>(kSnapshotSsrcs, 0, count(kSnapshotSsrcs)), flat.Ssrcs);
+    flat.Strings.assign(strings_, count(kSnapshotStrings));
+}
+
+SessionDescriptionPtr SdpSnapshotView::ToSessionDescription() const {
+    FlatSessionDescription flat;
+    ToFlat(flat);
+    return flat.ToSessionDescription();
+}
+
+std::string SdpSnapshotView::ToString() const {
+    FlatSessionDescription flat;
+    ToFlat(flat);
+    return flat.ToString();
+}
+
+}  // namespace mini_sdp
@@ -0,0 +1,201 @@
+/**
+ * @file mini_sdp/sdp_snapshot.h
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#ifndef MINI_SDP_SDP_SNAPSHOT_H_
+#define MINI_SDP_SDP_SNAPSHOT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "flat_sdp.h"
+#include "util.h"
+
+namespace mini_sdp {
+
+constexpr uint32_t kSdpSnapshotMagic = 0x53504453;     // "SDPS"
+constexpr uint16_t kSdpSnapshotVersion = 1;
+constexpr uint16_t kSdpSnapshotByteOrder = 0x0102;     // written in host order
+constexpr size_t   kSdpSnapshotAlign = 8;              // of the buffer and every section
+
+// sections of a snapshot, the pools of FlatSessionDescription
+enum SdpSnapshotSectionId {
+    kSnapshotMedias = 0,
+    kSnapshotCodecs,
+    kSnapshotTracks,
+    kSnapshotExts,
+    kSnapshotSsrcGroups,
+    kSnapshotRids,
+    kSnapshotAttrs,
+    kSnapshotStrPool,
+    kSnapshotSsrcs,
+    kSnapshotStrings,
+    kSnapshotSectionNum
+};
+
+struct SdpSnapshotSection {
+    uint32_t    Offset = 0;         // from the start of the snapshot
+    uint32_t    Count = 0;          // of records
+    uint32_t    RecordSize = 0;     // sizeof the record, 1 for Strings
+    uint32_t    Reserved = 0;
+};
+
+/*
+ * snapshot header
+ *  快照以该结构开头，其后为各个 section，session 级别的字段直接存放在 header 中
+ */
+struct SdpSnapshotHeader {
+    uint32_t            Magic = kSdpSnapshotMagic;
+    uint16_t            FormatVersion = kSdpSnapshotVersion;
+    uint16_t            ByteOrder = kSdpSnapshotByteOrder;
+    uint32_t            HeaderSize = sizeof(SdpSnapshotHeader);
+    uint32_t            TotalSize = 0;
+    SdpSnapshotSection  Sections[kSnapshotSectionNum];
+
+    // session of FlatSessionDescription
+    int32_t             Version = 0;
+    SdpAddrType         AddrType = SdpAddrType::kIPv4;
+    SdpTransType        TransType = SdpTransType::kTransNone;
+    SdpRoleType         RoleType = SdpRoleType::kRoleNone;
+    FlatStr             UserName;
+    FlatStr             SessionId;
+    FlatStr             SessionVersion;
+    FlatStr             SessionName;
+    FlatStr             SessionInfo;
+    FlatStr             MediaStreamId;
+    FlatRange           GroupBundle;    // of StrPool
+    FlatRange           Attributes;     // of Attrs
+};
+
+// records of a section in place
+template <typename T>
+struct FlatSpan {
+    const T*    ptr = nullptr;
+    size_t      len = 0;
+
+    const T* begin() const { return ptr; }
+    const T* end() const { return ptr + len; }
+    size_t size() const { return len; }
+    bool empty() const { return len == 0; }
+    const T& operator[](size_t i) const { return ptr[i]; }
+};
+
+/**
+ * @brief SDP Snapshot
+ *  FlatSessionDescription 的二进制快照：一段连续内存，只有偏移没有指针，可直接写入共享内存或文件，
+ *  在另一进程中原地读取，不反序列化
+ *  - 布局为 SdpSnapshotHeader + 各 section，section 为 FlatSessionDescription 各个池的原样拷贝，按 8 字节对齐
+ *  - header 记录格式版本、字节序与每种记录的大小，布局不同的版本 / 主机 / 编译产物生成的快照在 Open 时被拒绝
+ *  - 记录中的 padding 字节按原样拷贝，快照内容不用于比较
+ */
+
+// size of the snapshot of flat
+size_t SdpSnapshotSize(const FlatSessionDescription& flat);
+
+/**
+ * @brief write the snapshot of flat to buff
+ *  buff 需要按 kSdpSnapshotAlign 对齐才能原地读取
+ * @return size_t size of the snapshot, 0 if len is not enough or the snapshot exceeds 4GB
+ */
+size_t WriteSdpSnapshot(const FlatSessionDescription& flat, char* buff, size_t len);
+
+// dst is resized to the snapshot, the capacity is reused
+bool WriteSdpSnapshot(const FlatSessionDescription& flat, std::string& dst);
+
+/**
+ * @brief SDP Snapshot View
+ *  原地读取快照，Open 校验 header 并检查所有偏移与区间不越界（线性扫描，不分配内存），
+ *  之后的访问不再检查；快照内存在 view 使用期间需要保持有效且不被修改
+ */
+class SdpSnapshotView {
+  public:
+    SdpSnapshotView() = default;
+
+    // false if it is not a valid snapshot of this version, data is aligned by kSdpSnapshotAlign
+    bool Open(const void* data, size_t len);
+
+    bool IsOpen() const { return header_ != nullptr; }
+
+    const SdpSnapshotHeader& Header() const { return *header_; }
+
+    size_t Size() const { return header_->TotalSize; }
+
+    // sorted by key
+    FlatSpan<FlatMedia> Medias() const { return section<FlatMedia>(kSnapshotMedias, 0, count(kSnapshotMedias)); }
+
+    // media of the key, nullptr if not found
+    const FlatMedia* FindMedia(const char* key, size_t len) const;
+
+    const FlatMedia* FindMedia(const std::string& key) const { return FindMedia(key.data(), key.size()); }
+
+    FlatSpan<FlatCodec> Codecs(const FlatRange& range) const { return section<FlatCodec>(kSnapshotCodecs, range); }
+
+    FlatSpan<FlatTrack> Tracks(const FlatRange& range) const { return section<FlatTrack>(kSnapshotTracks, range); }
+
+    FlatSpan<FlatExt> Exts(const FlatRange& range) const { return section<FlatExt>(kSnapshotExts, range); }
+
+    FlatSpan<FlatSsrcGroup> SsrcGroups(const FlatRange& range) const {
+        return section<FlatSsrcGroup>(kSnapshotSsrcGroups, range);
+    }
+
+    FlatSpan<FlatRid> Rids(const FlatRange& range) const { return section<FlatRid>(kSnapshotRids, range); }
+
+    FlatSpan<FlatAttr> Attrs(const FlatRange& range) const { return section<FlatAttr>(kSnapshotAttrs, range); }
+
+    FlatSpan<FlatStr> StrPool(const FlatRange& range) const { return section<FlatStr>(kSnapshotStrPool, range); }
+
+    FlatSpan<uint32_t> Ssrcs(const FlatRange& range) const { return section<uint32_t>(kSnapshotSsrcs, range); }
+
+    StrSlice Str(const FlatStr& str) const { return StrSlice{strings_ + str.Offset, str.Size}; }
+
+    StrSlice Str(const FlatShortStr& str) const {
+        return str.Size <= kFlatShortStrCap ? StrSlice{str.Data, str.Size} : Str(str.Spill);
+    }
+
+    // copy of the pools, the capacity of flat is reused
+    void ToFlat(FlatSessionDescription& flat) const;
+
+    SessionDescriptionPtr ToSessionDescription() const;
+
+    std::string ToString() const;
+
+  private:
+    uint32_t count(SdpSnapshotSectionId id) const { return header_->Sections[id].Count; }
+
+    template <typename T>
+    FlatSpan<T> section(SdpSnapshotSectionId id, size_t begin, size_t size) const {
+        FlatSpan<T> span;
+        span.ptr = reinterpret_cast<const T*>(data_ + header_->Sections[id].Offset) + begin;
+        span.len = size;
+        return span;
+    }
+
+    template <typename T>
+    FlatSpan<T> section(SdpSnapshotSectionId id, const FlatRange& range) const {
+        return section<T>(id, range.Begin, range.Size);
+    }
+
+    bool checkMedia(const FlatMedia& media) const;
+
+    bool checkStr(const FlatStr& str) const;
+
+    bool checkStr(const FlatShortStr& str) const;
+
+    bool checkRange(const FlatRange& range, SdpSnapshotSectionId id) const;
+
+    bool checkAttrs(const FlatRange& range) const;
+
+  private:
+    const char*                 data_ = nullptr;
+    const SdpSnapshotHeader*    header_ = nullptr;
+    const char*                 strings_ = nullptr;
+};  // class SdpSnapshotView
+
+}  // namespace mini_sdp
+
+#endif  // MINI_SDP_SDP_SNAPSHOT_H_
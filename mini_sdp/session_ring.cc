@@ -0,0 +1,357 @@
+/**
+ * @file mini_sdp/session_ring.cc
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include "session_ring.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <ctime>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+
+namespace mini_sdp {
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2, "atomics in shared memory are lock free");
+
+constexpr uint32_t kSessionRingMagic = 0x474e4952;     // "RING"
+constexpr uint32_t kSessionRingVersion = 1;
+constexpr size_t   kCacheLine = 64;
+constexpr uint32_t kMaxPayloadSize = 1u << 30;
+
+/*
+ * shared header
+ *  reserve 为生产者的预留位置，released 为消费者已归还的位置，高 32 位为 slot 序号，低 32 位为 payload 字节序号；
+ *  两者都只增不减，按 2^32 回绕，差值即占用量。生产者以一次 CAS 同时预留 slot 和 payload，
+ *  payload 按预留顺序分配，消费者按同样的顺序归还
+ */
+struct SessionRingHeader {
+    uint32_t                magic;
+    uint32_t                version;
+    uint32_t                slot_num;
+    uint32_t                payload_size;
+    uint32_t                slot_size;
+
+    alignas(kCacheLine) std::atomic<uint64_t>  reserve;
+    alignas(kCacheLine) std::atomic<uint64_t>  released;
+    std::atomic<uint32_t>   waiting;        // the consumer is blocked on the eventfd
+};
+
+struct alignas(kCacheLine) SessionRingSlot {
+    std::atomic<uint32_t>   ready;          // pos + 1 when published
+    uint32_t                payload_offset;
+    uint32_t                payload_end;    // of the reservation, in bytes since creation
+    uint32_t                origin_sdp_len;
+    uint32_t                stream_url_len;
+    uint32_t                svrsig_len;
+    SessionRingMeta         meta;
+};
+
+static uint32_t roundUpPow2(uint32_t value) {
+    uint32_t pow2 = 1;
+    while (pow2 < value) pow2 <<= 1;
+    return pow2;
+}
+
+static size_t alignUp(size_t size) {
+    return (size + kCacheLine - 1) & ~(kCacheLine - 1);
+}
+
+static size_t segmentSize(uint32_t slot_num, uint32_t payload_size) {
+    return alignUp(sizeof(SessionRingHeader)) + size_t(slot_num) * sizeof(SessionRingSlot) + payload_size;
+}
+
+static uint64_t monotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint64_t(ts.tv_sec) * 1000000000ull + uint64_t(ts.tv_nsec);
+}
+
+bool RingSourceAddr::Assign(const struct sockaddr* sa) {
+    *this = RingSourceAddr();
+    if (sa == nullptr) return false;
+    if (sa->sa_family == AF_INET) {
+        auto in = reinterpret_cast<const struct sockaddr_in*>(sa);
+        family = AF_INET;
+        port = ntohs(in->sin_port);
+        memcpy(addr, &in->sin_addr, sizeof(in->sin_addr));
+        return true;
+    }
+    if (sa->sa_family == AF_INET6) {
+        auto in6 = reinterpret_cast<const struct sockaddr_in6*>(sa);
+        family = AF_INET6;
+        port = ntohs(in6->sin6_port);
+        memcpy(addr, &in6->sin6_addr, sizeof(in6->sin6_addr));
+        return true;
+    }
+    return false;
+}
+
+void SessionRingMeta::Assign(const OriginSdpAttr& attr) {
+    status_code = attr.status_code;
+    seq = attr.seq;
+    sdp_type = uint8_t(attr.sdp_type);
+    version = attr.version;
+    is_push = int8_t(attr.is_push);
+    is_imm_send = attr.is_imm_send;
+    is_support_aac_fmtp = attr.is_support_aac_fmtp;
+    is_compact_fingerprint = attr.is_compact_fingerprint;
+}
+
+void SessionRingEntry::ToOriginSdpAttr(OriginSdpAttr& attr) const {
+    attr.sdp_type = SdpType(meta->sdp_type);
+    attr.origin_sdp.assign(origin_sdp.ptr, origin_sdp.len);
+    attr.stream_url.assign(stream_url.ptr, stream_url.len);
+    attr.svrsig.assign(svrsig.ptr, svrsig.len);
+    attr.status_code = meta->status_code;
+    attr.seq = meta->seq;
+    attr.is_imm_send = meta->is_imm_send;
+    attr.is_support_aac_fmtp = meta->is_support_aac_fmtp;
+    attr.is_compact_fingerprint = meta->is_compact_fingerprint;
+    attr.is_push = StreamDirection(meta->is_push);
+    attr.version = meta->version;
+}
+
+/**
+ * SessionRing
+ */
+
+SessionRing::~SessionRing() {
+    close();
+}
+
+void SessionRing::close() {
+    if (base_ != nullptr) munmap(base_, map_size_);
+    if (shm_fd_ >= 0) ::close(shm_fd_);
+    if (event_fd_ >= 0) ::close(event_fd_);
+    shm_fd_ = -1;
+    event_fd_ = -1;
+    base_ = nullptr;
+    map_size_ = 0;
+    header_ = nullptr;
+    slots_ = nullptr;
+    payload_ = nullptr;
+    slot_num_ = 0;
+    payload_size_ = 0;
+    tail_ = 0;
+}
+
+bool SessionRing::map(int shm_fd, size_t size, uint32_t slot_num) {
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+    if (base == MAP_FAILED) return false;
+    base_ = static_cast<char*>(base);
+    map_size_ = size;
+    header_ = reinterpret_cast<SessionRingHeader*>(base_);
+    slots_ = reinterpret_cast<SessionRingSlot*>(base_ + alignUp(sizeof(SessionRingHeader)));
+    payload_ = base_ + alignUp(sizeof(SessionRingHeader)) + size_t(slot_num) * sizeof(SessionRingSlot);
+    return true;
+}
+
+bool SessionRing::Create(uint32_t slot_num, uint32_t payload_size) {
+    close();
+    if (slot_num == 0 || slot_num > (1u << 24) || payload_size == 0 || payload_size > kMaxPayloadSize) return false;
+    slot_num = roundUpPow2(slot_num);
+    payload_size = roundUpPow2(payload_size);
+    size_t size = segmentSize(slot_num, payload_size);
+
+#ifdef SYS_memfd_create
+    int shm_fd = int(syscall(SYS_memfd_create, "mini_sdp_ring", MFD_CLOEXEC));
+#else
+    int shm_fd = -1;
+#endif
+    if (shm_fd < 0) return false;
+    if (ftruncate(shm_fd, off_t(size)) != 0) {
+        ::close(shm_fd);
+        return false;
+    }
+    shm_fd_ = shm_fd;
+    event_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (event_fd_ < 0 || !map(shm_fd, size, slot_num)) {
+        close();
+        return false;
+    }
+    // the pages of a new memfd are zero, so are the atomics
+    header_->magic = kSessionRingMagic;
+    header_->version = kSessionRingVersion;
+    header_->slot_num = slot_num;
+    header_->payload_size = payload_size;
+    header_->slot_size = sizeof(SessionRingSlot);
+    slot_num_ = slot_num;
+    payload_size_ = payload_size;
+    return true;
+}
+
+bool SessionRing::Attach(int shm_fd, int event_fd) {
+    close();
+    struct stat st;
+    if (shm_fd < 0 || event_fd < 0 || fstat(shm_fd, &st) != 0 || size_t(st.st_size) < sizeof(SessionRingHeader)) {
+        return false;
+    }
+    // magic, version, slot_num, payload_size, slot_size
+    uint32_t fields[5];
+    if (pread(shm_fd, fields, sizeof(fields), 0) != ssize_t(sizeof(fields))) return false;
+    uint32_t slot_num = fields[2], payload_size = fields[3];
+    if (fields[0] != kSessionRingMagic || fields[1] != kSessionRingVersion || fields[4] != sizeof(SessionRingSlot) ||
+        slot_num == 0 || (slot_num & (slot_num - 1)) || slot_num > (1u << 24) || payload_size == 0 ||
+        (payload_size & (payload_size - 1)) || payload_size > kMaxPayloadSize ||
+        size_t(st.st_size) < segmentSize(slot_num, payload_size)) {
+        return false;
+    }
+    if (!map(shm_fd, segmentSize(slot_num, payload_size), slot_num)) return false;
+    shm_fd_ = shm_fd;
+    event_fd_ = event_fd;
+    slot_num_ = slot_num;
+    payload_size_ = payload_size;
+    tail_ = uint32_t(header_->released.load(std::memory_order_acquire) >> 32);
+    return true;
+}
+
+bool SessionRing::Reserve(size_t origin_sdp_len, size_t stream_url_len, size_t svrsig_len,
+                          SessionRingReservation& reservation) {
+    if (header_ == nullptr) return false;
+    size_t len = origin_sdp_len + stream_url_len + svrsig_len;
+    if (len > MaxPayload()) return false;
+    const uint32_t mask = payload_size_ - 1;
+
+    uint64_t cur = header_->reserve.load(std::memory_order_relaxed);
+    uint32_t slot_pos, offset, need;
+    for (;;) {
+        slot_pos = uint32_t(cur >> 32);
+        uint32_t payload_pos = uint32_t(cur);
+        uint64_t released = header_->released.load(std::memory_order_acquire);
+        if (slot_pos - uint32_t(released >> 32) >= slot_num_) return false;
+        // the payload is contiguous, the bytes left at the end are skipped; len <= MaxPayload makes it fit
+        offset = payload_pos & mask;
+        need = uint32_t(len);
+        if (offset + len > payload_size_) {
+            need += payload_size_ - offset;
+            offset = 0;
+        }
+        if (payload_pos + need - uint32_t(released) > payload_size_) return false;
+        uint64_t next = (uint64_t(slot_pos + 1) << 32) | uint32_t(payload_pos + need);
+        if (header_->reserve.compare_exchange_weak(cur, next, std::memory_order_relaxed)) {
+            need += payload_pos;
+            break;
+        }
+    }
+
+    SessionRingSlot& slot = slots_[slot_pos & (slot_num_ - 1)];
+    slot.payload_offset = offset;
+    slot.payload_end = need;
+    slot.origin_sdp_len = uint32_t(origin_sdp_len);
+    slot.stream_url_len = uint32_t(stream_url_len);
+    slot.svrsig_len = uint32_t(svrsig_len);
+    slot.meta = SessionRingMeta();
+    reservation.meta = &slot.meta;
+    reservation.origin_sdp = payload_ + offset;
+    reservation.stream_url = reservation.origin_sdp + origin_sdp_len;
+    reservation.svrsig = reservation.stream_url + stream_url_len;
+    reservation.pos = slot_pos;
+    return true;
+}
+
+void SessionRing::Commit(const SessionRingReservation& reservation) {
+    SessionRingSlot& slot = slots_[reservation.pos & (slot_num_ - 1)];
+    slot.meta.enqueue_ns = monotonicNs();
+    slot.ready.store(reservation.pos + 1, std::memory_order_release);
+
+    // pairs with the fence in Wait: either the consumer sees the entry or we see it waiting
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (header_->waiting.load(std::memory_order_relaxed) && header_->waiting.exchange(0)) {
+        uint64_t one = 1;
+        ssize_t ret = write(event_fd_, &one, sizeof(one));
+        (void)ret;
+    }
+}
+
+bool SessionRing::TryPush(const OriginSdpAttr& attr, const RingSourceAddr& source) {
+    SessionRingReservation reservation;
+    if (!Reserve(attr.origin_sdp.size(), attr.stream_url.size(), attr.svrsig.size(), reservation)) return false;
+    reservation.meta->Assign(attr);
+    reservation.meta->source = source;
+    memcpy(reservation.origin_sdp, attr.origin_sdp.data(), attr.origin_sdp.size());
+    memcpy(reservation.stream_url, attr.stream_url.data(), attr.stream_url.size());
+    memcpy(reservation.svrsig, attr.svrsig.data(), attr.svrsig.size());
+    Commit(reservation);
+    return true;
+}
+
+size_t SessionRing::Peek(SessionRingEntry* entries, size_t max) {
+    if (header_ == nullptr) return 0;
+    size_t n = 0;
+    for (; n < max; n++) {
+        uint32_t pos = tail_ + uint32_t(n);
+        const SessionRingSlot& slot = slots_[pos & (slot_num_ - 1)];
+        if (slot.ready.load(std::memory_order_acquire) != pos + 1) break;
+        // written by another process, kept in the payload area whatever they are
+        uint32_t offset = std::min(slot.payload_offset, payload_size_);
+        uint32_t left = payload_size_ - offset;
+        uint32_t origin_sdp_len = std::min(slot.origin_sdp_len, left);
+        left -= origin_sdp_len;
+        uint32_t stream_url_len = std::min(slot.stream_url_len, left);
+        left -= stream_url_len;
+        uint32_t svrsig_len = std::min(slot.svrsig_len, left);
+        SessionRingEntry& entry = entries[n];
+        const char* payload = payload_ + offset;
+        entry.meta = &slot.meta;
+        entry.origin_sdp = StrSlice{payload, origin_sdp_len};
+        entry.stream_url = StrSlice{payload + origin_sdp_len, stream_url_len};
+        entry.svrsig = StrSlice{payload + origin_sdp_len + stream_url_len, svrsig_len};
+    }
+    return n;
+}
+
+void SessionRing::Release(size_t n) {
+    if (header_ == nullptr || n == 0) return;
+    tail_ += uint32_t(n);
+    const SessionRingSlot& last = slots_[(tail_ - 1) & (slot_num_ - 1)];
+    header_->released.store((uint64_t(tail_) << 32) | last.payload_end, std::memory_order_release);
+}
+
+bool SessionRing::isEmpty() const {
+    return slots_[tail_ & (slot_num_ - 1)].ready.load(std::memory_order_acquire) != tail_ + 1;
+}
+
+bool SessionRing::Wait(int timeout_ms) {
+    if (header_ == nullptr) return false;
+    // a negative timeout waits forever, as poll
+    bool forever = timeout_ms < 0;
+    uint64_t deadline = monotonicNs() + uint64_t(forever ? 0 : timeout_ms) * 1000000;
+    while (isEmpty()) {
+        header_->waiting.store(1, std::memory_order_relaxed);
+        // pairs with the fence in Commit: either we see the entry or the producer sees us waiting
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (isEmpty()) {
+            uint64_t now = monotonicNs();
+            if (!forever && now >= deadline) break;
+            struct pollfd pfd;
+            pfd.fd = event_fd_;
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+            poll(&pfd, 1, forever ? -1 : int((deadline - now + 999999) / 1000000));
+            // a wakeup left by an entry already consumed only makes another round
+            uint64_t count;
+            ssize_t ret = read(event_fd_, &count, sizeof(count));
+            (void)ret;
+        }
+        header_->waiting.store(0, std::memory_order_relaxed);
+    }
+    header_->waiting.store(0, std::memory_order_relaxed);
+    return !isEmpty();
+}
+
+}  // namespace mini_sdp
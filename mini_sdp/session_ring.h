@@ -0,0 +1,152 @@
+/**
+ * @file mini_sdp/session_ring.h
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#ifndef MINI_SDP_SESSION_RING_H_
+#define MINI_SDP_SESSION_RING_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <sys/socket.h>
+#include "mini_sdp.h"
+#include "util.h"
+
+namespace mini_sdp {
+
+// source address of a request
+struct RingSourceAddr {
+    uint16_t    family = 0;     // AF_INET / AF_INET6, 0 if not set
+    uint16_t    port = 0;       // host order
+    uint8_t     addr[16] = {};  // network order, 4 bytes of ipv4
+
+    // false if it is neither ipv4 nor ipv6
+    bool Assign(const struct sockaddr* sa);
+};
+
+// fixed fields of an entry, in its slot
+struct SessionRingMeta {
+    int32_t         status_code = 0;
+    uint16_t        seq = 0;
+    uint8_t         sdp_type = 0;           // SdpType
+    uint8_t         version = 0;
+    int8_t          is_push = 0;            // StreamDirection
+    uint8_t         is_imm_send = 0;
+    uint8_t         is_support_aac_fmtp = 0;
+    uint8_t         is_compact_fingerprint = 0;
+    RingSourceAddr  source;
+    uint64_t        enqueue_ns = 0;         // CLOCK_MONOTONIC, set by Commit
+
+    // the fixed fields of attr, the strings are written to the payload
+    void Assign(const OriginSdpAttr& attr);
+};
+
+// an entry being written by a producer
+struct SessionRingReservation {
+    SessionRingMeta*    meta = nullptr;
+    char*               origin_sdp = nullptr;
+    char*               stream_url = nullptr;
+    char*               svrsig = nullptr;
+    uint32_t            pos = 0;
+};
+
+// an entry read in place by the consumer, valid until Release
+struct SessionRingEntry {
+    const SessionRingMeta*  meta = nullptr;
+    StrSlice                origin_sdp = {nullptr, 0};
+    StrSlice                stream_url = {nullptr, 0};
+    StrSlice                svrsig = {nullptr, 0};
+
+    // copied out
+    void ToOriginSdpAttr(OriginSdpAttr& attr) const;
+};
+
+struct SessionRingHeader;
+struct SessionRingSlot;
+
+/**
+ * @brief Session Ring
+ *  信令进程把解码后的请求（OriginSdpAttr 的字段 + 源地址）交给媒体进程的共享内存环形队列，替代本地 socket
+ *  - 段位于 memfd 中：header + 定长 slot 数组 + 变长 payload 区，fd 可通过 fork 继承或 SCM_RIGHTS 传给其他进程
+ *  - 多生产者单消费者：生产者以一次 CAS 同时预留 slot 和 payload 字节，原地写入字段后 Commit 发布；
+ *    只有一个生产者时 CAS 无竞争，即 SPSC
+ *  - 消费者 Peek 批量原地读取已发布的条目，处理后 Release 归还，均无系统调用；
+ *    队列为空时 Wait 在 eventfd 上等待，生产者只在消费者等待时写 eventfd
+ *  - 每个媒体 worker 一个 ring；条目按预留顺序发布，预留后未 Commit 的条目会阻塞其后的条目
+ */
+class SessionRing {
+  public:
+    SessionRing() = default;
+
+    ~SessionRing();
+
+    SessionRing(const SessionRing&) = delete;
+    SessionRing& operator=(const SessionRing&) = delete;
+
+    /**
+     * @brief create a segment in a memfd and an eventfd
+     * @param slot_num max entries, rounded up to a power of 2
+     * @param payload_size bytes of strings, rounded up to a power of 2, no more than 1GB
+     */
+    bool Create(uint32_t slot_num, uint32_t payload_size);
+
+    // map a segment created by another process, the fds are owned by the ring after success
+    bool Attach(int shm_fd, int event_fd);
+
+    int ShmFd() const { return shm_fd_; }
+
+    int EventFd() const { return event_fd_; }
+
+    // max length of the strings of an entry, half of the payload area
+    size_t MaxPayload() const { return payload_size_ / 2; }
+
+    /**
+     * @brief reserve an entry, any number of producers
+     * @return false if the ring is full or the strings exceed MaxPayload
+     */
+    bool Reserve(size_t origin_sdp_len, size_t stream_url_len, size_t svrsig_len,
+                 SessionRingReservation& reservation);
+
+    // publish a reserved entry, and wake up the consumer if it is waiting
+    void Commit(const SessionRingReservation& reservation);
+
+    // Reserve + copy + Commit
+    bool TryPush(const OriginSdpAttr& attr, const RingSourceAddr& source);
+
+    // entries published from the head, no more than max, one consumer only;
+    // the lengths in the shared segment are clamped, a slice never leaves the payload area
+    size_t Peek(SessionRingEntry* entries, size_t max);
+
+    // the first n entries of the last Peek are consumed
+    void Release(size_t n);
+
+    // wait for an entry, true if the ring is not empty; a negative timeout waits until an entry is published
+    bool Wait(int timeout_ms);
+
+  private:
+    bool map(int shm_fd, size_t size, uint32_t slot_num);
+
+    bool isEmpty() const;
+
+    void close();
+
+  private:
+    int                 shm_fd_ = -1;
+    int                 event_fd_ = -1;
+    char*               base_ = nullptr;
+    size_t              map_size_ = 0;
+    SessionRingHeader*  header_ = nullptr;
+    SessionRingSlot*    slots_ = nullptr;
+    char*               payload_ = nullptr;
+    uint32_t            slot_num_ = 0;
+    uint32_t            payload_size_ = 0;
+    uint32_t            tail_ = 0;          // of slots, the consumer's
+};  // class SessionRing
+
+}  // namespace mini_sdp
+
+#endif  // MINI_SDP_SESSION_RING_H_
@@ -0,0 +1,222 @@
+/**
+ * @file mini_sdp/size_analyzer.cc
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include "size_analyzer.h"
+#include <functional>
+#include "mini_sdp_codec.h"
+#include "mini_sdp_impl.h"
+#include "sdp_parser.h"
+#include "util.h"
+
+namespace mini_sdp {
+
+static const char* g_section_names[kSizeSectionNum] = {
+    "fixed", "stream_url", "svrsig", "ice", "fingerprint", "candidate", "codecs", "aac_config", "extensions",
+    "tracks"
+};
+
+static const char* g_drop_step_names[kPackDropStepNum] = {
+    "drop_redundant_profile", "drop_unused_extension", "drop_aac_config", "drop_second_ssrc"
+};
+
+const char* SizeSectionName(SizeSection section) {
+    return section < kSizeSectionNum ? g_section_names[section] : "unknown";
+}
+
+namespace {
+
+using SdpEdit = std::function<void(SessionDescription&)>;
+
+/**
+ * @brief Size Probe
+ *  重新解析原始 SDP，修改后打包，得到不受 buffer 限制的打包大小
+ */
+class SizeProbe {
+  public:
+    explicit SizeProbe(const OriginSdpAttr& attr) : attr_(attr), scratch_(packedSizeBound(attr)) {}
+
+    // 0 if failed
+    size_t Size(const OriginSdpAttr& attr, const SdpEdit& edit = nullptr) {
+        const MiniSdpCodec* codec = MiniSdpCodecRegistry::Instance().Find(attr.version);
+        if (!codec) return 0;
+        SessionDescriptionPtr sdp_info;
+        if (attr.sdp_type != SdpType::kSdpNone) {
+            SdpParser sdp_parser(attr.origin_sdp.c_str(), attr.origin_sdp.size());
+            if (!sdp_parser.Parse()) return 0;
+            sdp_info = sdp_parser.GetSessionDescription();
+            if (edit) edit(*sdp_info);
+        }
+        if (scratch_.size() < packedSizeBound(attr)) scratch_.resize(packedSizeBound(attr));
+        int size = codec->Pack(attr, sdp_info, scratch_.data(), scratch_.size());
+        while (size > 0 && size_t(size) > scratch_.size()) {
+            scratch_.resize(size * 2);
+            size = codec->Pack(attr, sdp_info, scratch_.data(), scratch_.size());
+        }
+        return size;
+    }
+
+    size_t Size(const SdpEdit& edit) { return Size(attr_, edit); }
+
+    // bytes saved by edit
+    size_t Saved(size_t total, const SdpEdit& edit) {
+        size_t size = Size(edit);
+        return size > 0 && size < total ? total - size : 0;
+    }
+
+    // bytes saved by edit of the mid media
+    size_t Saved(size_t total, const std::string& mid, const std::function<void(MediaDescription&)>& edit) {
+        return Saved(total, [&](SessionDescription& sdp) {
+            auto it = sdp.Medias.find(mid);
+            if (it != sdp.Medias.end()) edit(*it->second);
+        });
+    }
+
+  private:
+    // 头部不超过一个最大包，其余每项都比原始 SDP 中对应的行短，字符串原样写入
+    static size_t packedSizeBound(const OriginSdpAttr& attr) {
+        return kMiniMiniSdpMaxLen + attr.origin_sdp.size() + attr.stream_url.size() + attr.svrsig.size();
+    }
+
+    const OriginSdpAttr&    attr_;
+    std::vector<char>       scratch_;
+};  // class SizeProbe
+
+bool isAacCodec(const CodecDescription& codec) {
+    return codec.Name == kSdpCodecLatm || codec.Name == kSdpCodecAdts;
+}
+
+void analyzeMedias(const OriginSdpAttr& attr, const MiniSdpCodec& codec, SizeProbe& probe, SizeAnalysis& analysis) {
+    SdpParser sdp_parser(attr.origin_sdp.c_str(), attr.origin_sdp.size());
+    if (!sdp_parser.Parse()) return;
+    for (auto& media_pair : sdp_parser.GetSessionDescription()->Medias) {
+        auto& media = *media_pair.second;
+        MediaSize media_size;
+        media_size.mid = media_pair.first;
+        media_size.media_type = media.MediaType;
+        for (auto& codec_pair : media.Codecs) {
+            if (codec.CodecSize(*codec_pair.second, attr.is_support_aac_fmtp) > 0) media_size.codec_num++;
+        }
+        for (auto& ext : media.ExtMap) {
+            if (codec.ExtSize(Trim(ext.second)) > 0) media_size.ext_num++;
+        }
+
+        size_t codecs = probe.Saved(analysis.total, media_size.mid, [](MediaDescription& m) { m.Codecs.clear(); });
+        media_size.aac_config = probe.Saved(analysis.total, media_size.mid, [](MediaDescription& m) {
+            for (auto& codec_pair : m.Codecs) {
+                if (isAacCodec(*codec_pair.second)) codec_pair.second->FormatParams.erase("config");
+            }
+        });
+        media_size.codecs = codecs > media_size.aac_config ? codecs - media_size.aac_config : 0;
+        media_size.extensions = probe.Saved(analysis.total, media_size.mid,
+                                            [](MediaDescription& m) { m.ExtMap.clear(); });
+        media_size.tracks = probe.Saved(analysis.total, media_size.mid, [](MediaDescription& m) {
+            m.Tracks.clear();
+            m.TracksOrder.clear();
+            m.SsrcGroups.clear();
+            m.Rids.clear();
+            m.Simulcast.clear();
+        });
+
+        analysis.sections[kSizeSectionCodecs] += media_size.codecs;
+        analysis.sections[kSizeSectionAacConfig] += media_size.aac_config;
+        analysis.sections[kSizeSectionExtensions] += media_size.extensions;
+        analysis.sections[kSizeSectionTracks] += media_size.tracks;
+        analysis.medias.push_back(media_size);
+    }
+}
+
+void analyzeWhatIfs(const OriginSdpAttr& attr, const MiniSdpCodec& codec, SizeProbe& probe, SizeAnalysis& analysis) {
+    if (!attr.is_compact_fingerprint) {
+        OriginSdpAttr compact = attr;
+        compact.is_compact_fingerprint = true;
+        size_t size = probe.Size(compact);
+        if (size > 0) analysis.what_ifs.push_back(SizeWhatIf{"compact_fingerprint", size});
+    }
+
+    for (int version = 0; version < 256; version++) {
+        if (version == attr.version || !MiniSdpCodecRegistry::Instance().Find(version)) continue;
+        OriginSdpAttr other = attr;
+        other.version = version;
+        size_t size = probe.Size(other);
+        if (size > 0) analysis.what_ifs.push_back(SizeWhatIf{"v" + std::to_string(version), size});
+    }
+
+    if (attr.sdp_type == SdpType::kSdpNone) return;
+
+    // every droppable content of the steps is dropped with a zero limit
+    auto drop = [&](const std::string& name, const std::vector<PackDropStep>& order) {
+        PackBudget budget;
+        budget.order = order;
+        PackDegradeReport report;
+        MiniSdpPacker packer;
+        packer.PackToDstMem(nullptr, 0, attr, budget, &report, codec);
+        size_t saved = 0;
+        for (auto& record : report.dropped) saved += record.saved;
+        if (report.full_size > 0) analysis.what_ifs.push_back(SizeWhatIf{name, report.full_size - saved});
+    };
+    std::vector<PackDropStep> all;
+    for (int step = 0; step < kPackDropStepNum; step++) {
+        drop(g_drop_step_names[step], {PackDropStep(step)});
+        all.push_back(PackDropStep(step));
+    }
+    drop("drop_all", all);
+}
+
+}  // namespace
+
+ssize_t AnalyzeMiniSdpSize(const OriginSdpAttr& attr, SizeAnalysis& analysis) {
+    analysis = SizeAnalysis();
+    analysis.limit = kMiniMiniSdpMaxLen;
+    if (attr.stream_url.size() > kMiniSdpUrlMaxLen) {
+        return kSdpRetUrlExceeded;
+    }
+    const MiniSdpCodec* codec = MiniSdpCodecRegistry::Instance().Find(attr.version);
+    if (!codec) {
+        return kSdpRetWrongFormat;
+    }
+    SizeProbe probe(attr);
+    analysis.total = probe.Size(nullptr);
+    if (analysis.total == 0) {
+        return kSdpRetWrongFormat;
+    }
+
+    OriginSdpAttr edited = attr;
+    edited.stream_url = kMiniSdpUrlPrefix;
+    size_t size = probe.Size(edited);
+    analysis.sections[kSizeSectionStreamUrl] = size > 0 && size < analysis.total ? analysis.total - size : 0;
+    edited = attr;
+    edited.svrsig.clear();
+    size = probe.Size(edited);
+    analysis.sections[kSizeSectionSvrsig] = size > 0 && size < analysis.total ? analysis.total - size : 0;
+
+    if (attr.sdp_type != SdpType::kSdpNone) {
+        analysis.sections[kSizeSectionIce] = probe.Saved(analysis.total, [](SessionDescription& sdp) {
+            for (auto& media_pair : sdp.Medias) {
+                media_pair.second->IceUfrag.clear();
+                media_pair.second->IcePwd.clear();
+            }
+        });
+        analysis.sections[kSizeSectionFingerprint] = probe.Saved(analysis.total, [](SessionDescription& sdp) {
+            for (auto& media_pair : sdp.Medias) media_pair.second->Fingerprint = {};
+        });
+        analysis.sections[kSizeSectionCandidate] = probe.Saved(analysis.total, [](SessionDescription& sdp) {
+            for (auto& media_pair : sdp.Medias) media_pair.second->Candidate = {};
+        });
+        analyzeMedias(attr, *codec, probe, analysis);
+    }
+
+    size_t others = 0;
+    for (size_t i = kSizeSectionFixed + 1; i < kSizeSectionNum; i++) others += analysis.sections[i];
+    analysis.sections[kSizeSectionFixed] = analysis.total > others ? analysis.total - others : 0;
+
+    analyzeWhatIfs(attr, *codec, probe, analysis);
+    return analysis.total;
+}
+
+}  // namespace mini_sdp
@@ -0,0 +1,90 @@
+/**
+ * @file mini_sdp/size_analyzer.h
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#ifndef MINI_SDP_SIZE_ANALYZER_H_
+#define MINI_SDP_SIZE_ANALYZER_H_
+
+#include <string>
+#include <vector>
+#include "mini_sdp.h"
+
+namespace mini_sdp {
+
+/**
+ * @brief Size Section
+ *  mini sdp 中按来源划分的字节
+ */
+enum SizeSection {
+    kSizeSectionFixed = 0,      // 包头、media 头、auth 等，为总大小减去其他各项
+    kSizeSectionStreamUrl,      // stream url (去掉 webrtc:// 前缀)
+    kSizeSectionSvrsig,
+    kSizeSectionIce,            // ice-ufrag 和 ice-pwd
+    kSizeSectionFingerprint,
+    kSizeSectionCandidate,
+    kSizeSectionCodecs,         // codec 描述，不含 AAC config
+    kSizeSectionAacConfig,      // AAC fmtp 中的 config
+    kSizeSectionExtensions,
+    kSizeSectionTracks,         // ssrc、ssrc-group、rid 和 simulcast
+    kSizeSectionNum
+};
+
+const char* SizeSectionName(SizeSection section);
+
+/**
+ * @brief Media Size
+ *  单个 media 的字节
+ */
+struct MediaSize {
+    std::string     mid;
+    SdpMediaType    media_type;
+    size_t          codec_num = 0;      // codecs carried by mini sdp
+    size_t          ext_num = 0;        // extmaps carried by mini sdp
+    size_t          codecs = 0;
+    size_t          aac_config = 0;
+    size_t          extensions = 0;
+    size_t          tracks = 0;
+};  // struct MediaSize
+
+/**
+ * @brief What-if Size
+ *  采用某项可选压缩后的打包大小
+ */
+struct SizeWhatIf {
+    // compact_fingerprint / v<version> / drop_<PackDropStep> / drop_all
+    std::string     name;
+    size_t          size;
+};  // struct SizeWhatIf
+
+/**
+ * @brief Size Analysis
+ *  打包大小分析结果
+ *  - 各项为去掉该内容前后打包大小之差，与实际打包使用同一编码实现，因而与 ParseOriginSdpToMiniSdp 结果一致
+ *  - sections 之和等于 total
+ */
+struct SizeAnalysis {
+    size_t                  total = 0;
+    size_t                  limit = 1400;   // size limit of a mini sdp
+    size_t                  sections[kSizeSectionNum] = {};
+    std::vector<MediaSize>  medias;
+    std::vector<SizeWhatIf> what_ifs;
+};  // struct SizeAnalysis
+
+/**
+ * @brief Analyze size of mini sdp
+ *  按 attr 打包并给出各部分字节数，以及每项可选压缩（紧凑 fingerprint、其他格式版本、PackDropStep）单独生效时的大小
+ *  - 不受 buffer 大小限制，超过 1400 字节的 SDP 同样可分析
+ * @param attr
+ * @param analysis
+ * @return ssize_t total size or SdpRetCode
+ */
+ssize_t AnalyzeMiniSdpSize(const OriginSdpAttr& attr, SizeAnalysis& analysis);
+
+}  // namespace mini_sdp
+
+#endif  // MINI_SDP_SIZE_ANALYZER_H_
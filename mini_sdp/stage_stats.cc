@@ -0,0 +1,105 @@
+/**
+ * @file mini_sdp/stage_stats.cc
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include "stage_stats.h"
+#include <atomic>
+#include "per_thread_stats.h"
+
+namespace mini_sdp {
+
+static const char* g_stage_names[kSdpStageNum] = {
+    "parse", "to_string", "pack", "pack_media", "load", "load_media", "stop_build", "stop_load", "peek"
+};
+
+const char* SdpStageName(SdpStage stage) {
+    return size_t(stage) < kSdpStageNum ? g_stage_names[size_t(stage)] : "unknown";
+}
+
+size_t SdpRetcodeSlot(ssize_t ret) {
+    if (ret > 0) return 0;
+    if (ret < 0 && ret > -ssize_t(kSdpRetcodeSlots - 1)) return size_t(-ret);
+    return kSdpRetcodeSlots - 1;
+}
+
+namespace {
+
+// written by the owner thread only
+struct ThreadStageStats {
+    Histogram               latency[kSdpStageNum];
+    std::atomic<uint64_t>   retcodes[kSdpStageNum][kSdpRetcodeSlots];
+    std::atomic<uint64_t>   parse_stats[kParseStatSlots];
+
+    ThreadStageStats() {
+        for (auto &stage : retcodes) {
+            for (auto &counter : stage) counter.store(0, std::memory_order_relaxed);
+        }
+        for (auto &counter : parse_stats) counter.store(0, std::memory_order_relaxed);
+    }
+
+    void Snapshot(StageStatsSnapshot &snapshot) const {
+        for (size_t i = 0; i < kSdpStageNum; i++) {
+            latency[i].Snapshot(snapshot.latency[i]);
+            for (size_t j = 0; j < kSdpRetcodeSlots; j++) {
+                snapshot.retcodes[i][j] = retcodes[i][j].load(std::memory_order_relaxed);
+            }
+        }
+        for (size_t i = 0; i < kParseStatSlots; i++) {
+            snapshot.parse_stats[i] = parse_stats[i].load(std::memory_order_relaxed);
+        }
+    }
+};
+
+typedef PerThreadStats<ThreadStageStats, StageStatsSnapshot> StageStatsShards;
+
+std::atomic<bool> g_stage_stats_enabled(true);
+
+}  // namespace
+
+void StageStatsSnapshot::Merge(const StageStatsSnapshot &rhs) {
+    for (size_t i = 0; i < kSdpStageNum; i++) {
+        latency[i].Merge(rhs.latency[i]);
+        for (size_t j = 0; j < kSdpRetcodeSlots; j++) {
+            retcodes[i][j] += rhs.retcodes[i][j];
+        }
+    }
+    for (size_t i = 0; i < kParseStatSlots; i++) {
+        parse_stats[i] += rhs.parse_stats[i];
+    }
+}
+
+StageStatsSnapshot GetStageStatsSnapshot() {
+    return StageStatsShards::Collect();
+}
+
+void SetStageStatsEnabled(bool enabled) {
+    g_stage_stats_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool IsStageStatsEnabled() {
+    return MINI_SDP_STAGE_STATS && g_stage_stats_enabled.load(std::memory_order_relaxed);
+}
+
+void RecordStageLatency(SdpStage stage, uint64_t ns) {
+    if (size_t(stage) >= kSdpStageNum) return;
+    StageStatsShards::Local().latency[size_t(stage)].Record(ns);
+}
+
+void RecordStageRetcode(SdpStage stage, ssize_t ret) {
+    if (size_t(stage) >= kSdpStageNum) return;
+    StatsBump(StageStatsShards::Local().retcodes[size_t(stage)][SdpRetcodeSlot(ret)]);
+}
+
+void RecordParseStat(int parse_stat) {
+    if (!IsStageStatsEnabled()) return;
+    size_t slot = size_t(parse_stat + 1);
+    if (slot >= kParseStatSlots) return;
+    StatsBump(StageStatsShards::Local().parse_stats[slot]);
+}
+
+}  // namespace mini_sdp
@@ -0,0 +1,131 @@
+/**
+ * @file mini_sdp/stage_stats.h
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#ifndef MINI_SDP_STAGE_STATS_H_
+#define MINI_SDP_STAGE_STATS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <sys/types.h>
+#include <time.h>
+#include "histogram.h"
+
+// 编译期开关，cmake -DMINISDP_STAGE_STATS=OFF 时所有埋点编译为空
+#ifndef MINI_SDP_STAGE_STATS
+#define MINI_SDP_STAGE_STATS 1
+#endif
+
+namespace mini_sdp {
+
+/*
+ * 热路径各阶段耗时 (ns) 及返回码统计
+ *  - 每个线程写自己的数据块，无锁；线程首次记录时注册，退出时并入全局
+ *  - GetStageStatsSnapshot 汇总所有线程，结果为进程启动以来的累计值
+ */
+enum class SdpStage : uint8_t {
+    kParse = 0,     // SdpParser::Parse
+    kToString,      // SessionDescription::ToString
+    kPack,          // ParseOriginSdpToMiniSdp
+    kPackMedia,     // one media of the pack media walk
+    kLoad,          // LoadMiniSdpToOriginSdp
+    kLoadMedia,     // one media of MiniSdpLoader::parseMedia
+    kStopBuild,     // BuildStopStreamPacket
+    kStopLoad,      // LoadStopStreamPacket
+    kPeek,          // PeekMiniSdp
+    kStageNum
+};
+
+constexpr size_t kSdpStageNum = size_t(SdpStage::kStageNum);
+
+const char* SdpStageName(SdpStage stage);
+
+/*
+ * 返回码计数的下标
+ *  0: 成功 (>0)，1 ~ 6: kSdpRetWrongFormat ~ kSdpRetVersionUnsupported，7: 其他 (0 或未知的负数)
+ */
+constexpr size_t kSdpRetcodeSlots = 8;
+
+size_t SdpRetcodeSlot(ssize_t ret);
+
+// SdpParser::StatCode + 1
+constexpr size_t kParseStatSlots = 5;
+
+struct StageStatsSnapshot {
+    HistogramSnapshot   latency[kSdpStageNum];
+    uint64_t            retcodes[kSdpStageNum][kSdpRetcodeSlots] = {};
+    uint64_t            parse_stats[kParseStatSlots] = {};
+
+    void Merge(const StageStatsSnapshot &rhs);
+};  // struct StageStatsSnapshot
+
+StageStatsSnapshot GetStageStatsSnapshot();
+
+// runtime switch, stats are recorded by default
+void SetStageStatsEnabled(bool enabled);
+
+bool IsStageStatsEnabled();
+
+// for instrumentation of the library
+void RecordStageLatency(SdpStage stage, uint64_t ns);
+
+void RecordStageRetcode(SdpStage stage, ssize_t ret);
+
+// parse_stat: SdpParser::StatCode
+void RecordParseStat(int parse_stat);
+
+inline uint64_t StageClockNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return uint64_t(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+}
+
+#if MINI_SDP_STAGE_STATS
+
+/**
+ * @brief Stage Timer
+ *  析构时记录该阶段耗时；Result 记录返回码并原样返回
+ *
+ *  ssize_t Foo() {
+ *      StageTimer timer(SdpStage::kPack);
+ *      return timer.Result(doFoo());
+ *  }
+ */
+class StageTimer {
+  public:
+    explicit StageTimer(SdpStage stage)
+        : stage_(stage), start_(IsStageStatsEnabled() ? StageClockNs() : 0) {}
+
+    ~StageTimer() {
+        if (start_) RecordStageLatency(stage_, StageClockNs() - start_);
+    }
+
+    ssize_t Result(ssize_t ret) const {
+        if (start_) RecordStageRetcode(stage_, ret);
+        return ret;
+    }
+
+  private:
+    SdpStage stage_;
+    uint64_t start_;
+};  // class StageTimer
+
+#else
+
+class StageTimer {
+  public:
+    explicit StageTimer(SdpStage) {}
+
+    ssize_t Result(ssize_t ret) const { return ret; }
+};  // class StageTimer
+
+#endif  // MINI_SDP_STAGE_STATS
+
+}  // namespace mini_sdp
+
+#endif  // MINI_SDP_STAGE_STATS_H_
@@ -0,0 +1,68 @@
+/**
+ * @file mini_sdp/timer_wheel.cc
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include "timer_wheel.h"
+#include <algorithm>
+#include <limits>
+
+namespace mini_sdp {
+
+TimerWheel::TimerWheel(uint32_t tick_ms, size_t slot_num, uint64_t now_ms)
+: tick_ms_(std::max<uint32_t>(tick_ms, 1)), current_tick_(now_ms / tick_ms_), slots_(std::max<size_t>(slot_num, 1)) {
+    // nothing
+}
+
+uint64_t TimerWheel::Schedule(uint64_t id, uint64_t deadline_ms) {
+    uint64_t tick = std::max((deadline_ms + tick_ms_ - 1) / tick_ms_, current_tick_ + 1);
+    slots_[tick % slots_.size()].push_back(Timer{id, tick});
+    size_++;
+    return tick;
+}
+
+bool TimerWheel::Cancel(uint64_t id, uint64_t tick) {
+    auto& slot = slots_[tick % slots_.size()];
+    for (size_t i = 0; i < slot.size(); i++) {
+        if (slot[i].id == id && slot[i].tick == tick) {
+            // keeps the scheduling order of the others
+            slot.erase(slot.begin() + i);
+            size_--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void TimerWheel::Advance(uint64_t now_ms, std::vector<uint64_t>& expired) {
+    expired.clear();
+    uint64_t now_tick = now_ms / tick_ms_;
+    if (now_tick <= current_tick_) return;
+
+    // a jump of more than one round visits every slot once
+    uint64_t steps = std::min<uint64_t>(now_tick - current_tick_, slots_.size());
+    for (uint64_t i = 1; i <= steps && size_ > 0; i++) {
+        auto& slot = slots_[(current_tick_ + i) % slots_.size()];
+        size_t kept = 0;
+        for (size_t j = 0; j < slot.size(); j++) {
+            if (slot[j].tick <= now_tick) {
+                expired.push_back(slot[j].id);
+            } else {
+                slot[kept++] = slot[j];
+            }
+        }
+        size_ -= slot.size() - kept;
+        slot.resize(kept);
+    }
+    current_tick_ = now_tick;
+}
+
+uint64_t TimerWheel::NextTickMs() const {
+    return size_ > 0 ? (current_tick_ + 1) * tick_ms_ : std::numeric_limits<uint64_t>::max();
+}
+
+}  // namespace mini_sdp
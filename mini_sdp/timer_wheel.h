@@ -0,0 +1,67 @@
+/**
+ * @file mini_sdp/timer_wheel.h
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#ifndef MINI_SDP_TIMER_WHEEL_H_
+#define MINI_SDP_TIMER_WHEEL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mini_sdp {
+
+/**
+ * @brief Timer Wheel
+ *  哈希时间轮，定时器按到期 tick 放入 slot，到期时间超过一圈的定时器在经过 slot 时跳过
+ *  - 添加 O(1)，推进时只访问经过的 slot，适合大量超时时间相近的重传定时器
+ *  - 删除需要给出添加时返回的 tick，只查找所在的 slot
+ *  - 非线程安全
+ */
+class TimerWheel {
+  public:
+    /**
+     * @param tick_ms precision, timers fire at the first tick not earlier than their deadline
+     * @param slot_num
+     * @param now_ms monotonic time
+     */
+    TimerWheel(uint32_t tick_ms, size_t slot_num, uint64_t now_ms);
+
+    // a deadline already passed fires at the next tick, returns the tick it fires at
+    uint64_t Schedule(uint64_t id, uint64_t deadline_ms);
+
+    // remove a timer not fired yet, tick is returned by Schedule, false if not found
+    bool Cancel(uint64_t id, uint64_t tick);
+
+    /**
+     * @brief ids of the timers due by now_ms
+     *  expired is cleared first, ids of the same slot are in scheduling order
+     */
+    void Advance(uint64_t now_ms, std::vector<uint64_t>& expired);
+
+    // when Advance is due next, the next tick if not empty, UINT64_MAX if empty
+    uint64_t NextTickMs() const;
+
+    size_t Size() const { return size_; }
+
+  private:
+    struct Timer {
+        uint64_t    id;
+        uint64_t    tick;
+    };
+
+  private:
+    uint32_t                        tick_ms_;
+    uint64_t                        current_tick_;
+    size_t                          size_ = 0;
+    std::vector<std::vector<Timer>> slots_;
+};  // class TimerWheel
+
+}  // namespace mini_sdp
+
+#endif  // MINI_SDP_TIMER_WHEEL_H_
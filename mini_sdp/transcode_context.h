@@ -0,0 +1,44 @@
+/**
+ * @file mini_sdp/transcode_context.h
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#ifndef MINI_SDP_TRANSCODE_CONTEXT_H_
+#define MINI_SDP_TRANSCODE_CONTEXT_H_
+
+#include "sdp_recycler.h"
+
+namespace mini_sdp {
+
+/**
+ * @brief Transcode Context
+ *  转码上下文，由一个工作线程持有并在多次请求间复用，传入 ParseOriginSdpToMiniSdp / LoadMiniSdpToOriginSdp 的重载
+ *  - 保留上一次请求的 SessionDescription 及其中的对象和字符串容量，下一次请求原地重建，稳定后几乎没有堆分配
+ *  - 结果与不带上下文的接口相同；不可在多个线程间同时使用
+ */
+class TranscodeContext {
+  public:
+    TranscodeContext() = default;
+
+    TranscodeContext(const TranscodeContext&) = delete;
+    TranscodeContext& operator=(const TranscodeContext&) = delete;
+
+    // the description of the last request, parsed when packing and built when loading; nullptr if none
+    SessionDescriptionPtr GetSessionDescription() const { return recycler_.GetSessionDescription(); }
+
+    // release everything retained, e.g. after an unusually large sdp
+    void Clear() { recycler_.Clear(); }
+
+    SdpRecycler& Recycler() { return recycler_; }
+
+  private:
+    SdpRecycler recycler_;
+};  // class TranscodeContext
+
+}  // namespace mini_sdp
+
+#endif  // MINI_SDP_TRANSCODE_CONTEXT_H_
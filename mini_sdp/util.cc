@@ -9,36 +9,54 @@
  */
 #include <cstring>
 #include "util.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace mini_sdp {
 
+bool StrSplitter::Next(StrSlice& slice) {
+    if (len_ == 0) return false;
+    const char* ppos = (const char*)memchr(data_, chr_, len_);
+    slice.ptr = data_;
+    if (ppos) {
+        slice.len = ppos - data_;
+        len_ -= slice.len + 1;
+        data_ = ppos + 1;
+        if (is_remove_space_) {
+            while (len_ > 0 && *data_ == chr_) {
+                data_++;
+                len_--;
+            }
+        }
+    } else {
+        slice.len = len_;
+        len_ = 0;
+    }
+    return true;
+}
+
 std::vector<StrSlice> StrSplit(const char* data, size_t len, char chr, bool is_remove_space) {
     std::vector<StrSlice> slices;
-    const char* ppos = nullptr;
-
+    StrSplitter splitter(data, len, chr, is_remove_space);
     StrSlice slice;
-    while (len > 0) {
-        ppos = (const char*)memchr(data, chr, len);
-        slice.ptr = data;
-        if (ppos) {
-            slice.len = ppos - data;
-            len -= slice.len + 1;
-            data = ppos + 1;
-            if (is_remove_space) {
-                while (len > 0 && *data == chr) {
-                    data++;
-                    len--;
-                }
-            }
-        } else {
-            slice.len = len;
-            len = 0;
-        }
+    while (splitter.Next(slice)) {
         slices.push_back(slice);
     }
     return slices;
 }
 
+size_t StrSplit(const char* data, size_t len, char chr, StrSlice* slices, size_t max_num, bool is_remove_space) {
+    StrSplitter splitter(data, len, chr, is_remove_space);
+    StrSlice slice;
+    size_t num = 0;
+    while (splitter.Next(slice)) {
+        if (slices && num < max_num) slices[num] = slice;
+        num++;
+    }
+    return num;
+}
+
 std::pair<std::string, const char*> StrGetFirstSplit(const char* data, size_t len, char chr) {
     const char* pos = (const char*)memchr(data, chr, len);
     if (pos == nullptr) {
@@ -47,6 +65,20 @@ std::pair<std::string, const char*> StrGetFirstSplit(const char* data, size_t le
     return std::make_pair(std::string(data, pos - data), pos + 1);
 }
 
+const char* StrParseUint(const char* data, size_t len, uint64_t max, uint64_t& value) {
+    const char* end = data + len;
+    const char* pos = data;
+    uint64_t parsed = 0;
+    for (; pos < end && *pos >= '0' && *pos <= '9'; pos++) {
+        uint64_t digit = uint64_t(*pos - '0');
+        if (parsed > (max - digit) / 10) return nullptr;
+        parsed = parsed * 10 + digit;
+    }
+    if (pos == data) return nullptr;
+    value = parsed;
+    return pos;
+}
+
 std::string& Trim(std::string &str) {  
     if (str.empty())   
     {  
@@ -58,4 +90,148 @@ std::string& Trim(std::string &str) {
     return str;  
 }  
 
+static const char kHexUpper[] = "0123456789ABCDEF";
+
+static inline int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    c |= 0x20;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+ssize_t HexColonDecodeScalar(const char* str, size_t len, uint8_t* out, size_t out_len) {
+    // "XX" or "XX:XX[:XX]..."
+    if (len < 2 || (len + 1) % 3 != 0) return -1;
+    size_t n = (len + 1) / 3;
+    if (n > out_len) return -1;
+    for (size_t i = 0; i < n; i++) {
+        const char* p = str + i * 3;
+        int hi = hexValue(p[0]);
+        int lo = hexValue(p[1]);
+        if (hi < 0 || lo < 0) return -1;
+        if (i + 1 < n && p[2] != ':') return -1;
+        out[i] = (uint8_t)((hi << 4) | lo);
+    }
+    return n;
+}
+
+size_t HexColonEncodeScalar(const uint8_t* data, size_t len, char* out) {
+    if (len == 0) return 0;
+    char* p = out;
+    for (size_t i = 0; i < len; i++) {
+        *p++ = kHexUpper[data[i] >> 4];
+        *p++ = kHexUpper[data[i] & 0xF];
+        *p++ = ':';
+    }
+    return p - out - 1;
+}
+
+#if defined(__SSE2__)
+
+// 48 chars "XX:" * 16 are decoded as one block, the colon position repeats every 3 lanes
+alignas(16) static const uint8_t kHexColonMask[48] = {
+    0, 0, 0xFF, 0, 0, 0xFF, 0, 0, 0xFF, 0, 0, 0xFF, 0, 0, 0xFF, 0,
+    0, 0xFF, 0, 0, 0xFF, 0, 0, 0xFF, 0, 0, 0xFF, 0, 0, 0xFF, 0, 0,
+    0xFF, 0, 0, 0xFF, 0, 0, 0xFF, 0, 0, 0xFF, 0, 0, 0xFF, 0, 0, 0xFF,
+};
+
+// convert 16 chars to nibbles, return false if any char mismatches hex/colon pattern
+static inline bool hexNibble16(const char* src, const uint8_t* colon_mask, uint8_t* nib) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    __m128i is_digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                                     _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+    __m128i is_alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)),
+                                     _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+    __m128i is_colon = _mm_cmpeq_epi8(v, _mm_set1_epi8(':'));
+    __m128i expect_colon = _mm_load_si128(reinterpret_cast<const __m128i*>(colon_mask));
+    __m128i ok = _mm_or_si128(_mm_and_si128(expect_colon, is_colon),
+                              _mm_andnot_si128(expect_colon, _mm_or_si128(is_digit, is_alpha)));
+    if (_mm_movemask_epi8(ok) != 0xFFFF) return false;
+
+    __m128i digit_val = _mm_and_si128(is_digit, _mm_sub_epi8(v, _mm_set1_epi8('0')));
+    __m128i alpha_val = _mm_and_si128(is_alpha, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(nib), _mm_or_si128(digit_val, alpha_val));
+    return true;
+}
+
+static inline bool hexColonDecodeBlock(const char* src, uint8_t* out, size_t n) {
+    uint8_t nib[48];
+    if (!hexNibble16(src, kHexColonMask, nib) ||
+        !hexNibble16(src + 16, kHexColonMask + 16, nib + 16) ||
+        !hexNibble16(src + 32, kHexColonMask + 32, nib + 32)) {
+        return false;
+    }
+    for (size_t i = 0; i < n; i++) {
+        out[i] = (uint8_t)((nib[i * 3] << 4) | nib[i * 3 + 1]);
+    }
+    return true;
+}
+
+ssize_t HexColonDecode(const char* str, size_t len, uint8_t* out, size_t out_len) {
+    if (len < 2 || (len + 1) % 3 != 0) return -1;
+    size_t n = (len + 1) / 3;
+    if (n > out_len) return -1;
+
+    size_t i = 0;
+    // full blocks, the trailing colon of a block is followed by more bytes
+    for (; n - i > 16; i += 16) {
+        if (!hexColonDecodeBlock(str + i * 3, out + i, 16)) return -1;
+    }
+    // last block: pad to 48 chars with a valid pattern
+    char tail[48];
+    size_t tail_len = len - i * 3;
+    memcpy(tail, str + i * 3, tail_len);
+    for (size_t k = tail_len; k < sizeof(tail); k++) {
+        tail[k] = (k % 3 == 2) ? ':' : '0';
+    }
+    if (!hexColonDecodeBlock(tail, out + i, n - i)) return -1;
+    return n;
+}
+
+// convert 16 nibbles to ascii
+static inline __m128i hexAscii16(__m128i nib) {
+    __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(nib, _mm_set1_epi8(9)), _mm_set1_epi8('A' - '9' - 1));
+    return _mm_add_epi8(_mm_add_epi8(nib, _mm_set1_epi8('0')), alpha);
+}
+
+size_t HexColonEncode(const uint8_t* data, size_t len, char* out) {
+    if (len == 0) return 0;
+    char* p = out;
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0F));
+        __m128i lo = _mm_and_si128(v, _mm_set1_epi8(0x0F));
+        hi = hexAscii16(hi);
+        lo = hexAscii16(lo);
+        char pairs[32];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pairs), _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pairs + 16), _mm_unpackhi_epi8(hi, lo));
+        for (int k = 0; k < 16; k++) {
+            memcpy(p, pairs + k * 2, 2);
+            p[2] = ':';
+            p += 3;
+        }
+    }
+    for (; i < len; i++) {
+        *p++ = kHexUpper[data[i] >> 4];
+        *p++ = kHexUpper[data[i] & 0xF];
+        *p++ = ':';
+    }
+    return p - out - 1;
+}
+
+#else
+
+ssize_t HexColonDecode(const char* str, size_t len, uint8_t* out, size_t out_len) {
+    return HexColonDecodeScalar(str, len, out, out_len);
+}
+
+size_t HexColonEncode(const uint8_t* data, size_t len, char* out) {
+    return HexColonEncodeScalar(data, len, out);
+}
+
+#endif  // __SSE2__
+
 }  // namespace mini_sdp
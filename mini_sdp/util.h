@@ -12,6 +12,7 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
 #include <cstring>
 #include <string>
 #include <vector>
@@ -46,14 +47,191 @@ struct StrSlice {
  */
 std::vector<StrSlice> StrSplit(const char* data, size_t len, char chr, bool is_remove_space = true);
 
+/**
+ * @brief Split String by a char, slice by slice
+ *  与 StrSplit 的切分相同，不分配内存
+ */
+class StrSplitter {
+  public:
+    StrSplitter(const char* data, size_t len, char chr, bool is_remove_space = true)
+        : data_(data), len_(len), chr_(chr), is_remove_space_(is_remove_space) {}
+
+    // false if no slice left
+    bool Next(StrSlice& slice);
+
+  private:
+    const char* data_;
+    size_t      len_;
+    char        chr_;
+    bool        is_remove_space_;
+};  // class StrSplitter
+
+/**
+ * @brief Split String by a char into slices
+ *
+ * @param slices the first max_num slices are stored, nullptr to count only
+ * @return size_t number of all slices, may be greater than max_num
+ */
+size_t StrSplit(const char* data, size_t len, char chr, StrSlice* slices, size_t max_num, bool is_remove_space = true);
+
 std::pair<std::string, const char*> StrGetFirstSplit(const char* data, size_t len, char chr);
 
+/**
+ * @brief Parse the leading decimal digits, like std::from_chars
+ *  不抛异常、不依赖 locale，只读取 [data, data + len)，不接受符号和空白
+ * @param max values greater than max are out of range
+ * @param value unchanged if failed
+ * @return const char* the first char not parsed, nullptr if no digit or out of range
+ */
+const char* StrParseUint(const char* data, size_t len, uint64_t max, uint64_t& value);
+
+// the whole [data, data + len) is a decimal number not greater than max
+inline bool StrToUint(const char* data, size_t len, uint64_t max, uint64_t& value) {
+    uint64_t parsed = 0;
+    if (StrParseUint(data, len, max, parsed) != data + len) return false;
+    value = parsed;
+    return true;
+}
+
+inline bool StrToUint(const StrSlice& slice, uint64_t max, uint64_t& value) {
+    return StrToUint(slice.ptr, slice.len, max, value);
+}
+
 inline bool IsStrEqual(const char* str1, size_t len1, const char* str2, size_t len2) {
     return len1 == len2 ? strncmp(str1, str2, len1) == 0 : false;
 }
 
 std::string& Trim(std::string &str);
 
+/**
+ * @brief Decode colon separated hex string to bytes
+ *  like "8A:BD:A6" => {0x8A, 0xBD, 0xA6}, both upper and lower case are accepted
+ * @param str 
+ * @param len 
+ * @param out 
+ * @param out_len 
+ * @return ssize_t size of decoded bytes, -1 if format error or out_len is not enough
+ */
+ssize_t HexColonDecode(const char* str, size_t len, uint8_t* out, size_t out_len);
+
+/**
+ * @brief Encode bytes to colon separated upper case hex string
+ * @param data 
+ * @param len 
+ * @param out must have at least 3 * len bytes, the last one is used as scratch
+ * @return size_t size of encoded string
+ */
+size_t HexColonEncode(const uint8_t* data, size_t len, char* out);
+
+// scalar implementations, HexColonDecode/HexColonEncode use SIMD kernels when available
+ssize_t HexColonDecodeScalar(const char* str, size_t len, uint8_t* out, size_t out_len);
+size_t HexColonEncodeScalar(const uint8_t* data, size_t len, char* out);
+
+/**
+ * @brief Buffer Writer
+ *  顺序写入，超出 buffer 后不再写入但继续计数，Offset() 为所需的总大小
+ */
+class BufferWriter {
+  public:
+    BufferWriter(char* buff, size_t len) : buff_(buff), len_(len) {}
+
+    void Put(const void* data, size_t size) {
+        if (size > 0 && offset_ + size <= len_) memcpy(buff_ + offset_, data, size);
+        offset_ += size;
+    }
+
+    void PutU8(uint8_t value) { Put(&value, sizeof(value)); }
+
+    void PutU16(uint16_t value) { value = htons(value); Put(&value, sizeof(value)); }
+
+    void PutU32(uint32_t value) { value = htonl(value); Put(&value, sizeof(value)); }
+
+    // unsigned LEB128, 1 byte for values below 128
+    void PutVarint(uint32_t value) {
+        while (value >= 0x80) {
+            PutU8(uint8_t(value) | 0x80);
+            value >>= 7;
+        }
+        PutU8(uint8_t(value));
+    }
+
+    // position of the next byte, nullptr if exceeded
+    char* Current() { return offset_ < len_ ? buff_ + offset_ : nullptr; }
+
+    size_t Offset() const { return offset_; }
+
+    bool Exceeded() const { return offset_ > len_; }
+
+  private:
+    char*   buff_;
+    size_t  len_;
+    size_t  offset_ = 0;
+};  // class BufferWriter
+
+/**
+ * @brief Buffer Reader
+ *  顺序读取，越界后 Failed() 为 true，之后的读取均返回空值
+ */
+class BufferReader {
+  public:
+    BufferReader(const char* buff, size_t len) : buff_(buff), len_(len) {}
+
+    const char* Get(size_t size) {
+        if (failed_ || offset_ + size > len_) {
+            failed_ = true;
+            return nullptr;
+        }
+        const char* data = buff_ + offset_;
+        offset_ += size;
+        return data;
+    }
+
+    uint8_t GetU8() { const char* data = Get(1); return data ? (uint8_t)*data : 0; }
+
+    uint16_t GetU16() {
+        uint16_t value = 0;
+        const char* data = Get(sizeof(value));
+        if (data) memcpy(&value, data, sizeof(value));
+        return ntohs(value);
+    }
+
+    uint32_t GetU32() {
+        uint32_t value = 0;
+        const char* data = Get(sizeof(value));
+        if (data) memcpy(&value, data, sizeof(value));
+        return ntohl(value);
+    }
+
+    uint32_t GetVarint() {
+        uint32_t value = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            const char* data = Get(1);
+            if (!data) return 0;
+            value |= uint32_t(*data & 0x7F) << shift;
+            if (!(*data & 0x80)) return value;
+        }
+        failed_ = true;
+        return 0;
+    }
+
+    void GetStr(std::string& dst, size_t size) {
+        const char* data = Get(size);
+        if (data) dst.assign(data, size);
+    }
+
+    size_t Offset() const { return offset_; }
+
+    size_t Remaining() const { return len_ - offset_; }
+
+    bool Failed() const { return failed_; }
+
+  private:
+    const char* buff_;
+    size_t      len_;
+    size_t      offset_ = 0;
+    bool        failed_ = false;
+};  // class BufferReader
+
 constexpr uint32_t IPV6_ADDR_LEN = 16;
 
 
@@ -0,0 +1,146 @@
+/**
+ * @file test/test_alloc.cc
+ * @brief allocation budget of every stage
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ * 每个阶段的堆分配次数不得超过预算。热路径上新增分配会使本测试失败，
+ * 构建时作为 run_alloc_test 的 POST_BUILD 步骤执行（MINISDP_ALLOC_GATE）。
+ * 减少了分配后请同步调低预算。
+ *
+ */
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <string>
+#include "alloc_stats.h"
+#include "mini_sdp.h"
+#include "sdp_parser.h"
+#include "transcode_context.h"
+
+using namespace mini_sdp;
+
+#ifndef MINI_SDP_CORPUS_DIR
+#define MINI_SDP_CORPUS_DIR "corpus"
+#endif
+
+static int failed = 0;
+
+static void check(bool cond, const char* what) {
+    if (!cond) {
+        printf("FAILED: %s\n", what);
+        failed++;
+    }
+}
+
+static std::string readSdp(const std::string& name) {
+    std::ifstream file(std::string(MINI_SDP_CORPUS_DIR) + "/" + name);
+    std::string sdp, line;
+    while (std::getline(file, line)) {
+        if (!line.empty()) sdp += line + "\r\n";
+    }
+    return sdp;
+}
+
+// budgets are the counts measured with GCC 12 / libstdc++ (Debian 12), another standard library
+// may allocate a little more, e.g. a different small string size; a stage without allocation stays at 0
+static uint64_t allowedAllocs(uint64_t budget) {
+    return budget + (budget + 9) / 10;
+}
+
+// run twice, the first run may fill lazily initialized statics
+static void checkBudget(const std::string& stage, uint64_t budget, const std::function<void()>& func) {
+    func();
+    AllocScope scope;
+    func();
+    uint64_t allocs = scope.Allocs();
+    uint64_t frees = scope.Frees();
+    uint64_t bytes = scope.Bytes();
+    printf("%-36s %6lu allocs %8lu bytes  budget %6lu%s\n", stage.c_str(), (unsigned long)allocs,
+           (unsigned long)bytes, (unsigned long)budget,
+           allocs > allowedAllocs(budget) ? "  OVER BUDGET" : (allocs < budget ? "  (lower the budget)" : ""));
+    check(allocs <= allowedAllocs(budget), stage.c_str());
+    check(frees == allocs, (stage + " leaks").c_str());
+}
+
+struct SdpBudget {
+    const char* file;
+    SdpType     sdp_type;
+    uint64_t    parse;
+    uint64_t    pack[2];    // v0, v1
+    uint64_t    load[2];
+    uint64_t    ctx_pack[2];    // with a TranscodeContext reused
+    uint64_t    ctx_load[2];
+};
+
+static const SdpBudget kSdpBudgets[] = {
+    {"server_answer.sdp",       SdpType::kAnswer,   74,     {75, 91},       {135, 150},     {2, 18},    {9, 22}},
+    {"obs_whip_offer.sdp",      SdpType::kOffer,    53,     {53, 58},       {56, 63},       {0, 5},     {2, 8}},
+    {"chrome_push_offer.sdp",   SdpType::kOffer,    274,    {279, 296},     {175, 187},     {7, 24},    {8, 20}},
+};
+
+static void checkSdp(const SdpBudget& budget) {
+    OriginSdpAttr attr;
+    attr.origin_sdp = readSdp(budget.file);
+    attr.sdp_type = budget.sdp_type;
+    attr.stream_url = "webrtc://domain/live/stream?txSecret=0123456789abcdef";
+    attr.svrsig = "1h8s";
+    attr.is_compact_fingerprint = true;
+    check(!attr.origin_sdp.empty(), budget.file);
+    std::string name = budget.file;
+
+    checkBudget("parse/" + name, budget.parse, [&] {
+        SdpParser parser(attr.origin_sdp.data(), attr.origin_sdp.size());
+        parser.Parse();
+    });
+
+    for (uint8_t version = 0; version < 2; version++) {
+        attr.version = version;
+        std::string tag = version == 0 ? "" : "_v1";
+        char buff[1400];
+        ssize_t size = 0;
+        checkBudget("pack" + tag + "/" + name, budget.pack[version],
+                    [&] { size = ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff)); });
+        check(size > 0, "pack");
+        checkBudget("load" + tag + "/" + name, budget.load[version], [&] {
+            OriginSdpAttr loaded;
+            LoadMiniSdpToOriginSdp(buff, size, loaded);
+        });
+
+        // steady state of a worker, the context has seen the shape before
+        TranscodeContext ctx;
+        OriginSdpAttr loaded;
+        auto ctx_pack = [&] { ParseOriginSdpToMiniSdp(ctx, attr, buff, sizeof(buff)); };
+        auto ctx_load = [&] { LoadMiniSdpToOriginSdp(ctx, buff, size, loaded); };
+        ctx_pack();
+        checkBudget("ctx_pack" + tag + "/" + name, budget.ctx_pack[version], ctx_pack);
+        ctx_load();
+        checkBudget("ctx_load" + tag + "/" + name, budget.ctx_load[version], ctx_load);
+    }
+}
+
+// stages that must not touch the heap
+static void checkZeroAlloc() {
+    StopStreamAttr stop;
+    stop.svrsig = "127.0.0.1:0_xxxx_d71956d9cc93e4a467b11e06fdaf039a_de71a64097d807c3:1h8s";
+    char buff[1400];
+    ssize_t size = 0;
+    checkBudget("stop_build", 0, [&] { size = BuildStopStreamPacket(buff, sizeof(buff), stop); });
+    checkBudget("is_stop_pack", 0, [&] { check(IsMiniSdpStopPack(buff, size), "is stop"); });
+    checkBudget("is_req_pack", 0, [&] { check(!IsMiniSdpReqPack(buff, size), "is req"); });
+}
+
+int main() {
+    if (!IsAllocHooked()) {
+        printf("alloc hooks are not linked\n");
+        return 1;
+    }
+    for (auto& budget : kSdpBudgets) {
+        checkSdp(budget);
+    }
+    checkZeroAlloc();
+    printf("test end, %d failed\n", failed);
+    return failed == 0 ? 0 : 1;
+}
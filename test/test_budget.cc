@@ -0,0 +1,213 @@
+/**
+ * @file test/test_budget.cc
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "mini_sdp.h"
+
+using namespace mini_sdp;
+
+static const char* kDropStepName[] = {"redundant-profile", "unused-extension", "aac-config", "second-ssrc"};
+
+static const char* kChromeExtmaps =
+    "a=extmap:1 urn:ietf:params:rtp-hdrext:ssrc-audio-level\r\n"
+    "a=extmap:2 http://www.webrtc.org/experiments/rtp-hdrext/abs-send-time\r\n"
+    "a=extmap:3 http://www.ietf.org/id/draft-holmer-rmcat-transport-wide-cc-extensions-01\r\n"
+    "a=extmap:4 urn:ietf:params:rtp-hdrext:sdes:mid\r\n"
+    "a=extmap:12 http://www.webrtc.org/experiments/rtp-hdrext/playout-delay\r\n"
+    "a=extmap:9 http://www.webrtc.org/experiments/rtp-hdrext/decoding-timestamp\r\n"
+    "a=extmap:10 http://www.webrtc.org/experiments/rtp-hdrext/video-composition-time\r\n"
+    "a=extmap:21 http://www.webrtc.org/experiments/rtp-hdrext/meta-data-01\r\n"
+    "a=extmap:22 http://www.webrtc.org/experiments/rtp-hdrext/meta-data-02\r\n"
+    "a=extmap:23 http://www.webrtc.org/experiments/rtp-hdrext/meta-data-03\r\n"
+    "a=extmap:30 http://www.webrtc.org/experiments/rtp-hdrext/video-frame-type\r\n";
+
+// chrome style offer, every H264 profile comes with a rtx codec
+static std::string MakeOffer(int h264_num, bool aac) {
+    std::string sdp =
+        "v=0\r\no=- 4611731400430051336 2 IN IP4 127.0.0.1\r\ns=-\r\nt=0 0\r\n"
+        "a=group:BUNDLE 0 1\r\na=extmap-allow-mixed\r\na=msid-semantic: WMS stream\r\n";
+    sdp += aac ? "m=audio 9 UDP/TLS/RTP/SAVPF 111 63 9 0 8 13 110 126\r\n" : "m=audio 9 UDP/TLS/RTP/SAVPF 111 63 9 0 8\r\n";
+    sdp += "c=IN IP4 0.0.0.0\r\na=rtcp:9 IN IP4 0.0.0.0\r\n"
+           "a=ice-ufrag:Zh1u\r\na=ice-pwd:2P3Ww8ytUu1Sz6NUy1mWOUZr\r\na=ice-options:trickle\r\n"
+           "a=fingerprint:sha-256 8A:BD:A6:61:75:AF:31:4C:02:81:2A:FA:12:92:4C:48:7B:9F:23:DD:BF:3D:51:30:"
+           "E7:59:5C:9B:17:3D:92:34\r\n"
+           "a=setup:actpass\r\na=mid:0\r\n";
+    sdp += kChromeExtmaps;
+    sdp += "a=sendonly\r\na=msid:stream audio\r\na=rtcp-mux\r\n"
+           "a=rtpmap:111 opus/48000/2\r\na=rtcp-fb:111 transport-cc\r\na=fmtp:111 minptime=10;useinbandfec=1\r\n"
+           "a=rtpmap:63 red/48000/2\r\na=fmtp:63 111/111\r\n"
+           "a=rtpmap:9 G722/8000\r\na=rtpmap:0 PCMU/8000\r\na=rtpmap:8 PCMA/8000\r\n";
+    if (aac) {
+        sdp += "a=rtpmap:13 MP4A-LATM/48000/2\r\n"
+               "a=fmtp:13 object=2;cpresent=0;config=400024203fc0c0c0c0c0c0c0c0c0c0c0c0c0c0c0c0c0c0c0c0\r\n"
+               "a=rtpmap:110 MP4A-ADTS/44100/2\r\n"
+               "a=fmtp:110 object=2;config=1210562105210521052105210521052105210521052105210521050\r\n"
+               "a=rtpmap:126 MP4A-LATM/44100/2\r\n"
+               "a=fmtp:126 object=5;SBR-enabled=1;PS-enabled=1;config=2b11880056e5a3412c41062a1042005608c0c0c0c0c0\r\n";
+    }
+    sdp += "a=ssrc:3570614608 cname:4TOk42mSjXCkVIa6\r\na=ssrc:3570614608 msid:stream audio\r\n";
+
+    std::string pts;
+    std::string lines;
+    int pt = 96;
+    static const char* profiles[] = {"42001f", "42e01f", "4d001f", "64001f", "640032", "4d0032", "42e034", "640034"};
+    for (int i = 0; i < h264_num; i++, pt += 2) {
+        std::string fmt = std::to_string(pt), rtx = std::to_string(pt + 1);
+        pts += " " + fmt + " " + rtx;
+        lines += "a=rtpmap:" + fmt + " H264/90000\r\n"
+                 "a=rtcp-fb:" + fmt + " goog-remb\r\na=rtcp-fb:" + fmt + " transport-cc\r\n"
+                 "a=rtcp-fb:" + fmt + " ccm fir\r\na=rtcp-fb:" + fmt + " nack\r\na=rtcp-fb:" + fmt + " nack pli\r\n"
+                 "a=fmtp:" + fmt + " level-asymmetry-allowed=1;packetization-mode=" + std::to_string((i / 8) % 2 ? 0 : 1) +
+                 ";profile-level-id=" + profiles[i % 8] + "\r\n"
+                 "a=rtpmap:" + rtx + " rtx/90000\r\na=fmtp:" + rtx + " apt=" + fmt + "\r\n";
+    }
+    sdp += "m=video 9 UDP/TLS/RTP/SAVPF" + pts + "\r\n";
+    sdp += "c=IN IP4 0.0.0.0\r\na=rtcp:9 IN IP4 0.0.0.0\r\n"
+           "a=ice-ufrag:Zh1u\r\na=ice-pwd:2P3Ww8ytUu1Sz6NUy1mWOUZr\r\na=ice-options:trickle\r\n"
+           "a=fingerprint:sha-256 8A:BD:A6:61:75:AF:31:4C:02:81:2A:FA:12:92:4C:48:7B:9F:23:DD:BF:3D:51:30:"
+           "E7:59:5C:9B:17:3D:92:34\r\n"
+           "a=setup:actpass\r\na=mid:1\r\n";
+    sdp += kChromeExtmaps;
+    sdp += "a=sendonly\r\na=msid:stream video\r\na=rtcp-mux\r\na=rtcp-rsize\r\n";
+    sdp += lines;
+    sdp += "a=ssrc-group:FID 2291961624 1366387413\r\n"
+           "a=ssrc:2291961624 cname:4TOk42mSjXCkVIa6\r\na=ssrc:2291961624 msid:stream video\r\n"
+           "a=ssrc:1366387413 cname:4TOk42mSjXCkVIa6\r\na=ssrc:1366387413 msid:stream video\r\n";
+    return sdp;
+}
+
+static std::string MakeUrl(size_t len) {
+    std::string url = "webrtc://domain/live/xxxx_d71956d9cc93e4a467b11e06fdaf039a?txSecret=";
+    while (url.size() < len) url += "0123456789abcdef";
+    return url.substr(0, len);
+}
+
+static int failed = 0;
+
+static void check(bool cond, const char* what) {
+    if (!cond) {
+        printf("FAILED: %s\n", what);
+        failed++;
+    }
+}
+
+static void testDegrade() {
+    OriginSdpAttr attr;
+    attr.origin_sdp = MakeOffer(16, true);
+    attr.sdp_type = SdpType::kOffer;
+    attr.stream_url = MakeUrl(1000);
+    attr.svrsig = "1h8s";
+
+    char buff[1400];
+    check(ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff)) == kSdpRetSizeExceeded, "plain pack exceeded");
+
+    PackBudget budget;
+    PackDegradeReport report;
+    ssize_t size = ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff), budget, &report);
+    check(size > 0 && size <= 1400 && (size_t)size == report.packed_size, "budget pack");
+    printf("full size %zu, packed size %zu, dropped %zu\n", report.full_size, report.packed_size, report.dropped.size());
+
+    size_t saved = 0;
+    for (auto& record : report.dropped) {
+        printf("  drop %-17s media %d value %u saved %zu\n",
+               kDropStepName[record.step], (int)record.media_type, record.value, record.saved);
+        saved += record.saved;
+    }
+    // the size is tracked incrementally and must match the packed result
+    check(report.full_size - saved == report.packed_size, "incremental size");
+
+    OriginSdpAttr attr2;
+    check(LoadMiniSdpToOriginSdp(buff, size, attr2) == size, "load");
+    check(attr2.origin_sdp.find("a=rtpmap:96 H264/90000") != std::string::npos, "first profile kept");
+    check(attr2.origin_sdp.find("transport-wide-cc") != std::string::npos, "kept extension");
+
+    // only redundant profiles are dropped when the budget is loose
+    char large_buff[2048];
+    budget.max_size = report.full_size - 4;
+    size = ParseOriginSdpToMiniSdp(attr, large_buff, sizeof(large_buff), budget, &report);
+    check(size > 0 && report.dropped.size() == 1 && report.dropped[0].step == kPackDropRedundantProfile, "loose budget");
+
+    // nothing can be dropped
+    budget.order.clear();
+    check(ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff), budget, &report) == kSdpRetSizeExceeded, "empty order");
+
+    // fits without degradation
+    attr.stream_url = MakeUrl(60);
+    PackBudget budget2;
+    size = ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff), budget2, &report);
+    check(size > 0 && report.dropped.empty() && report.full_size == (size_t)size, "no degradation");
+}
+
+// a buffer shorter than the budget degrades further or fails, nothing is written past its end
+static void testTightBuffer() {
+    OriginSdpAttr attr;
+    attr.origin_sdp = MakeOffer(16, true);
+    attr.sdp_type = SdpType::kOffer;
+    attr.stream_url = MakeUrl(1000);
+    attr.svrsig = "1h8s";
+
+    char buff[1400 + 32];
+    PackDegradeReport report;
+    ssize_t full = ParseOriginSdpToMiniSdp(attr, buff, 1400, PackBudget(), &report);
+    check(full > 0, "tight full size");
+    int overrun = 0, wrong = 0;
+    for (size_t len = 0; len <= size_t(full); len++) {
+        memset(buff, 0xa5, sizeof(buff));
+        ssize_t size = ParseOriginSdpToMiniSdp(attr, buff, len, PackBudget(), &report);
+        for (size_t i = len; i < len + 32; i++) {
+            if (uint8_t(buff[i]) != 0xa5) {
+                overrun++;
+                break;
+            }
+        }
+        if (size != kSdpRetSizeExceeded && (size <= 0 || size_t(size) > len)) wrong++;
+        if (len == size_t(full) && size != full) wrong++;
+    }
+    check(overrun == 0, "tight buffer canary");
+    check(wrong == 0, "tight buffer result");
+}
+
+static void reportFallbackRate() {
+    int total = 0, plain_fallback = 0, budget_fallback = 0;
+    size_t dropped = 0;
+    char buff[1400];
+    for (int h264_num : {2, 6, 12, 16}) {
+        for (bool aac : {false, true}) {
+            for (size_t url_len : {80, 300, 600, 800, 900, 1000}) {
+                OriginSdpAttr attr;
+                attr.origin_sdp = MakeOffer(h264_num, aac);
+                attr.sdp_type = SdpType::kOffer;
+                attr.stream_url = MakeUrl(url_len);
+                attr.svrsig = "1h8s";
+                total++;
+                if (ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff)) < 0) plain_fallback++;
+
+                PackDegradeReport report;
+                if (ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff), PackBudget(), &report) < 0) {
+                    budget_fallback++;
+                }
+                dropped += report.dropped.size();
+            }
+        }
+    }
+    printf("fallback rate over %d offers: plain %.1f%%, budget %.1f%%, %.1f items dropped per offer\n",
+           total, plain_fallback * 100.0 / total, budget_fallback * 100.0 / total, (double)dropped / total);
+}
+
+int main() {
+    printf("test budget\n");
+    testDegrade();
+    testTightBuffer();
+    reportFallbackRate();
+    printf("test end, %d failed\n", failed);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,268 @@
+/**
+ * @file test/test_c_api.c
+ * @brief C interface, compiled as C and linked to libminisdp.so
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mini_sdp_c.h"
+
+#ifndef MINI_SDP_CORPUS_DIR
+#define MINI_SDP_CORPUS_DIR "corpus"
+#endif
+
+static int failed = 0;
+static const char* current = "";
+
+static void check(int cond, const char* what) {
+    if (!cond) {
+        printf("FAILED: %s: %s\n", current, what);
+        failed++;
+    }
+}
+
+static int strEqual(minisdp_str lhs, minisdp_str rhs) {
+    return lhs.len == rhs.len && (lhs.len == 0 || memcmp(lhs.data, rhs.data, lhs.len) == 0);
+}
+
+static minisdp_str cstr(const char* str) {
+    minisdp_str ret = {str, strlen(str)};
+    return ret;
+}
+
+// lines end with \r\n, the caller frees it
+static char* readSdp(const char* name, size_t* len) {
+    char path[512], line[4096];
+    snprintf(path, sizeof(path), "%s/%s", MINI_SDP_CORPUS_DIR, name);
+    FILE* file = fopen(path, "r");
+    char* sdp = calloc(1, 64 * 1024);
+    *len = 0;
+    if (file == NULL) return sdp;
+    while (fgets(line, sizeof(line), file)) {
+        size_t n = strcspn(line, "\r\n");
+        if (n == 0) continue;
+        memcpy(sdp + *len, line, n);
+        memcpy(sdp + *len + n, "\r\n", 2);
+        *len += n + 2;
+    }
+    fclose(file);
+    return sdp;
+}
+
+static void testAttrInit(void) {
+    minisdp_attr attr;
+    current = "attr init";
+    memset(&attr, 0x5a, sizeof(attr));
+    minisdp_attr_init(&attr);
+    check(attr.sdp_type == MINISDP_OFFER && attr.is_push == MINISDP_STREAM_DEFAULT, "type");
+    check(attr.is_support_aac_fmtp == 1 && attr.is_imm_send == 0 && attr.version == 0, "flags");
+    check(attr.origin_sdp.data == NULL && attr.stream_url.len == 0 && attr.svrsig.len == 0, "strings");
+}
+
+static void testRoundTrip(const char* name, int sdp_type, uint8_t version) {
+    size_t sdp_len = 0, required = 0, dst_required = 0;
+    char* sdp = readSdp(name, &sdp_len);
+    char packet[MINISDP_MAX_PACKET], repacked[MINISDP_MAX_PACKET], small[16], dst[8192];
+    minisdp_attr attr, loaded, viewed;
+    ssize_t size, ret;
+    current = name;
+    check(sdp_len > 0, "corpus");
+
+    minisdp_attr_init(&attr);
+    attr.sdp_type = sdp_type;
+    attr.origin_sdp.data = sdp;
+    attr.origin_sdp.len = sdp_len;
+    attr.stream_url = cstr("webrtc://domain/live/stream");
+    attr.svrsig = sdp_type == MINISDP_ANSWER ? cstr("1h8s") : cstr("");
+    attr.status_code = sdp_type == MINISDP_ANSWER ? 200 : 0;
+    attr.seq = 42;
+    attr.is_imm_send = 1;
+    attr.is_push = MINISDP_STREAM_PUSH;
+    attr.version = version;
+
+    size = minisdp_pack(&attr, packet, sizeof(packet), &required);
+    check(size > 0 && (size_t)size == required, "pack");
+    check(minisdp_is_req_pack(packet, size) && !minisdp_is_stop_pack(packet, size), "is req pack");
+    check(minisdp_pack(&attr, small, sizeof(small), &required) == MINISDP_RET_SIZE_EXCEEDED, "small buffer");
+    check((ssize_t)required == size, "required");
+    check(minisdp_pack(&attr, packet, sizeof(packet), NULL) == size, "no required");
+
+    ret = minisdp_load(packet, size, &loaded, dst, 10, &dst_required);
+    check(ret == MINISDP_RET_SIZE_EXCEEDED && dst_required > 10, "small dst");
+    ret = minisdp_load(packet, size, &loaded, dst, sizeof(dst), &required);
+    check(ret == size && required == dst_required, "load");
+    check(loaded.origin_sdp.data == dst && loaded.stream_url.data == dst + loaded.origin_sdp.len, "in dst");
+    check(strEqual(loaded.stream_url, attr.stream_url), "url");
+    // <ip>:<ice-ufrag>:<svrsig>
+    check(loaded.svrsig.len >= attr.svrsig.len &&
+          !memcmp(loaded.svrsig.data + loaded.svrsig.len - attr.svrsig.len, attr.svrsig.data, attr.svrsig.len),
+          "svrsig");
+    check(loaded.sdp_type == sdp_type && loaded.seq == 42 && loaded.status_code == attr.status_code, "fields");
+    check(loaded.is_imm_send == 1 && loaded.is_push == MINISDP_STREAM_PUSH && loaded.version == version, "flags");
+
+    // truncated, a failure and never 0
+    check(minisdp_load_view(packet, size / 2, &viewed) < 0, "truncated view");
+    check(minisdp_load(packet, size / 2, &viewed, dst, sizeof(dst), NULL) < 0, "truncated load");
+
+    ret = minisdp_load_view(packet, size, &viewed);
+    check(ret == size && viewed.origin_sdp.data != dst && strEqual(viewed.origin_sdp, loaded.origin_sdp), "view");
+    check(strEqual(viewed.stream_url, loaded.stream_url) && strEqual(viewed.svrsig, loaded.svrsig), "view strings");
+
+    // the loaded sdp packs to the same packet
+    loaded.svrsig = attr.svrsig;
+    check(minisdp_pack(&loaded, repacked, sizeof(repacked), NULL) == size && !memcmp(packet, repacked, size),
+          "repack");
+    free(sdp);
+}
+
+// every buffer too small is reported with the required size, nothing written past its end
+static void testProbe(const char* name, int sdp_type, uint8_t version) {
+    size_t sdp_len = 0, required = 0, len, i;
+    char* sdp = readSdp(name, &sdp_len);
+    char packet[MINISDP_MAX_PACKET + 32];
+    minisdp_attr attr;
+    ssize_t size;
+    int overrun = 0, wrong = 0;
+    current = name;
+
+    minisdp_attr_init(&attr);
+    attr.sdp_type = sdp_type;
+    attr.origin_sdp.data = sdp;
+    attr.origin_sdp.len = sdp_len;
+    attr.stream_url = cstr("webrtc://domain/live/stream");
+    attr.svrsig = sdp_type == MINISDP_ANSWER ? cstr("1h8s") : cstr("");
+    attr.version = version;
+    size = minisdp_pack(&attr, packet, MINISDP_MAX_PACKET, NULL);
+    check(size > 16, "probe pack");
+    for (len = 16; (ssize_t)len < size; len++) {
+        memset(packet, 0xa5, sizeof(packet));
+        if (minisdp_pack(&attr, packet, len, &required) != MINISDP_RET_SIZE_EXCEEDED ||
+            (ssize_t)required != size) {
+            wrong++;
+        }
+        for (i = len; i < len + 32; i++) {
+            if ((unsigned char)packet[i] != 0xa5) {
+                overrun++;
+                break;
+            }
+        }
+    }
+    check(wrong == 0, "probe required");
+    check(overrun == 0, "probe canary");
+    free(sdp);
+}
+
+static void testPeek(void) {
+    size_t sdp_len = 0, i, ssrcs = 0;
+    char* sdp = readSdp("chrome_simulcast_offer.sdp", &sdp_len);
+    char packet[MINISDP_MAX_PACKET];
+    minisdp_attr attr;
+    minisdp_dispatch_view view;
+    ssize_t size;
+    current = "peek";
+
+    minisdp_attr_init(&attr);
+    attr.origin_sdp.data = sdp;
+    attr.origin_sdp.len = sdp_len;
+    attr.stream_url = cstr("webrtc://domain/live/simulcast");
+    attr.seq = 7;
+    attr.is_push = MINISDP_STREAM_PUSH;
+    size = minisdp_pack(&attr, packet, sizeof(packet), NULL);
+    check(size > 0, "pack");
+    check(minisdp_peek(packet, size, &view) == size, "peek");
+    check(view.sdp_type == MINISDP_OFFER && view.seq == 7 && view.is_push == MINISDP_STREAM_PUSH, "fields");
+    check(strEqual(view.stream_url, attr.stream_url), "url");
+    check(view.media_num >= 2 && view.medias[0].payload_type_num > 0, "medias");
+    for (i = 0; i < view.media_num; i++) {
+        ssrcs += view.medias[i].ssrc_num;
+        check(view.medias[i].media_type == MINISDP_MEDIA_AUDIO || view.medias[i].media_type == MINISDP_MEDIA_VIDEO,
+              "media type");
+    }
+    check(ssrcs > 1, "ssrcs");
+    check(minisdp_peek(packet, 3, &view) < 0, "truncated");
+    free(sdp);
+}
+
+static void testErrors(void) {
+    char packet[MINISDP_MAX_PACKET], url[1300];
+    char* header;
+    minisdp_attr attr;
+    size_t required = 1;
+    const char* garbage = "\xff" "SDPxxxxxxxxxxxxxxxxxxxxxxxx";
+    current = "errors";
+
+    minisdp_attr_init(&attr);
+    attr.origin_sdp = cstr("v=0\r\nno such line\r\n");
+    check(minisdp_pack(&attr, packet, sizeof(packet), &required) < 0 && required == 0, "bad sdp");
+
+    memset(url, 'a', sizeof(url));
+    attr.sdp_type = MINISDP_SDP_NONE;
+    attr.stream_url.data = url;
+    attr.stream_url.len = sizeof(url);
+    check(minisdp_pack(&attr, packet, sizeof(packet), NULL) == MINISDP_RET_URL_EXCEEDED, "url");
+
+    attr.stream_url = cstr("webrtc://domain/live/stream");
+    attr.version = 200;
+    check(minisdp_pack(&attr, packet, sizeof(packet), NULL) == MINISDP_RET_VERSION_UNSUPPORTED, "version");
+
+    attr.sdp_type = 5;
+    check(minisdp_pack(&attr, packet, sizeof(packet), NULL) == MINISDP_RET_SDP_PARAM_ERROR, "sdp type");
+
+    check(minisdp_load(garbage, strlen(garbage), &attr, url, sizeof(url), &required) < 0 && required == 0, "load");
+    check(minisdp_load_view(garbage, 2, &attr) < 0, "load view");
+    // a v0 header cut short, on the heap so a sanitizer sees a read past it
+    header = (char*)malloc(5);
+    memcpy(header, "\xFFSDP", 5);
+    check(minisdp_load_view(header, 5, &attr) == MINISDP_RET_WRONG_FORMAT, "header only view");
+    check(minisdp_load(header, 5, &attr, url, sizeof(url), NULL) == MINISDP_RET_WRONG_FORMAT, "header only load");
+    free(header);
+}
+
+static void testStop(void) {
+    char packet[256], small[16];
+    minisdp_stop_attr attr, loaded;
+    size_t required = 0;
+    ssize_t size;
+    current = "stop";
+
+    attr.svrsig = cstr("127.0.0.1:abcd:efgh");
+    attr.status = 200;
+    attr.seq = 9;
+    attr.version = 1;
+    size = minisdp_stop_build(&attr, packet, sizeof(packet), &required);
+    check(size > 0 && (size_t)size == required, "build");
+    check(minisdp_is_stop_pack(packet, size) && !minisdp_is_req_pack(packet, size), "is stop pack");
+    check(minisdp_stop_build(&attr, small, sizeof(small), &required) == MINISDP_RET_SIZE_EXCEEDED &&
+          (ssize_t)required == size, "small buffer");
+
+    check(minisdp_stop_load(packet, size, &loaded) == size, "load");
+    check(strEqual(loaded.svrsig, attr.svrsig) && loaded.status == 200 && loaded.seq == 9 && loaded.version == 1,
+          "fields");
+    check(loaded.svrsig.data > packet && loaded.svrsig.data < packet + size, "in the packet");
+    check(minisdp_stop_load(packet, size - 1, &loaded) == MINISDP_RET_SIZE_EXCEEDED, "truncated");
+
+    attr.version = 200;
+    check(minisdp_stop_build(&attr, packet, sizeof(packet), NULL) == MINISDP_RET_VERSION_UNSUPPORTED, "version");
+}
+
+int main(void) {
+    testAttrInit();
+    testRoundTrip("chrome_push_offer.sdp", MINISDP_OFFER, 0);
+    testRoundTrip("chrome_push_offer.sdp", MINISDP_OFFER, 1);
+    testRoundTrip("server_answer.sdp", MINISDP_ANSWER, 0);
+    testRoundTrip("server_answer.sdp", MINISDP_ANSWER, 1);
+    testProbe("chrome_push_offer.sdp", MINISDP_OFFER, 0);
+    testProbe("chrome_push_offer.sdp", MINISDP_OFFER, 1);
+    testProbe("server_answer.sdp", MINISDP_ANSWER, 0);
+    testProbe("server_answer.sdp", MINISDP_ANSWER, 1);
+    testPeek();
+    testErrors();
+    testStop();
+    printf("test end, %d failed\n", failed);
+    return failed == 0 ? 0 : 1;
+}
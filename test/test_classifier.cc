@@ -0,0 +1,166 @@
+/**
+ * @file test/test_classifier.cc
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "mini_sdp.h"
+#include "mini_sdp_delta.h"
+#include "mini_sdp_frag.h"
+#include "packet_classifier.h"
+
+using namespace mini_sdp;
+
+static int failed = 0;
+static std::string current;
+
+static void check(bool cond, const std::string& what) {
+    if (!cond) {
+        printf("FAILED: %s: %s\n", current.c_str(), what.c_str());
+        failed++;
+    }
+}
+
+static std::string makePacket(uint8_t first, uint8_t second, size_t len) {
+    std::string packet(len, 0);
+    packet[0] = first;
+    if (len > 1) packet[1] = second;
+    return packet;
+}
+
+static PacketClass classify(const std::string& packet) {
+    return ClassifyPacket(packet.data(), packet.size());
+}
+
+// RFC 7983 ranges of the first byte
+static void testFirstByte() {
+    current = "first byte";
+    for (int byte = 0; byte < 256; byte++) {
+        PacketClass expect = kPacketUnknown;
+        if (byte <= 3) expect = kPacketStun;
+        else if (byte >= 16 && byte <= 19) expect = kPacketZrtp;
+        else if (byte >= 20 && byte <= 63) expect = kPacketDtls;
+        else if (byte >= 64 && byte <= 79) expect = kPacketTurnChannel;
+        else if (byte >= 128 && byte <= 191) expect = kPacketRtp;
+        check(classify(makePacket(byte, 96, 100)) == expect, "byte " + std::to_string(byte));
+    }
+
+    current = "rtcp";
+    for (int pt = 0; pt < 256; pt++) {
+        PacketClass expect = pt >= 192 && pt <= 223 ? kPacketRtcp : kPacketRtp;
+        check(classify(makePacket(0x80, pt, 100)) == expect, "payload type " + std::to_string(pt));
+    }
+}
+
+static void testMinLen() {
+    current = "min len";
+    check(classify(makePacket(0x00, 0x01, 19)) == kPacketUnknown, "stun 19");
+    check(classify(makePacket(0x00, 0x01, 20)) == kPacketStun, "stun 20");
+    check(classify(makePacket(22, 0xfe, 12)) == kPacketUnknown, "dtls 12");
+    check(classify(makePacket(22, 0xfe, 13)) == kPacketDtls, "dtls 13");
+    check(classify(makePacket(0x80, 96, 11)) == kPacketUnknown, "rtp 11");
+    check(classify(makePacket(0x80, 96, 12)) == kPacketRtp, "rtp 12");
+    check(classify(makePacket(0x81, 200, 7)) == kPacketUnknown, "rtcp 7");
+    check(classify(makePacket(0x81, 200, 8)) == kPacketRtcp, "rtcp 8");
+    check(classify(makePacket(0x40, 0, 4)) == kPacketTurnChannel, "turn channel 4");
+    check(ClassifyPacket("\xff", 1) == kPacketUnknown, "mini sdp 1");
+    check(ClassifyPacket(nullptr, 0) == kPacketUnknown, "empty");
+}
+
+// the same answer as IsMiniSdp*Pack, for real packets and random bytes after 0xFF
+static void testMiniSdp() {
+    current = "mini sdp";
+    OriginSdpAttr attr;
+    attr.sdp_type = SdpType::kSdpNone;
+    attr.stream_url = "webrtc://domain/live/stream";
+    attr.svrsig = "127.0.0.1:ufrag:svrsig";
+    char buff[1400];
+    ssize_t size = ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff));
+    check(size > 0 && ClassifyPacket(buff, size) == kPacketMiniSdpReq, "request");
+
+    StopStreamAttr stop;
+    stop.svrsig = attr.svrsig;
+    size = BuildStopStreamPacket(buff, sizeof(buff), stop);
+    check(size > 0 && ClassifyPacket(buff, size) == kPacketMiniSdpStop, "stop");
+
+    std::mt19937 rng(20261019);
+    const char* magics[] = {"SDP", "STP", "FRG", "DLT", "SDQ", "XYZ"};
+    for (int i = 0; i < 10000; i++) {
+        std::string packet(rng() % 8, 0);
+        for (auto& c : packet) c = char(rng());
+        if (!packet.empty()) packet[0] = char(0xFF);
+        if (packet.size() >= 4 && rng() % 2) packet.replace(1, 3, magics[rng() % 6]);
+
+        PacketClass expect = kPacketUnknown;
+        if (IsMiniSdpReqPack(packet.data(), packet.size())) expect = kPacketMiniSdpReq;
+        else if (IsMiniSdpStopPack(packet.data(), packet.size())) expect = kPacketMiniSdpStop;
+        else if (IsMiniSdpFragPack(packet.data(), packet.size())) expect = kPacketMiniSdpFrag;
+        else if (IsMiniSdpDeltaPack(packet.data(), packet.size())) expect = kPacketMiniSdpDelta;
+        if (classify(packet) != expect) {
+            check(false, "random packet " + std::to_string(i));
+            break;
+        }
+    }
+}
+
+// queues keep the receiving order, and buffers are reused across batches
+static void testBatch() {
+    current = "batch";
+    std::vector<std::string> packets = {
+        makePacket(0x80, 96, 1200), makePacket(0x00, 0x01, 20), makePacket(0x80, 111, 200),
+        makePacket(0x81, 201, 32),  makePacket(22, 0xfe, 100),  makePacket(0x80, 96, 1200),
+        std::string("\xff" "SDP" "\x00", 5), makePacket(0x05, 0, 100), makePacket(0x80, 96, 3),
+    };
+    std::vector<struct iovec> iovs(packets.size());
+    std::vector<struct mmsghdr> msgs(packets.size());
+    for (size_t i = 0; i < packets.size(); i++) {
+        iovs[i].iov_base = &packets[i][0];
+        iovs[i].iov_len = packets[i].size();
+        msgs[i] = mmsghdr();
+        msgs[i].msg_hdr.msg_iov = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_len = packets[i].size();
+    }
+
+    PacketQueues queues;
+    for (int round = 0; round < 2; round++) {
+        if (round == 0) ClassifyPacketBatch(iovs.data(), iovs.size(), queues);
+        else ClassifyPacketBatch(msgs.data(), msgs.size(), queues);
+
+        check(queues.offsets[kPacketClassNum] == packets.size(), "all packets");
+        check(std::vector<uint32_t>(queues.Begin(kPacketRtp), queues.End(kPacketRtp)) ==
+              std::vector<uint32_t>({0, 2, 5}), "rtp queue in order");
+        check(queues.Size(kPacketRtcp) == 1 && *queues.Begin(kPacketRtcp) == 3, "rtcp queue");
+        check(queues.Size(kPacketStun) == 1 && queues.Size(kPacketDtls) == 1, "stun and dtls queue");
+        check(queues.Size(kPacketMiniSdpReq) == 1 && *queues.Begin(kPacketMiniSdpReq) == 6, "mini sdp queue");
+        check(std::vector<uint32_t>(queues.Begin(kPacketUnknown), queues.End(kPacketUnknown)) ==
+              std::vector<uint32_t>({7, 8}), "unknown queue");
+        for (size_t i = 0; i < packets.size(); i++) {
+            check(queues.classes[i] == classify(packets[i]), "class of packet " + std::to_string(i));
+        }
+    }
+
+    // truncated datagram
+    msgs[0].msg_len = packets[0].size() + 1;
+    ClassifyPacketBatch(msgs.data(), 1, queues);
+    check(queues.Size(kPacketUnknown) == 1 && queues.Size(kPacketRtp) == 0, "truncated");
+
+    ClassifyPacketBatch(msgs.data(), 0, queues);
+    check(queues.offsets[kPacketClassNum] == 0, "empty batch");
+}
+
+int main() {
+    testFirstByte();
+    testMinLen();
+    testMiniSdp();
+    testBatch();
+    printf("test end, %d failed\n", failed);
+    return failed == 0 ? 0 : 1;
+}
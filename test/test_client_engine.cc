@@ -0,0 +1,386 @@
+/**
+ * @file test/test_client_engine.cc
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <fstream>
+#include <map>
+#include <poll.h>
+#include <set>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "mini_sdp_client.h"
+#include "timer_wheel.h"
+
+using namespace mini_sdp;
+
+#ifndef MINI_SDP_CORPUS_DIR
+#define MINI_SDP_CORPUS_DIR "corpus"
+#endif
+
+static int failed = 0;
+static std::string current;
+
+static void check(bool cond, const std::string& what) {
+    if (!cond) {
+        printf("FAILED: %s: %s\n", current.c_str(), what.c_str());
+        failed++;
+    }
+}
+
+static std::string readSdp(const std::string& name) {
+    std::ifstream file(std::string(MINI_SDP_CORPUS_DIR) + "/" + name);
+    std::string sdp, line;
+    while (std::getline(file, line)) {
+        if (!line.empty()) sdp += line + "\r\n";
+    }
+    return sdp;
+}
+
+static uint64_t nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static int bindLoopback(struct sockaddr_in& addr) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    addr = sockaddr_in();
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addr_len = sizeof(addr);
+    if (fd < 0 || bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        getsockname(fd, (struct sockaddr*)&addr, &addr_len) != 0) {
+        printf("bind loopback failed\n");
+        exit(1);
+    }
+    return fd;
+}
+
+static struct sockaddr_in peerAddr(uint64_t peer) {
+    struct sockaddr_in addr = sockaddr_in();
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(uint32_t(peer >> 16));
+    addr.sin_port = htons(uint16_t(peer));
+    return addr;
+}
+
+static void testTimerWheel() {
+    current = "timer wheel";
+    TimerWheel wheel(10, 8, 0);
+    std::vector<uint64_t> expired;
+    check(wheel.NextTickMs() == UINT64_MAX, "empty");
+
+    wheel.Schedule(1, 25);
+    wheel.Schedule(2, 5);
+    wheel.Schedule(3, 200);     // more than one round away
+    wheel.Schedule(4, 0);       // already passed
+    check(wheel.Size() == 4 && wheel.NextTickMs() == 10, "next tick");
+
+    wheel.Advance(9, expired);
+    check(expired.empty(), "before the first tick");
+    wheel.Advance(10, expired);
+    check(expired == std::vector<uint64_t>({2, 4}), "first tick");
+    wheel.Advance(30, expired);
+    check(expired == std::vector<uint64_t>({1}), "deadline rounded up to a tick");
+    wheel.Advance(100, expired);
+    check(expired.empty() && wheel.Size() == 1, "skipped in the first round");
+    wheel.Advance(1000, expired);
+    check(expired == std::vector<uint64_t>({3}) && wheel.Size() == 0, "jump of several rounds");
+
+    // scheduled from the current tick, not from the deadline
+    wheel.Schedule(5, 1000);
+    check(wheel.NextTickMs() == 1010, "next tick after a jump");
+    wheel.Advance(1010, expired);
+    check(expired == std::vector<uint64_t>({5}), "passed deadline fires at the next tick");
+
+    // cancelled timers never fire, the others keep their order
+    uint64_t tick6 = wheel.Schedule(6, 1050);
+    uint64_t tick7 = wheel.Schedule(7, 1050);
+    wheel.Schedule(8, 1050);
+    check(wheel.Cancel(6, tick6) && !wheel.Cancel(6, tick6) && !wheel.Cancel(7, tick7 + 1), "cancel");
+    check(wheel.Size() == 2, "size after cancel");
+    wheel.Advance(1050, expired);
+    check(expired == std::vector<uint64_t>({7, 8}) && wheel.NextTickMs() == UINT64_MAX, "cancelled not fired");
+}
+
+static void testSeqAllocator() {
+    current = "seq allocator";
+    MiniSdpSeqAllocator seqs(1);
+    constexpr int kThreads = 4;
+    constexpr int kSeqs = 10000;
+    std::vector<std::vector<uint16_t>> allocated(kThreads);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kThreads; i++) {
+        threads.emplace_back([&, i] {
+            for (int j = 0; j < kSeqs; j++) allocated[i].push_back(seqs.Next(0x7f0000011f40));
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    std::set<uint16_t> unique;
+    for (auto& seq_list : allocated) unique.insert(seq_list.begin(), seq_list.end());
+    check(unique.size() == kThreads * kSeqs, "unique seqs for one peer");
+
+    check(MiniSdpSeqAllocator(1).Next(1) == MiniSdpSeqAllocator(1).Next(1), "seeded");
+}
+
+/*
+ * retransmit schedule on a fake clock
+ *  rto 20 -> 40 -> 80 (max)，4 次重传后再等一个 rto 超时
+ */
+static void testBackoff() {
+    current = "backoff";
+    MiniSdpSeqAllocator seqs(2);
+    MiniSdpClient::Options options;
+    options.initial_rto_ms = 20;
+    options.max_rto_ms = 80;
+    options.max_retransmits = 4;
+    std::vector<uint64_t> sent;
+    uint64_t now = 1000;
+    MiniSdpClient client([&](uint64_t, const char*, size_t) { sent.push_back(now); }, seqs, options, now);
+
+    StopStreamAttr stop;
+    stop.svrsig = "127.0.0.1:ufrag:svrsig";
+    std::vector<MiniSdpClient::Response> responses;
+    check(client.Stop(1, stop, now, [&](const MiniSdpClient::Response& response) {
+        responses.push_back(response);
+    }) >= 0, "stop");
+    for (; now <= 1400; now += 5) client.Advance(now);
+
+    check(sent == std::vector<uint64_t>({1000, 1020, 1060, 1140, 1220}), "retransmit times");
+    check(responses.size() == 1 && responses[0].status == MiniSdpClient::Status::kTimeout &&
+          responses[0].retransmits == 4 && responses[0].rtt_ms == 300, "timeout");
+    check(client.PendingCount() == 0 && client.NextTimeoutMs() == UINT64_MAX, "nothing pending");
+    check(client.GetStats().retransmits == 4 && client.GetStats().timeouts == 1, "stats");
+
+    // cancelled requests are not retransmitted, their timers are removed
+    ssize_t seq = client.Stop(1, stop, now, [&](const MiniSdpClient::Response& response) {
+        responses.push_back(response);
+    });
+    check(client.Cancel(1, uint16_t(seq), now) && !client.Cancel(1, uint16_t(seq), now), "cancel");
+    check(responses.size() == 2 && responses[1].status == MiniSdpClient::Status::kCancelled, "cancelled");
+    check(client.NextTimeoutMs() == UINT64_MAX, "no timer after cancel");
+    sent.clear();
+    for (uint64_t end = now + 400; now <= end; now += 5) client.Advance(now);
+    check(sent.empty() && client.GetStats().cancelled == 1, "not retransmitted");
+}
+
+// an answered request leaves no timer behind
+static void testAnswered() {
+    current = "answered";
+    MiniSdpSeqAllocator seqs(4);
+    std::string sent;
+    MiniSdpClient client([&](uint64_t, const char* data, size_t len) { sent.assign(data, len); }, seqs,
+                         MiniSdpClient::Options(), 0);
+    StopStreamAttr stop;
+    stop.svrsig = "127.0.0.1:ufrag:svrsig";
+    int answered = 0;
+    check(client.Stop(1, stop, 0, [&](const MiniSdpClient::Response& response) {
+        if (response.status == MiniSdpClient::Status::kAnswered) answered++;
+    }) >= 0, "stop");
+    check(client.NextTimeoutMs() != UINT64_MAX, "timer while pending");
+    // the server echoes the stop packet
+    check(client.OnPacket(1, sent.data(), sent.size(), 5), "answer");
+    check(answered == 1 && client.PendingCount() == 0 && client.NextTimeoutMs() == UINT64_MAX, "no timer");
+}
+
+// every seq of a peer pending, a new request fails and the pending ones are kept
+static void testSeqExhausted() {
+    current = "seq exhausted";
+    MiniSdpSeqAllocator seqs(5);
+    MiniSdpClient client([](uint64_t, const char*, size_t) {}, seqs, MiniSdpClient::Options(), 0);
+    StopStreamAttr stop;
+    stop.svrsig = "127.0.0.1:ufrag:svrsig";
+    int cancelled = 0, others = 0;
+    auto on_done = [&](const MiniSdpClient::Response& response) {
+        if (response.status == MiniSdpClient::Status::kCancelled) cancelled++;
+        else others++;
+    };
+    int failures = 0;
+    for (int i = 0; i < 65536; i++) {
+        if (client.Stop(1, stop, 0, on_done) < 0) failures++;
+    }
+    check(failures == 0 && client.PendingCount() == 65536, "all seqs pending");
+    check(client.Stop(1, stop, 0, on_done) == kSdpRetBusy, "no seq free");
+    check(client.PendingCount() == 65536 && others == 0, "pending kept");
+    // another peer is not affected
+    check(client.Stop(2, stop, 0, on_done) >= 0, "another peer");
+    for (uint32_t seq = 0; seq < 65536; seq++) client.Cancel(1, uint16_t(seq), 0);
+    check(cancelled == 65536 && client.PendingCount() == 1, "every request completes once");
+}
+
+/*
+ * loopback responder with induced loss
+ *  - 每个请求的前 seq % 3 个副本丢弃
+ *  - seq % 5 == 0 时第一个响应丢弃
+ *  - seq % 4 == 0 时响应发送两次，第二个没有匹配的请求
+ */
+class Responder {
+  public:
+    Responder() : fd_(bindLoopback(addr_)) {
+        OriginSdpAttr attr;
+        attr.sdp_type = SdpType::kAnswer;
+        attr.origin_sdp = readSdp("server_answer.sdp");
+        attr.stream_url = "webrtc://domain/live/stream";
+        attr.svrsig = "127.0.0.1:ufrag:svrsig";
+        answer_ = attr;
+        thread_ = std::thread([this] { run(); });
+    }
+
+    ~Responder() {
+        stopped_ = true;
+        thread_.join();
+        close(fd_);
+    }
+
+    uint64_t Peer() const { return MiniSdpPeerKey(addr_); }
+
+    // copy of the request answered first
+    static int AnsweredCopy(uint16_t seq) { return seq % 3 + 1 + (seq % 5 == 0 ? 1 : 0); }
+
+    static bool IsDuplicated(uint16_t seq) { return seq % 4 == 0; }
+
+  private:
+    void run() {
+        char buff[1500];
+        while (!stopped_) {
+            struct pollfd pfd = {fd_, POLLIN, 0};
+            if (poll(&pfd, 1, 10) <= 0) continue;
+            struct sockaddr_in from;
+            socklen_t from_len = sizeof(from);
+            ssize_t len = recvfrom(fd_, buff, sizeof(buff), 0, (struct sockaddr*)&from, &from_len);
+            if (len <= 0) continue;
+
+            char reply[1500];
+            ssize_t reply_len = 0;
+            uint16_t seq = 0;
+            if (IsMiniSdpStopPack(buff, len)) {
+                StopStreamAttr stop;
+                if (LoadStopStreamPacket(buff, len, stop) <= 0) continue;
+                seq = stop.seq;
+                reply_len = BuildStopStreamPacket(reply, sizeof(reply), stop);
+            } else {
+                MiniSdpDispatchInfo info;
+                if (PeekMiniSdp(buff, len, info) <= 0) continue;
+                seq = info.seq;
+                answer_.seq = seq;
+                reply_len = ParseOriginSdpToMiniSdp(answer_, reply, sizeof(reply));
+            }
+            int copy = ++copies_[seq];
+            if (copy < AnsweredCopy(seq) || reply_len <= 0) continue;
+            sendto(fd_, reply, reply_len, 0, (struct sockaddr*)&from, from_len);
+            if (IsDuplicated(seq)) sendto(fd_, reply, reply_len, 0, (struct sockaddr*)&from, from_len);
+        }
+    }
+
+  private:
+    struct sockaddr_in          addr_;
+    int                         fd_;
+    OriginSdpAttr               answer_;
+    std::map<uint16_t, int>     copies_;
+    std::atomic<bool>           stopped_{false};
+    std::thread                 thread_;
+};  // class Responder
+
+static void testLoopback() {
+    current = "loopback";
+    Responder responder;
+    struct sockaddr_in black_hole_addr;
+    int black_hole = bindLoopback(black_hole_addr);
+    struct sockaddr_in client_addr;
+    int fd = bindLoopback(client_addr);
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    MiniSdpSeqAllocator seqs(3);
+    MiniSdpClient::Options options;
+    // longer than the responder takes for all requests, also in sanitizer builds
+    options.initial_rto_ms = 100;
+    options.max_rto_ms = 400;
+    options.max_retransmits = 4;
+    uint64_t now = nowMs();
+    MiniSdpClient client([fd](uint64_t peer, const char* data, size_t len) {
+        struct sockaddr_in addr = peerAddr(peer);
+        sendto(fd, data, len, 0, (struct sockaddr*)&addr, sizeof(addr));
+    }, seqs, options, now);
+
+    OriginSdpAttr offer;
+    offer.sdp_type = SdpType::kOffer;
+    offer.origin_sdp = readSdp("chrome_push_offer.sdp");
+    offer.stream_url = "webrtc://domain/live/stream";
+    offer.is_imm_send = true;
+    StopStreamAttr stop;
+    stop.svrsig = "127.0.0.1:ufrag:svrsig";
+
+    constexpr int kRequests = 200;
+    int answered = 0, wrong = 0, duplicated = 0, timeouts = 0;
+    auto on_answer = [&](const MiniSdpClient::Response& response) {
+        if (response.status != MiniSdpClient::Status::kAnswered ||
+            response.retransmits + 1 != uint32_t(Responder::AnsweredCopy(response.seq))) {
+            wrong++;
+            return;
+        }
+        answered++;
+        if (Responder::IsDuplicated(response.seq)) duplicated++;
+    };
+    for (int i = 0; i < kRequests; i++) {
+        ssize_t ret = i % 4 == 3 ? client.Stop(responder.Peer(), stop, now, on_answer)
+                                 : client.Request(responder.Peer(), offer, now, on_answer);
+        check(ret >= 0, "request " + std::to_string(i));
+    }
+    client.Request(MiniSdpPeerKey(black_hole_addr), offer, now, [&](const MiniSdpClient::Response& response) {
+        if (response.status == MiniSdpClient::Status::kTimeout && response.retransmits == 4) timeouts++;
+    });
+
+    // event loop, until every request completes and late duplicates are drained
+    uint64_t deadline = now + 5000, drained = 0;
+    while (now < deadline && (client.PendingCount() > 0 || now < drained)) {
+        uint64_t next = client.NextTimeoutMs();
+        int timeout = next == UINT64_MAX ? 10 : int(std::min<uint64_t>(next > now ? next - now : 0, 10));
+        struct pollfd pfd = {fd, POLLIN, 0};
+        poll(&pfd, 1, timeout);
+        now = nowMs();
+        char buff[1500];
+        struct sockaddr_in from;
+        socklen_t from_len = sizeof(from);
+        ssize_t len;
+        while ((len = recvfrom(fd, buff, sizeof(buff), 0, (struct sockaddr*)&from, &from_len)) > 0) {
+            client.OnPacket(MiniSdpPeerKey(from), buff, len, now);
+            from_len = sizeof(from);
+        }
+        client.Advance(now);
+        if (client.PendingCount() == 0 && drained == 0) drained = now + 50;
+    }
+
+    const MiniSdpClient::Stats& stats = client.GetStats();
+    printf("requests %lu  retransmits %lu  answered %lu  timeouts %lu  unmatched %lu  errors %lu\n",
+           (unsigned long)stats.requests, (unsigned long)stats.retransmits, (unsigned long)stats.answered,
+           (unsigned long)stats.timeouts, (unsigned long)stats.unmatched, (unsigned long)stats.errors);
+    check(answered == kRequests && wrong == 0, "answered after the expected retransmits");
+    check(timeouts == 1, "black hole times out");
+    check(stats.unmatched == uint64_t(duplicated) && duplicated > 0, "duplicate answers unmatched");
+    check(stats.errors == 0 && client.PendingCount() == 0, "no errors");
+    close(fd);
+    close(black_hole);
+}
+
+int main() {
+    testTimerWheel();
+    testSeqAllocator();
+    testBackoff();
+    testAnswered();
+    testSeqExhausted();
+    testLoopback();
+    printf("test end, %d failed\n", failed);
+    return failed == 0 ? 0 : 1;
+}
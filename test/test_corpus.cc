@@ -0,0 +1,275 @@
+/**
+ * @file test/test_corpus.cc
+ * @brief round trip over test/corpus: pack -> load -> re-parse
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ * usage: run_corpus_test [corpus dir]
+ *  文件名以 _offer.sdp / _answer.sdp 结尾，决定 SdpType
+ *
+ */
+#include <dirent.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "mini_sdp.h"
+#include "mini_sdp_impl.h"
+#include "sdp_parser.h"
+
+using namespace mini_sdp;
+
+#ifndef MINI_SDP_CORPUS_DIR
+#define MINI_SDP_CORPUS_DIR "corpus"
+#endif
+
+static int failed = 0;
+static std::string current;
+
+static void check(bool cond, const std::string& what) {
+    if (!cond) {
+        printf("FAILED: %s: %s\n", current.c_str(), what.c_str());
+        failed++;
+    }
+}
+
+static bool endsWith(const std::string& str, const std::string& suffix) {
+    return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// corpus files are stored with '\n', sdp requires "\r\n"
+static std::string readSdp(const std::string& path) {
+    std::ifstream file(path);
+    std::string sdp, line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+        sdp += line + kSdpEndOfLine;
+    }
+    return sdp;
+}
+
+static SessionDescriptionPtr parse(const std::string& sdp) {
+    SdpParser parser(sdp.data(), sdp.size());
+    parser.Parse();
+    return parser.GetSessionDescription();
+}
+
+static std::vector<MediaDescriptionPtr> mediasInOrder(const SessionDescription& sdp) {
+    std::vector<MediaDescriptionPtr> medias;
+    for (auto& mid : sdp.GroupBundle) {
+        auto it = sdp.Medias.find(mid);
+        if (it != sdp.Medias.end()) medias.push_back(it->second);
+    }
+    if (medias.size() != sdp.Medias.size()) {
+        medias.clear();
+        for (auto& media_pair : sdp.Medias) medias.push_back(media_pair.second);
+    }
+    return medias;
+}
+
+/*
+ * mini sdp 只携带部分内容，与原始 SDP 比较其携带的部分：
+ *  - 每个 codec 在原始 SDP 中有同 pt 的 codec，且 name/sample_rate/channels 一致，feedback 为其子集
+ *  - extmap 为原始 SDP 的子集，track 及其顺序、ssrc-group、rid、simulcast 与原始 SDP 一致
+ *  - ice / fingerprint / 方向 / DTLS 角色一致
+ */
+static void checkCarried(const SessionDescription& origin, const SessionDescription& loaded) {
+    auto origin_medias = mediasInOrder(origin);
+    auto loaded_medias = mediasInOrder(loaded);
+    check(origin_medias.size() == loaded_medias.size(), "media count");
+    for (size_t i = 0; i < std::min(origin_medias.size(), loaded_medias.size()); i++) {
+        auto& from = *origin_medias[i];
+        auto& to = *loaded_medias[i];
+        std::string media = "media " + std::to_string(i);
+        check(from.MediaType == to.MediaType, media + " type");
+        check(from.IceUfrag.empty() || from.IceUfrag == to.IceUfrag, media + " ice-ufrag");
+        check(from.IcePwd.empty() || from.IcePwd == to.IcePwd, media + " ice-pwd");
+        check(from.Fingerprint.second.empty() || from.Fingerprint == to.Fingerprint, media + " fingerprint");
+        check(from.TransType == SdpTransType::kTransNone || from.TransType == to.TransType, media + " direction");
+        check(from.RoleType == SdpRoleType::kRoleNone || from.RoleType == to.RoleType, media + " setup");
+        check(from.Candidate.first.empty() || from.Candidate == to.Candidate, media + " candidate");
+
+        for (auto& codec_pair : to.Codecs) {
+            auto it = from.Codecs.find(codec_pair.first);
+            std::string codec = media + " codec " + std::to_string(codec_pair.first);
+            check(it != from.Codecs.end() && it->second->IsSimpleEqual(*codec_pair.second), codec);
+            if (it == from.Codecs.end()) continue;
+            for (auto& feedback : codec_pair.second->Feedbacks) {
+                check(it->second->Feedbacks.count(feedback), codec + " feedback " + feedback);
+            }
+        }
+        for (auto& ext_pair : to.ExtMap) {
+            auto it = from.ExtMap.find(ext_pair.first);
+            check(it != from.ExtMap.end() && it->second == ext_pair.second, media + " extmap");
+        }
+        for (auto& track_pair : to.Tracks) {
+            check(from.Tracks.count(track_pair.first), media + " track");
+        }
+        check(from.TracksOrder == to.TracksOrder, media + " track order");
+        check(from.SsrcGroups.size() == to.SsrcGroups.size() || from.SsrcGroups.empty(), media + " ssrc-group");
+        for (size_t j = 0; j < std::min(from.SsrcGroups.size(), to.SsrcGroups.size()); j++) {
+            check(from.SsrcGroups[j].Semantics == to.SsrcGroups[j].Semantics &&
+                  from.SsrcGroups[j].Ssrcs == to.SsrcGroups[j].Ssrcs, media + " ssrc-group " + std::to_string(j));
+        }
+        check(from.Rids.size() == to.Rids.size(), media + " rid");
+        for (size_t j = 0; j < std::min(from.Rids.size(), to.Rids.size()); j++) {
+            check(from.Rids[j].Id == to.Rids[j].Id && from.Rids[j].Direction == to.Rids[j].Direction &&
+                  from.Rids[j].Params == to.Rids[j].Params, media + " rid " + std::to_string(j));
+        }
+        check(from.Simulcast == to.Simulcast, media + " simulcast");
+    }
+}
+
+// a loaded sdp is packed into the same content
+static void checkStrictEqual(const SessionDescription& lhs, const SessionDescription& rhs) {
+    auto lhs_medias = mediasInOrder(lhs);
+    auto rhs_medias = mediasInOrder(rhs);
+    check(lhs.ToString() == rhs.ToString(), "to string");
+    check(lhs_medias.size() == rhs_medias.size(), "fixpoint media count");
+    for (size_t i = 0; i < std::min(lhs_medias.size(), rhs_medias.size()); i++) {
+        auto& from = *lhs_medias[i];
+        auto& to = *rhs_medias[i];
+        check(from.Codecs.size() == to.Codecs.size(), "fixpoint codec count");
+        for (auto& codec_pair : from.Codecs) {
+            auto it = to.Codecs.find(codec_pair.first);
+            check(it != to.Codecs.end() && it->second->IsStrictEqual(*codec_pair.second), "fixpoint codec");
+        }
+        check(from.Tracks.size() == to.Tracks.size(), "fixpoint track count");
+        for (auto& track_pair : from.Tracks) {
+            auto it = to.Tracks.find(track_pair.first);
+            check(it != to.Tracks.end() && it->second->IsStrictEqaul(*track_pair.second), "fixpoint track");
+        }
+        check(from.ExtMap == to.ExtMap, "fixpoint extmap");
+    }
+}
+
+// every buffer shorter than the packet is rejected without writing past its end
+static void checkBounded(const OriginSdpAttr& attr, const std::string& tag) {
+    const size_t kCanary = 32;
+    char full[1400];
+    ssize_t size = ParseOriginSdpToMiniSdp(attr, full, sizeof(full));
+    check(size > 0, tag + "bounded pack");
+    if (size <= 0) return;
+    std::vector<char> buff;
+    size_t overruns = 0, accepted = 0;
+    for (size_t len = 0; len <= (size_t)size; len++) {
+        buff.assign(len + kCanary, char(0xa5));
+        ssize_t ret = ParseOriginSdpToMiniSdp(attr, buff.data(), len);
+        if (std::count(buff.begin() + len, buff.end(), char(0xa5)) != (ssize_t)kCanary) overruns++;
+        if (len < (size_t)size ? ret != kSdpRetSizeExceeded : ret != size) accepted++;
+    }
+    check(overruns == 0, tag + "overruns " + std::to_string(overruns));
+    check(accepted == 0, tag + "wrong results " + std::to_string(accepted));
+}
+
+using Clock = std::chrono::steady_clock;
+
+template <typename Func>
+static double nsPerOp(Func&& func) {
+    const int kLoops = 1000;
+    auto start = Clock::now();
+    for (int i = 0; i < kLoops; i++) func();
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / kLoops;
+}
+
+static void runFile(const std::string& dir, const std::string& name) {
+    current = name;
+    OriginSdpAttr attr;
+    attr.origin_sdp = readSdp(dir + "/" + name);
+    attr.sdp_type = endsWith(name, "_answer.sdp") ? SdpType::kAnswer : SdpType::kOffer;
+    attr.stream_url = "webrtc://domain/live/stream?txSecret=0123456789abcdef";
+    attr.svrsig = attr.sdp_type == SdpType::kAnswer ? "1h8s" : "";
+    attr.status_code = attr.sdp_type == SdpType::kAnswer ? 200 : 0;
+    attr.is_support_aac_fmtp = true;
+    attr.is_compact_fingerprint = true;
+    auto origin = parse(attr.origin_sdp);
+    check(!origin->Medias.empty(), "parse");
+
+    size_t sizes[2] = {0, 0};
+    for (uint8_t version = 0; version < 2; version++) {
+        attr.version = version;
+        std::string tag = "v" + std::to_string(version) + " ";
+        char buff[1400];
+        ssize_t size = ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff));
+        check(size > 0 && (size_t)size <= sizeof(buff), tag + "pack");
+        if (size <= 0 || (size_t)size > sizeof(buff)) continue;
+        sizes[version] = size;
+
+        OriginSdpAttr loaded;
+        OriginSdpAttr truncated;
+        check(LoadMiniSdpToOriginSdp(buff, size / 2, truncated) == kSdpRetWrongFormat, tag + "truncated");
+        // every prefix, in a buffer of its own size so a sanitizer sees any read past it
+        int overread = 0;
+        for (ssize_t len = 0; len < size; len++) {
+            std::vector<char> prefix(buff, buff + len);
+            ssize_t ret = LoadMiniSdpToOriginSdp(prefix.data(), prefix.size(), truncated);
+            if (ret > len) overread++;
+        }
+        check(overread == 0, tag + "prefixes");
+        // a direction out of the table
+        std::vector<char> directed(buff, buff + size);
+        if (version == 0) reinterpret_cast<MiniSdpHdr*>(directed.data())->direction = 3;
+        check(LoadMiniSdpToOriginSdp(directed.data(), directed.size(), truncated) == size, tag + "direction");
+        check(LoadMiniSdpToOriginSdp(buff, size, loaded) == size, tag + "load");
+        auto first = parse(loaded.origin_sdp);
+        checkCarried(*origin, *first);
+
+        // pack the loaded sdp again
+        loaded.svrsig = attr.svrsig;
+        loaded.is_compact_fingerprint = true;
+        char buff2[1400];
+        ssize_t size2 = ParseOriginSdpToMiniSdp(loaded, buff2, sizeof(buff2));
+        check(size2 == size && std::equal(buff, buff + size, buff2), tag + "fixpoint bytes");
+        OriginSdpAttr loaded2;
+        LoadMiniSdpToOriginSdp(buff2, size2, loaded2);
+        checkStrictEqual(*first, *parse(loaded2.origin_sdp));
+
+        OriginSdpAttr bounded = attr;
+        checkBounded(bounded, tag);
+        bounded.svrsig.assign(100, 's');
+        checkBounded(bounded, tag + "long svrsig ");
+        bounded.sdp_type = SdpType::kSdpNone;
+        checkBounded(bounded, tag + "none ");
+    }
+
+    attr.version = 0;
+    char buff[1400];
+    ssize_t size = ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff));
+    double parse_ns = nsPerOp([&] { parse(attr.origin_sdp); });
+    double pack_ns = nsPerOp([&] { ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff)); });
+    double load_ns = nsPerOp([&] {
+        OriginSdpAttr loaded;
+        LoadMiniSdpToOriginSdp(buff, size, loaded);
+    });
+    printf("%-32s %6zu %6zu %6zu %10.0f %10.0f %10.0f\n", name.c_str(), attr.origin_sdp.size(), sizes[0], sizes[1],
+           parse_ns, pack_ns, load_ns);
+}
+
+int main(int argc, char** argv) {
+    std::string dir = argc > 1 ? argv[1] : MINI_SDP_CORPUS_DIR;
+    std::vector<std::string> names;
+    DIR* dirp = opendir(dir.c_str());
+    if (!dirp) {
+        printf("open %s failed\n", dir.c_str());
+        return 1;
+    }
+    while (struct dirent* entry = readdir(dirp)) {
+        std::string name = entry->d_name;
+        if (endsWith(name, ".sdp")) names.push_back(name);
+    }
+    closedir(dirp);
+    std::sort(names.begin(), names.end());
+
+    printf("%-32s %6s %6s %6s %10s %10s %10s\n", "file", "sdp", "v0", "v1", "parse ns", "pack ns", "load ns");
+    for (auto& name : names) {
+        runFile(dir, name);
+    }
+    printf("test end, %zu files, %d failed\n", names.size(), failed);
+    return failed == 0 && !names.empty() ? 0 : 1;
+}
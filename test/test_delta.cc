@@ -0,0 +1,227 @@
+/**
+ * @file test/test_delta.cc
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include "mini_sdp.h"
+#include "mini_sdp_delta.h"
+#include "sdp_parser.h"
+
+using namespace mini_sdp;
+
+static int failed = 0;
+
+static void check(bool cond, const char* what) {
+    if (!cond) {
+        printf("FAILED: %s\n", what);
+        failed++;
+    }
+}
+
+struct OfferParam {
+    std::string ufrag = "Zh1u";
+    std::string pwd = "2P3Ww8ytUu1Sz6NUy1mWOUZr";
+    bool        nack = true;
+    bool        h265 = false;
+    bool        aac = false;
+    bool        second_ssrc = false;
+    bool        fid_group = false;      // of the two video ssrcs
+    std::string video_ufrag;            // the same as audio if empty
+};
+
+static std::string MakeOffer(const OfferParam& param) {
+    std::string ice = "a=ice-ufrag:" + param.ufrag + "\r\na=ice-pwd:" + param.pwd + "\r\n";
+    std::string sdp =
+        "v=0\r\no=- 1 0 IN IP4 127.0.0.1\r\ns=-\r\nt=0 0\r\na=group:BUNDLE 0 1\r\n";
+    sdp += param.aac ? "m=audio 9 UDP/TLS/RTP/SAVPF 111 13\r\n" : "m=audio 9 UDP/TLS/RTP/SAVPF 111\r\n";
+    sdp += "c=IN IP4 0.0.0.0\r\n" + ice +
+           "a=fingerprint:sha-256 8A:BD:A6:61:75:AF:31:4C:02:81:2A:FA:12:92:4C:48:7B:9F:23:DD:BF:3D:51:30:"
+           "E7:59:5C:9B:17:3D:92:34\r\n"
+           "a=setup:actpass\r\na=mid:0\r\na=sendrecv\r\na=rtpmap:111 opus/48000/2\r\na=rtcp-fb:111 transport-cc\r\n";
+    if (param.aac) {
+        sdp += "a=rtpmap:13 MP4A-LATM/48000/2\r\na=fmtp:13 object=2;cpresent=0;config=400024203fc0c0c0c0\r\n";
+    }
+    sdp += "a=ssrc:3570614608 cname:4TOk42mSjXCkVIa6\r\n";
+    sdp += param.h265 ? "m=video 9 UDP/TLS/RTP/SAVPF 96 98\r\n" : "m=video 9 UDP/TLS/RTP/SAVPF 96\r\n";
+    if (!param.video_ufrag.empty()) ice = "a=ice-ufrag:" + param.video_ufrag + "\r\na=ice-pwd:" + param.pwd + "\r\n";
+    sdp += "c=IN IP4 0.0.0.0\r\n" + ice + "a=setup:actpass\r\na=mid:1\r\na=sendrecv\r\n"
+           "a=rtpmap:96 H264/90000\r\na=rtcp-fb:96 transport-cc\r\n";
+    if (param.nack) sdp += "a=rtcp-fb:96 nack\r\n";
+    if (param.h265) sdp += "a=rtpmap:98 H265/90000\r\na=rtcp-fb:98 nack\r\n";
+    if (param.fid_group) sdp += "a=ssrc-group:FID 2291961624 1366387413\r\n";
+    sdp += "a=ssrc:2291961624 cname:4TOk42mSjXCkVIa6\r\na=ssrc:2291961624 msid:stream video\r\n";
+    if (param.second_ssrc) {
+        sdp += "a=ssrc:1366387413 cname:4TOk42mSjXCkVIa6\r\na=ssrc:1366387413 msid:stream video\r\n";
+    }
+    return sdp;
+}
+
+static SessionDescriptionPtr Parse(const std::string& sdp) {
+    SdpParser parser(sdp.data(), sdp.size());
+    check(parser.Parse(), "parse");
+    return parser.GetSessionDescription();
+}
+
+// diff, transfer, apply, and the result has no difference from target
+static size_t RoundTrip(const OfferParam& base_param, const OfferParam& target_param, const char* name) {
+    auto base = Parse(MakeOffer(base_param));
+    auto target = Parse(MakeOffer(target_param));
+
+    SdpDeltaAttr attr;
+    attr.svrsig = "127.0.0.1:Zh1u:9a8b";
+    attr.seq = 3;
+    check(DiffSessionDescription(*base, *target, attr.delta), name);
+    check(!attr.delta.Empty(), name);
+
+    char buff[1400];
+    ssize_t size = BuildSdpDeltaPacket(buff, sizeof(buff), attr);
+    check(size > 0 && IsMiniSdpDeltaPack(buff, size), name);
+
+    SdpDeltaAttr attr2;
+    check(LoadSdpDeltaPacket(buff, size, attr2) == size, name);
+    check(attr2.svrsig == attr.svrsig && attr2.seq == attr.seq, name);
+    check(ApplySdpDelta(attr2.delta, *base), name);
+
+    SdpDelta rest;
+    check(DiffSessionDescription(*base, *target, rest) && rest.Empty(), name);
+
+    // rendered and parsed again, every track keeps its attributes and groups refer to tracks only
+    auto rendered = Parse(base->ToString());
+    check(DiffSessionDescription(*rendered, *target, rest) && rest.Empty(), name);
+    for (auto& media_pair : rendered->Medias) {
+        auto& media = *media_pair.second;
+        auto target_it = target->Medias.find(media_pair.first);
+        check(target_it != target->Medias.end() && media.SsrcGroups.size() == target_it->second->SsrcGroups.size(),
+              name);
+        for (auto& track_pair : media.Tracks) {
+            check(track_pair.second->GetAttributes() == target_it->second->Tracks[track_pair.first]->GetAttributes(),
+                  name);
+        }
+        for (auto& group : media.SsrcGroups) {
+            for (auto ssrc : group.Ssrcs) check(media.Tracks.count(ssrc), name);
+        }
+    }
+    printf("%-14s delta %zd bytes\n", name, size);
+    return size;
+}
+
+static void testDelta() {
+    OfferParam base;
+
+    OfferParam ice_restart;
+    ice_restart.ufrag = "8c2b";
+    ice_restart.pwd = "p0Qw1Xq5Vw8Vn3Lz2Wm6Ka9s";
+    RoundTrip(base, ice_restart, "ice-restart");
+
+    OfferParam new_track;
+    new_track.second_ssrc = true;
+    RoundTrip(base, new_track, "new-track");
+    RoundTrip(new_track, base, "remove-track");
+
+    // the group of a removed ssrc is removed with it
+    OfferParam fid_track = new_track;
+    fid_track.fid_group = true;
+    RoundTrip(fid_track, base, "remove-fid");
+
+    // ufrag and pwd of every media are compared
+    OfferParam video_ice;
+    video_ice.video_ufrag = "8c2b";
+    RoundTrip(video_ice, base, "ice-per-media");
+
+    OfferParam codecs;
+    codecs.nack = false;
+    codecs.h265 = true;
+    codecs.aac = true;
+    RoundTrip(base, codecs, "codec-change");
+    RoundTrip(codecs, base, "codec-remove");
+
+    // nothing changed
+    SdpDelta delta;
+    auto sdp = Parse(MakeOffer(base));
+    check(DiffSessionDescription(*sdp, *Parse(MakeOffer(base)), delta) && delta.Empty(), "no change");
+
+    // medias restarted with different ufrags need a full offer
+    check(!DiffSessionDescription(*sdp, *Parse(MakeOffer(video_ice)), delta), "ice of a media");
+
+    // a new media needs a full offer
+    std::string audio_only = MakeOffer(base);
+    audio_only = audio_only.substr(0, audio_only.find("m=video"));
+    check(!DiffSessionDescription(*sdp, *Parse(audio_only), delta), "media added");
+
+    // a media in delta is not found
+    delta.medias.resize(1);
+    delta.medias[0].mid = "9";
+    check(!ApplySdpDelta(delta, *sdp), "unknown mid");
+
+    // truncated packet
+    SdpDeltaAttr attr;
+    attr.svrsig = "127.0.0.1:Zh1u:9a8b";
+    check(DiffSessionDescription(*sdp, *Parse(MakeOffer(codecs)), attr.delta), "diff");
+    char buff[1400];
+    ssize_t size = BuildSdpDeltaPacket(buff, sizeof(buff), attr);
+    check(size > 0, "build");
+    for (ssize_t len = 0; len < size; len++) {
+        check(LoadSdpDeltaPacket(buff, len, attr) < 0, "truncated");
+    }
+    check(BuildSdpDeltaPacket(buff, size - 1, attr) == kSdpRetSizeExceeded, "small buffer");
+}
+
+template <typename Func>
+static double nsPerOp(int loops, Func&& func) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < loops; i++) func();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / loops;
+}
+
+// server side cost of an ice restart: load a full offer, or load and apply a delta
+static void benchRestart() {
+    const int kLoops = 20000;
+    OfferParam base, restart;
+    restart.ufrag = "8c2b";
+    restart.pwd = "p0Qw1Xq5Vw8Vn3Lz2Wm6Ka9s";
+
+    OriginSdpAttr full_attr;
+    full_attr.origin_sdp = MakeOffer(restart);
+    full_attr.sdp_type = SdpType::kOffer;
+    full_attr.stream_url = "webrtc://domain/live/xxxx_d71956d9cc93e4a467b11e06fdaf039a";
+    full_attr.svrsig = "127.0.0.1:Zh1u:9a8b";
+    char full_buff[1400];
+    ssize_t full_size = ParseOriginSdpToMiniSdp(full_attr, full_buff, sizeof(full_buff));
+    check(full_size > 0, "full pack");
+
+    SdpDeltaAttr delta_attr;
+    delta_attr.svrsig = full_attr.svrsig;
+    auto stored = Parse(MakeOffer(base));
+    DiffSessionDescription(*stored, *Parse(MakeOffer(restart)), delta_attr.delta);
+    char delta_buff[1400];
+    ssize_t delta_size = BuildSdpDeltaPacket(delta_buff, sizeof(delta_buff), delta_attr);
+
+    double full_ns = nsPerOp(kLoops, [&] {
+        OriginSdpAttr attr;
+        LoadMiniSdpToOriginSdp(full_buff, full_size, attr);
+        Parse(attr.origin_sdp);
+    });
+    double delta_ns = nsPerOp(kLoops, [&] {
+        SdpDeltaAttr attr;
+        LoadSdpDeltaPacket(delta_buff, delta_size, attr);
+        ApplySdpDelta(attr.delta, *stored);
+    });
+    printf("ice restart: full offer %zd bytes %.0f ns, delta %zd bytes %.0f ns\n",
+           full_size, full_ns, delta_size, delta_ns);
+}
+
+int main() {
+    printf("test delta\n");
+    testDelta();
+    benchRestart();
+    printf("test end, %d failed\n", failed);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,212 @@
+/**
+ * @file test/test_dispatch.cc
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <dirent.h>
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+#include "mini_sdp.h"
+#include "sdp_parser.h"
+
+using namespace mini_sdp;
+
+#ifndef MINI_SDP_CORPUS_DIR
+#define MINI_SDP_CORPUS_DIR "corpus"
+#endif
+
+static int failed = 0;
+static std::string current;
+
+static void check(bool cond, const std::string& what) {
+    if (!cond) {
+        printf("FAILED: %s: %s\n", current.c_str(), what.c_str());
+        failed++;
+    }
+}
+
+static bool endsWith(const std::string& str, const std::string& suffix) {
+    return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+static std::string readSdp(const std::string& name) {
+    std::ifstream file(std::string(MINI_SDP_CORPUS_DIR) + "/" + name);
+    std::string sdp, line;
+    while (std::getline(file, line)) {
+        if (!line.empty()) sdp += line + "\r\n";
+    }
+    return sdp;
+}
+
+static OriginSdpAttr makeAttr(const std::string& name, uint8_t version) {
+    OriginSdpAttr attr;
+    attr.origin_sdp = readSdp(name);
+    attr.sdp_type = endsWith(name, "_answer.sdp") ? SdpType::kAnswer : SdpType::kOffer;
+    attr.stream_url = "webrtc://domain/live/stream?txSecret=0123456789abcdef";
+    if (attr.sdp_type == SdpType::kAnswer) attr.svrsig = "127.0.0.1:ufrag:svrsig";
+    attr.seq = 4321;
+    attr.is_imm_send = true;
+    attr.is_push = kStreamPush;
+    attr.version = version;
+    return attr;
+}
+
+// dispatch info is what the full decode gives
+static void checkInfo(const MiniSdpDispatchInfo& info, const OriginSdpAttr& loaded) {
+    check(info.version == loaded.version, "version");
+    check(info.sdp_type == loaded.sdp_type, "sdp type");
+    check(info.seq == loaded.seq, "seq");
+    check(info.is_imm_send == loaded.is_imm_send, "imm send");
+    check(info.is_push == loaded.is_push, "push");
+    check(info.stream_url == loaded.stream_url, "stream url");
+    if (loaded.sdp_type == SdpType::kSdpNone) {
+        check(info.medias.empty(), "no media");
+        return;
+    }
+
+    SdpParser sdp_parser(loaded.origin_sdp.c_str(), loaded.origin_sdp.size());
+    check(sdp_parser.Parse(), "parse loaded");
+    auto sdp_info = sdp_parser.GetSessionDescription();
+    check(info.medias.size() == sdp_info->GroupBundle.size(), "media count");
+    for (size_t i = 0; i < std::min(info.medias.size(), sdp_info->GroupBundle.size()); i++) {
+        auto& media = *sdp_info->Medias[sdp_info->GroupBundle[i]];
+        std::set<uint8_t> payload_types;
+        for (auto& codec_pair : media.Codecs) payload_types.insert(codec_pair.first);
+        check(info.medias[i].media_type == media.MediaType, "media type");
+        check(info.medias[i].ssrcs == media.TracksOrder, "ssrcs");
+        check(std::set<uint8_t>(info.medias[i].payload_types.begin(), info.medias[i].payload_types.end()) ==
+              payload_types, "payload types");
+    }
+}
+
+static void checkFile(const std::string& name) {
+    for (uint8_t version = 0; version < 2; version++) {
+        current = name + " v" + std::to_string(version);
+        OriginSdpAttr attr = makeAttr(name, version);
+        char buff[1400];
+        ssize_t size = ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff));
+        check(size > 0, "pack");
+        if (size <= 0) continue;
+
+        MiniSdpDispatchInfo info;
+        OriginSdpAttr loaded;
+        check(PeekMiniSdp(buff, size, info) == size, "peek");
+        check(LoadMiniSdpToOriginSdp(buff, size, loaded) == size, "load");
+        checkInfo(info, loaded);
+
+        // a prefix is peeked only if it can be loaded, the full decode is not bounds checked in v0
+        for (size_t len = 0; len < size_t(size); len++) {
+            ssize_t peek_size = PeekMiniSdp(buff, len, info);
+            if (peek_size > 0 && LoadMiniSdpToOriginSdp(buff, len, loaded) != peek_size) {
+                check(false, "prefix " + std::to_string(len));
+                break;
+            }
+        }
+    }
+}
+
+static void testStaged() {
+    current = "staged";
+    OriginSdpAttr attr = makeAttr("chrome_simulcast_offer.sdp", 0);
+    char buff[1400];
+    ssize_t size = ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff));
+
+    int dispatched = 0;
+    OriginSdpAttr loaded;
+    ssize_t ret = LoadMiniSdpToOriginSdp(buff, size, loaded, [&](const MiniSdpDispatchInfo& info) {
+        dispatched++;
+        check(loaded.origin_sdp.empty(), "dispatched before the full decode");
+        check(info.is_imm_send && info.seq == attr.seq && info.stream_url == attr.stream_url, "info");
+        auto video = std::find_if(info.medias.begin(), info.medias.end(), [](const MiniSdpDispatchInfo::Media& media) {
+            return media.media_type == SdpMediaType::kVideo;
+        });
+        check(info.medias.size() == 2 && video != info.medias.end() && video->ssrcs.size() == 6, "simulcast ssrcs");
+    });
+    check(ret == size && dispatched == 1 && !loaded.origin_sdp.empty(), "loaded");
+
+    // no sdp, like a request of an existing session
+    attr.sdp_type = SdpType::kSdpNone;
+    size = ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff));
+    MiniSdpDispatchInfo info;
+    check(PeekMiniSdp(buff, size, info) == size && info.medias.empty(), "no sdp");
+    check(LoadMiniSdpToOriginSdp(buff, size, loaded) == size, "load no sdp");
+    checkInfo(info, loaded);
+
+    dispatched = 0;
+    buff[1] = 'X';
+    check(LoadMiniSdpToOriginSdp(buff, size, loaded, [&](const MiniSdpDispatchInfo&) { dispatched++; }) ==
+          kSdpRetWrongFormat && dispatched == 0, "bad magic");
+    check(LoadMiniSdpToOriginSdp(buff, 3, loaded, nullptr) == kSdpRetSizeExceeded, "too short");
+}
+
+/*
+ * time to first dispatch
+ *  从收到包到回调的耗时，对比完整解码 (LoadMiniSdpToOriginSdp)，各取中位数
+ */
+static void testTimeToDispatch() {
+    using Clock = std::chrono::steady_clock;
+    const char* names[] = {"chrome_push_offer.sdp", "chrome_simulcast_offer.sdp", "server_answer.sdp"};
+    for (auto name : names) {
+        for (uint8_t version = 0; version < 2; version++) {
+            current = std::string(name) + " v" + std::to_string(version) + " timing";
+            OriginSdpAttr attr = makeAttr(name, version);
+            char buff[1400];
+            ssize_t size = ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff));
+
+            constexpr int kRounds = 2000;
+            std::vector<double> dispatch_ns, staged_ns, full_ns;
+            for (int i = 0; i < kRounds; i++) {
+                OriginSdpAttr loaded;
+                Clock::time_point start = Clock::now(), dispatch;
+                LoadMiniSdpToOriginSdp(buff, size, loaded, [&](const MiniSdpDispatchInfo&) { dispatch = Clock::now(); });
+                Clock::time_point end = Clock::now();
+                dispatch_ns.push_back(std::chrono::duration<double, std::nano>(dispatch - start).count());
+                staged_ns.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+
+                start = Clock::now();
+                LoadMiniSdpToOriginSdp(buff, size, loaded);
+                full_ns.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count());
+            }
+            auto median = [](std::vector<double>& values) {
+                std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+                return values[values.size() / 2];
+            };
+            double dispatch = median(dispatch_ns), staged = median(staged_ns), full = median(full_ns);
+            printf("%-28s v%u  first dispatch %8.0f ns  staged load %8.0f ns  full load %8.0f ns  (%.1f%%)\n",
+                   name, version, dispatch, staged, full, 100 * dispatch / full);
+            check(dispatch < full, "dispatched before a full decode would finish");
+        }
+    }
+}
+
+int main() {
+    std::vector<std::string> names;
+    DIR* dirp = opendir(MINI_SDP_CORPUS_DIR);
+    if (!dirp) {
+        printf("open %s failed\n", MINI_SDP_CORPUS_DIR);
+        return 1;
+    }
+    while (struct dirent* entry = readdir(dirp)) {
+        std::string name = entry->d_name;
+        if (endsWith(name, ".sdp")) names.push_back(name);
+    }
+    closedir(dirp);
+    std::sort(names.begin(), names.end());
+
+    for (auto& name : names) {
+        checkFile(name);
+    }
+    testStaged();
+    testTimeToDispatch();
+    printf("test end, %d failed\n", failed);
+    return failed == 0 ? 0 : 1;
+}
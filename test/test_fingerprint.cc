@@ -0,0 +1,146 @@
+/**
+ * @file test/test_fingerprint.cc
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "mini_sdp.h"
+#include "util.h"
+
+using namespace mini_sdp;
+
+static std::string MakeSdp(const std::string& fingerprint) {
+    return "v=0\r\no=- 1 0 IN IP4 127.0.0.1\r\n"
+           "s=webrtc_core\r\nt=0 0\r\na=group:BUNDLE 0 1\r\n"
+           "m=audio 9 UDP/TLS/RTP/SAVPF 111\r\nc=IN IP4 0.0.0.0\r\n"
+           "a=candidate:foundation 1 udp 100 127.0.0.1 8000 typ srflx raddr 127.0.0.1 rport 8000 generation 0\r\n"
+           "a=ice-ufrag:0_xxxx_d71956d9cc93e4a467b11e06fdaf039a_de71a64097d807c3\r\n"
+           "a=ice-pwd:be8577c0a03b0d3ffa4e5235\r\n"
+           "a=fingerprint:" + fingerprint + "\r\n"
+           "a=setup:passive\r\na=sendrecv\r\na=mid:0\r\n"
+           "a=rtpmap:111 opus/48000/2\r\na=rtcp-fb:111 nack\r\n"
+           "a=ssrc:27172315 cname:webrtccore\r\n"
+           "m=video 9 UDP/TLS/RTP/SAVPF 102\r\nc=IN IP4 0.0.0.0\r\n"
+           "a=ice-ufrag:0_xxxx_d71956d9cc93e4a467b11e06fdaf039a_de71a64097d807c3\r\n"
+           "a=ice-pwd:be8577c0a03b0d3ffa4e5235\r\n"
+           "a=fingerprint:" + fingerprint + "\r\n"
+           "a=setup:passive\r\na=sendrecv\r\na=mid:1\r\n"
+           "a=rtpmap:102 H264/90000\r\na=rtcp-fb:102 nack\r\n"
+           "a=ssrc:10395099 cname:webrtccore\r\n";
+}
+
+static std::string RandomHex(size_t n) {
+    std::string bytes(n, 0);
+    for (size_t i = 0; i < n; i++) bytes[i] = (char)(rand() & 0xFF);
+    std::string hex(n * 3, 0);
+    hex.resize(HexColonEncodeScalar(reinterpret_cast<const uint8_t*>(bytes.data()), n, &hex[0]));
+    return hex;
+}
+
+static int failed = 0;
+
+static void check(bool cond, const char* what) {
+    if (!cond) {
+        printf("FAILED: %s\n", what);
+        failed++;
+    }
+}
+
+static void testKernels() {
+    for (size_t n = 1; n <= 80; n++) {
+        std::string hex = RandomHex(n);
+        uint8_t a[80], b[80];
+        check(HexColonDecode(hex.data(), hex.size(), a, sizeof(a)) == (ssize_t)n, "decode size");
+        check(HexColonDecodeScalar(hex.data(), hex.size(), b, sizeof(b)) == (ssize_t)n, "scalar decode size");
+        check(memcmp(a, b, n) == 0, "decode equal");
+
+        char out[240];
+        size_t out_len = HexColonEncode(a, n, out);
+        check(std::string(out, out_len) == hex, "encode equal");
+
+        // lower case is accepted
+        std::string lower = hex;
+        for (auto& c : lower) c = tolower(c);
+        check(HexColonDecode(lower.data(), lower.size(), b, sizeof(b)) == (ssize_t)n && memcmp(a, b, n) == 0, "lower case");
+
+        // every broken char must be rejected by both kernels
+        for (size_t i = 0; i < hex.size(); i++) {
+            std::string bad = hex;
+            bad[i] = (bad[i] == ':') ? 'A' : 'G';
+            check(HexColonDecode(bad.data(), bad.size(), b, sizeof(b)) < 0, "reject");
+            check(HexColonDecodeScalar(bad.data(), bad.size(), b, sizeof(b)) < 0, "scalar reject");
+        }
+    }
+}
+
+static void testPacket(const char* method, size_t digest_len) {
+    std::string fingerprint = std::string(method) + " " + RandomHex(digest_len);
+
+    OriginSdpAttr attr;
+    attr.origin_sdp = MakeSdp(fingerprint);
+    attr.sdp_type = SdpType::kOffer;
+    attr.stream_url = "webrtc://domain/live/xxxx_d71956d9cc93e4a467b11e06fdaf039a";
+    attr.svrsig = "1h8s";
+
+    char text_buff[1400], compact_buff[1400];
+    ssize_t text_size = ParseOriginSdpToMiniSdp(attr, text_buff, sizeof(text_buff));
+    attr.is_compact_fingerprint = true;
+    ssize_t compact_size = ParseOriginSdpToMiniSdp(attr, compact_buff, sizeof(compact_buff));
+    check(text_size > 0 && compact_size > 0, "pack");
+
+    OriginSdpAttr text_attr, compact_attr;
+    check(LoadMiniSdpToOriginSdp(text_buff, text_size, text_attr) == text_size, "load text");
+    check(LoadMiniSdpToOriginSdp(compact_buff, compact_size, compact_attr) == compact_size, "load compact");
+    check(text_attr.origin_sdp == compact_attr.origin_sdp, "same sdp");
+    check(compact_attr.is_compact_fingerprint && !text_attr.is_compact_fingerprint, "compact flag");
+    check(compact_attr.is_push == kStreamDefault, "direction");
+    check(compact_attr.origin_sdp.find(fingerprint) != std::string::npos, "fingerprint");
+
+    printf("%-8s packet: text %zd bytes, compact %zd bytes, saved %zd bytes\n",
+           method, text_size, compact_size, text_size - compact_size);
+}
+
+template <typename Func>
+static double nsPerOp(int loops, Func&& func) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < loops; i++) func();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / loops;
+}
+
+static void benchKernels() {
+    const int kLoops = 1000000;
+    std::string hex = RandomHex(32);
+    uint8_t digest[32];
+    char out[96];
+    volatile size_t sink = 0;
+
+    double simd_decode = nsPerOp(kLoops, [&] { sink += HexColonDecode(hex.data(), hex.size(), digest, sizeof(digest)); });
+    double scalar_decode = nsPerOp(kLoops, [&] { sink += HexColonDecodeScalar(hex.data(), hex.size(), digest, sizeof(digest)); });
+    double simd_encode = nsPerOp(kLoops, [&] { sink += HexColonEncode(digest, sizeof(digest), out); });
+    double scalar_encode = nsPerOp(kLoops, [&] { sink += HexColonEncodeScalar(digest, sizeof(digest), out); });
+
+    printf("sha-256 decode: simd %.1f ns/op (%.0f MB/s), scalar %.1f ns/op (%.0f MB/s)\n",
+           simd_decode, hex.size() * 1e3 / simd_decode, scalar_decode, hex.size() * 1e3 / scalar_decode);
+    printf("sha-256 encode: simd %.1f ns/op (%.0f MB/s), scalar %.1f ns/op (%.0f MB/s)\n",
+           simd_encode, sizeof(digest) * 1e3 / simd_encode, scalar_encode, sizeof(digest) * 1e3 / scalar_encode);
+}
+
+int main() {
+    printf("test fingerprint\n");
+    testKernels();
+    testPacket("sha-1", 20);
+    testPacket("sha-256", 32);
+    testPacket("sha-384", 48);
+    testPacket("sha-512", 64);
+    benchKernels();
+    printf("test end, %d failed\n", failed);
+    return failed == 0 ? 0 : 1;
+}
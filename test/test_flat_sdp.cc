@@ -0,0 +1,137 @@
+/**
+ * @file test/test_flat_sdp.cc
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include <algorithm>
+#include <cstdio>
+#include <dirent.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "flat_sdp.h"
+#include "mini_sdp.h"
+#include "sdp_parser.h"
+
+using namespace mini_sdp;
+
+#ifndef MINI_SDP_CORPUS_DIR
+#define MINI_SDP_CORPUS_DIR "corpus"
+#endif
+
+static int failed = 0;
+static std::string current;
+
+static void check(bool cond, const std::string& what) {
+    if (!cond) {
+        printf("FAILED: %s: %s\n", current.c_str(), what.c_str());
+        failed++;
+    }
+}
+
+static bool endsWith(const std::string& str, const std::string& suffix) {
+    return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+static std::string readSdp(const std::string& name) {
+    std::ifstream file(std::string(MINI_SDP_CORPUS_DIR) + "/" + name);
+    std::string sdp, line;
+    while (std::getline(file, line)) {
+        if (!line.empty()) sdp += line + "\r\n";
+    }
+    return sdp;
+}
+
+// flat ToString and the round trip give what the graph gives
+static void checkSdp(const std::string& sdp) {
+    SdpParser parser(sdp.data(), sdp.size());
+    check(parser.Parse(), "parse");
+    SessionDescriptionPtr session = parser.GetSessionDescription();
+    std::string expected = session->ToString();
+
+    FlatSessionDescription flat;
+    flat.Assign(*session);
+    check(flat.ToString() == expected, "flat to string");
+    check(flat.ToSessionDescription()->ToString() == expected, "round trip");
+
+    size_t codecs = 0, tracks = 0;
+    for (auto& media : session->Medias) {
+        codecs += media.second->Codecs.size();
+        tracks += media.second->Tracks.size();
+    }
+    check(flat.Medias.size() == session->Medias.size() && flat.Codecs.size() == codecs &&
+          flat.Tracks.size() == tracks, "pool sizes");
+
+    // reused
+    flat.Assign(*session);
+    check(flat.ToString() == expected, "assign again");
+}
+
+static void checkFile(const std::string& name) {
+    current = name;
+    std::string sdp = readSdp(name);
+    checkSdp(sdp);
+
+    // descriptions built by the mini sdp decoder
+    OriginSdpAttr attr;
+    attr.origin_sdp = sdp;
+    attr.sdp_type = endsWith(name, "_answer.sdp") ? SdpType::kAnswer : SdpType::kOffer;
+    attr.stream_url = "webrtc://domain/live/stream";
+    char buff[1400];
+    ssize_t size = ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff));
+    OriginSdpAttr loaded;
+    check(size > 0 && LoadMiniSdpToOriginSdp(buff, size, loaded) == size, "mini sdp");
+    current = name + " loaded";
+    checkSdp(loaded.origin_sdp);
+}
+
+static void testEdges() {
+    current = "edges";
+    std::string ufrag(80, 'u');
+    std::string sdp = "v=0\r\no=- 1 2 IN IP4 127.0.0.1\r\ns=-\r\nt=0 0\r\na=group:BUNDLE 0\r\n"
+                      "m=video 9 UDP/TLS/RTP/SAVPF 96 97\r\nc=IN IP4 0.0.0.0\r\n"
+                      "a=ice-ufrag:" + ufrag + "\r\na=ice-pwd:Lk2X0pWm9sQe4RtYu8IoP3aZ\r\na=mid:0\r\na=sendonly\r\n"
+                      "a=rtpmap:96 VP8/90000\r\n"
+                      "a=rtcp-fb:96 zzz\r\na=rtcp-fb:96 transport-cc\r\na=rtcp-fb:96 nack rpsi\r\n"
+                      "a=rtcp-fb:96 nack pli\r\na=rtcp-fb:96 nack\r\na=rtcp-fb:96 goog-lntf\r\n"
+                      "a=rtcp-fb:96 ccm fir\r\na=rtcp-fb:96 aaa\r\na=rtcp-fb:96 goog-remb\r\na=rtcp-fb:96 nac\r\n"
+                      "a=rtpmap:97 rtx/90000\r\na=fmtp:97 apt=96\r\n"
+                      "a=ssrc-group:FID 2 1\r\na=ssrc:2 cname:b\r\na=ssrc:1 cname:a\r\n"
+                      "m=audio 9 UDP/TLS/RTP/SAVPF 111\r\nc=IN IP4 0.0.0.0\r\na=sendonly\r\n"
+                      "a=rtpmap:111 opus/48000/2\r\n";
+    checkSdp(sdp);
+
+    SdpParser parser(sdp.data(), sdp.size());
+    parser.Parse();
+    FlatSessionDescription flat;
+    flat.Assign(*parser.GetSessionDescription());
+    check(flat.Str(flat.Medias[0].IceUfrag) == ufrag || flat.Str(flat.Medias[1].IceUfrag) == ufrag, "long ufrag");
+    auto& codec = flat.Codecs[flat.Medias[flat.Medias[0].MediaType == SdpMediaType::kVideo ? 0 : 1].Codecs.Begin];
+    check(codec.Feedbacks == (1u << kFlatFbNum) - 1 && codec.ExtraFeedbacks.Size == 5, "feedbacks");
+}
+
+int main() {
+    std::vector<std::string> names;
+    DIR* dirp = opendir(MINI_SDP_CORPUS_DIR);
+    if (!dirp) {
+        printf("open %s failed\n", MINI_SDP_CORPUS_DIR);
+        return 1;
+    }
+    while (struct dirent* entry = readdir(dirp)) {
+        std::string name = entry->d_name;
+        if (endsWith(name, ".sdp")) names.push_back(name);
+    }
+    closedir(dirp);
+    std::sort(names.begin(), names.end());
+
+    for (auto& name : names) {
+        checkFile(name);
+    }
+    testEdges();
+    printf("test end, %d failed\n", failed);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,255 @@
+/**
+ * @file test/test_frag.cc
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "mini_sdp.h"
+#include "mini_sdp_frag.h"
+
+using namespace mini_sdp;
+
+static int failed = 0;
+
+static void check(bool cond, const char* what) {
+    if (!cond) {
+        printf("FAILED: %s\n", what);
+        failed++;
+    }
+}
+
+// an offer with many codecs and a long url, which does not fit in one datagram
+static std::string MakePacket() {
+    std::string sdp =
+        "v=0\r\no=- 1 0 IN IP4 127.0.0.1\r\ns=-\r\nt=0 0\r\na=group:BUNDLE 0 1\r\n"
+        "m=audio 9 UDP/TLS/RTP/SAVPF 111\r\nc=IN IP4 0.0.0.0\r\n"
+        "a=ice-ufrag:Zh1u\r\na=ice-pwd:2P3Ww8ytUu1Sz6NUy1mWOUZr\r\n"
+        "a=fingerprint:sha-256 8A:BD:A6:61:75:AF:31:4C:02:81:2A:FA:12:92:4C:48:7B:9F:23:DD:BF:3D:51:30:"
+        "E7:59:5C:9B:17:3D:92:34\r\n"
+        "a=setup:actpass\r\na=mid:0\r\na=sendrecv\r\na=rtpmap:111 opus/48000/2\r\n"
+        "a=ssrc:3570614608 cname:4TOk42mSjXCkVIa6\r\n"
+        "m=video 9 UDP/TLS/RTP/SAVPF";
+    std::string lines;
+    for (int pt = 40; pt < 100; pt++) {
+        sdp += " " + std::to_string(pt);
+        lines += "a=rtpmap:" + std::to_string(pt) + " H264/90000\r\na=rtcp-fb:" + std::to_string(pt) + " nack\r\n";
+    }
+    sdp += "\r\nc=IN IP4 0.0.0.0\r\na=ice-ufrag:Zh1u\r\na=ice-pwd:2P3Ww8ytUu1Sz6NUy1mWOUZr\r\n"
+           "a=setup:actpass\r\na=mid:1\r\na=sendrecv\r\n" + lines +
+           "a=ssrc:2291961624 cname:4TOk42mSjXCkVIa6\r\n";
+
+    OriginSdpAttr attr;
+    attr.origin_sdp = sdp;
+    attr.sdp_type = SdpType::kOffer;
+    attr.stream_url = "webrtc://domain/live/xxxx_d71956d9cc93e4a467b11e06fdaf039a?txSecret=" + std::string(1000, 'a');
+    attr.svrsig = "1h8s";
+
+    // no drop, only a larger limit
+    PackBudget budget;
+    budget.max_size = 8192;
+    budget.order.clear();
+    std::string packet(budget.max_size, 0);
+    ssize_t size = ParseOriginSdpToMiniSdp(attr, &packet[0], packet.size(), budget);
+    check(size > 1400, "pack large");
+    packet.resize(size > 0 ? size : 0);
+    return packet;
+}
+
+static std::vector<std::string> Split(const std::string& packet, uint32_t msg_id, size_t max_frag_size) {
+    std::vector<std::string> frags(GetMiniSdpFragCount(packet.size(), max_frag_size));
+    for (size_t i = 0; i < frags.size(); i++) {
+        frags[i].resize(max_frag_size);
+        ssize_t size = BuildMiniSdpFragPacket(&frags[i][0], frags[i].size(), packet.data(), packet.size(),
+                                              msg_id, (uint8_t)i, max_frag_size);
+        check(size > 0 && (size_t)size <= max_frag_size && IsMiniSdpFragPack(frags[i].data(), size), "build frag");
+        frags[i].resize(size > 0 ? size : 0);
+    }
+    return frags;
+}
+
+static void testReassemble(const std::string& packet) {
+    auto frags = Split(packet, 7, 1400);
+    check(frags.size() == 2, "frag count");
+
+    MiniSdpReassembler reassembler;
+    std::string out;
+    // out of order with duplicates
+    check(reassembler.Feed(1, frags[1].data(), frags[1].size(), 0, out) == MiniSdpReassembler::FeedResult::kIncomplete, "first");
+    check(reassembler.Feed(1, frags[1].data(), frags[1].size(), 1, out) == MiniSdpReassembler::FeedResult::kDuplicate, "duplicate");
+    // the same msg_id from another source is another message
+    check(reassembler.Feed(2, frags[0].data(), frags[0].size(), 1, out) == MiniSdpReassembler::FeedResult::kIncomplete, "source");
+    check(reassembler.Feed(1, frags[0].data(), frags[0].size(), 2, out) == MiniSdpReassembler::FeedResult::kComplete, "complete");
+    check(out == packet, "same packet");
+    check(reassembler.Feed(1, frags[0].data(), frags[0].size(), 3, out) == MiniSdpReassembler::FeedResult::kDuplicate, "retransmit");
+
+    OriginSdpAttr attr;
+    check(LoadMiniSdpToOriginSdp(out.data(), out.size(), attr) == (ssize_t)out.size(), "load");
+    check(attr.origin_sdp.find("a=rtpmap:99 H264/90000") != std::string::npos, "content");
+
+    // timeout
+    reassembler.Expire(10000);
+    check(reassembler.PendingCount() == 0 && reassembler.MemoryUsage() == 0, "expire");
+    check(reassembler.GetStats().expired == 1, "expired stats");
+
+    // conflicted fragment
+    auto frags2 = Split(packet, 8, 700);
+    check(reassembler.Feed(1, frags2[0].data(), frags2[0].size(), 10000, out) == MiniSdpReassembler::FeedResult::kIncomplete, "conflict 1");
+    auto frags3 = Split(packet.substr(0, 1000), 8, 700);
+    check(reassembler.Feed(1, frags3[1].data(), frags3[1].size(), 10000, out) == MiniSdpReassembler::FeedResult::kWrongFormat, "conflict 2");
+
+    // broken header
+    std::string bad = frags2[1];
+    bad[sizeof(MiniSdpFragHdr) - 2] = (char)0xFF;
+    check(reassembler.Feed(1, bad.data(), bad.size(), 10000, out) == MiniSdpReassembler::FeedResult::kWrongFormat, "bad offset");
+}
+
+static void testMemoryBudget(const std::string& packet) {
+    MiniSdpReassembler reassembler(packet.size() * 3, 3000);
+    std::string out;
+    for (uint32_t msg_id = 0; msg_id < 10; msg_id++) {
+        auto frags = Split(packet, msg_id, 1400);
+        reassembler.Feed(1, frags[0].data(), frags[0].size(), msg_id, out);
+        check(reassembler.MemoryUsage() <= packet.size() * 3, "memory usage");
+    }
+    check(reassembler.PendingCount() == 3 && reassembler.GetStats().evicted == 7, "evicted");
+
+    MiniSdpReassembler small(packet.size() - 1, 3000);
+    auto frags = Split(packet, 1, 1400);
+    check(small.Feed(1, frags[0].data(), frags[0].size(), 0, out) == MiniSdpReassembler::FeedResult::kDropped, "dropped");
+}
+
+// fragments not where BuildMiniSdpFragPacket puts them never complete a message
+static void testLayout(const std::string& packet) {
+    auto frags = Split(packet, 9, 700);
+    check(frags.size() >= 3, "layout frag count");
+    MiniSdpReassembler reassembler;
+    std::string out;
+
+    // offset is not index * chunk
+    std::string shifted = frags[1];
+    MiniSdpFragHdr* hdr = (MiniSdpFragHdr*)&shifted[0];
+    hdr->offset = htons(ntohs(hdr->offset) - 1);
+    check(reassembler.Feed(1, shifted.data(), shifted.size(), 0, out) == MiniSdpReassembler::FeedResult::kWrongFormat, "shifted offset");
+    // the last fragment does not reach the end
+    std::string last = frags.back().substr(0, frags.back().size() - 1);
+    check(reassembler.Feed(1, last.data(), last.size(), 0, out) == MiniSdpReassembler::FeedResult::kWrongFormat, "uncovered end");
+    check(reassembler.Feed(1, frags[0].data(), frags[0].size(), 0, out) == MiniSdpReassembler::FeedResult::kIncomplete, "layout first");
+    // a fragment shorter than the others
+    std::string cut = frags[1].substr(0, frags[1].size() - 1);
+    check(reassembler.Feed(1, cut.data(), cut.size(), 0, out) == MiniSdpReassembler::FeedResult::kWrongFormat, "short fragment");
+    // a fragment of another size
+    auto frags2 = Split(packet, 9, 600);
+    check(frags2.size() == frags.size(), "another chunk count");
+    check(reassembler.Feed(1, frags2[1].data(), frags2[1].size(), 0, out) == MiniSdpReassembler::FeedResult::kWrongFormat, "another chunk");
+
+    MiniSdpReassembler::FeedResult result = MiniSdpReassembler::FeedResult::kIncomplete;
+    for (size_t i = 1; i < frags.size(); i++) {
+        result = reassembler.Feed(1, frags[i].data(), frags[i].size(), 0, out);
+    }
+    check(result == MiniSdpReassembler::FeedResult::kComplete && out == packet, "layout complete");
+}
+
+// records of completed messages are bounded by the memory budget
+static void testCompletedBudget() {
+    std::string msg(100, 's');
+    MiniSdpReassembler reassembler(1000, 3000);
+    std::string out;
+    for (uint32_t msg_id = 0; msg_id < 100; msg_id++) {
+        auto frags = Split(msg, msg_id, 80);
+        reassembler.Feed(1, frags[0].data(), frags[0].size(), msg_id, out);
+        reassembler.Feed(1, frags[1].data(), frags[1].size(), msg_id, out);
+    }
+    check(reassembler.GetStats().completed == 100, "completed");
+    auto frags99 = Split(msg, 99, 80);
+    check(reassembler.Feed(1, frags99[0].data(), frags99[0].size(), 100, out) == MiniSdpReassembler::FeedResult::kDuplicate, "recent record kept");
+    // the record of the oldest is dropped, its retransmit starts a new message
+    auto frags0 = Split(msg, 0, 80);
+    check(reassembler.Feed(1, frags0[0].data(), frags0[0].size(), 100, out) == MiniSdpReassembler::FeedResult::kIncomplete, "oldest record dropped");
+    check(reassembler.Feed(1, frags0[1].data(), frags0[1].size(), 100, out) == MiniSdpReassembler::FeedResult::kComplete, "completed again");
+    // the records of the first completion expire, the second one is kept
+    check(reassembler.Feed(1, frags0[0].data(), frags0[0].size(), 3050, out) == MiniSdpReassembler::FeedResult::kDuplicate, "second record kept");
+}
+
+// every round the sender sends all fragments, the receiver keeps fragments across rounds.
+// no-reuse is the latency if a message only completes with all fragments of the same round.
+static void simulateLoss(const std::string& packet) {
+    const uint32_t kRtoMs = 200;
+    const uint32_t kRounds = 10;
+    const int kTrials = 20000;
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    std::uniform_int_distribution<int> delay(10, 30);
+
+    auto percentile = [](std::vector<uint32_t>& vec, int p) -> uint32_t {
+        if (vec.empty()) return 0;
+        std::sort(vec.begin(), vec.end());
+        return vec[vec.size() * p / 100];
+    };
+
+    printf("%-6s %-6s %-10s %-8s %-8s %-10s %-8s %-8s\n",
+           "frags", "loss", "complete", "p50", "p99", "no-reuse", "p50", "p99");
+    for (size_t max_frag_size : {1400, 700, 400}) {
+        auto frags = Split(packet, 0, max_frag_size);
+        for (double loss : {0.0, 0.05, 0.1, 0.2}) {
+            std::vector<uint32_t> latency, latency_without_reuse;
+            for (int trial = 0; trial < kTrials; trial++) {
+                MiniSdpReassembler reassembler;
+                std::string out;
+                // <arrive_ms, index>
+                std::vector<std::pair<uint32_t, size_t>> arrivals;
+                bool round_done = false;
+                for (uint32_t round = 0; round < kRounds; round++) {
+                    size_t arrived = 0;
+                    uint32_t last_ms = 0;
+                    for (size_t i = 0; i < frags.size(); i++) {
+                        if (uniform(rng) < loss) continue;
+                        uint32_t arrive_ms = round * kRtoMs + delay(rng);
+                        arrivals.emplace_back(arrive_ms, i);
+                        last_ms = std::max(last_ms, arrive_ms);
+                        arrived++;
+                    }
+                    if (arrived == frags.size() && !round_done) {
+                        latency_without_reuse.push_back(last_ms);
+                        round_done = true;
+                    }
+                }
+                std::sort(arrivals.begin(), arrivals.end());
+                for (auto& arrival : arrivals) {
+                    auto& frag = frags[arrival.second];
+                    if (reassembler.Feed(1, frag.data(), frag.size(), arrival.first, out) ==
+                        MiniSdpReassembler::FeedResult::kComplete) {
+                        latency.push_back(arrival.first);
+                        break;
+                    }
+                }
+            }
+            printf("%-6zu %-6.2f %-10.4f %-8u %-8u %-10.4f %-8u %-8u\n", frags.size(), loss,
+                   (double)latency.size() / kTrials, percentile(latency, 50), percentile(latency, 99),
+                   (double)latency_without_reuse.size() / kTrials, percentile(latency_without_reuse, 50),
+                   percentile(latency_without_reuse, 99));
+            if (loss == 0.0) check(latency.size() == (size_t)kTrials, "no loss");
+        }
+    }
+}
+
+int main() {
+    printf("test frag\n");
+    std::string packet = MakePacket();
+    printf("packet size %zu\n", packet.size());
+    testReassemble(packet);
+    testMemoryBudget(packet);
+    testLayout(packet);
+    testCompletedBudget();
+    simulateLoss(packet);
+    printf("test end, %d failed\n", failed);
+    return failed == 0 ? 0 : 1;
+}
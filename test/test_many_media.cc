@@ -0,0 +1,180 @@
+/**
+ * @file test/test_many_media.cc
+ * @brief sdp with many m-lines, and several medias of a type in mini sdp
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "flat_sdp.h"
+#include "mini_sdp.h"
+#include "sdp_parser.h"
+
+using namespace mini_sdp;
+
+static int failed = 0;
+static std::string current;
+
+static void check(bool cond, const std::string& what) {
+    if (!cond) {
+        printf("FAILED: %s: %s\n", current.c_str(), what.c_str());
+        failed++;
+    }
+}
+
+static const char* kFingerprint =
+    "a=fingerprint:sha-256 8A:BD:A6:61:75:AF:31:4C:02:81:2A:FA:12:92:4C:48:7B:9F:23:DD:BF:3D:51:30:"
+    "E7:59:5C:9B:17:3D:92:34\r\n";
+
+struct MediaSpec {
+    std::string             mid;    // no a=mid if empty
+    bool                    is_audio;
+    std::vector<uint32_t>   ssrcs;
+};
+
+static std::string makeSdp(const std::string& bundle, const std::vector<MediaSpec>& medias) {
+    std::string sdp = "v=0\r\no=- 1 0 IN IP4 127.0.0.1\r\ns=-\r\nt=0 0\r\na=group:BUNDLE" + bundle + "\r\n";
+    for (auto& media : medias) {
+        sdp += media.is_audio ? "m=audio 9 UDP/TLS/RTP/SAVPF 111\r\n" : "m=video 9 UDP/TLS/RTP/SAVPF 96\r\n";
+        sdp += "c=IN IP4 0.0.0.0\r\na=ice-ufrag:Zh1u\r\na=ice-pwd:2P3Ww8ytUu1Sz6NUy1mWOUZr\r\n";
+        sdp += kFingerprint;
+        sdp += "a=setup:actpass\r\n";
+        if (!media.mid.empty()) sdp += "a=mid:" + media.mid + "\r\n";
+        sdp += "a=sendonly\r\na=rtcp-mux\r\n";
+        sdp += media.is_audio ? "a=rtpmap:111 opus/48000/2\r\n" : "a=rtpmap:96 H264/90000\r\na=rtcp-fb:96 nack\r\n";
+        if (media.ssrcs.size() > 1) {
+            sdp += "a=ssrc-group:SIM";
+            for (uint32_t ssrc : media.ssrcs) sdp += " " + std::to_string(ssrc);
+            sdp += "\r\n";
+        }
+        for (uint32_t ssrc : media.ssrcs) sdp += "a=ssrc:" + std::to_string(ssrc) + " cname:4TOk42mSjXCkVIa6\r\n";
+    }
+    return sdp;
+}
+
+static SessionDescriptionPtr parse(const std::string& sdp) {
+    SdpParser parser(sdp.data(), sdp.size());
+    check(parser.Parse(), "parse " + parser.FormatError());
+    return parser.GetSessionDescription();
+}
+
+static std::string flatString(const SessionDescription& session) {
+    FlatSessionDescription flat;
+    flat.Assign(session);
+    return flat.ToString();
+}
+
+// the bundle order with duplicated and unknown mids, the others in key order
+static void testManyMedias() {
+    current = "many medias";
+    const int kMediaNum = 1000;
+    std::vector<MediaSpec> medias;
+    std::string bundle;
+    for (int i = 0; i < kMediaNum; i++) {
+        medias.push_back({std::to_string(i), i % 2 == 0, {uint32_t(10000 + i)}});
+        // the bundle leaves out every tenth media, from the last to the first
+        if (i % 10 != 0) bundle = " " + std::to_string(i) + bundle;
+    }
+    bundle += " 999 unknown";
+    SessionDescriptionPtr session = parse(makeSdp(bundle, medias));
+    check(session->Medias.size() == size_t(kMediaNum), "media num");
+
+    std::string sdp = session->ToString();
+    check(sdp.find("a=mid:999\r\n") < sdp.find("a=mid:998\r\n"), "bundle order");
+    check(sdp.find("a=mid:1\r\n") < sdp.find("a=mid:0\r\n"), "the others after the bundle");
+    check(sdp.find("a=mid:0\r\n") < sdp.find("a=mid:10\r\n"), "the others in key order");
+    size_t count = 0;
+    for (size_t pos = sdp.find("m="); pos != std::string::npos; pos = sdp.find("m=", pos + 1)) count++;
+    check(count == size_t(kMediaNum) + 1, "duplicated bundle mid");  // 999 is rendered twice, as before
+    check(flatString(*session) == sdp, "flat");
+
+    current = "no mid";
+    std::vector<MediaSpec> no_mids(kMediaNum, MediaSpec{"", false, {}});
+    no_mids[0].mid = "3";
+    session = parse(makeSdp(" 3", no_mids));
+    check(session->Medias.size() == size_t(kMediaNum), "media num");
+    // the numbers skip the mid taken
+    check(session->Medias.count("0") && session->Medias.count("999") && !session->Medias.count("1000"), "keys");
+    check(flatString(*session) == session->ToString(), "flat");
+}
+
+// the medias of a sdp by type and ssrcs, order ignored
+static std::vector<std::pair<bool, std::vector<uint32_t>>> mediaKeys(const SessionDescription& session) {
+    std::vector<std::pair<bool, std::vector<uint32_t>>> keys;
+    for (auto& media : session.Medias) {
+        keys.emplace_back(media.second->MediaType == SdpMediaType::kAudio, media.second->TracksOrder);
+    }
+    std::sort(keys.begin(), keys.end());
+    return keys;
+}
+
+static void testSameType() {
+    const std::vector<MediaSpec> medias = {
+        {"0", true, {100}},
+        {"1", false, {200, 201, 202}},
+        {"2", false, {300}},
+        {"3", true, {400}},
+        {"4", false, {500, 501}},
+    };
+    const std::vector<MediaSpec> string_mids = {
+        {"audio", true, {100}},
+        {"video", false, {200, 201, 202}},
+        {"video2", false, {300}},
+    };
+    struct Case {
+        std::string             name;
+        std::string             bundle;
+        std::vector<MediaSpec>  medias;
+    };
+    const Case cases[] = {
+        {"numeric mids", " 0 1 2 3 4", medias},
+        {"string mids", " audio video video2", string_mids},
+    };
+    for (auto& c : cases) {
+        for (uint8_t version = 0; version < 2; version++) {
+            current = c.name + " v" + std::to_string(version);
+            OriginSdpAttr attr;
+            attr.origin_sdp = makeSdp(c.bundle, c.medias);
+            attr.sdp_type = SdpType::kOffer;
+            attr.stream_url = "webrtc://domain/live/stream";
+            attr.is_compact_fingerprint = true;
+            attr.version = version;
+            char buff[1400];
+            ssize_t size = ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff));
+            check(size > 0, "pack");
+            if (size <= 0) continue;
+
+            OriginSdpAttr loaded;
+            check(LoadMiniSdpToOriginSdp(buff, size, loaded) == size, "load");
+            SessionDescriptionPtr origin = parse(attr.origin_sdp);
+            SessionDescriptionPtr session = parse(loaded.origin_sdp);
+            check(mediaKeys(*session) == mediaKeys(*origin), "medias");
+            check(session->GroupBundle.size() == c.medias.size(), "bundle");
+
+            MiniSdpDispatchInfo info;
+            check(PeekMiniSdp(buff, size, info) > 0 && info.medias.size() == c.medias.size(), "peek");
+            std::vector<std::pair<bool, std::vector<uint32_t>>> keys;
+            for (auto& media : info.medias) keys.emplace_back(media.media_type == SdpMediaType::kAudio, media.ssrcs);
+            std::sort(keys.begin(), keys.end());
+            check(keys == mediaKeys(*origin), "peek medias");
+
+            // the extra media section is checked, in the tail of v0
+            for (ssize_t len = size - 1; version == 0 && len > size - 16; len--) {
+                check(PeekMiniSdp(buff, len, info) <= 0, "peek truncated " + std::to_string(len));
+                check(LoadMiniSdpToOriginSdp(buff, len, loaded) <= 0, "load truncated " + std::to_string(len));
+            }
+        }
+    }
+}
+
+int main() {
+    testManyMedias();
+    testSameType();
+    printf("test end, %d failed\n", failed);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,198 @@
+/**
+ * @file test/test_metrics.cc
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "metrics.h"
+#include "mini_sdp.h"
+#include "mini_sdp_c.h"
+
+using namespace mini_sdp;
+
+#ifndef MINI_SDP_CORPUS_DIR
+#define MINI_SDP_CORPUS_DIR "corpus"
+#endif
+
+static int failed = 0;
+
+static void check(bool cond, const char* what) {
+    if (!cond) {
+        printf("FAILED: %s\n", what);
+        failed++;
+    }
+}
+
+static std::string readSdp(const std::string& name) {
+    std::ifstream file(std::string(MINI_SDP_CORPUS_DIR) + "/" + name);
+    std::string sdp, line;
+    while (std::getline(file, line)) {
+        if (!line.empty()) sdp += line + "\r\n";
+    }
+    return sdp;
+}
+
+static OriginSdpAttr makeAttr(const std::string& name, SdpType sdp_type) {
+    OriginSdpAttr attr;
+    attr.origin_sdp = readSdp(name);
+    attr.sdp_type = sdp_type;
+    attr.stream_url = "webrtc://domain/live/stream";
+    attr.svrsig = "127.0.0.1:ufrag:svrsig";
+    attr.seq = 7;
+    return attr;
+}
+
+static void testBuckets() {
+    check(PackedSizeBucket(0) == 0 && PackedSizeBucket(200) == 0 && PackedSizeBucket(201) == 1, "first bucket");
+    check(PackedSizeBucket(1400) == kPackedSizeBucketNum - 2, "limit bucket");
+    check(PackedSizeBucket(1401) == kPackedSizeBucketNum - 1, "over limit bucket");
+    check(StatusCodeSlot(kStatCodeSuccess) == 0 && StatusCodeSlot(kStatCodeNotFound) == 5, "status slot");
+    check(StatusCodeSlot(999) == kStatusCodeSlots - 1, "unknown status slot");
+}
+
+static void testSignaling() {
+    auto before = GetSignalingMetricsSnapshot();
+
+    char offer[1400], answer[1400], stop[256];
+    OriginSdpAttr offer_attr = makeAttr("obs_whip_offer.sdp", SdpType::kOffer);
+    ssize_t offer_size = ParseOriginSdpToMiniSdp(offer_attr, offer, sizeof(offer));
+    OriginSdpAttr answer_attr = makeAttr("server_answer.sdp", SdpType::kAnswer);
+    answer_attr.status_code = kStatCodeAuthError;
+    ssize_t answer_size = ParseOriginSdpToMiniSdp(answer_attr, answer, sizeof(answer));
+    check(offer_size > 0 && answer_size > 0, "pack");
+
+    // a request retransmitted once, a new request with another seq
+    OriginSdpAttr loaded;
+    LoadMiniSdpToOriginSdp(offer, offer_size, loaded);
+    LoadMiniSdpToOriginSdp(offer, offer_size, loaded);
+    offer_attr.seq = 8;
+    offer_size = ParseOriginSdpToMiniSdp(offer_attr, offer, sizeof(offer));
+    LoadMiniSdpToOriginSdp(offer, offer_size, loaded);
+    LoadMiniSdpToOriginSdp(answer, answer_size, loaded);
+
+    StopStreamAttr stop_attr;
+    stop_attr.svrsig = answer_attr.svrsig;
+    ssize_t stop_size = BuildStopStreamPacket(stop, sizeof(stop), stop_attr);
+    LoadStopStreamPacket(stop, stop_size, stop_attr);
+    LoadStopStreamPacket(stop, stop_size, stop_attr);
+
+    // failures
+    check(LoadMiniSdpToOriginSdp(offer, 3, loaded) == kSdpRetSizeExceeded, "short packet");
+    check(LoadStopStreamPacket(offer, offer_size, stop_attr) == kSdpRetWrongFormat, "not a stop packet");
+    OriginSdpAttr long_url = offer_attr;
+    long_url.stream_url.assign(2000, 'a');
+    check(ParseOriginSdpToMiniSdp(long_url, offer, sizeof(offer)) == kSdpRetUrlExceeded, "url exceeded");
+
+    auto after = GetSignalingMetricsSnapshot();
+    check(after.request_packets - before.request_packets == 3, "requests");
+    check(after.stop_packets - before.stop_packets == 2, "stop packets");
+    check(after.duplicate_seq - before.duplicate_seq == 2, "duplicate seq");
+    check(after.decode_failures[SdpRetcodeSlot(kSdpRetSizeExceeded)] -
+          before.decode_failures[SdpRetcodeSlot(kSdpRetSizeExceeded)] == 1, "decode size exceeded");
+    check(after.decode_failures[SdpRetcodeSlot(kSdpRetWrongFormat)] -
+          before.decode_failures[SdpRetcodeSlot(kSdpRetWrongFormat)] == 1, "decode wrong format");
+    check(after.encode_failures[SdpRetcodeSlot(kSdpRetUrlExceeded)] -
+          before.encode_failures[SdpRetcodeSlot(kSdpRetUrlExceeded)] == 1, "encode url exceeded");
+    size_t auth = StatusCodeSlot(kStatCodeAuthError);
+    check(after.answers_packed[auth] - before.answers_packed[auth] == 1, "answers packed");
+    check(after.answers_loaded[auth] - before.answers_loaded[auth] == 1, "answers loaded");
+    uint64_t packed = 0;
+    for (size_t i = 0; i < kPackedSizeBucketNum; i++) packed += after.packed_size[i] - before.packed_size[i];
+    check(packed == 3, "packed size count");
+    check(after.packed_size[PackedSizeBucket(answer_size)] > before.packed_size[PackedSizeBucket(answer_size)],
+          "packed size bucket");
+
+    // disabled at runtime
+    SetSignalingMetricsEnabled(false);
+    LoadStopStreamPacket(stop, stop_size, stop_attr);
+    check(GetSignalingMetricsSnapshot().stop_packets == after.stop_packets, "disabled");
+    SetSignalingMetricsEnabled(true);
+}
+
+// the required size of the C interface is not a second request
+static void testCApiRequired() {
+    OriginSdpAttr attr = makeAttr("obs_whip_offer.sdp", SdpType::kOffer);
+    minisdp_attr c_attr;
+    minisdp_attr_init(&c_attr);
+    c_attr.origin_sdp = minisdp_str{attr.origin_sdp.data(), attr.origin_sdp.size()};
+    c_attr.stream_url = minisdp_str{attr.stream_url.data(), attr.stream_url.size()};
+    c_attr.svrsig = minisdp_str{attr.svrsig.data(), attr.svrsig.size()};
+
+    auto before = GetSignalingMetricsSnapshot();
+    char small[16];
+    size_t required = 0;
+    check(minisdp_pack(&c_attr, small, sizeof(small), &required) == kSdpRetSizeExceeded && required > 0,
+          "c api required");
+    auto after = GetSignalingMetricsSnapshot();
+    check(after.encode_failures[SdpRetcodeSlot(kSdpRetSizeExceeded)] -
+          before.encode_failures[SdpRetcodeSlot(kSdpRetSizeExceeded)] == 1, "c api encode size exceeded");
+    uint64_t packed = 0;
+    for (size_t i = 0; i < kPackedSizeBucketNum; i++) packed += after.packed_size[i] - before.packed_size[i];
+    check(packed == 0, "c api packed size count");
+}
+
+// stats of exited threads are kept
+static void testThreads() {
+    OriginSdpAttr attr = makeAttr("obs_whip_offer.sdp", SdpType::kOffer);
+    char buff[1400];
+    ssize_t size = ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff));
+
+    const int kThreads = 4, kLoops = 100;
+    auto before = GetSignalingMetricsSnapshot();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kThreads; i++) {
+        threads.emplace_back([&] {
+            OriginSdpAttr loaded;
+            for (int j = 0; j < kLoops; j++) LoadMiniSdpToOriginSdp(buff, size, loaded);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    auto after = GetSignalingMetricsSnapshot();
+    check(after.request_packets - before.request_packets == kThreads * kLoops, "threads requests");
+    check(after.duplicate_seq - before.duplicate_seq == kThreads * (kLoops - 1), "threads duplicate seq");
+}
+
+static void testRender() {
+    std::vector<char> text(64 * 1024);
+    ssize_t size = RenderPrometheusMetrics(text.data(), text.size());
+    check(size > 0 && strlen(text.data()) == size_t(size), "render");
+    std::string exposition(text.data(), size > 0 ? size : 0);
+    const char* expected[] = {
+        "# TYPE minisdp_request_packets_received_total counter\n",
+        "minisdp_decode_failures_total{reason=\"size_exceeded\"} ",
+        "minisdp_answers_total{op=\"pack\",status=\"auth_error\"} ",
+        "minisdp_packed_size_bytes_bucket{le=\"1400\"} ",
+        "minisdp_packed_size_bytes_bucket{le=\"+Inf\"} ",
+        "minisdp_duplicate_seq_total ",
+#if MINI_SDP_STAGE_STATS
+        "minisdp_stage_latency_seconds{stage=\"pack\",quantile=\"0.99\"} ",
+        "minisdp_stage_latency_seconds_count{stage=\"load\"} ",
+#endif
+    };
+    for (auto line : expected) {
+        check(exposition.find(line) != std::string::npos, line);
+    }
+    check(exposition.back() == '\n', "render ends with newline");
+    check(RenderPrometheusMetrics(text.data(), size - 1) == kSdpRetSizeExceeded, "render size exceeded");
+    check(RenderPrometheusMetrics(text.data(), size) == size, "render exact size");
+    printf("%s", exposition.c_str());
+}
+
+int main() {
+    testBuckets();
+    testSignaling();
+    testCApiRequired();
+    testThreads();
+    testRender();
+    printf("test end, %d failed\n", failed);
+    return failed == 0 ? 0 : 1;
+}
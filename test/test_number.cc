@@ -0,0 +1,181 @@
+/**
+ * @file test/test_number.cc
+ * @brief numbers of sdp lines and fmtp values: malformed ones are rejected without exceptions
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <vector>
+#include "mini_sdp.h"
+#include "sdp_parser.h"
+#include "util.h"
+
+using namespace mini_sdp;
+
+static int failed = 0;
+static std::string current;
+
+static void check(bool cond, const std::string& what) {
+    if (!cond) {
+        printf("FAILED: %s: %s\n", current.c_str(), what.c_str());
+        failed++;
+    }
+}
+
+static const std::string kSdp =
+    "v=0\r\no=- 1 0 IN IP4 127.0.0.1\r\ns=-\r\nt=0 0\r\na=group:BUNDLE 0\r\n"
+    "m=video 9 UDP/TLS/RTP/SAVPF 96 124\r\n"
+    "c=IN IP4 0.0.0.0\r\n"
+    "a=candidate:foundation 1 udp 100 127.0.0.1 8000 typ host generation 0\r\n"
+    "a=ice-ufrag:Zh1u\r\na=ice-pwd:2P3Ww8ytUu1Sz6NUy1mWOUZr\r\n"
+    "a=fingerprint:sha-256 8A:BD:A6:61:75:AF:31:4C:02:81:2A:FA:12:92:4C:48:7B:9F:23:DD:BF:3D:51:30:"
+    "E7:59:5C:9B:17:3D:92:34\r\n"
+    "a=setup:actpass\r\na=mid:0\r\n"
+    "a=extmap:3 http://www.ietf.org/id/draft-holmer-rmcat-transport-wide-cc-extensions-01\r\n"
+    "a=sendonly\r\na=rtcp-mux\r\n"
+    "a=rtpmap:96 H264/90000\r\na=rtcp-fb:96 nack\r\n"
+    "a=fmtp:96 bframe-enabled=1;packetization-mode=1\r\n"
+    "a=rtpmap:124 flexfec-03/90000\r\n"
+    "a=ssrc-group:FEC-FR 2291961624 1366387413\r\n"
+    "a=ssrc:2291961624 cname:4TOk42mSjXCkVIa6\r\na=ssrc:1366387413 cname:4TOk42mSjXCkVIa6\r\n";
+
+static std::string replaced(const std::string& from, const std::string& to) {
+    std::string sdp = kSdp;
+    size_t pos = sdp.find(from);
+    check(pos != std::string::npos, "no " + from);
+    if (pos != std::string::npos) sdp.replace(pos, from.size(), to);
+    return sdp;
+}
+
+// kSuccess if parsed
+static SdpParser::StatCode parse(const std::string& sdp) {
+    SdpParser parser(sdp.data(), sdp.size());
+    try {
+        if (parser.Parse()) return SdpParser::StatCode::kSuccess;
+    } catch (...) {
+        check(false, "exception");
+    }
+    return parser.GetError().code;
+}
+
+static void testParseUint() {
+    current = "StrParseUint";
+    struct Case {
+        std::string str;
+        uint64_t    max;
+        bool        ok;
+        uint64_t    value;
+        size_t      parsed;
+    };
+    const uint64_t u64_max = std::numeric_limits<uint64_t>::max();
+    std::vector<Case> cases = {
+        {"0", 255, true, 0, 1},
+        {"255", 255, true, 255, 3},
+        {"256", 255, false, 0, 0},
+        {"00096", 255, true, 96, 5},
+        {"96abc", 255, true, 96, 2},
+        {"1/sendrecv", 255, true, 1, 1},
+        {"4294967295", std::numeric_limits<uint32_t>::max(), true, 4294967295u, 10},
+        {"4294967296", std::numeric_limits<uint32_t>::max(), false, 0, 0},
+        {"18446744073709551615", u64_max, true, u64_max, 20},
+        {"18446744073709551616", u64_max, false, 0, 0},
+        {"99999999999999999999999", u64_max, false, 0, 0},
+        {"", 255, false, 0, 0},
+        {"-1", 255, false, 0, 0},
+        {"+1", 255, false, 0, 0},
+        {" 1", 255, false, 0, 0},
+        {"*", 255, false, 0, 0},
+    };
+    for (auto& c : cases) {
+        uint64_t value = 7;
+        const char* end = StrParseUint(c.str.data(), c.str.size(), c.max, value);
+        check((end != nullptr) == c.ok, "'" + c.str + "' result");
+        if (c.ok) {
+            check(value == c.value && end == c.str.data() + c.parsed, "'" + c.str + "' value");
+        } else {
+            check(value == 7, "'" + c.str + "' value changed");
+        }
+    }
+
+    // only [data, data + len) is read
+    uint64_t value = 0;
+    check(StrToUint("1234", 2, 255, value) && value == 12, "bounded");
+    check(!StrToUint("96abc", 5, 255, value) && value == 12, "trailing chars");
+}
+
+static void testParser() {
+    current = "parser";
+    check(parse(kSdp) == SdpParser::StatCode::kSuccess, "valid");
+    check(parse(replaced("m=video 9 ", "m=video 9/2 ")) == SdpParser::StatCode::kSuccess, "number of ports");
+    check(parse(replaced("a=extmap:3 ", "a=extmap:3/sendonly ")) == SdpParser::StatCode::kSuccess,
+          "extmap direction");
+
+    const std::vector<std::pair<std::string, std::string>> malformed = {
+        {"m=video 9 ", "m=video x "},
+        {"m=video 9 ", "m=video 65536 "},
+        {"m=video 9 ", "m=video 9x "},
+        {"a=extmap:3 ", "a=extmap:256 "},
+        {"a=extmap:3 ", "a=extmap:3x "},
+        {"a=rtpmap:96 H264/90000", "a=rtpmap:96x H264/90000"},
+        {"a=rtpmap:96 H264/90000", "a=rtpmap:96 H264/90k"},
+        {"a=rtpmap:96 H264/90000", "a=rtpmap:96 H264/90000/-1"},
+        {"a=rtcp-fb:96 nack", "a=rtcp-fb:* nack"},
+        {"a=rtcp-fb:96 nack", "a=rtcp-fb:99999999999999999999 nack"},
+        {"a=fmtp:96 ", "a=fmtp:-96 "},
+        {"a=ssrc:2291961624 ", "a=ssrc:-2291961624 "},
+        {"a=ssrc:2291961624 ", "a=ssrc:4294967296 "},
+        {"FEC-FR 2291961624", "FEC-FR 0x88"},
+        {"FEC-FR 2291961624", "FEC-FR 0"},
+        {"127.0.0.1 8000 ", "127.0.0.1 80000 "},
+    };
+    for (auto& line : malformed) {
+        current = line.second;
+        check(parse(replaced(line.first, line.second)) == SdpParser::StatCode::kParamError, "param error");
+    }
+}
+
+static void testFmtp() {
+    current = "fmtp";
+    OriginSdpAttr attr;
+    attr.origin_sdp = kSdp;
+    attr.sdp_type = SdpType::kOffer;
+    attr.stream_url = "webrtc://domain/live/stream";
+    attr.is_compact_fingerprint = true;
+
+    // a value which is not a number is taken as not set
+    OriginSdpAttr garbage = attr;
+    garbage.origin_sdp = replaced("bframe-enabled=1", "bframe-enabled=on");
+    OriginSdpAttr unset = attr;
+    unset.origin_sdp = replaced("bframe-enabled=1", "bframe-enabled=0");
+    for (uint8_t version = 0; version < 2; version++) {
+        garbage.version = unset.version = version;
+        char buff[1400], expected[1400];
+        ssize_t size = 0, expected_size = 0;
+        try {
+            size = ParseOriginSdpToMiniSdp(garbage, buff, sizeof(buff));
+            expected_size = ParseOriginSdpToMiniSdp(unset, expected, sizeof(expected));
+        } catch (...) {
+            check(false, "exception");
+        }
+        if (version == 0) {
+            check(size > 0 && size == expected_size && std::string(buff, size) == std::string(expected, size),
+                  "v0 packed as 0");
+        } else {
+            // v1 flags are set by any value other than 0
+            check(size > 0, "v1 packed");
+        }
+    }
+}
+
+int main() {
+    testParseUint();
+    testParser();
+    testFmtp();
+    printf("test end, %d failed\n", failed);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,138 @@
+/**
+ * @file test/test_parse_error.cc
+ * @brief error record of SdpParser and the retcodes of ParseOriginSdpToMiniSdp
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include <cstdio>
+#include <string>
+#include "alloc_stats.h"
+#include "mini_sdp.h"
+#include "sdp_parser.h"
+
+using namespace mini_sdp;
+
+static int failed = 0;
+static std::string current;
+
+static void check(bool cond, const std::string& what) {
+    if (!cond) {
+        printf("FAILED: %s: %s\n", current.c_str(), what.c_str());
+        failed++;
+    }
+}
+
+static const std::string kHead = "v=0\r\no=- 1 0 IN IP4 127.0.0.1\r\ns=-\r\nt=0 0\r\na=group:BUNDLE 0\r\n";
+static const std::string kMedia =
+    "m=audio 9 UDP/TLS/RTP/SAVPF 111\r\n"
+    "c=IN IP4 0.0.0.0\r\n"
+    "a=ice-ufrag:Zh1u\r\na=ice-pwd:2P3Ww8ytUu1Sz6NUy1mWOUZr\r\n"
+    "a=fingerprint:sha-256 8A:BD:A6:61:75:AF:31:4C:02:81:2A:FA:12:92:4C:48:7B:9F:23:DD:BF:3D:51:30:"
+    "E7:59:5C:9B:17:3D:92:34\r\n"
+    "a=setup:actpass\r\na=mid:0\r\na=sendonly\r\n"
+    "a=rtpmap:111 opus/48000/2\r\n";
+
+struct ErrorCase {
+    std::string             name;
+    std::string             line;       // appended to kHead + kMedia
+    SdpParser::StatCode     code;
+    const char*             reason;
+    SdpAttrId               attr;
+    ssize_t                 retcode;
+};
+
+static void testErrors() {
+    const ErrorCase cases[] = {
+        {"unknown line", "x=bad", SdpParser::StatCode::kUnknownLine, "unknown line", SdpAttrId::kNone,
+         kSdpRetSdpUnknownLine},
+        {"media format", "m=video 9", SdpParser::StatCode::kFormatError, "format error", SdpAttrId::kNone,
+         kSdpRetWrongFormat},
+        {"media port", "m=video 70000 UDP/TLS/RTP/SAVPF 96", SdpParser::StatCode::kParamError, "port error",
+         SdpAttrId::kNone, kSdpRetSdpParamError},
+        {"rtcp-fb", "a=rtcp-fb:* nack", SdpParser::StatCode::kParamError, "param error", SdpAttrId::kRtcpFb,
+         kSdpRetSdpParamError},
+        {"setup", "a=setup:unknown", SdpParser::StatCode::kParamError, "param error", SdpAttrId::kSetup,
+         kSdpRetSdpParamError},
+        {"ssrc-group", "a=ssrc-group:FID 1 x", SdpParser::StatCode::kParamError, "param error",
+         SdpAttrId::kSsrcGroup, kSdpRetSdpParamError},
+    };
+    for (auto& c : cases) {
+        current = c.name;
+        std::string sdp = kHead + kMedia + c.line + "\r\na=rtcp-mux\r\n";
+        SdpParser parser(sdp.data(), sdp.size());
+        check(!parser.Parse(), "parsed");
+
+        auto& error = parser.GetError();
+        size_t offset = kHead.size() + kMedia.size();
+        size_t line = 0;
+        for (size_t i = 0; i < offset; i++) line += sdp[i] == '\n' ? 1 : 0;
+        check(error.code == c.code, "code");
+        check(std::string(error.reason) == c.reason, "reason");
+        check(error.line == line + 1 && error.offset == offset && error.length == c.line.size(), "position");
+        check(error.attr == c.attr, "attr");
+
+        std::string expected = std::string(c.reason) + ", line " + std::to_string(line + 1) + ", offset " +
+                               std::to_string(offset);
+        if (c.attr != SdpAttrId::kNone) expected += std::string(", a=") + SdpAttrName(c.attr);
+        expected += ": " + c.line;
+        check(parser.FormatError() == expected, "text " + parser.FormatError());
+
+        OriginSdpAttr attr;
+        attr.origin_sdp = sdp;
+        attr.sdp_type = SdpType::kOffer;
+        attr.stream_url = "webrtc://domain/live/stream";
+        char buff[1400];
+        check(ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff)) == c.retcode, "retcode");
+        PackBudget budget;
+        check(ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff), budget, nullptr) == c.retcode, "budget retcode");
+    }
+
+    current = "success";
+    std::string sdp = kHead + kMedia;
+    SdpParser parser(sdp.data(), sdp.size());
+    check(!parser.IsParsed(), "not parsed");
+    check(parser.Parse() && parser.IsSucess() && parser.GetError().line == 0, "parsed");
+    check(parser.FormatError().empty(), "no text");
+
+    current = "version";
+    OriginSdpAttr attr;
+    attr.origin_sdp = sdp;
+    attr.sdp_type = SdpType::kOffer;
+    attr.stream_url = "webrtc://domain/live/stream";
+    attr.version = 9;
+    char buff[1400];
+    check(ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff)) == kSdpRetVersionUnsupported, "retcode");
+}
+
+static uint64_t parseAllocs(const std::string& sdp) {
+    AllocScope scope;
+    SdpParser parser(sdp.data(), sdp.size());
+    parser.Parse();
+    return scope.Allocs();
+}
+
+// the error is recorded without allocating, the same as stopping before the line
+static void testNoAlloc() {
+    current = "no alloc";
+    if (!IsAllocHooked()) return;
+    const std::string lines[] = {
+        "x=bad",
+        "m=video 70000 UDP/TLS/RTP/SAVPF 96",
+        "a=rtcp-fb:* nack",
+        "a=setup:unknown",
+    };
+    uint64_t stopped = parseAllocs(kHead + kMedia + "x=stop\r\n");
+    for (auto& line : lines) {
+        check(parseAllocs(kHead + kMedia + line + "\r\n") <= stopped, line);
+    }
+}
+
+int main() {
+    testErrors();
+    testNoAlloc();
+    printf("test end, %d failed\n", failed);
+    return failed == 0 ? 0 : 1;
+}
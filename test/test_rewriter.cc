@@ -0,0 +1,170 @@
+/**
+ * @file test/test_rewriter.cc
+ * @brief rules of SdpRewriter on sdp text
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include <cstdio>
+#include <string>
+#include "alloc_stats.h"
+#include "sdp_parser.h"
+#include "sdp_rewriter.h"
+
+using namespace mini_sdp;
+
+static int failed = 0;
+static std::string current;
+
+static void check(bool cond, const std::string& what) {
+    if (!cond) {
+        printf("FAILED: %s: %s\n", current.c_str(), what.c_str());
+        failed++;
+    }
+}
+
+static const std::string kSession = "v=0\r\no=- 1 0 IN IP4 127.0.0.1\r\ns=-\r\nt=0 0\r\na=group:BUNDLE 0 1\r\n";
+static const std::string kAudio =
+    "m=audio 9 UDP/TLS/RTP/SAVPF 111\r\n"
+    "c=IN IP4 0.0.0.0\r\n"
+    "a=candidate:foundation 1 udp 100 10.0.0.1 8000 typ host generation 0\r\n"
+    "a=candidate:foundation 1 udp 90 192.168.0.1 8001 typ host generation 0\r\n"
+    "a=mid:0\r\n"
+    "a=extmap:3 http://www.ietf.org/id/draft-holmer-rmcat-transport-wide-cc-extensions-01\r\n"
+    "a=sendrecv\r\n"
+    "a=rtpmap:111 opus/48000/2\r\na=rtcp-fb:111 transport-cc\r\na=fmtp:111 minptime=10;useinbandfec=1\r\n";
+static const std::string kVideo =
+    "m=video 9 UDP/TLS/RTP/SAVPF 96 97 102 103 124\r\n"
+    "c=IN IP4 0.0.0.0\r\n"
+    "a=mid:1\r\n"
+    "a=extmap:3 http://www.ietf.org/id/draft-holmer-rmcat-transport-wide-cc-extensions-01\r\n"
+    "a=extmap:12 http://www.webrtc.org/experiments/rtp-hdrext/playout-delay\r\n"
+    "a=sendrecv\r\n"
+    "a=rtpmap:96 VP8/90000\r\na=rtcp-fb:96 nack\r\n"
+    "a=rtpmap:97 rtx/90000\r\na=fmtp:97 apt=96\r\n"
+    "a=rtpmap:102 H264/90000\r\na=rtcp-fb:102 nack\r\na=fmtp:102 packetization-mode=1\r\n"
+    "a=rtpmap:103 rtx/90000\r\na=fmtp:103 apt=102\r\n"
+    "a=rtpmap:124 flexfec-03/90000\r\na=rtcp-fb:124 transport-cc\r\n";
+
+static std::string replaced(std::string str, const std::string& from, const std::string& to) {
+    size_t pos = str.find(from);
+    check(pos != std::string::npos, "no " + from);
+    if (pos != std::string::npos) str.replace(pos, from.size(), to);
+    return str;
+}
+
+static void testNoRule() {
+    current = "no rule";
+    SdpRewriter rewriter;
+    std::string sdp = kSession + kAudio + kVideo, dst = "stale";
+    check(rewriter.Rewrite(sdp, dst) == 0 && dst == sdp, "same");
+
+    // line endings are kept, with or without the last one
+    std::string lf = "v=0\no=- 1 0 IN IP4 127.0.0.1\r\ns=-";
+    check(rewriter.Rewrite(lf, dst) == 0 && dst == lf, "line endings");
+}
+
+static void testLineRules() {
+    std::string sdp = kSession + kAudio + kVideo, dst;
+
+    current = "drop line";
+    SdpRewriter drop;
+    drop.DropLine("a=extmap:", "playout-delay");
+    check(drop.Rewrite(sdp, dst) == 1 &&
+          dst == replaced(sdp, "a=extmap:12 http://www.webrtc.org/experiments/rtp-hdrext/playout-delay\r\n", ""),
+          "extmap");
+
+    current = "candidate";
+    SdpRewriter candidate;
+    candidate.SetCandidateAddress("1.2.3.4", 9000, "10.0.0.1");
+    check(candidate.Rewrite(sdp, dst) == 1 && dst == replaced(sdp, "10.0.0.1 8000", "1.2.3.4 9000"), "from ip");
+    SdpRewriter all_candidates;
+    all_candidates.SetCandidateAddress("1.2.3.4", 9000);
+    std::string expected = replaced(replaced(sdp, "10.0.0.1 8000", "1.2.3.4 9000"), "192.168.0.1 8001", "1.2.3.4 9000");
+    check(all_candidates.Rewrite(sdp, dst) == 2 && dst == expected, "all");
+
+    current = "replace token";
+    SdpRewriter token;
+    token.ReplaceToken("c=", 2, "1.2.3.4", "", kRewriteVideo);
+    check(token.Rewrite(sdp, dst) == 1 && dst == kSession + kAudio + replaced(kVideo, "0.0.0.0", "1.2.3.4"), "c=");
+    SdpRewriter same;
+    same.ReplaceToken("c=", 2, "0.0.0.0");
+    check(same.Rewrite(sdp, dst) == 0 && dst == sdp, "the same value");
+
+    current = "direction";
+    SdpRewriter direction;
+    direction.SetDirection(SdpTransType::kSendOnly, kRewriteAudio);
+    check(direction.Rewrite(sdp, dst) == 1 && dst == kSession + replaced(kAudio, "a=sendrecv", "a=sendonly") + kVideo,
+          "audio");
+
+    current = "drop before replace";
+    SdpRewriter both;
+    both.SetCandidateAddress("1.2.3.4", 9000);
+    both.DropLine("a=candidate:", "192.168.0.1");
+    expected = replaced(replaced(sdp, "10.0.0.1 8000", "1.2.3.4 9000"),
+                        "a=candidate:foundation 1 udp 90 192.168.0.1 8001 typ host generation 0\r\n", "");
+    check(both.Rewrite(sdp, dst) == 2 && dst == expected, "dropped");
+}
+
+static void testDropCodec() {
+    std::string sdp = kSession + kAudio + kVideo, dst;
+
+    current = "drop codec";
+    SdpRewriter vp8;
+    vp8.DropCodec("vp8");
+    std::string video = replaced(kVideo, " 96 97 102", " 102");
+    video = replaced(video, "a=rtpmap:96 VP8/90000\r\na=rtcp-fb:96 nack\r\na=rtpmap:97 rtx/90000\r\na=fmtp:97 apt=96\r\n", "");
+    check(vp8.Rewrite(sdp, dst) == 5 && dst == kSession + kAudio + video, "with rtx");
+
+    SdpRewriter fec;
+    fec.DropCodec("FLEXFEC-03", kRewriteVideo);
+    fec.DropCodec("opus", kRewriteVideo);
+    video = replaced(replaced(kVideo, " 103 124\r\n", " 103\r\n"),
+                     "a=rtpmap:124 flexfec-03/90000\r\na=rtcp-fb:124 transport-cc\r\n", "");
+    check(fec.Rewrite(sdp, dst) == 3 && dst == kSession + kAudio + video, "scope");
+
+    current = "all dropped";
+    SdpRewriter opus;
+    opus.DropCodec("opus");
+    check(opus.Rewrite(sdp, dst) == 1 && dst == kSession + replaced(kAudio, "m=audio 9 ", "m=audio 0 ") + kVideo,
+          "rejected");
+
+    // the result is what the parser sees after removing the codecs from the tree
+    current = "parsed";
+    SdpRewriter rewriter;
+    rewriter.DropCodec("VP8");
+    rewriter.DropCodec("flexfec-03");
+    rewriter.Rewrite(sdp, dst);
+    SdpParser parser(dst.data(), dst.size());
+    bool parsed = parser.Parse();
+    check(parsed, "parse " + parser.FormatError());
+    auto& medias = parser.GetSessionDescription()->Medias;
+    check(medias.count("1") && medias["1"]->Codecs.size() == 2 && medias["1"]->Codecs.count(102) &&
+          medias["1"]->Codecs.count(103), "codecs");
+}
+
+static void testNoAlloc() {
+    current = "no alloc";
+    if (!IsAllocHooked()) return;
+    SdpRewriter rewriter;
+    rewriter.SetCandidateAddress("1.2.3.4", 9000);
+    rewriter.DropLine("a=extmap:", "playout-delay");
+    rewriter.DropCodec("VP8");
+    rewriter.SetDirection(SdpTransType::kSendOnly);
+    std::string sdp = kSession + kAudio + kVideo, dst;
+    rewriter.Rewrite(sdp, dst);
+    AllocScope scope;
+    rewriter.Rewrite(sdp, dst);
+    check(scope.Allocs() == 0, "allocs " + std::to_string(scope.Allocs()));
+}
+
+int main() {
+    testNoRule();
+    testLineRules();
+    testDropCodec();
+    testNoAlloc();
+    printf("test end, %d failed\n", failed);
+    return failed == 0 ? 0 : 1;
+}
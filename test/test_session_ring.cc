@@ -0,0 +1,282 @@
+/**
+ * @file test/test_session_ring.cc
+ * @brief shared memory ring of decoded sessions, in a process and across processes
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "session_ring.h"
+
+using namespace mini_sdp;
+
+static int failed = 0;
+static std::string current;
+
+static void check(bool cond, const std::string& what) {
+    if (!cond) {
+        printf("FAILED: %s: %s\n", current.c_str(), what.c_str());
+        failed++;
+    }
+}
+
+static OriginSdpAttr makeAttr(uint16_t seq, size_t sdp_len) {
+    OriginSdpAttr attr;
+    attr.sdp_type = SdpType::kOffer;
+    attr.origin_sdp = std::string(sdp_len, char('a' + seq % 26));
+    attr.stream_url = "webrtc://domain/live/stream" + std::to_string(seq);
+    attr.svrsig = seq % 2 ? "" : "10.0.0.1:abcd:efgh";
+    attr.seq = seq;
+    attr.status_code = 0;
+    attr.is_imm_send = true;
+    attr.is_push = kStreamPush;
+    attr.version = 1;
+    return attr;
+}
+
+static bool sameAttr(const OriginSdpAttr& lhs, const OriginSdpAttr& rhs) {
+    return lhs.sdp_type == rhs.sdp_type && lhs.origin_sdp == rhs.origin_sdp && lhs.stream_url == rhs.stream_url &&
+           lhs.svrsig == rhs.svrsig && lhs.seq == rhs.seq && lhs.status_code == rhs.status_code &&
+           lhs.is_imm_send == rhs.is_imm_send && lhs.is_push == rhs.is_push && lhs.version == rhs.version &&
+           lhs.is_support_aac_fmtp == rhs.is_support_aac_fmtp &&
+           lhs.is_compact_fingerprint == rhs.is_compact_fingerprint;
+}
+
+static RingSourceAddr makeSource(uint16_t port) {
+    struct sockaddr_in in = {};
+    in.sin_family = AF_INET;
+    in.sin_port = htons(port);
+    inet_pton(AF_INET, "192.0.2.1", &in.sin_addr);
+    RingSourceAddr source;
+    source.Assign(reinterpret_cast<struct sockaddr*>(&in));
+    return source;
+}
+
+static bool popOne(SessionRing& ring, OriginSdpAttr& attr, RingSourceAddr* source = nullptr) {
+    SessionRingEntry entry;
+    if (ring.Peek(&entry, 1) != 1) return false;
+    entry.ToOriginSdpAttr(attr);
+    if (source) *source = entry.meta->source;
+    ring.Release(1);
+    return true;
+}
+
+static void testPushPop() {
+    current = "push pop";
+    SessionRing ring;
+    check(ring.Create(3, 1000), "create");
+    check(ring.MaxPayload() == 512, "rounded up");
+
+    OriginSdpAttr attr = makeAttr(1, 300), popped;
+    RingSourceAddr source;
+    check(ring.TryPush(attr, makeSource(5000)), "push");
+    check(popOne(ring, popped, &source) && sameAttr(popped, attr), "fields");
+    check(source.family == AF_INET && source.port == 5000 && source.addr[0] == 192 && source.addr[3] == 1, "source");
+    check(!popOne(ring, popped), "empty");
+    check(!ring.Wait(1), "wait timeout");
+
+    current = "full";
+    for (uint16_t i = 0; i < 4; i++) check(ring.TryPush(makeAttr(i, 10), RingSourceAddr()), "push " + std::to_string(i));
+    check(!ring.TryPush(makeAttr(4, 10), RingSourceAddr()), "slots full");
+    check(ring.Wait(1), "not empty");
+    SessionRingEntry entries[8];
+    check(ring.Peek(entries, 8) == 4 && entries[3].meta->seq == 3, "peek batch");
+    ring.Release(2);
+    check(ring.TryPush(makeAttr(4, 10), RingSourceAddr()), "released");
+    check(ring.Peek(entries, 8) == 3 && entries[0].meta->seq == 2 && entries[2].meta->seq == 4, "after release");
+    ring.Release(3);
+
+    current = "payload";
+    check(!ring.TryPush(makeAttr(0, 513), RingSourceAddr()), "too large");
+    SessionRing bytes;
+    check(bytes.Create(8, 1024), "create");
+    // 1024 bytes: two entries of 400, the third skips the 224 bytes of the tail once the first is released
+    std::vector<OriginSdpAttr> attrs;
+    for (uint16_t i = 0; i < 3; i++) {
+        OriginSdpAttr big = makeAttr(i, 400);
+        big.stream_url.clear();
+        big.svrsig.clear();
+        attrs.push_back(big);
+    }
+    check(bytes.TryPush(attrs[0], RingSourceAddr()) && bytes.TryPush(attrs[1], RingSourceAddr()), "two");
+    check(!bytes.TryPush(attrs[2], RingSourceAddr()), "payload full");
+    check(popOne(bytes, popped) && sameAttr(popped, attrs[0]), "first");
+    check(bytes.TryPush(attrs[2], RingSourceAddr()), "wrapped");
+    check(!bytes.TryPush(attrs[0], RingSourceAddr()), "the skipped tail is in use");
+    check(popOne(bytes, popped) && sameAttr(popped, attrs[1]), "second");
+    check(popOne(bytes, popped) && sameAttr(popped, attrs[2]), "third");
+
+    current = "reserve";
+    SessionRingReservation reservation;
+    check(ring.Reserve(3, 0, 2, reservation), "reserve");
+    memcpy(reservation.origin_sdp, "v=0", 3);
+    memcpy(reservation.svrsig, "ab", 2);
+    reservation.meta->seq = 77;
+    SessionRingEntry entry;
+    check(ring.Peek(&entry, 1) == 0, "not committed");
+    ring.Commit(reservation);
+    check(ring.Peek(&entry, 1) == 1 && entry.meta->seq == 77 && entry.origin_sdp.IsEqual("v=0", 3) &&
+          entry.stream_url.len == 0 && entry.svrsig.IsEqual("ab", 2), "committed");
+    ring.Release(1);
+}
+
+static void testAttach() {
+    current = "attach";
+    SessionRing producer, consumer;
+    check(producer.Create(16, 4096), "create");
+    check(!consumer.Attach(-1, -1), "bad fds");
+    check(consumer.Attach(dup(producer.ShmFd()), dup(producer.EventFd())), "attach");
+    OriginSdpAttr attr = makeAttr(9, 100), popped;
+    check(producer.TryPush(attr, RingSourceAddr()), "push");
+    check(popOne(consumer, popped) && sameAttr(popped, attr), "pop");
+    check(consumer.TryPush(attr, RingSourceAddr()) && producer.Peek(nullptr, 0) == 0, "shared");
+}
+
+// a negative timeout blocks until an entry is published, as poll(-1)
+static void testWaitForever() {
+    current = "wait forever";
+    SessionRing ring;
+    check(ring.Create(4, 1024), "create");
+    std::thread producer([&ring] {
+        usleep(50000);
+        ring.TryPush(makeAttr(1, 10), RingSourceAddr());
+    });
+    auto start = std::chrono::steady_clock::now();
+    check(ring.Wait(-1), "woken up");
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    check(elapsed >= std::chrono::milliseconds(40), "blocked");
+    producer.join();
+    OriginSdpAttr popped;
+    check(popOne(ring, popped) && popped.seq == 1, "pop");
+}
+
+// the slots are written by other processes, Peek keeps what it returns in the payload area
+static void testCorruptSlot() {
+    current = "corrupt slot";
+    SessionRing ring;
+    check(ring.Create(4, 1024), "create");
+    SessionRingReservation first, second;
+    check(ring.Reserve(3, 0, 0, first) && ring.Reserve(3, 0, 0, second), "reserve");
+    // the first entry starts the payload area
+    const char* begin = first.origin_sdp;
+    const char* end = begin + ring.MaxPayload() * 2;
+    // payload_offset, payload_end and the three lengths precede the meta in a slot
+    uint32_t* fields = reinterpret_cast<uint32_t*>(first.meta) - 5;
+    fields[2] = fields[3] = fields[4] = 0xffffffff;
+    fields = reinterpret_cast<uint32_t*>(second.meta) - 5;
+    fields[0] = 0xfffffff0;
+    fields[2] = 100;
+    ring.Commit(first);
+    ring.Commit(second);
+
+    SessionRingEntry entries[2];
+    check(ring.Peek(entries, 2) == 2, "peek");
+    for (auto& entry : entries) {
+        for (const StrSlice* slice : {&entry.origin_sdp, &entry.stream_url, &entry.svrsig}) {
+            check(slice->ptr >= begin && slice->ptr + slice->len <= end, "in the payload area");
+        }
+    }
+    check(entries[0].origin_sdp.len == 1024 && entries[0].svrsig.len == 0, "clamped lengths");
+    ring.Release(2);
+}
+
+// entries of every producer in order, none lost
+static void testProducers() {
+    current = "producers";
+    const int kProducers = 4;
+    const uint16_t kPerProducer = 20000;
+    SessionRing ring;
+    check(ring.Create(64, 1 << 14), "create");
+    std::atomic<bool> stopped(false);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < kProducers; p++) {
+        threads.emplace_back([&ring, &stopped, p] {
+            for (uint16_t i = 0; i < kPerProducer && !stopped;) {
+                OriginSdpAttr attr = makeAttr(i, 50 + i % 200);
+                attr.status_code = p;
+                if (ring.TryPush(attr, RingSourceAddr())) i++;
+            }
+        });
+    }
+    std::vector<uint16_t> next(kProducers, 0);
+    size_t total = 0, bad = 0;
+    SessionRingEntry entries[32];
+    while (total < size_t(kProducers) * kPerProducer) {
+        if (!ring.Wait(1000)) break;
+        size_t n = ring.Peek(entries, 32);
+        for (size_t i = 0; i < n; i++) {
+            OriginSdpAttr attr;
+            entries[i].ToOriginSdpAttr(attr);
+            int p = attr.status_code;
+            OriginSdpAttr expected = makeAttr(next[p], 50 + next[p] % 200);
+            expected.status_code = p;
+            bad += sameAttr(attr, expected) ? 0 : 1;
+            next[p]++;
+        }
+        ring.Release(n);
+        total += n;
+    }
+    stopped = true;
+    for (auto& thread : threads) thread.join();
+    check(total == size_t(kProducers) * kPerProducer, "total " + std::to_string(total));
+    check(bad == 0, "bad " + std::to_string(bad));
+}
+
+// the consumer in a child process, woken up by the eventfd
+static void testProcess() {
+    current = "process";
+    const uint16_t kCount = 50000;
+    SessionRing ring;
+    check(ring.Create(256, 1 << 16), "create");
+    pid_t pid = fork();
+    if (pid == 0) {
+        uint16_t next = 0;
+        int bad = 0;
+        SessionRingEntry entries[64];
+        while (next < kCount && ring.Wait(5000)) {
+            size_t n = ring.Peek(entries, 64);
+            for (size_t i = 0; i < n; i++, next++) {
+                OriginSdpAttr attr;
+                entries[i].ToOriginSdpAttr(attr);
+                bad += sameAttr(attr, makeAttr(next, next % 1000)) ? 0 : 1;
+            }
+            ring.Release(n);
+        }
+        _exit(next == kCount && bad == 0 ? 0 : 1);
+    }
+    int status = 0;
+    bool exited = false;
+    for (uint16_t i = 0; i < kCount && !exited;) {
+        // pauses make the consumer wait on the eventfd
+        if (i % 5000 == 0) usleep(2000);
+        if (ring.TryPush(makeAttr(i, i % 1000), RingSourceAddr())) {
+            i++;
+        } else {
+            exited = waitpid(pid, &status, WNOHANG) == pid;
+        }
+    }
+    if (!exited) waitpid(pid, &status, 0);
+    check(WIFEXITED(status) && WEXITSTATUS(status) == 0, "child");
+}
+
+int main() {
+    testPushPop();
+    testAttach();
+    testWaitForever();
+    testCorruptSlot();
+    testProducers();
+    testProcess();
+    printf("test end, %d failed\n", failed);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,213 @@
+/**
+ * @file test/test_simulcast.cc
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "mini_sdp.h"
+#include "sdp_parser.h"
+
+using namespace mini_sdp;
+
+#ifndef MINI_SDP_CORPUS_DIR
+#define MINI_SDP_CORPUS_DIR "corpus"
+#endif
+
+static int failed = 0;
+static std::string current;
+
+static void check(bool cond, const std::string& what) {
+    if (!cond) {
+        printf("FAILED: %s: %s\n", current.c_str(), what.c_str());
+        failed++;
+    }
+}
+
+static std::string readSdp(const std::string& name) {
+    std::ifstream file(std::string(MINI_SDP_CORPUS_DIR) + "/" + name);
+    std::string sdp, line;
+    while (std::getline(file, line)) {
+        if (!line.empty()) sdp += line + "\r\n";
+    }
+    return sdp;
+}
+
+static MediaDescriptionPtr parseVideo(const std::string& sdp) {
+    SdpParser sdp_parser(sdp.c_str(), sdp.size());
+    if (!sdp_parser.Parse()) return nullptr;
+    for (auto& media_pair : sdp_parser.GetSessionDescription()->Medias) {
+        if (media_pair.second->MediaType == SdpMediaType::kVideo) return media_pair.second;
+    }
+    return nullptr;
+}
+
+// a video only offer with ssrc lines and the given simulcast lines
+static std::string makeOffer(const std::vector<uint32_t>& ssrcs, const std::string& lines) {
+    std::string sdp =
+        "v=0\r\no=- 1 2 IN IP4 127.0.0.1\r\ns=-\r\nt=0 0\r\na=group:BUNDLE 0\r\n"
+        "m=video 9 UDP/TLS/RTP/SAVPF 96 97\r\nc=IN IP4 0.0.0.0\r\n"
+        "a=ice-ufrag:Zh1u\r\na=ice-pwd:2P3Ww8ytUu1Sz6NUy1mWOUZr\r\n"
+        "a=fingerprint:sha-256 8A:BD:A6:61:75:AF:31:4C:02:81:2A:FA:12:92:4C:48:7B:9F:23:DD:BF:3D:51:30:"
+        "E7:59:5C:9B:17:3D:92:34\r\n"
+        "a=setup:actpass\r\na=mid:0\r\na=sendonly\r\na=rtcp-mux\r\n"
+        "a=rtpmap:96 H264/90000\r\na=rtcp-fb:96 nack\r\n"
+        "a=fmtp:96 level-asymmetry-allowed=1;packetization-mode=1;profile-level-id=42e01f\r\n"
+        "a=rtpmap:97 rtx/90000\r\na=fmtp:97 apt=96\r\n";
+    sdp += lines;
+    for (auto ssrc : ssrcs) sdp += "a=ssrc:" + std::to_string(ssrc) + " cname:Xb3kP0qLm2N7vR4s\r\n";
+    return sdp;
+}
+
+static OriginSdpAttr makeAttr(const std::string& sdp, uint8_t version) {
+    OriginSdpAttr attr;
+    attr.origin_sdp = sdp;
+    attr.sdp_type = SdpType::kOffer;
+    attr.stream_url = "webrtc://domain/live/stream?txSecret=0123456789abcdef";
+    attr.is_compact_fingerprint = true;
+    attr.version = version;
+    return attr;
+}
+
+// tracks, ssrc-group, rid and simulcast of the video are carried
+static void checkRoundTrip(const std::string& sdp, uint8_t version) {
+    char buff[1400];
+    ssize_t size = ParseOriginSdpToMiniSdp(makeAttr(sdp, version), buff, sizeof(buff));
+    check(size > 0, "pack");
+    if (size <= 0) return;
+    OriginSdpAttr loaded;
+    check(LoadMiniSdpToOriginSdp(buff, size, loaded) == size, "load");
+
+    auto from = parseVideo(sdp);
+    auto to = parseVideo(loaded.origin_sdp);
+    check(from && to, "parse");
+    if (!from || !to) return;
+    check(from->TracksOrder == to->TracksOrder, "tracks");
+    check(from->SsrcGroups.size() == to->SsrcGroups.size(), "ssrc-group count");
+    for (size_t i = 0; i < std::min(from->SsrcGroups.size(), to->SsrcGroups.size()); i++) {
+        check(from->SsrcGroups[i].Semantics == to->SsrcGroups[i].Semantics, "ssrc-group semantics");
+        check(from->SsrcGroups[i].Ssrcs == to->SsrcGroups[i].Ssrcs, "ssrc-group ssrcs");
+    }
+    check(from->Rids.size() == to->Rids.size(), "rid count");
+    for (size_t i = 0; i < std::min(from->Rids.size(), to->Rids.size()); i++) {
+        check(from->Rids[i].Id == to->Rids[i].Id, "rid id");
+        check(from->Rids[i].Direction == to->Rids[i].Direction, "rid direction");
+        check(from->Rids[i].Params == to->Rids[i].Params, "rid params");
+    }
+    check(from->Simulcast == to->Simulcast, "simulcast");
+}
+
+static void testParse() {
+    current = "parse";
+    auto media = parseVideo(makeOffer({11, 12, 21, 22},
+                                      "a=rid:h send pt=96;max-width=1280;max-height=720\r\n"
+                                      "a=rid:l recv\r\n"
+                                      "a=simulcast:send h recv l\r\n"
+                                      "a=ssrc-group:SIM 11 21\r\n"
+                                      "a=ssrc-group:FID 11 12\r\n"));
+    check(media != nullptr, "parse");
+    if (!media) return;
+    check(media->SsrcGroups.size() == 2 && media->SsrcGroups[0].Semantics == "SIM" &&
+          media->SsrcGroups[0].Ssrcs == std::vector<uint32_t>({11, 21}), "ssrc-group");
+    check(media->Rids.size() == 2 && media->Rids[0].Id == "h" && media->Rids[0].Direction == "send" &&
+          media->Rids[0].Params == "pt=96;max-width=1280;max-height=720" && media->Rids[1].Params.empty(), "rid");
+    check(media->Simulcast == "send h recv l", "simulcast");
+    check(!media->HasAttribute("ssrc-group") && !media->HasAttribute("rid"), "not kept as attribute");
+
+    std::string text = media->ToString();
+    check(text.find("a=ssrc-group:FID 11 12\r\n") != std::string::npos, "ssrc-group to string");
+    check(text.find("a=rid:h send pt=96;max-width=1280;max-height=720\r\n") != std::string::npos, "rid to string");
+    check(text.find("a=simulcast:send h recv l\r\n") != std::string::npos, "simulcast to string");
+
+    check(!parseVideo(makeOffer({11}, "a=rid:h sendrecv\r\n")), "bad rid direction");
+    check(!parseVideo(makeOffer({11}, "a=ssrc-group:SIM 11 abc\r\n")), "bad ssrc-group");
+}
+
+static void testRoundTrip() {
+    const std::vector<uint32_t> ssrcs = {2749138405u, 3871526094u, 1630297714u, 2918374456u, 3320517983u,
+                                         1024736695u};
+    const std::vector<std::pair<std::string, std::string>> cases = {
+        {"sim fid", "a=ssrc-group:SIM 2749138405 1630297714 3320517983\r\n"
+                    "a=ssrc-group:FID 2749138405 3871526094\r\n"
+                    "a=ssrc-group:FID 1630297714 2918374456\r\n"
+                    "a=ssrc-group:FID 3320517983 1024736695\r\n"},
+        {"rid", "a=rid:f send pt=96;max-fps=30\r\na=rid:h send\r\na=rid:q send\r\na=simulcast:send f;h;q\r\n"},
+        {"simulcast string", "a=rid:f send\r\na=rid:h send\r\na=rid:r recv\r\na=simulcast:send f,h recv r\r\n"},
+        {"custom semantics", "a=ssrc-group:X-LAYER 3320517983 2749138405\r\na=ssrc-group:FEC-FR 1024736695\r\n"},
+    };
+    for (uint8_t version = 0; version < 2; version++) {
+        for (auto& one_case : cases) {
+            current = "v" + std::to_string(version) + " " + one_case.first;
+            checkRoundTrip(makeOffer(ssrcs, one_case.second), version);
+        }
+        current = "v" + std::to_string(version) + " two tracks";
+        checkRoundTrip(makeOffer({11, 12}, "a=ssrc-group:FID 11 12\r\n"), version);
+    }
+
+    // more tracks than MiniSdpV1MediaHdr::track_num holds
+    current = "v1 many tracks";
+    std::vector<uint32_t> many;
+    for (uint32_t i = 1; i <= 200; i++) many.push_back(i * 7);
+    checkRoundTrip(makeOffer(many, "a=ssrc-group:SIM 7 1400\r\n"), 1);
+}
+
+// typical 3-layer simulcast offers fit in a datagram, even with a long signed stream url
+static void testCorpus() {
+    const char* names[] = {"chrome_simulcast_offer.sdp", "chrome_rid_simulcast_offer.sdp"};
+    for (auto name : names) {
+        for (uint8_t version = 0; version < 2; version++) {
+            current = std::string(name) + " v" + std::to_string(version);
+            OriginSdpAttr attr = makeAttr(readSdp(name), version);
+            attr.stream_url += "&txTime=" + std::string(512, 'f');
+            char buff[1400];
+            ssize_t size = ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff));
+            check(size > 0 && size_t(size) <= sizeof(buff), "within a datagram");
+            printf("%-32s v%u %4ld bytes\n", name, version, (long)size);
+        }
+    }
+}
+
+// tracks are dropped from the last one, so are the groups left with one member
+static void testDrop() {
+    current = "drop";
+    std::string sdp = makeOffer({11, 12, 21, 22, 31, 32}, "a=ssrc-group:SIM 11 21 31\r\n"
+                                                          "a=ssrc-group:FID 11 12\r\n"
+                                                          "a=ssrc-group:FID 21 22\r\n"
+                                                          "a=ssrc-group:FID 31 32\r\n");
+    OriginSdpAttr attr = makeAttr(sdp, 0);
+    char buff[1400];
+    ssize_t full = ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff));
+    PackBudget budget;
+    budget.max_size = full - 1;
+    budget.order = {kPackDropSecondSsrc};
+    PackDegradeReport report;
+    ssize_t size = ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff), budget, &report);
+    check(size > 0 && size < full, "dropped");
+    check(report.dropped.size() == 1 && report.dropped[0].value == 32, "last track dropped");
+
+    OriginSdpAttr loaded;
+    check(LoadMiniSdpToOriginSdp(buff, size, loaded) == size, "load");
+    auto media = parseVideo(loaded.origin_sdp);
+    check(media && media->TracksOrder.size() == 5, "tracks");
+    check(media && media->SsrcGroups.size() == 3 && media->SsrcGroups[0].Ssrcs == std::vector<uint32_t>({11, 21, 31}),
+          "group of the dropped track removed");
+
+    // truncated track section
+    size = ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff));
+    check(LoadMiniSdpToOriginSdp(buff, size - 1, loaded) <= 0, "truncated");
+}
+
+int main() {
+    testParse();
+    testRoundTrip();
+    testCorpus();
+    testDrop();
+    printf("test end, %d failed\n", failed);
+    return failed == 0 ? 0 : 1;
+}
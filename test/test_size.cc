@@ -0,0 +1,167 @@
+/**
+ * @file test/test_size.cc
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include <algorithm>
+#include <cstdio>
+#include <dirent.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "mini_sdp.h"
+#include "size_analyzer.h"
+
+using namespace mini_sdp;
+
+#ifndef MINI_SDP_CORPUS_DIR
+#define MINI_SDP_CORPUS_DIR "corpus"
+#endif
+
+static int failed = 0;
+static std::string current;
+
+static void check(bool cond, const std::string& what) {
+    if (!cond) {
+        printf("FAILED: %s: %s\n", current.c_str(), what.c_str());
+        failed++;
+    }
+}
+
+static bool endsWith(const std::string& str, const std::string& suffix) {
+    return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+static std::string readSdp(const std::string& path) {
+    std::ifstream file(path);
+    std::string sdp, line;
+    while (std::getline(file, line)) {
+        if (!line.empty()) sdp += line + "\r\n";
+    }
+    return sdp;
+}
+
+static const SizeWhatIf* findWhatIf(const SizeAnalysis& analysis, const std::string& name) {
+    for (auto& what_if : analysis.what_ifs) {
+        if (what_if.name == name) return &what_if;
+    }
+    return nullptr;
+}
+
+static ssize_t packSize(const OriginSdpAttr& attr) {
+    char buff[1400];
+    return ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff));
+}
+
+// the breakdown adds up and every what-if matches a real pack
+static void checkFile(const std::string& name) {
+    current = name;
+    OriginSdpAttr attr;
+    attr.origin_sdp = readSdp(std::string(MINI_SDP_CORPUS_DIR) + "/" + name);
+    attr.sdp_type = endsWith(name, "_answer.sdp") ? SdpType::kAnswer : SdpType::kOffer;
+    attr.stream_url = "webrtc://domain/live/stream";
+    if (attr.sdp_type == SdpType::kAnswer) attr.svrsig = "127.0.0.1:ufrag:svrsig";
+
+    for (uint8_t version = 0; version < 2; version++) {
+        attr.version = version;
+        SizeAnalysis analysis;
+        ssize_t total = AnalyzeMiniSdpSize(attr, analysis);
+        check(total > 0 && total == packSize(attr), "total is the packed size");
+
+        size_t sum = 0;
+        for (auto size : analysis.sections) sum += size;
+        check(sum == analysis.total, "sections add up");
+        check(analysis.sections[kSizeSectionStreamUrl] >= attr.stream_url.size() - 9, "stream url");
+        // a session level fingerprint is not carried by mini sdp
+        size_t media_pos = attr.origin_sdp.find("m=");
+        bool has_fingerprint = attr.origin_sdp.find("a=fingerprint", media_pos) != std::string::npos;
+        check((analysis.sections[kSizeSectionFingerprint] > 0) == has_fingerprint, "fingerprint");
+        check(analysis.sections[kSizeSectionCodecs] > 0, "codecs");
+        check(!analysis.medias.empty(), "medias");
+
+        OriginSdpAttr other = attr;
+        other.version = 1 - version;
+        auto what_if = findWhatIf(analysis, "v" + std::to_string(other.version));
+        check(what_if && ssize_t(what_if->size) == packSize(other), "other version");
+
+        if (version == 0) {
+            OriginSdpAttr compact = attr;
+            compact.is_compact_fingerprint = true;
+            what_if = findWhatIf(analysis, "compact_fingerprint");
+            check(what_if && ssize_t(what_if->size) == packSize(compact), "compact fingerprint");
+        }
+
+        // a budget of the drop_all size is always met
+        what_if = findWhatIf(analysis, "drop_all");
+        check(what_if && what_if->size <= analysis.total, "drop all");
+        if (what_if) {
+            PackBudget budget;
+            budget.max_size = what_if->size;
+            char buff[1400];
+            ssize_t size = ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff), budget);
+            check(size > 0 && size_t(size) <= what_if->size, "drop all within budget");
+        }
+    }
+}
+
+static void testOversize() {
+    current = "oversize";
+    OriginSdpAttr attr;
+    attr.origin_sdp = readSdp(std::string(MINI_SDP_CORPUS_DIR) + "/chrome_push_offer.sdp");
+    attr.sdp_type = SdpType::kOffer;
+    attr.stream_url = "webrtc://domain/live/" + std::string(1150, 's');
+
+    SizeAnalysis analysis;
+    check(packSize(attr) == kSdpRetSizeExceeded, "pack exceeded");
+    check(AnalyzeMiniSdpSize(attr, analysis) > 1400, "analyzed beyond the limit");
+    check(analysis.sections[kSizeSectionStreamUrl] == attr.stream_url.size() - 9, "stream url bytes");
+
+    attr.stream_url += std::string(100, 's');
+    check(AnalyzeMiniSdpSize(attr, analysis) == kSdpRetUrlExceeded, "url exceeded");
+    attr.stream_url = "webrtc://domain/live/stream";
+    attr.version = 200;
+    check(AnalyzeMiniSdpSize(attr, analysis) == kSdpRetWrongFormat, "unknown version");
+    attr.version = 0;
+    attr.origin_sdp = "v=0\r\nx=bad\r\n";
+    check(AnalyzeMiniSdpSize(attr, analysis) == kSdpRetWrongFormat, "bad sdp");
+
+    // a svrsig larger than the max packet, analyzed without overrunning the scratch buffer
+    attr.origin_sdp = readSdp(std::string(MINI_SDP_CORPUS_DIR) + "/server_answer.sdp");
+    attr.sdp_type = SdpType::kAnswer;
+    attr.svrsig = std::string(3000, 'g');
+    check(AnalyzeMiniSdpSize(attr, analysis) > 3000, "large svrsig");
+    check(analysis.sections[kSizeSectionSvrsig] >= attr.svrsig.size(), "large svrsig bytes");
+
+    // no sdp, like an error response
+    attr.sdp_type = SdpType::kSdpNone;
+    attr.svrsig = "127.0.0.1:ufrag:svrsig";
+    check(AnalyzeMiniSdpSize(attr, analysis) == packSize(attr), "no sdp");
+    check(analysis.sections[kSizeSectionStreamUrl] == attr.stream_url.size() - 9 && analysis.medias.empty(),
+          "no sdp sections");
+}
+
+int main() {
+    std::vector<std::string> names;
+    DIR* dirp = opendir(MINI_SDP_CORPUS_DIR);
+    if (!dirp) {
+        printf("open %s failed\n", MINI_SDP_CORPUS_DIR);
+        return 1;
+    }
+    while (struct dirent* entry = readdir(dirp)) {
+        std::string name = entry->d_name;
+        if (endsWith(name, ".sdp")) names.push_back(name);
+    }
+    closedir(dirp);
+    std::sort(names.begin(), names.end());
+
+    for (auto& name : names) {
+        checkFile(name);
+    }
+    testOversize();
+    printf("test end, %d failed\n", failed);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,233 @@
+/**
+ * @file test/test_snapshot.cc
+ * @brief binary snapshot of a session description, read in place
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+#include "alloc_stats.h"
+#include "sdp_parser.h"
+#include "sdp_snapshot.h"
+
+using namespace mini_sdp;
+
+#ifndef MINI_SDP_CORPUS_DIR
+#define MINI_SDP_CORPUS_DIR "corpus"
+#endif
+
+static int failed = 0;
+static std::string current;
+
+static void check(bool cond, const std::string& what) {
+    if (!cond) {
+        printf("FAILED: %s: %s\n", current.c_str(), what.c_str());
+        failed++;
+    }
+}
+
+static std::string readSdp(const std::string& name) {
+    std::ifstream file(std::string(MINI_SDP_CORPUS_DIR) + "/" + name);
+    std::string sdp, line;
+    while (std::getline(file, line)) {
+        if (!line.empty()) sdp += line + "\r\n";
+    }
+    return sdp;
+}
+
+static SessionDescriptionPtr parse(const std::string& sdp) {
+    SdpParser parser(sdp.data(), sdp.size());
+    bool parsed = parser.Parse();
+    check(parsed, "parse " + parser.FormatError());
+    return parser.GetSessionDescription();
+}
+
+static std::string snapshot(const SessionDescription& session) {
+    FlatSessionDescription flat;
+    flat.Assign(session);
+    std::string data;
+    check(WriteSdpSnapshot(flat, data) && data.size() == SdpSnapshotSize(flat), "write");
+    return data;
+}
+
+// the views of medias in place give what the graph gives
+static void checkView(const SdpSnapshotView& view, const SessionDescription& session) {
+    check(view.Medias().size() == session.Medias.size(), "media num");
+    for (auto& media_pair : session.Medias) {
+        const MediaDescription& media = *media_pair.second;
+        const FlatMedia* flat = view.FindMedia(media_pair.first);
+        check(flat != nullptr, "find " + media_pair.first);
+        if (flat == nullptr) continue;
+        check(view.Str(flat->IceUfrag).ToString() == media.IceUfrag, "ice-ufrag");
+        check(view.Str(flat->FingerprintValue).ToString() == media.Fingerprint.second, "fingerprint");
+        auto codecs = view.Codecs(flat->Codecs);
+        check(codecs.size() == media.Codecs.size(), "codec num");
+        auto it = media.Codecs.begin();
+        for (auto& codec : codecs) {
+            check(codec.Format == it->first && view.Str(codec.Name).ToString() == it->second->Name, "codec");
+            ++it;
+        }
+        auto order = view.Ssrcs(flat->TracksOrder);
+        check(std::vector<uint32_t>(order.begin(), order.end()) == media.TracksOrder, "tracks order");
+    }
+    check(view.FindMedia("no such mid") == nullptr, "not found");
+}
+
+static void checkFile(const std::string& name) {
+    current = name;
+    SessionDescriptionPtr session = parse(readSdp(name));
+    std::string expected = session->ToString();
+    std::string data = snapshot(*session);
+
+    SdpSnapshotView view;
+    check(view.Open(data.data(), data.size()) && view.Size() == data.size(), "open");
+    if (!view.IsOpen()) return;
+    checkView(view, *session);
+    check(view.ToString() == expected, "to string");
+    check(view.ToSessionDescription()->ToString() == expected, "to session");
+
+    // relocated, nothing refers to the address it was written at
+    std::vector<uint64_t> moved(data.size() / sizeof(uint64_t) + 1);
+    memcpy(moved.data(), data.data(), data.size());
+    data.assign(data.size(), '\0');
+    check(view.Open(moved.data(), moved.size() * sizeof(uint64_t)), "open moved");
+    check(view.ToString() == expected, "moved");
+
+    FlatSessionDescription flat;
+    view.ToFlat(flat);
+    check(flat.ToString() == expected, "to flat");
+}
+
+static void testCorpus() {
+    DIR* dir = opendir(MINI_SDP_CORPUS_DIR);
+    check(dir != nullptr, "corpus");
+    if (dir == nullptr) return;
+    size_t files = 0;
+    while (struct dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name.size() > 4 && name.compare(name.size() - 4, 4, ".sdp") == 0) {
+            checkFile(name);
+            files++;
+        }
+    }
+    closedir(dir);
+    current = "corpus";
+    check(files > 0, "no file");
+}
+
+// buffers are aligned, the same as shared memory or a mapped file
+static bool open(SdpSnapshotView& view, const std::string& data, std::vector<uint64_t>& buff) {
+    buff.assign(data.size() / sizeof(uint64_t) + 1, 0);
+    memcpy(buff.data(), data.data(), data.size());
+    return view.Open(buff.data(), data.size());
+}
+
+static void testInvalid() {
+    current = "invalid";
+    SessionDescriptionPtr session = parse(readSdp("chrome_simulcast_offer.sdp"));
+    const std::string data = snapshot(*session);
+    SdpSnapshotView view;
+    std::vector<uint64_t> buff;
+    check(open(view, data, buff), "valid");
+    check(!view.Open(nullptr, 0), "null");
+    check(!view.IsOpen(), "closed after failure");
+
+    // truncated
+    for (size_t len : {size_t(0), size_t(8), sizeof(SdpSnapshotHeader), data.size() / 2, data.size() - 8}) {
+        check(!open(view, data.substr(0, len), buff), "truncated " + std::to_string(len));
+    }
+
+    // misaligned
+    std::vector<uint64_t> misaligned(data.size() / sizeof(uint64_t) + 2);
+    char* ptr = reinterpret_cast<char*>(misaligned.data()) + 4;
+    memcpy(ptr, data.data(), data.size());
+    check(!view.Open(ptr, data.size()), "misaligned");
+
+    auto corrupted = [&](const std::string& what, const std::function<void(SdpSnapshotHeader&, char*)>& corrupt) {
+        std::string copy = data;
+        corrupt(*reinterpret_cast<SdpSnapshotHeader*>(&copy[0]), &copy[0]);
+        check(!open(view, copy, buff), what);
+    };
+    corrupted("magic", [](SdpSnapshotHeader& header, char*) { header.Magic = 0; });
+    corrupted("version", [](SdpSnapshotHeader& header, char*) { header.FormatVersion++; });
+    corrupted("byte order", [](SdpSnapshotHeader& header, char*) { header.ByteOrder = 0x0201; });
+    corrupted("record size", [](SdpSnapshotHeader& header, char*) {
+        header.Sections[kSnapshotMedias].RecordSize += 4;
+    });
+    corrupted("section", [](SdpSnapshotHeader& header, char*) { header.Sections[kSnapshotCodecs].Count += 1000; });
+    corrupted("session string", [](SdpSnapshotHeader& header, char*) {
+        header.SessionName.Offset = header.Sections[kSnapshotStrings].Count;
+        header.SessionName.Size = 1;
+    });
+    corrupted("media string", [](SdpSnapshotHeader& header, char* data) {
+        FlatMedia* media = reinterpret_cast<FlatMedia*>(data + header.Sections[kSnapshotMedias].Offset);
+        media->IceOptions.Size = UINT32_MAX;
+    });
+    corrupted("media range", [](SdpSnapshotHeader& header, char* data) {
+        FlatMedia* media = reinterpret_cast<FlatMedia*>(data + header.Sections[kSnapshotMedias].Offset);
+        media->Codecs.Begin = header.Sections[kSnapshotCodecs].Count;
+    });
+    corrupted("media type", [](SdpSnapshotHeader& header, char* data) {
+        FlatMedia* media = reinterpret_cast<FlatMedia*>(data + header.Sections[kSnapshotMedias].Offset);
+        media->MediaType = SdpMediaType(7);
+    });
+    corrupted("codec attr", [](SdpSnapshotHeader& header, char* data) {
+        FlatAttr* attr = reinterpret_cast<FlatAttr*>(data + header.Sections[kSnapshotAttrs].Offset);
+        attr->Value.Offset = UINT32_MAX;
+    });
+
+    // a buffer too small is not written
+    FlatSessionDescription flat;
+    flat.Assign(*session);
+    std::string small(data.size() - 1, '\0');
+    check(WriteSdpSnapshot(flat, &small[0], small.size()) == 0, "small buffer");
+}
+
+// an empty description has empty sections
+static void testEmpty() {
+    current = "empty";
+    FlatSessionDescription flat;
+    std::string data;
+    check(WriteSdpSnapshot(flat, data), "write");
+    SdpSnapshotView view;
+    std::vector<uint64_t> buff;
+    check(open(view, data, buff) && view.Medias().empty(), "open");
+    check(view.IsOpen() && view.ToString() == flat.ToString(), "to string");
+}
+
+static void testNoAlloc() {
+    current = "no alloc";
+    if (!IsAllocHooked()) return;
+    SessionDescriptionPtr session = parse(readSdp("chrome_simulcast_offer.sdp"));
+    FlatSessionDescription flat;
+    flat.Assign(*session);
+    std::string data;
+    WriteSdpSnapshot(flat, data);
+    std::vector<uint64_t> buff(data.size() / sizeof(uint64_t) + 1);
+
+    AllocScope scope;
+    WriteSdpSnapshot(flat, reinterpret_cast<char*>(buff.data()), buff.size() * sizeof(uint64_t));
+    SdpSnapshotView view;
+    bool opened = view.Open(buff.data(), data.size());
+    size_t sum = 0;
+    for (auto& media : view.Medias()) sum += view.Codecs(media.Codecs).size() + view.Str(media.IcePwd).len;
+    check(scope.Allocs() == 0, "allocs " + std::to_string(scope.Allocs()));
+    check(opened && sum > 0, "read");
+}
+
+int main() {
+    testCorpus();
+    testInvalid();
+    testEmpty();
+    testNoAlloc();
+    printf("test end, %d failed\n", failed);
+    return failed == 0 ? 0 : 1;
+}
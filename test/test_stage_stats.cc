@@ -0,0 +1,159 @@
+/**
+ * @file test/test_stage_stats.cc
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "mini_sdp.h"
+#include "sdp_parser.h"
+#include "stage_stats.h"
+
+using namespace mini_sdp;
+
+#ifndef MINI_SDP_CORPUS_DIR
+#define MINI_SDP_CORPUS_DIR "corpus"
+#endif
+
+static int failed = 0;
+
+static void check(bool cond, const char* what) {
+    if (!cond) {
+        printf("FAILED: %s\n", what);
+        failed++;
+    }
+}
+
+static std::string readSdp(const std::string& name) {
+    std::ifstream file(std::string(MINI_SDP_CORPUS_DIR) + "/" + name);
+    std::string sdp, line;
+    while (std::getline(file, line)) {
+        if (!line.empty()) sdp += line + "\r\n";
+    }
+    return sdp;
+}
+
+static void testHistogram() {
+    // every value is in the bucket it is mapped to, and buckets are ordered
+    size_t last_idx = 0;
+    for (uint64_t value = 0; value < (1u << 20); value += 1 + value / 64) {
+        size_t idx = HistogramBucketIndex(value);
+        check(idx >= last_idx, "bucket order");
+        check(HistogramBucketLowerBound(idx) <= value && value <= HistogramBucketUpperBound(idx), "bucket bound");
+        check(value < 8 || HistogramBucketUpperBound(idx) - HistogramBucketLowerBound(idx) <= value / 8,
+              "bucket relative error");
+        last_idx = idx;
+    }
+    check(HistogramBucketIndex(~0ull) == kHistogramBucketNum - 1, "last bucket");
+
+    Histogram histogram;
+    for (uint64_t value = 1; value <= 1000; value++) histogram.Record(value);
+    HistogramSnapshot snapshot;
+    histogram.Snapshot(snapshot);
+    check(snapshot.count == 1000 && snapshot.sum == 500500 && snapshot.max == 1000, "count/sum/max");
+    uint64_t p50 = snapshot.Percentile(0.5), p99 = snapshot.Percentile(0.99);
+    check(p50 >= 500 && p50 <= 500 * 9 / 8, "p50");
+    check(p99 >= 990 && p99 <= 1000, "p99");
+
+    HistogramSnapshot merged;
+    merged.Merge(snapshot);
+    merged.Merge(snapshot);
+    check(merged.count == 2000 && merged.Percentile(0.5) == p50, "merge");
+}
+
+static uint64_t stageCount(const StageStatsSnapshot& snapshot, SdpStage stage) {
+    return snapshot.latency[size_t(stage)].count;
+}
+
+static void testStages() {
+    OriginSdpAttr attr;
+    attr.origin_sdp = readSdp("server_answer.sdp");
+    attr.sdp_type = SdpType::kAnswer;
+    attr.stream_url = "webrtc://domain/live/stream";
+
+    auto before = GetStageStatsSnapshot();
+    char buff[1400];
+    ssize_t size = ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff));
+    OriginSdpAttr loaded;
+    LoadMiniSdpToOriginSdp(buff, size, loaded);
+    check(ParseOriginSdpToMiniSdp(attr, buff, 10) == kSdpRetSizeExceeded, "size exceeded");
+    OriginSdpAttr bad = attr;
+    bad.origin_sdp = "v=0\r\nx=bad\r\n";
+    check(ParseOriginSdpToMiniSdp(bad, buff, sizeof(buff)) == kSdpRetSdpUnknownLine, "unknown line");
+    StopStreamAttr stop;
+    size = BuildStopStreamPacket(buff, sizeof(buff), stop);
+    LoadStopStreamPacket(buff, size, stop);
+    auto after = GetStageStatsSnapshot();
+
+#if MINI_SDP_STAGE_STATS
+    check(stageCount(after, SdpStage::kParse) - stageCount(before, SdpStage::kParse) == 3, "parse count");
+    check(stageCount(after, SdpStage::kPack) - stageCount(before, SdpStage::kPack) == 3, "pack count");
+    check(stageCount(after, SdpStage::kPackMedia) - stageCount(before, SdpStage::kPackMedia) >= 2, "pack media");
+    check(stageCount(after, SdpStage::kLoad) - stageCount(before, SdpStage::kLoad) == 1, "load count");
+    check(stageCount(after, SdpStage::kLoadMedia) - stageCount(before, SdpStage::kLoadMedia) == 2, "load media");
+    check(stageCount(after, SdpStage::kStopBuild) - stageCount(before, SdpStage::kStopBuild) == 1, "stop build");
+    check(stageCount(after, SdpStage::kStopLoad) - stageCount(before, SdpStage::kStopLoad) == 1, "stop load");
+
+    auto pack = size_t(SdpStage::kPack);
+    check(after.retcodes[pack][0] - before.retcodes[pack][0] == 1, "pack ok");
+    check(after.retcodes[pack][SdpRetcodeSlot(kSdpRetSdpUnknownLine)] -
+          before.retcodes[pack][SdpRetcodeSlot(kSdpRetSdpUnknownLine)] == 1, "pack unknown line");
+    check(after.retcodes[pack][SdpRetcodeSlot(kSdpRetSizeExceeded)] -
+          before.retcodes[pack][SdpRetcodeSlot(kSdpRetSizeExceeded)] == 1, "pack size exceeded");
+    auto unknown_line = size_t(SdpParser::StatCode::kUnknownLine) + 1;
+    check(after.parse_stats[unknown_line] - before.parse_stats[unknown_line] == 1, "parse unknown line");
+
+    // disabled at runtime
+    SetStageStatsEnabled(false);
+    before = GetStageStatsSnapshot();
+    ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff));
+    after = GetStageStatsSnapshot();
+    check(stageCount(after, SdpStage::kPack) == stageCount(before, SdpStage::kPack), "disabled");
+    SetStageStatsEnabled(true);
+#else
+    check(stageCount(after, SdpStage::kPack) == 0, "compiled out");
+#endif
+}
+
+// stats of exited threads are kept
+static void testThreads() {
+    OriginSdpAttr attr;
+    attr.origin_sdp = readSdp("obs_whip_offer.sdp");
+    attr.sdp_type = SdpType::kOffer;
+    attr.stream_url = "webrtc://domain/live/stream";
+
+    const int kThreads = 4, kLoops = 100;
+    auto before = GetStageStatsSnapshot();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kThreads; i++) {
+        threads.emplace_back([&] {
+            char buff[1400];
+            for (int j = 0; j < kLoops; j++) ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff));
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    auto after = GetStageStatsSnapshot();
+#if MINI_SDP_STAGE_STATS
+    check(stageCount(after, SdpStage::kPack) - stageCount(before, SdpStage::kPack) == kThreads * kLoops,
+          "threads");
+#endif
+
+    auto& latency = after.latency[size_t(SdpStage::kPack)];
+    printf("pack: count %lu, mean %.0f ns, p50 %lu ns, p99 %lu ns\n", (unsigned long)latency.count, latency.Mean(),
+           (unsigned long)latency.Percentile(0.5), (unsigned long)latency.Percentile(0.99));
+}
+
+int main() {
+    testHistogram();
+    testStages();
+    testThreads();
+    printf("test end, %d failed\n", failed);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,143 @@
+/**
+ * @file test/test_transcode.cc
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include <algorithm>
+#include <cstdio>
+#include <dirent.h>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "mini_sdp.h"
+#include "sdp_parser.h"
+#include "transcode_context.h"
+
+using namespace mini_sdp;
+
+#ifndef MINI_SDP_CORPUS_DIR
+#define MINI_SDP_CORPUS_DIR "corpus"
+#endif
+
+static int failed = 0;
+static std::string current;
+
+static void check(bool cond, const std::string& what) {
+    if (!cond) {
+        printf("FAILED: %s: %s\n", current.c_str(), what.c_str());
+        failed++;
+    }
+}
+
+static bool endsWith(const std::string& str, const std::string& suffix) {
+    return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+static std::string readSdp(const std::string& name) {
+    std::ifstream file(std::string(MINI_SDP_CORPUS_DIR) + "/" + name);
+    std::string sdp, line;
+    while (std::getline(file, line)) {
+        if (!line.empty()) sdp += line + "\r\n";
+    }
+    return sdp;
+}
+
+static OriginSdpAttr makeAttr(const std::string& name, uint8_t version) {
+    OriginSdpAttr attr;
+    attr.origin_sdp = readSdp(name);
+    attr.sdp_type = endsWith(name, "_answer.sdp") ? SdpType::kAnswer : SdpType::kOffer;
+    attr.stream_url = "webrtc://domain/live/stream";
+    attr.svrsig = "1h8s";
+    attr.is_compact_fingerprint = true;
+    attr.version = version;
+    return attr;
+}
+
+static bool isSameAttr(const OriginSdpAttr& lhs, const OriginSdpAttr& rhs) {
+    return lhs.sdp_type == rhs.sdp_type && lhs.origin_sdp == rhs.origin_sdp && lhs.stream_url == rhs.stream_url &&
+           lhs.svrsig == rhs.svrsig && lhs.status_code == rhs.status_code && lhs.seq == rhs.seq &&
+           lhs.is_imm_send == rhs.is_imm_send && lhs.is_support_aac_fmtp == rhs.is_support_aac_fmtp &&
+           lhs.is_compact_fingerprint == rhs.is_compact_fingerprint && lhs.is_push == rhs.is_push &&
+           lhs.version == rhs.version;
+}
+
+// the context gives what the plain functions give, whatever it built before
+static void checkTranscode(TranscodeContext& ctx, const OriginSdpAttr& attr) {
+    char expected[1400], buff[1400];
+    ssize_t expected_size = ParseOriginSdpToMiniSdp(attr, expected, sizeof(expected));
+    ssize_t size = ParseOriginSdpToMiniSdp(ctx, attr, buff, sizeof(buff));
+    check(expected_size > 0 && size == expected_size &&
+          std::equal(buff, buff + size, expected), "pack v" + std::to_string(attr.version));
+
+    SdpParser parser(attr.origin_sdp.data(), attr.origin_sdp.size());
+    parser.Parse();
+    check(ctx.GetSessionDescription() &&
+          ctx.GetSessionDescription()->ToString() == parser.GetSessionDescription()->ToString(), "parsed");
+
+    OriginSdpAttr expected_attr, loaded;
+    loaded.origin_sdp = "stale";
+    loaded.svrsig = "stale";
+    ssize_t load_size = LoadMiniSdpToOriginSdp(expected, expected_size, expected_attr);
+    check(LoadMiniSdpToOriginSdp(ctx, buff, size, loaded) == load_size && isSameAttr(loaded, expected_attr),
+          "load v" + std::to_string(attr.version));
+    check(ctx.GetSessionDescription()->ToString() == expected_attr.origin_sdp, "loaded");
+}
+
+static void checkFailure(TranscodeContext& ctx, const OriginSdpAttr& valid) {
+    current = "failure";
+    OriginSdpAttr attr = valid;
+    // fails in the middle of a media
+    attr.origin_sdp = valid.origin_sdp + "m=video 9 UDP/TLS/RTP/SAVPF 96\r\na=setup:unknown\r\n";
+    char buff[1400];
+    check(ParseOriginSdpToMiniSdp(ctx, attr, buff, sizeof(buff)) == kSdpRetSdpParamError, "invalid sdp");
+    check(LoadMiniSdpToOriginSdp(ctx, "\xff" "SDPxxxx", 8, attr) <= 0, "invalid mini sdp");
+    checkTranscode(ctx, valid);
+}
+
+static void checkClear(TranscodeContext& ctx, const OriginSdpAttr& attr) {
+    current = "clear";
+    ctx.Clear();
+    check(!ctx.GetSessionDescription(), "cleared");
+    checkTranscode(ctx, attr);
+
+    // the description of the last call is kept by the caller, the next call builds a new one
+    SessionDescriptionPtr kept = ctx.GetSessionDescription();
+    std::string kept_sdp = kept->ToString();
+    checkTranscode(ctx, attr);
+    check(kept->ToString() == kept_sdp && kept != ctx.GetSessionDescription(), "kept");
+}
+
+int main() {
+    std::vector<std::string> names;
+    DIR* dirp = opendir(MINI_SDP_CORPUS_DIR);
+    if (!dirp) {
+        printf("open %s failed\n", MINI_SDP_CORPUS_DIR);
+        return 1;
+    }
+    while (struct dirent* entry = readdir(dirp)) {
+        std::string name = entry->d_name;
+        if (endsWith(name, ".sdp")) names.push_back(name);
+    }
+    closedir(dirp);
+    std::sort(names.begin(), names.end());
+
+    // one context for all files, each shape rebuilds the one before, then in the reverse order
+    TranscodeContext ctx;
+    for (int round = 0; round < 2; round++) {
+        for (auto& name : names) {
+            for (uint8_t version = 0; version < 2; version++) {
+                current = name;
+                checkTranscode(ctx, makeAttr(name, version));
+            }
+        }
+        std::reverse(names.begin(), names.end());
+    }
+    checkFailure(ctx, makeAttr(names.front(), 0));
+    checkClear(ctx, makeAttr(names.back(), 1));
+    printf("test end, %d failed\n", failed);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,285 @@
+/**
+ * @file test/test_v1.cc
+ * @brief
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ */
+#include <chrono>
+#include <cstdio>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "mini_sdp.h"
+#include "mini_sdp_delta.h"
+#include "sdp_parser.h"
+
+using namespace mini_sdp;
+
+static int failed = 0;
+
+static void check(bool cond, const char* what) {
+    if (!cond) {
+        printf("FAILED: %s\n", what);
+        failed++;
+    }
+}
+
+static const char* kFingerprint =
+    "a=fingerprint:sha-256 8A:BD:A6:61:75:AF:31:4C:02:81:2A:FA:12:92:4C:48:7B:9F:23:DD:BF:3D:51:30:"
+    "E7:59:5C:9B:17:3D:92:34\r\n";
+
+static const char* kExtmaps =
+    "a=extmap:2 http://www.webrtc.org/experiments/rtp-hdrext/abs-send-time\r\n"
+    "a=extmap:3 http://www.ietf.org/id/draft-holmer-rmcat-transport-wide-cc-extensions-01\r\n"
+    "a=extmap:12 http://www.webrtc.org/experiments/rtp-hdrext/playout-delay\r\n";
+
+// chrome style offer, every H264 profile comes with a rtx codec
+static std::string MakeOffer(int h264_num, bool aac) {
+    std::string sdp = "v=0\r\no=- 4611731400430051336 2 IN IP4 127.0.0.1\r\ns=-\r\nt=0 0\r\na=group:BUNDLE 0 1\r\n";
+    sdp += aac ? "m=audio 9 UDP/TLS/RTP/SAVPF 111 13\r\n" : "m=audio 9 UDP/TLS/RTP/SAVPF 111\r\n";
+    sdp += "c=IN IP4 0.0.0.0\r\na=ice-ufrag:Zh1u\r\na=ice-pwd:2P3Ww8ytUu1Sz6NUy1mWOUZr\r\n";
+    sdp += kFingerprint;
+    sdp += "a=setup:actpass\r\na=mid:0\r\n";
+    sdp += kExtmaps;
+    sdp += "a=sendonly\r\na=rtcp-mux\r\n"
+           "a=rtpmap:111 opus/48000/2\r\na=rtcp-fb:111 transport-cc\r\na=fmtp:111 minptime=10;useinbandfec=1\r\n";
+    if (aac) {
+        sdp += "a=rtpmap:13 MP4A-LATM/48000/2\r\n"
+               "a=fmtp:13 object=2;cpresent=0;config=400024203fc0c0c0c0c0c0c0c0c0\r\n";
+    }
+    sdp += "a=ssrc:3570614608 cname:4TOk42mSjXCkVIa6\r\n";
+
+    std::string pts, lines;
+    for (int i = 0, pt = 96; i < h264_num; i++, pt += 2) {
+        std::string fmt = std::to_string(pt), rtx = std::to_string(pt + 1);
+        pts += " " + fmt + " " + rtx;
+        lines += "a=rtpmap:" + fmt + " H264/90000\r\n"
+                 "a=rtcp-fb:" + fmt + " goog-remb\r\na=rtcp-fb:" + fmt + " transport-cc\r\n"
+                 "a=rtcp-fb:" + fmt + " nack\r\n"
+                 "a=fmtp:" + fmt + " level-asymmetry-allowed=1;packetization-mode=1;profile-level-id=42e01f\r\n"
+                 "a=rtpmap:" + rtx + " rtx/90000\r\na=fmtp:" + rtx + " apt=" + fmt + "\r\n";
+    }
+    sdp += "m=video 9 UDP/TLS/RTP/SAVPF" + pts + "\r\n";
+    sdp += "c=IN IP4 0.0.0.0\r\na=ice-ufrag:Zh1u\r\na=ice-pwd:2P3Ww8ytUu1Sz6NUy1mWOUZr\r\n";
+    sdp += kFingerprint;
+    sdp += "a=setup:actpass\r\na=mid:1\r\n";
+    sdp += kExtmaps;
+    sdp += "a=sendonly\r\na=rtcp-mux\r\n" + lines;
+    sdp += "a=ssrc:2291961624 cname:4TOk42mSjXCkVIa6\r\na=ssrc:1366387413 cname:4TOk42mSjXCkVIa6\r\n";
+    return sdp;
+}
+
+// server answer with a candidate
+static std::string MakeAnswer(bool ipv6) {
+    std::string ip = ipv6 ? "2001:db8::1" : "127.0.0.1";
+    std::string addr = ipv6 ? "IP6" : "IP4";
+    std::string sdp = "v=0\r\no=- 1 0 IN " + addr + " " + ip + "\r\ns=-\r\nt=0 0\r\na=group:BUNDLE 0 1\r\n";
+    for (int mid = 0; mid < 2; mid++) {
+        sdp += mid == 0 ? "m=audio 1 UDP/TLS/RTP/SAVPF 111\r\n" : "m=video 1 UDP/TLS/RTP/SAVPF 102 124\r\n";
+        sdp += "c=IN " + addr + " " + ip + "\r\n"
+               "a=candidate:foundation 1 udp 100 " + ip + " 8000 typ host generation 0\r\n"
+               "a=ice-ufrag:0_xxxx_d71956d9cc93e4a467b11e06fdaf039a_de71a64097d807c3\r\n"
+               "a=ice-pwd:be8577c0a03b0d3ffa4e5235\r\n";
+        sdp += kFingerprint;
+        sdp += "a=setup:passive\r\na=sendrecv\r\na=mid:" + std::to_string(mid) + "\r\n";
+        sdp += kExtmaps;
+        if (mid == 0) {
+            sdp += "a=rtpmap:111 opus/48000/2\r\na=rtcp-fb:111 nack\r\na=fmtp:111 stereo=1;useinbandfec=1\r\n"
+                   "a=ssrc:27172315 cname:webrtccore\r\n";
+        } else {
+            sdp += "a=rtpmap:102 H264/90000\r\na=rtcp-fb:102 nack\r\na=rtcp-fb:102 transport-cc\r\n"
+                   "a=fmtp:102 bframe-enabled=1;packetization-mode=1\r\n"
+                   "a=rtpmap:124 flexfec-03/90000\r\n"
+                   "a=ssrc:50331648 cname:webrtccore\r\na=ssrc:50331649 cname:webrtccore\r\n";
+        }
+    }
+    return sdp;
+}
+
+struct Sample {
+    const char*     name;
+    OriginSdpAttr   attr;
+};
+
+static std::vector<Sample> MakeCorpus() {
+    std::vector<Sample> corpus;
+    auto add = [&](const char* name, const std::string& sdp, SdpType type, StreamDirection is_push) {
+        Sample sample;
+        sample.name = name;
+        sample.attr.origin_sdp = sdp;
+        sample.attr.sdp_type = type;
+        sample.attr.stream_url = "webrtc://domain/live/xxxx_d71956d9cc93e4a467b11e06fdaf039a?txSecret=0123456789abcdef";
+        sample.attr.svrsig = type == SdpType::kAnswer ? "1h8s" : "";
+        sample.attr.seq = 7;
+        sample.attr.status_code = type == SdpType::kAnswer ? 200 : 0;
+        sample.attr.is_imm_send = type == SdpType::kOffer;
+        sample.attr.is_push = is_push;
+        sample.attr.is_compact_fingerprint = true;
+        corpus.push_back(sample);
+    };
+    add("offer-2", MakeOffer(2, false), SdpType::kOffer, kStreamPull);
+    add("offer-8-aac", MakeOffer(8, true), SdpType::kOffer, kStreamDefault);
+    add("offer-16", MakeOffer(16, false), SdpType::kOffer, kStreamPush);
+    add("answer", MakeAnswer(false), SdpType::kAnswer, kStreamPull);
+    add("answer-ipv6", MakeAnswer(true), SdpType::kAnswer, kStreamDefault);
+    add("error", "", SdpType::kSdpNone, kStreamDefault);
+    return corpus;
+}
+
+static SessionDescriptionPtr Parse(const std::string& sdp) {
+    SdpParser parser(sdp.data(), sdp.size());
+    parser.Parse();
+    return parser.GetSessionDescription();
+}
+
+static std::string Pack(const OriginSdpAttr& attr, uint8_t version) {
+    OriginSdpAttr versioned = attr;
+    versioned.version = version;
+    std::string buff(1400, 0);
+    ssize_t size = ParseOriginSdpToMiniSdp(versioned, &buff[0], buff.size());
+    buff.resize(size > 0 ? size : 0);
+    return buff;
+}
+
+// v1 carries everything v0 does
+static void testRoundTrip(const Sample& sample) {
+    std::string v0 = Pack(sample.attr, 0);
+    std::string v1 = Pack(sample.attr, 1);
+    check(!v0.empty() && !v1.empty(), sample.name);
+    check(IsMiniSdpReqPack(v1.data(), v1.size()), "v1 is request");
+
+    OriginSdpAttr attr0, attr1;
+    check(LoadMiniSdpToOriginSdp(v0.data(), v0.size(), attr0) == (ssize_t)v0.size(), "load v0");
+    check(LoadMiniSdpToOriginSdp(v1.data(), v1.size(), attr1) == (ssize_t)v1.size(), "load v1");
+    check(attr0.version == 0 && attr1.version == 1, "version");
+    check(attr1.sdp_type == sample.attr.sdp_type && attr1.seq == sample.attr.seq &&
+          attr1.status_code == sample.attr.status_code, "header");
+    check(attr1.stream_url == attr0.stream_url && attr1.svrsig == attr0.svrsig, "url and svrsig");
+    check(attr1.is_push == attr0.is_push && attr1.is_imm_send == attr0.is_imm_send, "flags");
+
+    if (sample.attr.sdp_type != SdpType::kSdpNone) {
+        auto sdp0 = Parse(attr0.origin_sdp);
+        auto sdp1 = Parse(attr1.origin_sdp);
+        SdpDelta delta;
+        check(DiffSessionDescription(*sdp0, *sdp1, delta) && delta.Empty(), "same content");
+        for (auto& media_pair : sdp0->Medias) {
+            auto& media1 = sdp1->Medias[media_pair.first];
+            check(media1 && media1->Fingerprint == media_pair.second->Fingerprint, "fingerprint");
+            check(media1 && media1->Candidate == media_pair.second->Candidate, "candidate");
+            check(media1 && media1->ExtMap == media_pair.second->ExtMap, "extmap");
+            check(media1 && media1->TransType == media_pair.second->TransType &&
+                  media1->RoleType == media_pair.second->RoleType, "direction and role");
+        }
+        check(sdp1->AddrType == sdp0->AddrType, "addr type");
+    }
+
+    // a loaded sdp packs to the same packet, svrsig is composed as ip:ufrag:svrsig by the loader
+    attr1.svrsig = sample.attr.svrsig;
+    attr1.is_compact_fingerprint = true;
+    check(Pack(attr1, 1) == v1, "fixpoint");
+
+    // bounds checked, never reads out of the packet
+    for (size_t len = 0; len < v1.size(); len++) {
+        std::string truncated = v1.substr(0, len);
+        OriginSdpAttr attr;
+        check(LoadMiniSdpToOriginSdp(truncated.data(), truncated.size(), attr) < 0, "truncated");
+    }
+}
+
+static void testDispatch() {
+    // unknown version
+    std::string v1 = Pack(MakeCorpus()[0].attr, 1);
+    v1[4] = 9;
+    OriginSdpAttr attr;
+    check(LoadMiniSdpToOriginSdp(v1.data(), v1.size(), attr) == kSdpRetWrongFormat, "unknown version");
+
+    // a known version without the magic does not reach a codec
+    for (uint8_t version = 0; version < 2; version++) {
+        std::string packet = Pack(MakeCorpus()[0].attr, version);
+        packet[1] = 'X';
+        MiniSdpDispatchInfo info;
+        check(LoadMiniSdpToOriginSdp(packet.data(), packet.size(), attr) == kSdpRetWrongFormat, "no magic load");
+        check(PeekMiniSdp(packet.data(), packet.size(), info) == kSdpRetWrongFormat, "no magic peek");
+    }
+    // a v0 header cut short, on the heap so a sanitizer sees a read past it
+    std::vector<char> header(std::begin("\xFFSDP"), std::end("\xFFSDP"));
+    check(LoadMiniSdpToOriginSdp(header.data(), header.size(), attr) == kSdpRetWrongFormat, "v0 header only");
+
+    attr = MakeCorpus()[0].attr;
+    attr.version = 9;
+    char buff[1400];
+    check(ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff)) == kSdpRetVersionUnsupported, "pack unknown version");
+
+    // stop packet carries the version of the session
+    StopStreamAttr stop;
+    stop.svrsig = "127.0.0.1:Zh1u:1h8s";
+    stop.version = 1;
+    ssize_t size = BuildStopStreamPacket(buff, sizeof(buff), stop);
+    StopStreamAttr stop2;
+    check(size > 0 && LoadStopStreamPacket(buff, size, stop2) == size && stop2.version == 1, "stop v1");
+    stop.version = 9;
+    check(BuildStopStreamPacket(buff, sizeof(buff), stop) == kSdpRetVersionUnsupported, "stop unknown version");
+
+    // budget packing measures the chosen version
+    attr = MakeCorpus()[2].attr;
+    attr.version = 1;
+    attr.stream_url += std::string(1200 - attr.stream_url.size(), 'a');
+    PackBudget budget;
+    PackDegradeReport report;
+    size = ParseOriginSdpToMiniSdp(attr, buff, sizeof(buff), budget, &report);
+    size_t saved = 0;
+    for (auto& record : report.dropped) saved += record.saved;
+    check(size > 0 && !report.dropped.empty() && report.full_size - saved == report.packed_size, "v1 budget");
+    OriginSdpAttr attr2;
+    check(LoadMiniSdpToOriginSdp(buff, size, attr2) == size && attr2.version == 1, "load v1 budget");
+}
+
+template <typename Func>
+static double nsPerOp(int loops, Func&& func) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < loops; i++) func();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / loops;
+}
+
+static void benchVersions(const std::vector<Sample>& corpus) {
+    const int kLoops = 5000;
+    printf("%-12s %-8s %-8s %-8s %-10s %-10s %-10s %-10s\n",
+           "sdp", "v0", "v1", "saved", "pack v0", "pack v1", "load v0", "load v1");
+    size_t total0 = 0, total1 = 0;
+    for (auto& sample : corpus) {
+        std::string v0 = Pack(sample.attr, 0);
+        std::string v1 = Pack(sample.attr, 1);
+        total0 += v0.size();
+        total1 += v1.size();
+        double pack_ns[2], load_ns[2];
+        const std::string* packets[2] = {&v0, &v1};
+        for (uint8_t version = 0; version < 2; version++) {
+            pack_ns[version] = nsPerOp(kLoops, [&] { Pack(sample.attr, version); });
+            load_ns[version] = nsPerOp(kLoops, [&] {
+                OriginSdpAttr attr;
+                LoadMiniSdpToOriginSdp(packets[version]->data(), packets[version]->size(), attr);
+            });
+        }
+        printf("%-12s %-8zu %-8zu %-8zd %-10.0f %-10.0f %-10.0f %-10.0f\n", sample.name, v0.size(), v1.size(),
+               (ssize_t)v0.size() - (ssize_t)v1.size(), pack_ns[0], pack_ns[1], load_ns[0], load_ns[1]);
+    }
+    printf("total: v0 %zu bytes, v1 %zu bytes, %.1f%% smaller\n", total0, total1,
+           100.0 * (total0 - total1) / total0);
+    check(total1 < total0, "v1 is smaller");
+}
+
+int main() {
+    printf("test v1\n");
+    auto corpus = MakeCorpus();
+    for (auto& sample : corpus) {
+        testRoundTrip(sample);
+    }
+    testDispatch();
+    benchVersions(corpus);
+    printf("test end, %d failed\n", failed);
+    return failed == 0 ? 0 : 1;
+}
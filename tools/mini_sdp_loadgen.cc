@@ -0,0 +1,419 @@
+/**
+ * @file tools/mini_sdp_loadgen.cc
+ * @brief multi-threaded UDP load generator for mini sdp signaling
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ * usage: mini_sdp_loadgen [--server <ip:port> | --loopback] [--threads <n>] [--rate <requests/s>]
+ *                         [--duration <s>] [--loss <0~1>] [--stop-ratio <0~1>] [--version <n>]
+ *                         [--rto <ms>] [--max-rto <ms>] [--retransmits <n>] [--max-inflight <n>]
+ *                         [--seed <n>] <offer file or corpus dir>...
+ *        mini_sdp_loadgen --serve <port> [--threads <n>] [--duration <s>]
+ *
+ */
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fstream>
+#include <memory>
+#include <poll.h>
+#include <random>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "histogram.h"
+#include "mini_sdp_client.h"
+
+using namespace mini_sdp;
+
+struct LoadOptions {
+    struct sockaddr_in  server;
+    bool                loopback = false;
+    int                 serve_port = -1;
+    int                 threads = 2;
+    double              rate = 1000;        // requests/s of all threads
+    double              duration = 10;      // s, 0 to serve forever
+    double              loss = 0;           // drop probability of every packet sent by the generator
+    double              stop_ratio = 0;     // share of stop requests
+    uint8_t             version = 0;
+    size_t              max_inflight = 4096;    // per thread, requests over it are skipped
+    uint32_t            seed = 0;
+    MiniSdpClient::Options client;
+    std::vector<std::string> offers;
+};
+
+// lines end with CRLF whatever the file uses
+static bool readSdp(const std::string& path, std::string& sdp) {
+    std::ifstream file(path);
+    if (!file) return false;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!line.empty()) sdp += line + "\r\n";
+    }
+    return true;
+}
+
+// a directory contributes its *_offer.sdp files
+static bool readOffers(const std::string& path, std::vector<std::string>& offers) {
+    DIR* dirp = opendir(path.c_str());
+    if (!dirp) {
+        std::string sdp;
+        if (!readSdp(path, sdp)) return false;
+        offers.push_back(sdp);
+        return true;
+    }
+    std::vector<std::string> names;
+    while (struct dirent* entry = readdir(dirp)) {
+        std::string name = entry->d_name;
+        const std::string suffix = "_offer.sdp";
+        if (name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+            names.push_back(name);
+        }
+    }
+    closedir(dirp);
+    for (auto& name : names) {
+        std::string sdp;
+        if (!readSdp(path + "/" + name, sdp)) return false;
+        offers.push_back(sdp);
+    }
+    return true;
+}
+
+static bool parseAddr(const char* str, struct sockaddr_in& addr) {
+    const char* colon = strrchr(str, ':');
+    if (!colon) return false;
+    std::string ip(str, colon - str);
+    addr = sockaddr_in();
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(uint16_t(atoi(colon + 1)));
+    return inet_pton(AF_INET, ip.c_str(), &addr.sin_addr) == 1;
+}
+
+static uint64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static int udpSocket(int port, bool reuse_port) {
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd < 0) return -1;
+    int on = 1;
+    if (reuse_port) setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on));
+    int buff_size = 4 << 20;
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &buff_size, sizeof(buff_size));
+    setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &buff_size, sizeof(buff_size));
+    struct sockaddr_in addr = sockaddr_in();
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(uint16_t(port));
+    // port < 0: bound on the first send
+    if (port >= 0 && bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/*
+ * responder
+ *  offer 完整解码后以原始 SDP 打包为 answer，停流包原样回复，服务端的编解码开销与真实信令节点相当
+ */
+static void runResponder(int fd, const std::atomic<bool>& stopped, std::atomic<uint64_t>& served) {
+    char buff[1500], reply[1500];
+    while (!stopped.load(std::memory_order_relaxed)) {
+        struct pollfd pfd = {fd, POLLIN, 0};
+        if (poll(&pfd, 1, 50) <= 0) continue;
+        struct sockaddr_in from;
+        socklen_t from_len = sizeof(from);
+        ssize_t len = recvfrom(fd, buff, sizeof(buff), 0, (struct sockaddr*)&from, &from_len);
+        if (len <= 0) continue;
+
+        ssize_t reply_len = 0;
+        if (IsMiniSdpStopPack(buff, len)) {
+            StopStreamAttr stop;
+            if (LoadStopStreamPacket(buff, len, stop) <= 0) continue;
+            reply_len = BuildStopStreamPacket(reply, sizeof(reply), stop);
+        } else if (IsMiniSdpReqPack(buff, len)) {
+            OriginSdpAttr attr;
+            if (LoadMiniSdpToOriginSdp(buff, len, attr) <= 0) continue;
+            attr.sdp_type = SdpType::kAnswer;
+            attr.svrsig = "svrsig";
+            reply_len = ParseOriginSdpToMiniSdp(attr, reply, sizeof(reply));
+        }
+        if (reply_len <= 0) continue;
+        sendto(fd, reply, reply_len, 0, (struct sockaddr*)&from, from_len);
+        served.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+struct SenderResult {
+    Histogram   offer_rtt;      // ns, offer -> answer
+    Histogram   stop_rtt;       // ns, stop -> response
+    uint64_t    offers = 0;
+    uint64_t    stops = 0;
+    uint64_t    skipped = 0;    // over max_inflight
+    uint64_t    dropped = 0;    // induced loss
+    uint64_t    pack_errors = 0;
+    MiniSdpClient::Stats stats;
+};
+
+/*
+ * sender
+ *  开环发送：按固定间隔安排请求，延迟从计划发送时间开始计算，发送线程落后时排队时间也计入延迟，
+ *  不会因为服务端变慢而少发请求 (coordinated omission)
+ */
+static void runSender(const LoadOptions& options, int index, MiniSdpSeqAllocator& seqs, SenderResult& result) {
+    int fd = udpSocket(-1, false);
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    std::mt19937_64 rng(options.seed * 1000003ull + index);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    uint64_t server = MiniSdpPeerKey(options.server);
+
+    MiniSdpClient client([&](uint64_t peer, const char* data, size_t len) {
+        if (options.loss > 0 && uniform(rng) < options.loss) {
+            result.dropped++;
+            return;
+        }
+        struct sockaddr_in addr = options.server;
+        addr.sin_addr.s_addr = htonl(uint32_t(peer >> 16));
+        addr.sin_port = htons(uint16_t(peer));
+        sendto(fd, data, len, 0, (struct sockaddr*)&addr, sizeof(addr));
+    }, seqs, options.client, nowNs() / 1000000);
+
+    OriginSdpAttr offer;
+    offer.sdp_type = SdpType::kOffer;
+    offer.is_imm_send = true;
+    offer.version = options.version;
+    StopStreamAttr stop;
+    stop.svrsig = "127.0.0.1:ufrag:svrsig";
+    stop.version = options.version;
+
+    uint64_t interval_ns = uint64_t(1e9 * options.threads / options.rate);
+    uint64_t start_ns = nowNs() + interval_ns * index / options.threads;
+    uint64_t end_ns = start_ns + uint64_t(options.duration * 1e9);
+    // every request completes within the retransmit schedule
+    uint64_t drain_ns = end_ns + uint64_t(options.client.max_rto_ms) * (options.client.max_retransmits + 1) * 1000000;
+    uint64_t next_ns = start_ns;
+    char buff[1500];
+    for (uint64_t now_ns = nowNs(); now_ns < drain_ns; now_ns = nowNs()) {
+        if (now_ns >= end_ns && client.PendingCount() == 0) break;
+        uint64_t now_ms = now_ns / 1000000;
+
+        for (; next_ns <= now_ns && next_ns < end_ns; next_ns += interval_ns) {
+            if (client.PendingCount() >= options.max_inflight) {
+                result.skipped++;
+                continue;
+            }
+            uint64_t scheduled_ns = next_ns;
+            ssize_t ret;
+            if (options.stop_ratio > 0 && uniform(rng) < options.stop_ratio) {
+                result.stops++;
+                ret = client.Stop(server, stop, now_ms, [&result, scheduled_ns](const MiniSdpClient::Response& response) {
+                    if (response.status == MiniSdpClient::Status::kAnswered) {
+                        result.stop_rtt.Record(nowNs() - scheduled_ns);
+                    }
+                });
+            } else {
+                result.offers++;
+                offer.origin_sdp = options.offers[rng() % options.offers.size()];
+                char url[64];
+                snprintf(url, sizeof(url), "webrtc://domain/live/load_%016llx", (unsigned long long)rng());
+                offer.stream_url = url;
+                ret = client.Request(server, offer, now_ms, [&result, scheduled_ns](const MiniSdpClient::Response& response) {
+                    if (response.status == MiniSdpClient::Status::kAnswered) {
+                        result.offer_rtt.Record(nowNs() - scheduled_ns);
+                    }
+                });
+            }
+            if (ret < 0) result.pack_errors++;
+        }
+
+        // sleep until the next send or retransmit, sub-millisecond so that senders do not spin
+        uint64_t wake_ns = next_ns < end_ns ? next_ns : drain_ns;
+        if (client.NextTimeoutMs() != UINT64_MAX) wake_ns = std::min(wake_ns, client.NextTimeoutMs() * 1000000);
+        uint64_t timeout_ns = wake_ns > now_ns ? std::min<uint64_t>(wake_ns - now_ns, 10000000) : 0;
+        struct timespec timeout = {0, long(timeout_ns)};
+        struct pollfd pfd = {fd, POLLIN, 0};
+        ppoll(&pfd, 1, &timeout, nullptr);
+
+        now_ms = nowNs() / 1000000;
+        struct sockaddr_in from;
+        socklen_t from_len = sizeof(from);
+        ssize_t len;
+        while ((len = recvfrom(fd, buff, sizeof(buff), 0, (struct sockaddr*)&from, &from_len)) > 0) {
+            client.OnPacket(MiniSdpPeerKey(from), buff, len, now_ms);
+            from_len = sizeof(from);
+        }
+        client.Advance(now_ms);
+    }
+    result.stats = client.GetStats();
+    close(fd);
+}
+
+static void printLatency(const char* name, const HistogramSnapshot& snapshot) {
+    auto us = [](uint64_t ns) { return ns / 1000.0; };
+    printf("%-8s %10lu %10.1f %10.1f %10.1f %10.1f %10.1f\n", name, (unsigned long)snapshot.count,
+           us(snapshot.Percentile(0.5)), us(snapshot.Percentile(0.99)), us(snapshot.Percentile(0.999)),
+           us(snapshot.max), us(uint64_t(snapshot.Mean())));
+}
+
+static void usage(const char* name) {
+    printf("usage: %s [--server <ip:port> | --loopback] [--threads <n>] [--rate <requests/s>]\n"
+           "       %*s [--duration <s>] [--loss <0~1>] [--stop-ratio <0~1>] [--version <n>]\n"
+           "       %*s [--rto <ms>] [--max-rto <ms>] [--retransmits <n>] [--max-inflight <n>]\n"
+           "       %*s [--seed <n>] <offer file or corpus dir>...\n"
+           "       %s --serve <port> [--threads <n>] [--duration <s>]\n",
+           name, (int)strlen(name), "", (int)strlen(name), "", (int)strlen(name), "", name);
+}
+
+static bool parseArgs(int argc, char** argv, LoadOptions& options) {
+    parseAddr("127.0.0.1:8000", options.server);
+    options.seed = std::random_device()();
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (!strcmp(arg, "--server") && has_value) {
+            if (!parseAddr(argv[++i], options.server)) return false;
+        } else if (!strcmp(arg, "--loopback")) {
+            options.loopback = true;
+        } else if (!strcmp(arg, "--serve") && has_value) {
+            options.serve_port = atoi(argv[++i]);
+        } else if (!strcmp(arg, "--threads") && has_value) {
+            options.threads = std::max(1, atoi(argv[++i]));
+        } else if (!strcmp(arg, "--rate") && has_value) {
+            options.rate = atof(argv[++i]);
+        } else if (!strcmp(arg, "--duration") && has_value) {
+            options.duration = atof(argv[++i]);
+        } else if (!strcmp(arg, "--loss") && has_value) {
+            options.loss = atof(argv[++i]);
+        } else if (!strcmp(arg, "--stop-ratio") && has_value) {
+            options.stop_ratio = atof(argv[++i]);
+        } else if (!strcmp(arg, "--version") && has_value) {
+            options.version = (uint8_t)atoi(argv[++i]);
+        } else if (!strcmp(arg, "--rto") && has_value) {
+            options.client.initial_rto_ms = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(arg, "--max-rto") && has_value) {
+            options.client.max_rto_ms = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(arg, "--retransmits") && has_value) {
+            options.client.max_retransmits = (uint32_t)atoi(argv[++i]);
+        } else if (!strcmp(arg, "--max-inflight") && has_value) {
+            options.max_inflight = (size_t)atol(argv[++i]);
+        } else if (!strcmp(arg, "--seed") && has_value) {
+            options.seed = (uint32_t)atol(argv[++i]);
+        } else if (arg[0] != '-') {
+            if (!readOffers(arg, options.offers)) {
+                printf("read %s failed\n", arg);
+                return false;
+            }
+        } else {
+            return false;
+        }
+    }
+    return options.rate > 0 && (options.serve_port >= 0 || !options.offers.empty());
+}
+
+int main(int argc, char** argv) {
+    LoadOptions options;
+    if (!parseArgs(argc, argv, options)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // responders share the port with SO_REUSEPORT, one socket per thread
+    std::atomic<bool> stopped(false);
+    std::atomic<uint64_t> served(0);
+    std::vector<std::thread> responders;
+    if (options.serve_port >= 0 || options.loopback) {
+        int port = options.serve_port >= 0 ? options.serve_port : 0;
+        for (int i = 0; i < options.threads; i++) {
+            int fd = udpSocket(port, true);
+            if (fd < 0) {
+                printf("bind port %d failed\n", port);
+                return 1;
+            }
+            if (port == 0) {
+                socklen_t addr_len = sizeof(options.server);
+                getsockname(fd, (struct sockaddr*)&options.server, &addr_len);
+                port = ntohs(options.server.sin_port);
+            }
+            responders.emplace_back([fd, &stopped, &served] {
+                runResponder(fd, stopped, served);
+                close(fd);
+            });
+        }
+        printf("responding on 127.0.0.1:%d with %d threads\n", port, options.threads);
+    }
+    if (options.serve_port >= 0) {
+        if (options.duration > 0) std::this_thread::sleep_for(std::chrono::duration<double>(options.duration));
+        else for (;;) std::this_thread::sleep_for(std::chrono::seconds(1));
+        stopped = true;
+        for (auto& thread : responders) thread.join();
+        printf("served %lu\n", (unsigned long)served.load());
+        return 0;
+    }
+
+    char server[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &options.server.sin_addr, server, sizeof(server));
+    printf("%d threads, %.0f requests/s for %.1f s to %s:%d, %lu offers, loss %.3f, stop ratio %.3f, seed %u\n",
+           options.threads, options.rate, options.duration, server, ntohs(options.server.sin_port),
+           (unsigned long)options.offers.size(), options.loss, options.stop_ratio, options.seed);
+
+    MiniSdpSeqAllocator seqs(options.seed);
+    std::vector<std::unique_ptr<SenderResult>> results;
+    std::vector<std::thread> senders;
+    uint64_t start_ns = nowNs();
+    for (int i = 0; i < options.threads; i++) {
+        results.emplace_back(new SenderResult());
+        senders.emplace_back(runSender, std::cref(options), i, std::ref(seqs), std::ref(*results.back()));
+    }
+    for (auto& thread : senders) thread.join();
+    double elapsed = (nowNs() - start_ns) / 1e9;
+    stopped = true;
+    for (auto& thread : responders) thread.join();
+
+    HistogramSnapshot offer_rtt, stop_rtt, snapshot;
+    SenderResult total;
+    for (auto& result : results) {
+        result->offer_rtt.Snapshot(snapshot);
+        offer_rtt.Merge(snapshot);
+        result->stop_rtt.Snapshot(snapshot);
+        stop_rtt.Merge(snapshot);
+        total.offers += result->offers;
+        total.stops += result->stops;
+        total.skipped += result->skipped;
+        total.dropped += result->dropped;
+        total.pack_errors += result->pack_errors;
+        total.stats.requests += result->stats.requests;
+        total.stats.retransmits += result->stats.retransmits;
+        total.stats.answered += result->stats.answered;
+        total.stats.timeouts += result->stats.timeouts;
+        total.stats.unmatched += result->stats.unmatched;
+        total.stats.errors += result->stats.errors;
+    }
+
+    printf("\n%-8s %10s %10s %10s %10s %10s %10s\n", "latency", "count", "p50 us", "p99 us", "p99.9 us", "max us",
+           "mean us");
+    printLatency("offer", offer_rtt);
+    printLatency("stop", stop_rtt);
+
+    const MiniSdpClient::Stats& stats = total.stats;
+    printf("\nrequests %lu (offers %lu, stops %lu), skipped %lu, pack errors %lu\n", (unsigned long)stats.requests,
+           (unsigned long)total.offers, (unsigned long)total.stops, (unsigned long)total.skipped,
+           (unsigned long)total.pack_errors);
+    printf("answered %lu, timeouts %lu, retransmits %lu, dropped %lu, unmatched %lu, errors %lu\n",
+           (unsigned long)stats.answered, (unsigned long)stats.timeouts, (unsigned long)stats.retransmits,
+           (unsigned long)total.dropped, (unsigned long)stats.unmatched, (unsigned long)stats.errors);
+    printf("elapsed %.2f s, sent %.0f requests/s, answered %.0f requests/s\n", elapsed,
+           (stats.requests + stats.retransmits) / elapsed, stats.answered / elapsed);
+    return 0;
+}
@@ -0,0 +1,122 @@
+/**
+ * @file tools/mini_sdp_size.cc
+ * @brief per-section size breakdown of a packed mini sdp
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2021 Tencent. All rights reserved.
+ *
+ * usage: mini_sdp_size [--answer] [--version <n>] [--url <stream url>] [--svrsig <svrsig>]
+ *                      [--compact-fingerprint] [--no-aac-fmtp] <sdp file>
+ *
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include "size_analyzer.h"
+
+using namespace mini_sdp;
+
+static const char* mediaTypeName(SdpMediaType media_type) {
+    switch (media_type) {
+    case SdpMediaType::kAudio: return "audio";
+    case SdpMediaType::kVideo: return "video";
+    case SdpMediaType::kData:  return "data";
+    default:                   return "unknown";
+    }
+}
+
+// lines end with CRLF whatever the file uses
+static bool readSdp(const char* path, std::string& sdp) {
+    std::ifstream file(path);
+    if (!file) return false;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!line.empty()) sdp += line + "\r\n";
+    }
+    return true;
+}
+
+static void usage(const char* name) {
+    printf("usage: %s [--answer] [--version <n>] [--url <stream url>] [--svrsig <svrsig>]\n"
+           "       %*s [--compact-fingerprint] [--no-aac-fmtp] <sdp file>\n",
+           name, (int)strlen(name), "");
+}
+
+static void printAnalysis(const SizeAnalysis& analysis) {
+    auto percent = [&](size_t size) { return analysis.total ? 100.0 * size / analysis.total : 0; };
+    long headroom = long(analysis.limit) - long(analysis.total);
+    printf("total %lu bytes, limit %lu, %s %ld bytes\n\n", (unsigned long)analysis.total,
+           (unsigned long)analysis.limit, headroom >= 0 ? "headroom" : "EXCEEDED by", labs(headroom));
+
+    printf("%-16s %8s %8s\n", "section", "bytes", "share");
+    for (int i = 0; i < kSizeSectionNum; i++) {
+        size_t size = analysis.sections[i];
+        printf("%-16s %8lu %7.1f%%\n", SizeSectionName(SizeSection(i)), (unsigned long)size, percent(size));
+    }
+
+    if (!analysis.medias.empty()) {
+        printf("\n%-8s %-6s %7s %7s %7s %7s %7s %7s\n", "mid", "type", "codecs", "bytes", "aac", "exts", "bytes",
+               "tracks");
+        for (auto& media : analysis.medias) {
+            printf("%-8s %-6s %7lu %7lu %7lu %7lu %7lu %7lu\n", media.mid.c_str(), mediaTypeName(media.media_type),
+                   (unsigned long)media.codec_num, (unsigned long)media.codecs, (unsigned long)media.aac_config,
+                   (unsigned long)media.ext_num, (unsigned long)media.extensions, (unsigned long)media.tracks);
+        }
+    }
+
+    if (!analysis.what_ifs.empty()) {
+        printf("\n%-24s %8s %8s\n", "what if", "bytes", "saved");
+        for (auto& what_if : analysis.what_ifs) {
+            printf("%-24s %8lu %8ld%s\n", what_if.name.c_str(), (unsigned long)what_if.size,
+                   long(analysis.total) - long(what_if.size), what_if.size <= analysis.limit ? "" : "  (exceeded)");
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    OriginSdpAttr attr;
+    attr.sdp_type = SdpType::kOffer;
+    attr.stream_url = "webrtc://domain/live/stream";
+    const char* path = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--answer")) {
+            attr.sdp_type = SdpType::kAnswer;
+        } else if (!strcmp(argv[i], "--version") && i + 1 < argc) {
+            attr.version = (uint8_t)atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--url") && i + 1 < argc) {
+            attr.stream_url = argv[++i];
+        } else if (!strcmp(argv[i], "--svrsig") && i + 1 < argc) {
+            attr.svrsig = argv[++i];
+        } else if (!strcmp(argv[i], "--compact-fingerprint")) {
+            attr.is_compact_fingerprint = true;
+        } else if (!strcmp(argv[i], "--no-aac-fmtp")) {
+            attr.is_support_aac_fmtp = false;
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!path) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (!readSdp(path, attr.origin_sdp)) {
+        printf("read %s failed\n", path);
+        return 1;
+    }
+
+    SizeAnalysis analysis;
+    ssize_t ret = AnalyzeMiniSdpSize(attr, analysis);
+    if (ret < 0) {
+        printf("analyze failed: %ld\n", (long)ret);
+        return 1;
+    }
+    printAnalysis(analysis);
+    return 0;
+}